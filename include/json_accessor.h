@@ -18,6 +18,29 @@ extern "C"
 {
 #endif
 
+    /**
+     * @struct JsonKey
+     * @brief A lookup key with its length and hash computed up front.
+     *
+     * Handlers that read the same keys from every document can build their
+     * keys once with json_key() and use the `_k` accessors, which compare
+     * hash and length before touching the key bytes.
+     */
+    typedef struct
+    {
+        const char *str; /**< The key string; must outlive the handle. */
+        size_t length;   /**< Length of the key in bytes. */
+        uint32_t hash;   /**< json_hash_key() of the key. */
+    } JsonKey;
+
+    /**
+     * @brief Builds a lookup handle for a key.
+     *
+     * @param[in] key The null-terminated key string. It is not copied.
+     * @return The handle, usable with any object.
+     */
+    JsonKey json_key(const char *key);
+
     /**
      * @brief Retrieves a string value from a JSON object by key.
      *
@@ -72,6 +95,73 @@ extern "C"
      */
     bool json_is_null(const JsonValue *object, const char *key);
 
+    /**
+     * @brief Retrieves a value of any type from a JSON object by key.
+     *
+     * @param[in] object Pointer to the JsonValue object (must be of type JSON_OBJECT).
+     * @param[in] key    The key string to search for.
+     * @return Pointer to the member's value if found, NULL otherwise.
+     */
+    JsonValue *json_get_value(const JsonValue *object, const char *key);
+
+    /**
+     * @name Accessors by precomputed key
+     * Same as the accessors above, but look the member up by a JsonKey.
+     * @{
+     */
+    const char *json_get_string_k(const JsonValue *object, JsonKey key);
+    double json_get_number_k(const JsonValue *object, JsonKey key);
+    bool json_get_bool_k(const JsonValue *object, JsonKey key);
+    JsonValue *json_get_array_k(const JsonValue *object, JsonKey key);
+    JsonValue *json_get_object_k(const JsonValue *object, JsonKey key);
+    bool json_is_null_k(const JsonValue *object, JsonKey key);
+    JsonValue *json_get_value_k(const JsonValue *object, JsonKey key);
+    /** @} */
+
+/** Bit for a JsonType in JsonFieldSpec::types. */
+#define JSON_TYPE_BIT(type) (1u << (type))
+
+    /**
+     * @struct JsonFieldSpec
+     * @brief Describes one member to extract with json_get_many().
+     */
+    typedef struct
+    {
+        JsonKey key;        /**< The member's key. */
+        unsigned int types; /**< Accepted types as JSON_TYPE_BIT() flags, or 0 for any type. */
+    } JsonFieldSpec;
+
+    /**
+     * @brief Extracts several members of an object in a single pass.
+     *
+     * Each pair of the object is visited once and matched against the specs
+     * by hash and length, so pulling a fixed set of fields costs one scan
+     * instead of one scan per field. As with the single-key accessors, the
+     * first member with a given key is the one used.
+     *
+     * @param[in]  object Pointer to the JsonValue object (must be of type JSON_OBJECT).
+     * @param[in]  specs  The members to extract.
+     * @param[in]  n      Number of specs.
+     * @param[out] out    Receives, for each spec, the member's value, or NULL
+     *                    if it is missing or not of an accepted type.
+     * @return The number of specs that were filled in.
+     */
+    size_t json_get_many(const JsonValue *object, const JsonFieldSpec specs[], size_t n, JsonValue *out[]);
+
+    /**
+     * @brief Returns a packed numeric array as a contiguous array of doubles.
+     *
+     * Arrays parsed with JsonParserOptions.pack_numeric_arrays that contain
+     * only numbers are stored packed. The returned pointer aliases the
+     * array's storage (no copy), so it suits vectorized loops directly.
+     *
+     * @param[in]  array  Pointer to the JsonValue array.
+     * @param[out] length Receives the number of elements. May be NULL.
+     * @return Pointer to the elements if the array is packed, NULL otherwise
+     *         (in which case `*length` is set to 0).
+     */
+    const double *json_array_as_doubles(const JsonValue *array, size_t *length);
+
 #ifdef __cplusplus
 }
 #endif
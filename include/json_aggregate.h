@@ -0,0 +1,75 @@
+#ifndef JSON_AGGREGATE_H
+#define JSON_AGGREGATE_H
+
+#include "json_types.h"
+
+/**
+ * @file json_aggregate.h
+ * @brief Declares aggregation primitives over JSON arrays.
+ *
+ * These functions reduce the numbers held in an array, or in a field of
+ * each object in an array (e.g. `orders[*].amount`), in a single pass.
+ * Packed numeric arrays are reduced directly with vectorized kernels;
+ * other arrays are gathered into small blocks of doubles first.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @enum JsonAggregateOp
+     * @brief Selects which aggregates to compute. Values may be OR'ed together.
+     */
+    typedef enum
+    {
+        JSON_AGG_SUM = 1 << 0,   /**< Sum of the values. */
+        JSON_AGG_MIN = 1 << 1,   /**< Smallest value. */
+        JSON_AGG_MAX = 1 << 2,   /**< Largest value. */
+        JSON_AGG_COUNT = 1 << 3, /**< Number of values. */
+        JSON_AGG_MEAN = 1 << 4,  /**< Arithmetic mean of the values. */
+        JSON_AGG_ALL = 0x1f      /**< Every aggregate. */
+    } JsonAggregateOp;
+
+    /**
+     * @struct JsonAggregate
+     * @brief Results of json_array_aggregate().
+     *
+     * Only the fields selected by the requested operations are meaningful;
+     * `count` is always filled in.
+     */
+    typedef struct
+    {
+        size_t count; /**< Number of numeric values aggregated. */
+        double sum;   /**< Sum of the values. */
+        double min;   /**< Smallest value, 0.0 if there were none. */
+        double max;   /**< Largest value, 0.0 if there were none. */
+        double mean;  /**< Mean of the values, 0.0 if there were none. */
+    } JsonAggregate;
+
+    /**
+     * @brief Aggregates the numbers in an array or in a field of its objects.
+     *
+     * With an empty or NULL `path` the array's own items are aggregated.
+     * Otherwise `path` is a dot-separated sequence of keys looked up in each
+     * item, so `"amount"` aggregates `array[*].amount` and `"price.net"`
+     * aggregates `array[*].price.net`. Items that are not numbers, or that
+     * do not contain the path, are skipped.
+     *
+     * @param[in]  array Pointer to the JsonValue array.
+     * @param[in]  path  Dot-separated key path within each item, or NULL.
+     * @param[in]  ops   The aggregates to compute (JsonAggregateOp flags).
+     * @param[out] out   Receives the results.
+     * @return 1 on success, 0 if `array` is not an array or memory runs out.
+     *
+     * @note Sums are accumulated in several lanes, so the result may differ
+     *       from a strictly sequential sum in the last bits.
+     */
+    int json_array_aggregate(const JsonValue *array, const char *path, unsigned int ops, JsonAggregate *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_AGGREGATE_H
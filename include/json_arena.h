@@ -0,0 +1,109 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @file json_arena.h
+ * @brief Bump allocator used as a node pool for JSON documents.
+ *
+ * An arena hands out memory from large blocks and releases it all at once.
+ * Resetting an arena keeps its blocks, so a long-lived arena that is reset
+ * between documents stops calling `json_alloc` once it has grown to the
+ * size of the largest document it has held.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @struct JsonArenaBlock
+     * @brief A block of memory owned by a JsonArena (opaque).
+     */
+    typedef struct JsonArenaBlock JsonArenaBlock;
+
+    /**
+     * @struct JsonArena
+     * @brief A chain of blocks that allocations are carved from.
+     */
+    typedef struct
+    {
+        JsonArenaBlock *first;   /**< First block in the chain. */
+        JsonArenaBlock *current; /**< Block allocations are currently carved from. */
+        size_t block_size;       /**< Default size of newly allocated blocks. */
+    } JsonArena;
+
+    /**
+     * @brief Initializes an empty arena.
+     *
+     * @param[out] arena      Pointer to the JsonArena to initialize.
+     * @param[in]  block_size Size in bytes of each block, or 0 for the default.
+     */
+    void json_arena_init(JsonArena *arena, size_t block_size);
+
+    /**
+     * @brief Allocates memory from the arena.
+     *
+     * The returned memory is suitably aligned for any JSON node type and
+     * remains valid until the arena is reset or destroyed.
+     *
+     * @param[in,out] arena Pointer to the JsonArena.
+     * @param[in]     size  Number of bytes to allocate.
+     * @return Pointer to the allocated memory, or NULL if allocation fails.
+     */
+    void *json_arena_alloc(JsonArena *arena, size_t size);
+
+    /**
+     * @brief Copies a range of characters into the arena as a null-terminated string.
+     *
+     * @param[in,out] arena Pointer to the JsonArena.
+     * @param[in]     s     The source characters.
+     * @param[in]     len   The number of characters to copy.
+     * @return Pointer to the copied string, or NULL if allocation fails.
+     */
+    char *json_arena_strdup_range(JsonArena *arena, const char *s, size_t len);
+
+    /**
+     * @brief Checks whether memory was allocated from the arena.
+     *
+     * Walks the arena's blocks, so the cost grows with their number.
+     *
+     * @param[in] arena Pointer to the JsonArena.
+     * @param[in] ptr   The address to look up.
+     * @return 1 if `ptr` lies in memory handed out by the arena, 0 otherwise.
+     *         After a reset, memory handed out before it may still be
+     *         reported as owned.
+     */
+    int json_arena_owns(const JsonArena *arena, const void *ptr);
+
+    /**
+     * @brief Returns the memory held by an arena.
+     *
+     * @param[in] arena Pointer to the JsonArena.
+     * @return Total size in bytes of the blocks the arena has allocated,
+     *         including blocks kept by a reset.
+     */
+    size_t json_arena_size(const JsonArena *arena);
+
+    /**
+     * @brief Releases every allocation made from the arena, keeping its blocks.
+     *
+     * @param[in,out] arena Pointer to the JsonArena to reset.
+     */
+    void json_arena_reset(JsonArena *arena);
+
+    /**
+     * @brief Frees all blocks owned by the arena.
+     *
+     * @param[in,out] arena Pointer to the JsonArena to destroy. It may be
+     *                      reused after calling json_arena_init() again.
+     */
+    void json_arena_destroy(JsonArena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_ARENA_H
@@ -0,0 +1,64 @@
+#ifndef JSON_ATOMIC_H
+#define JSON_ATOMIC_H
+
+/**
+ * @file json_atomic.h
+ * @brief Minimal atomic primitives used internally by the JSON library.
+ *
+ * The library is built as C99, which has no standard atomics, so these
+ * macros map onto the GCC/Clang `__atomic` builtins. On other compilers
+ * they degrade to plain loads and stores and JSON_ATOMICS_AVAILABLE is 0;
+ * the features built on top of them are then only safe from one thread.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#define JSON_ATOMICS_AVAILABLE 1
+
+#define JSON_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define JSON_ATOMIC_STORE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define JSON_ATOMIC_EXCHANGE(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#define JSON_ATOMIC_CAS(ptr, expected, desired)                  \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), 0, \
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define JSON_ATOMIC_TRY_LOCK(flag) (!__atomic_test_and_set((flag), __ATOMIC_ACQUIRE))
+#define JSON_ATOMIC_UNLOCK(flag) __atomic_clear((flag), __ATOMIC_RELEASE)
+#define JSON_ATOMIC_ADD(ptr, val) __atomic_add_fetch((ptr), (val), __ATOMIC_ACQ_REL)
+#define JSON_ATOMIC_SUB(ptr, val) __atomic_sub_fetch((ptr), (val), __ATOMIC_ACQ_REL)
+#define JSON_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* Tells the CPU it is in a spin-wait loop, to save power and yield to a sibling hyperthread */
+#if defined(__x86_64__) || defined(__i386__)
+#define JSON_ATOMIC_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define JSON_ATOMIC_PAUSE() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define JSON_ATOMIC_PAUSE() ((void)0)
+#endif
+
+#else
+
+#define JSON_ATOMICS_AVAILABLE 0
+
+#define JSON_ATOMIC_LOAD(ptr) (*(ptr))
+#define JSON_ATOMIC_STORE(ptr, val) (*(ptr) = (val))
+#define JSON_ATOMIC_EXCHANGE(ptr, val) json_atomic_exchange_fallback((void **)(ptr), (val))
+#define JSON_ATOMIC_CAS(ptr, expected, desired) \
+    (*(ptr) == *(expected) ? (*(ptr) = (desired), 1) : (*(expected) = *(ptr), 0))
+#define JSON_ATOMIC_TRY_LOCK(flag) (*(flag) ? 0 : (*(flag) = 1))
+#define JSON_ATOMIC_UNLOCK(flag) (*(flag) = 0)
+#define JSON_ATOMIC_ADD(ptr, val) (*(ptr) += (val))
+#define JSON_ATOMIC_SUB(ptr, val) (*(ptr) -= (val))
+#define JSON_ATOMIC_FENCE() ((void)0)
+#define JSON_ATOMIC_PAUSE() ((void)0)
+
+static inline void *json_atomic_exchange_fallback(void **ptr, void *val)
+{
+    void *old = *ptr;
+    *ptr = val;
+    return old;
+}
+
+#endif
+
+#endif // JSON_ATOMIC_H
@@ -0,0 +1,146 @@
+#ifndef JSON_BIND_H
+#define JSON_BIND_H
+
+#include "json_writer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file json_bind.h
+ * @brief Declares schema-driven binding between JSON objects and C structs.
+ *
+ * A JsonStructDesc lists the members of a C struct that correspond to keys
+ * of a JSON object. json_bind() reads the JSON text once and stores each
+ * described member straight into the struct, without building a JsonValue
+ * tree. Keys the descriptor does not mention are skipped. In the other
+ * direction, json_emit_struct() writes a struct as JSON text.
+ *
+ * Example:
+ * @code
+ * typedef struct { int64_t id; char *name; bool active; } User;
+ *
+ * static const JsonFieldDesc user_fields[] = {
+ *     JSON_FIELD("id", JSON_FIELD_INT, User, id, NULL),
+ *     JSON_FIELD("name", JSON_FIELD_STRING, User, name, NULL),
+ *     JSON_FIELD("active", JSON_FIELD_BOOL, User, active, NULL),
+ * };
+ * static const JsonStructDesc user_desc = JSON_STRUCT_DESC(User, user_fields);
+ *
+ * User user;
+ * if (json_bind(text, length, &user_desc, &user)) { ...; json_bind_free(&user_desc, &user); }
+ * @endcode
+ *
+ * The json_bindgen tool (tools/json_bindgen.c) emits struct definitions
+ * and descriptors like these from a sample document.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @enum JsonFieldType
+     * @brief C type of a bound struct member.
+     */
+    typedef enum
+    {
+        JSON_FIELD_BOOL,   /**< `bool`, bound from true or false. */
+        JSON_FIELD_INT,    /**< `int64_t`, bound from a number without fraction or exponent. */
+        JSON_FIELD_DOUBLE, /**< `double`, bound from a number. */
+        JSON_FIELD_STRING, /**< `char *` allocated with json_alloc, bound from a string (NULL for null). */
+        JSON_FIELD_OBJECT  /**< A nested struct stored in place, described by `nested`. */
+    } JsonFieldType;
+
+    typedef struct JsonStructDesc JsonStructDesc;
+
+    /**
+     * @struct JsonFieldDesc
+     * @brief Maps one JSON key to a member of a C struct.
+     */
+    typedef struct
+    {
+        const char *key;              /**< The JSON key. */
+        JsonFieldType type;           /**< C type of the member. */
+        size_t offset;                /**< offsetof() the member within the struct. */
+        const JsonStructDesc *nested; /**< Descriptor of the member if type is JSON_FIELD_OBJECT. */
+        const char *fragment;         /**< Pre-escaped `,"key":` emitted before the value, or NULL
+                                           to escape `key` on every json_emit_struct() call. */
+        size_t fragment_length;       /**< Length of `fragment` in bytes. */
+    } JsonFieldDesc;
+
+/**
+ * Initializer for a JsonFieldDesc. The key's `,"key":` fragment is built
+ * at compile time, so `key` must be a string literal that needs no JSON
+ * escaping (no `"`, `\` or control characters); describe other keys with
+ * a plain initializer and a NULL fragment.
+ */
+#define JSON_FIELD(key, type, struct_type, member, nested) \
+    {(key), (type), offsetof(struct_type, member), (nested), ",\"" key "\":", sizeof(",\"" key "\":") - 1}
+
+    /**
+     * @struct JsonStructDesc
+     * @brief Describes a C struct bound from a JSON object.
+     */
+    struct JsonStructDesc
+    {
+        size_t size;                 /**< sizeof() the struct. */
+        const JsonFieldDesc *fields; /**< The bound members. */
+        size_t count;                /**< Number of entries in `fields`. */
+    };
+
+/** Initializer for a JsonStructDesc from a struct type and a JsonFieldDesc array. */
+#define JSON_STRUCT_DESC(type, fields) {sizeof(type), (fields), sizeof(fields) / sizeof((fields)[0])}
+
+    /**
+     * @brief Parses a JSON object directly into a C struct.
+     *
+     * The struct is zeroed first, so members whose keys are absent, or whose
+     * value is null, are left as 0/NULL/false. A key that appears more than
+     * once takes its last value.
+     *
+     * @param[in]  json   The JSON text. Need not be null-terminated.
+     * @param[in]  length Number of bytes of JSON text.
+     * @param[in]  desc   Descriptor of the struct.
+     * @param[out] out    The struct to fill in.
+     * @return 1 on success; 0 if the text is malformed, is not an object, or
+     *         holds a value of the wrong type for a described member. On
+     *         failure nothing needs to be freed.
+     *
+     * @note Values of unknown keys are skipped by matching brackets only and
+     *       are not otherwise validated.
+     */
+    int json_bind(const char *json, size_t length, const JsonStructDesc *desc, void *out);
+
+    /**
+     * @brief Frees the strings json_bind() stored in a struct.
+     *
+     * The struct itself is owned by the caller; its string members are set
+     * to NULL.
+     *
+     * @param[in]     desc Descriptor of the struct.
+     * @param[in,out] out  The struct filled in by json_bind().
+     */
+    void json_bind_free(const JsonStructDesc *desc, void *out);
+
+    /**
+     * @brief Writes a C struct as a JSON object.
+     *
+     * Members are written in descriptor order. Key fragments prepared by
+     * JSON_FIELD() are copied as-is, so most of the output is produced by
+     * memcpy. Numbers use the same format as json_serialize(); NULL string
+     * members are written as null.
+     *
+     * @param[in]     desc   Descriptor of the struct.
+     * @param[in]     obj    The struct to write.
+     * @param[in,out] writer The writer receiving the output.
+     * @return 1 on success, 0 if the writer has run out of memory.
+     */
+    int json_emit_struct(const JsonStructDesc *desc, const void *obj, JsonWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_BIND_H
@@ -0,0 +1,223 @@
+#ifndef JSON_BUILDER_H
+#define JSON_BUILDER_H
+
+#include "json_types.h"
+#include "json_arena.h"
+#include <stddef.h>
+
+/**
+ * @file json_builder.h
+ * @brief Declares functions that create and edit JSON documents.
+ *
+ * Every function takes the arena the document lives in, or NULL for a
+ * document whose nodes are separate heap allocations (as returned by
+ * json_parse() and freed with json_free_value()). Pass the same arena for
+ * every change to a document; for a document returned by
+ * json_parser_parse() that is json_parser_arena(). Nothing is ever freed
+ * from an arena, so values removed from an arena document stay allocated
+ * until the arena is reset.
+ *
+ * Values added to a container are adopted, not copied: the container takes
+ * ownership and they must not be added anywhere else. They must come from
+ * the same allocator as the container. On failure nothing changes and the
+ * caller keeps ownership of everything passed in.
+ *
+ * Arrays and objects grow geometrically, so appending is amortized O(1).
+ * Containers the parser laid out in a single allocation (including packed
+ * number arrays and objects with shared keys) are moved to growable storage
+ * the first time they grow, and an object's shape is dropped whenever its
+ * members change.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** json_object_set() flag: take ownership of `key` instead of copying it. */
+#define JSON_BUILD_MOVE_KEY 0x1u
+
+    /**
+     * @brief Creates a null value.
+     *
+     * @param[in,out] arena Arena to allocate from, or NULL for the heap.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_null(JsonArena *arena);
+
+    /**
+     * @brief Creates a boolean value.
+     *
+     * @param[in,out] arena   Arena to allocate from, or NULL for the heap.
+     * @param[in]     boolean Non-zero for true.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_bool(JsonArena *arena, int boolean);
+
+    /**
+     * @brief Creates a number value.
+     *
+     * @param[in,out] arena  Arena to allocate from, or NULL for the heap.
+     * @param[in]     number The number.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_number(JsonArena *arena, double number);
+
+    /**
+     * @brief Creates a string value holding a copy of some text.
+     *
+     * The copy shares the value's allocation.
+     *
+     * @param[in,out] arena  Arena to allocate from, or NULL for the heap.
+     * @param[in]     s      The text. Need not be null-terminated.
+     * @param[in]     length Number of bytes at `s`.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_string(JsonArena *arena, const char *s, size_t length);
+
+    /**
+     * @brief Creates a string value that takes ownership of a string.
+     *
+     * @param[in,out] arena Arena to allocate from, or NULL for the heap.
+     * @param[in]     s     The null-terminated string. Without an arena it must
+     *                      have been allocated with json_alloc(); with one it
+     *                      must live at least as long as the arena.
+     * @return The new value, or NULL if allocation fails (the caller then
+     *         still owns `s`).
+     */
+    JsonValue *json_new_string_move(JsonArena *arena, char *s);
+
+    /**
+     * @brief Creates an empty array.
+     *
+     * @param[in,out] arena Arena to allocate from, or NULL for the heap.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_array(JsonArena *arena);
+
+    /**
+     * @brief Creates an empty object.
+     *
+     * @param[in,out] arena Arena to allocate from, or NULL for the heap.
+     * @return The new value, or NULL if allocation fails.
+     */
+    JsonValue *json_new_object(JsonArena *arena);
+
+    /**
+     * @brief Sets an object member, replacing any member with the same key.
+     *
+     * A replaced value is freed (unless the object lives in an arena) and
+     * the member keeps its position; a new member is appended.
+     *
+     * @param[in,out] arena  The object's arena, or NULL for the heap.
+     * @param[in,out] object The object to change.
+     * @param[in]     key    The null-terminated key.
+     * @param[in]     value  The value to adopt.
+     * @param[in]     flags  JSON_BUILD_MOVE_KEY to take ownership of `key`
+     *                       (allocated like json_new_string_move() requires)
+     *                       rather than copy it, or 0.
+     * @return 1 on success, 0 if `object` is not an object or allocation fails.
+     */
+    int json_object_set(JsonArena *arena, JsonValue *object, const char *key, JsonValue *value, unsigned int flags);
+
+    /**
+     * @brief Removes an object member, keeping the order of the others.
+     *
+     * @param[in,out] arena   The object's arena, or NULL for the heap.
+     * @param[in,out] object  The object to change.
+     * @param[in]     key     The null-terminated key.
+     * @param[out]    removed If non-NULL, receives the member's value, which
+     *                        the caller then owns; otherwise the value is freed
+     *                        (unless the object lives in an arena).
+     * @return 1 if a member was removed, 0 if there was none.
+     */
+    int json_object_remove(JsonArena *arena, JsonValue *object, const char *key, JsonValue **removed);
+
+    /**
+     * @brief Makes room for an object to hold at least `capacity` members.
+     *
+     * @param[in,out] arena    The object's arena, or NULL for the heap.
+     * @param[in,out] object   The object to change.
+     * @param[in]     capacity Number of members to make room for.
+     * @return 1 on success, 0 if `object` is not an object or allocation fails.
+     */
+    int json_object_reserve(JsonArena *arena, JsonValue *object, size_t capacity);
+
+    /**
+     * @brief Appends an item to an array.
+     *
+     * @param[in,out] arena The array's arena, or NULL for the heap.
+     * @param[in,out] array The array to change.
+     * @param[in]     value The value to adopt.
+     * @return 1 on success, 0 if `array` is not an array or allocation fails.
+     */
+    int json_array_push(JsonArena *arena, JsonValue *array, JsonValue *value);
+
+    /**
+     * @brief Inserts an item into an array, shifting later items up.
+     *
+     * @param[in,out] arena The array's arena, or NULL for the heap.
+     * @param[in,out] array The array to change.
+     * @param[in]     index Position of the new item, at most the item count.
+     * @param[in]     value The value to adopt.
+     * @return 1 on success, 0 if `array` is not an array, `index` is out of
+     *         range or allocation fails.
+     */
+    int json_array_insert(JsonArena *arena, JsonValue *array, size_t index, JsonValue *value);
+
+    /**
+     * @brief Removes an item from an array, shifting later items down.
+     *
+     * @param[in,out] arena   The array's arena, or NULL for the heap.
+     * @param[in,out] array   The array to change.
+     * @param[in]     index   Position of the item.
+     * @param[out]    removed If non-NULL, receives the item, which the caller
+     *                        then owns; otherwise the item is freed (unless the
+     *                        array lives in an arena).
+     * @return 1 on success, 0 if `array` is not an array, `index` is out of
+     *         range or allocation fails.
+     */
+    int json_array_remove(JsonArena *arena, JsonValue *array, size_t index, JsonValue **removed);
+
+    /**
+     * @brief Makes room for an array to hold at least `capacity` items.
+     *
+     * @param[in,out] arena    The array's arena, or NULL for the heap.
+     * @param[in,out] array    The array to change.
+     * @param[in]     capacity Number of items to make room for.
+     * @return 1 on success, 0 if `array` is not an array or allocation fails.
+     */
+    int json_array_reserve(JsonArena *arena, JsonValue *array, size_t capacity);
+
+    /**
+     * @brief Frees a value that has left its document.
+     *
+     * Heap values are freed with json_free_value(); values from an arena are
+     * left alone, as nothing is freed from an arena.
+     *
+     * @param[in]     arena The value's arena, or NULL for the heap.
+     * @param[in,out] value The value to free. May be NULL.
+     */
+    void json_release(JsonArena *arena, JsonValue *value);
+
+    /**
+     * @brief Makes a deep copy of a value.
+     *
+     * The tree is copied in one pass. Each container is copied into a single
+     * allocation holding its header, children and keys, the way the parser
+     * lays out small containers; packed arrays stay packed. Objects get
+     * their own copies of shared keys and lose their shape, so the copy
+     * depends on nothing in the original.
+     *
+     * @param[in,out] arena Arena to copy into, or NULL for the heap (free the
+     *                      copy with json_free_value()).
+     * @param[in]     value The value to copy.
+     * @return The copy, or NULL if `value` is NULL or allocation fails.
+     */
+    JsonValue *json_clone(JsonArena *arena, const JsonValue *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_BUILDER_H
@@ -0,0 +1,115 @@
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include "json_document.h"
+#include "json_parser.h"
+#include <stddef.h>
+
+/**
+ * @file json_cache.h
+ * @brief Declares a cache of parsed documents keyed by their JSON text.
+ *
+ * Services often receive the same bytes over and over (configuration
+ * fetched on every request, polling payloads that rarely change). A
+ * JsonParseCache maps the text to the frozen JsonDocument parsed from it,
+ * so repeated text is hashed and compared instead of parsed. Documents are
+ * shared: every caller gets its own reference to the same immutable tree.
+ *
+ * The least recently used documents are evicted once the memory held
+ * exceeds a limit. The cache may be used from any number of threads; a
+ * short spinlock guards the table, and parsing and freeing happen outside
+ * it (see json_atomic.h for the compilers this applies to).
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @struct JsonParseCache
+     * @brief A thread-safe LRU cache of parsed documents (opaque).
+     */
+    typedef struct JsonParseCache JsonParseCache;
+
+    /**
+     * @struct JsonParseCacheOptions
+     * @brief Configuration for a JsonParseCache.
+     *
+     * Zero-initialize and set only the fields you need; zero means the default.
+     */
+    typedef struct
+    {
+        size_t max_bytes;         /**< Memory the cached documents and their text may hold (default JSON_PARSE_CACHE_DEFAULT_BYTES). */
+        JsonParserOptions parser; /**< Options documents are parsed with. A zero pool_block_size sizes each document's pool to its text. */
+    } JsonParseCacheOptions;
+
+    /**
+     * @struct JsonParseCacheStats
+     * @brief Counters reported by json_parse_cache_stats().
+     */
+    typedef struct
+    {
+        size_t hits;      /**< Lookups answered from the cache. */
+        size_t misses;    /**< Lookups that parsed the text. */
+        size_t evictions; /**< Documents dropped to stay within max_bytes. */
+        size_t entries;   /**< Documents currently cached. */
+        size_t bytes;     /**< Memory currently held by the cached documents and their text. */
+    } JsonParseCacheStats;
+
+    /**
+     * @brief Creates a parse cache.
+     *
+     * @param[in] options Cache options, or NULL for the defaults.
+     * @return Pointer to the new JsonParseCache, or NULL if allocation fails.
+     */
+    JsonParseCache *json_parse_cache_new(const JsonParseCacheOptions *options);
+
+    /**
+     * @brief Frees a parse cache.
+     *
+     * Documents handed out by the cache stay valid until their references
+     * are released. No other thread may use the cache during this call.
+     *
+     * @param[in,out] cache The cache. May be NULL.
+     */
+    void json_parse_cache_free(JsonParseCache *cache);
+
+    /**
+     * @brief Returns the document parsed from some JSON text, parsing it only once.
+     *
+     * The text is looked up by a 64-bit hash and confirmed byte for byte.
+     * On a miss it is parsed, and the document is cached unless it alone
+     * would exceed max_bytes. Malformed text is not cached.
+     *
+     * @param[in,out] cache  The cache.
+     * @param[in]     json   The JSON text. Need not be null-terminated.
+     * @param[in]     length Number of bytes of JSON text.
+     * @return The frozen document, which the caller must release, or NULL if
+     *         the text is malformed or allocation fails.
+     */
+    JsonDocument *json_parse_cached(JsonParseCache *cache, const char *json, size_t length);
+
+    /**
+     * @brief Reports a cache's counters.
+     *
+     * @param[in]  cache The cache.
+     * @param[out] stats Receives the counters.
+     */
+    void json_parse_cache_stats(JsonParseCache *cache, JsonParseCacheStats *stats);
+
+    /**
+     * @brief Drops every document from a cache.
+     *
+     * Documents already handed out stay valid. The hit, miss and eviction
+     * counters are kept.
+     *
+     * @param[in,out] cache The cache.
+     */
+    void json_parse_cache_clear(JsonParseCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_CACHE_H
@@ -0,0 +1,80 @@
+#ifndef JSON_COMPARE_H
+#define JSON_COMPARE_H
+
+#include "json_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file json_compare.h
+ * @brief Declares deep equality and structural hashing of JSON values.
+ *
+ * Both work directly on the tree, without serializing it. Two values are
+ * equal when they have the same type and contents; object members are
+ * compared by key regardless of their order, and numbers are compared as
+ * doubles, so `-0` equals `0`. Values that are equal have the same hash, so
+ * the two can be used together to deduplicate or cache documents.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Compares two values for deep equality.
+     *
+     * Objects whose members are in the same order are compared pairwise;
+     * otherwise each key is looked up, through the shape index when the
+     * object has one. Objects with a repeated key are equal when they hold
+     * the same members the same number of times, in quadratic time. Packed
+     * and unpacked arrays compare by their numbers.
+     *
+     * @param[in] a The first value. May be NULL.
+     * @param[in] b The second value. May be NULL.
+     * @return 1 if the values are equal (or both NULL), 0 otherwise.
+     */
+    int json_equal(const JsonValue *a, const JsonValue *b);
+
+    /**
+     * @brief Computes a 64-bit structural hash of a value.
+     *
+     * The tree is hashed in a single pass, mixing 8 bytes at a time in the
+     * style of wyhash. Array elements are chained in order; object members
+     * are hashed individually and combined with an order-independent sum.
+     * The result is not stable across platforms or library versions.
+     *
+     * @param[in] value The value. May be NULL.
+     * @return The hash.
+     */
+    uint64_t json_hash(const JsonValue *value);
+
+    /**
+     * @brief Computes a 64-bit structural hash of a value with a caller-chosen seed.
+     *
+     * A secret random seed keeps others from producing colliding inputs.
+     *
+     * @param[in] value The value. May be NULL.
+     * @param[in] seed  The seed; json_hash() uses 0.
+     * @return The hash.
+     */
+    uint64_t json_hash_seeded(const JsonValue *value, uint64_t seed);
+
+    /**
+     * @brief Computes a 64-bit hash of a run of bytes.
+     *
+     * The byte hash json_hash() applies to strings and keys, 16 bytes per
+     * step; useful for keying raw JSON text.
+     *
+     * @param[in] data   The bytes. May be NULL if `length` is 0.
+     * @param[in] length Number of bytes.
+     * @param[in] seed   The seed.
+     * @return The hash.
+     */
+    uint64_t json_hash_bytes(const void *data, size_t length, uint64_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_COMPARE_H
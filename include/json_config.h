@@ -7,4 +7,28 @@
 // Set to 1 to enable logging via fprintf, or 0 to disable it
 #define ERROR_LOGGING_ENABLED 0 // For fprintf (error logging)
 
+// Strings up to this many bytes are stored in the same allocation as their JsonValue
+#define JSON_INLINE_STRING_MAX 14
+
+// Arrays and objects with up to this many children are stored in a single allocation
+#define JSON_INLINE_CHILDREN_MAX 8
+
+// Distinct object key layouts a JsonParser remembers when caching shapes
+#define JSON_SHAPE_CACHE_MAX 256
+
+// Deepest nesting json_validate accepts (tracked in a fixed bit stack, no allocation)
+#define JSON_VALIDATE_MAX_DEPTH 4096
+
+// Bytes a JsonStream reads from its JsonReader at a time
+#define JSON_STREAM_BUFFER_SIZE (64 * 1024)
+
+// Deepest nesting the streaming functions (json_reformat, ...) accept
+#define JSON_STREAM_MAX_DEPTH 4096
+
+// Deepest container at which json_filter_apply still matches rule paths
+#define JSON_FILTER_MAX_DEPTH 64
+
+// Memory a JsonParseCache may hold when no limit is given
+#define JSON_PARSE_CACHE_DEFAULT_BYTES (16 * 1024 * 1024)
+
 #endif // JSON_CONFIG_H
@@ -0,0 +1,233 @@
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+
+#include "json_types.h"
+#include "json_arena.h"
+#include "json_parser.h"
+#include <stddef.h>
+
+/**
+ * @file json_document.h
+ * @brief Declares reference-counted, immutable documents.
+ *
+ * A JsonDocument owns a tree and a reference count. Once frozen it is never
+ * modified, so any number of threads may read it without synchronization,
+ * and retaining or releasing it is a single atomic operation.
+ * json_document_subtree() hands out a member or element as a document of
+ * its own, which keeps the memory of the whole tree alive until it is
+ * released, so subtrees can be passed around without copying.
+ *
+ * A new version is made by copy-on-write: json_document_edit() starts a
+ * draft that shares its base's tree, json_document_unshare() copies the
+ * containers on the path to what is to be changed, the copies are edited
+ * with the json_builder.h functions, and json_document_freeze() makes the
+ * draft immutable. Everything the draft did not change stays shared with
+ * the base, which the new version keeps alive; readers of the base are
+ * unaffected. Because each version keeps its base alive, a long run of
+ * edits keeps every earlier version's storage; parsing a fresh document now
+ * and then starts a new chain.
+ *
+ * A JsonDocumentSlot holds the current version for readers to pick up, and
+ * lets a writer replace it.
+ *
+ * Reference counts are atomic only where json_atomic.h provides atomics
+ * (GCC and Clang); elsewhere documents must not be shared between threads.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @struct JsonDocument
+     * @brief A reference-counted tree, immutable once frozen (opaque).
+     */
+    typedef struct JsonDocument JsonDocument;
+
+    /**
+     * @struct JsonDocumentSlot
+     * @brief Publishes the current version of a document to readers.
+     *
+     * Readers never wait: acquiring only counts the reader in and out around
+     * taking a reference. A writer publishing a new version waits for
+     * readers that are in the middle of acquiring before it releases the
+     * slot's reference to the old version. Readers are counted per epoch,
+     * and publishing starts a new one, so the writer only waits for readers
+     * that started before it and cannot be held off by a steady stream of
+     * new ones. A reader whose epoch ends while it counts itself in counts
+     * itself in again under the new one.
+     */
+    typedef struct
+    {
+        JsonDocument *current; /**< The published version, or NULL. */
+        size_t epoch;          /**< Number of versions published; its parity picks the counter. */
+        size_t readers[2];     /**< Readers currently acquiring, by parity of their epoch. */
+    } JsonDocumentSlot;
+
+    /**
+     * @brief Parses JSON text into a frozen document.
+     *
+     * The tree is allocated in a node pool owned by the document, so
+     * releasing the document frees it in one go.
+     *
+     * @param[in] json    The JSON text. Need not be null-terminated.
+     * @param[in] length  Number of bytes of JSON text.
+     * @param[in] options Parser options, or NULL for the defaults.
+     * @return The document with a reference count of 1, or NULL if the text
+     *         is malformed or allocation fails.
+     */
+    JsonDocument *json_document_parse(const char *json, size_t length, const JsonParserOptions *options);
+
+    /**
+     * @brief Returns a document's root value.
+     *
+     * @param[in] document The document.
+     * @return The root, which must not be modified unless `document` is a
+     *         draft and the root was returned by json_document_unshare().
+     */
+    const JsonValue *json_document_root(const JsonDocument *document);
+
+    /**
+     * @brief Returns the memory held by a document.
+     *
+     * Counts the document and the node pools it owns, but not the documents
+     * it shares nodes with, nor the shapes of a parser caching them.
+     *
+     * @param[in] document The document.
+     * @return The size in bytes.
+     */
+    size_t json_document_size(const JsonDocument *document);
+
+    /**
+     * @brief Adds a reference to a document.
+     *
+     * @param[in,out] document The document.
+     * @return `document`, for convenience.
+     */
+    JsonDocument *json_document_retain(JsonDocument *document);
+
+    /**
+     * @brief Drops a reference to a document, freeing it with the last one.
+     *
+     * Freeing a document drops its reference to the document it shares
+     * nodes with, if any.
+     *
+     * @param[in,out] document The document. May be NULL.
+     */
+    void json_document_release(JsonDocument *document);
+
+    /**
+     * @brief Hands out a value within a frozen document as a document of its own.
+     *
+     * The new document's root is `value`; it keeps `document` alive until it
+     * is released.
+     *
+     * @param[in,out] document The frozen document containing `value`.
+     * @param[in]     value    A value within the document's tree.
+     * @return The new document with a reference count of 1, or NULL if
+     *         `document` is a draft or allocation fails.
+     */
+    JsonDocument *json_document_subtree(JsonDocument *document, const JsonValue *value);
+
+    /**
+     * @brief Starts a draft sharing a frozen document's tree.
+     *
+     * @param[in,out] base The frozen document to start from.
+     * @return The draft with a reference count of 1, or NULL if `base` is a
+     *         draft or allocation fails.
+     */
+    JsonDocument *json_document_edit(JsonDocument *base);
+
+    /**
+     * @brief Returns the arena of a draft, for use with the json_builder.h functions.
+     *
+     * @param[in,out] draft The draft.
+     * @return The arena that values added to the draft must be allocated in.
+     */
+    JsonArena *json_document_arena(JsonDocument *draft);
+
+    /**
+     * @brief Makes a container in a draft safe to modify.
+     *
+     * Resolves a JSON Pointer (RFC 6901, e.g. `""` for the root or
+     * `"/routes/0"`) and copies every container on the way to it that is
+     * still shared with the base; containers copied earlier are reused. The
+     * copies are shallow: their children stay shared until they are
+     * unshared in turn. Only the returned container may be modified, with
+     * the json_builder.h functions and json_document_arena().
+     *
+     * @param[in,out] draft   The draft.
+     * @param[in]     pointer The JSON Pointer of an array or object.
+     * @return The container, or NULL if the pointer does not resolve to an
+     *         array or object, `draft` is frozen or allocation fails.
+     *         Containers copied on the way stay copied.
+     */
+    JsonValue *json_document_unshare(JsonDocument *draft, const char *pointer);
+
+    /**
+     * @brief Replaces the root of a draft.
+     *
+     * @param[in,out] draft The draft.
+     * @param[in]     root  The new root, allocated in json_document_arena()
+     *                      or taken from the draft's tree.
+     * @return 1 on success, 0 if `draft` is frozen or `root` is NULL.
+     */
+    int json_document_set_root(JsonDocument *draft, JsonValue *root);
+
+    /**
+     * @brief Makes a draft immutable.
+     *
+     * @param[in,out] draft The draft. Nothing in its tree may be modified
+     *                      afterwards.
+     * @return `draft`, for convenience.
+     */
+    JsonDocument *json_document_freeze(JsonDocument *draft);
+
+    /**
+     * @brief Initializes a slot.
+     *
+     * @param[out] slot     The slot.
+     * @param[in]  document The first version, or NULL. The slot takes a
+     *                      reference to it.
+     */
+    void json_document_slot_init(JsonDocumentSlot *slot, JsonDocument *document);
+
+    /**
+     * @brief Takes a reference to the current version.
+     *
+     * Safe to call from any number of threads, concurrently with
+     * json_document_slot_publish().
+     *
+     * @param[in,out] slot The slot.
+     * @return The current version, which the caller must release, or NULL if
+     *         none has been published.
+     */
+    JsonDocument *json_document_slot_acquire(JsonDocumentSlot *slot);
+
+    /**
+     * @brief Publishes a new version.
+     *
+     * Readers that acquired the old version keep it until they release it.
+     * Publishing must not be done by more than one thread at a time.
+     *
+     * @param[in,out] slot     The slot.
+     * @param[in]     document The frozen new version, or NULL. The slot takes
+     *                         a reference to it.
+     */
+    void json_document_slot_publish(JsonDocumentSlot *slot, JsonDocument *document);
+
+    /**
+     * @brief Releases the slot's reference to the current version.
+     *
+     * No reader may use the slot during or after this call.
+     *
+     * @param[in,out] slot The slot.
+     */
+    void json_document_slot_clear(JsonDocumentSlot *slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_DOCUMENT_H
@@ -0,0 +1,111 @@
+#ifndef JSON_FILTER_H
+#define JSON_FILTER_H
+
+#include "json_stream.h"
+#include "json_writer.h"
+
+/**
+ * @file json_filter.h
+ * @brief Declares streaming projection and redaction of JSON text.
+ *
+ * A JsonFilter is compiled once from a set of key paths and then applied to
+ * any number of documents. json_filter_apply() copies its input to its
+ * output token by token, dropping or masking members as it goes, without
+ * building a JsonValue tree.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Maximum number of rules in one JsonFilter. */
+#define JSON_FILTER_MAX_RULES 64
+
+    /**
+     * @enum JsonFilterAction
+     * @brief What a JsonFilterRule does to the values its path matches.
+     */
+    typedef enum
+    {
+        JSON_FILTER_INCLUDE, /**< Keep the value; once any rule includes, everything else is dropped. */
+        JSON_FILTER_EXCLUDE, /**< Drop the member. */
+        JSON_FILTER_REDACT   /**< Keep the key but replace the value. */
+    } JsonFilterAction;
+
+    /**
+     * @struct JsonFilterRule
+     * @brief One path and the action applied to the values it matches.
+     *
+     * `path` is a dot-separated sequence of object keys, matched from the
+     * root; a `*` segment matches any key. Arrays do not take a segment:
+     * `"items.secret"` matches the `secret` member of every object in an
+     * `items` array.
+     */
+    typedef struct
+    {
+        const char *path;        /**< Dot-separated key path (copied by json_filter_compile()). */
+        JsonFilterAction action; /**< What to do with matching values. */
+        const char *replacement; /**< JSON text written for a redacted value, or NULL for `"[REDACTED]"`. */
+    } JsonFilterRule;
+
+    /**
+     * @brief A compiled set of filter rules. Immutable, so it can be shared
+     *        between threads.
+     */
+    typedef struct JsonFilter JsonFilter;
+
+    /**
+     * @brief Compiles a set of rules.
+     *
+     * Keys in paths are hashed once here, so matching a key while filtering
+     * costs a hash comparison per live rule.
+     *
+     * @param[in] rules The rules.
+     * @param[in] count Number of rules (at most JSON_FILTER_MAX_RULES).
+     * @return The compiled filter, or NULL if a path is empty, a replacement
+     *         is not valid JSON, there are too many rules, or allocation fails.
+     *
+     * @note Free the filter with json_filter_free().
+     */
+    JsonFilter *json_filter_compile(const JsonFilterRule *rules, size_t count);
+
+    /**
+     * @brief Frees a compiled filter.
+     *
+     * @param[in] filter The filter to free. May be NULL.
+     */
+    void json_filter_free(JsonFilter *filter);
+
+    /**
+     * @brief Copies a document from a reader to a writer, applying a filter.
+     *
+     * When rules conflict, exclusion wins over redaction and redaction over
+     * inclusion. With include rules, members on the way to an included
+     * path are kept (possibly ending up empty) and all others are dropped;
+     * a scalar root value is always kept.
+     *
+     * Output is compact. Tokens outside dropped and redacted values are
+     * checked against the JSON grammar, including number syntax, escapes
+     * and unescaped control characters in strings, and are then copied as
+     * written; dropped and redacted arrays and objects are skipped by
+     * bracket matching alone. Containers with no live rules left are copied without
+     * matching; documents where rules still apply more than
+     * JSON_FILTER_MAX_DEPTH containers deep are rejected.
+     *
+     * Output is flushed to the writer's sink, if it has one, before
+     * returning.
+     *
+     * @param[in]     filter The compiled filter.
+     * @param[in]     reader The input source.
+     * @param[in,out] writer The writer receiving the output.
+     * @return 1 on success; 0 if the input is malformed or too deep, or
+     *         memory or the sink fails.
+     */
+    int json_filter_apply(const JsonFilter *filter, const JsonReader *reader, JsonWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_FILTER_H
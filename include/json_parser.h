@@ -2,6 +2,8 @@
 #define JSON_PARSER_H
 
 #include "json_types.h"
+#include "json_arena.h"
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -16,6 +18,31 @@ extern "C"
      * JsonValue structures and for freeing the allocated JSON data structures.
      */
 
+    /**
+     * @struct JsonParser
+     * @brief A reusable parser that retains its buffers between documents (opaque).
+     */
+    typedef struct JsonParser JsonParser;
+
+    /**
+     * @struct JsonParserOptions
+     * @brief Tuning options for a JsonParser.
+     *
+     * Zero-initialize the structure and set only the fields of interest;
+     * a zero field selects the default.
+     */
+    typedef struct
+    {
+        size_t pool_block_size; /**< Size in bytes of each block in the node pool. */
+        size_t stack_capacity;  /**< Initial number of entries in the container stack. */
+        int pack_numeric_arrays; /**< Store non-empty arrays made only of numbers as packed
+                                      doubles (JSON_FLAG_PACKED_NUMBERS). Callers must then
+                                      read them with json_array_as_doubles(). */
+        int cache_shapes;        /**< Share one key table (JsonShape) between objects with the
+                                      same key sequence, across all documents the parser
+                                      handles, and index it for O(1) key lookups. */
+    } JsonParserOptions;
+
     /**
      * @brief Parses a JSON string and constructs a JsonValue data structure.
      *
@@ -23,17 +50,78 @@ extern "C"
      * a hierarchical JsonValue structure that represents the JSON data.
      *
      * @param[in] json The null-terminated JSON string to parse.
-     * @return Pointer to the root JsonValue if parsing is successful, NULL otherwise.
+     * @return Pointer to the root JsonValue if parsing is successful, NULL
+     *         otherwise (including for malformed input).
      *
      * @note It is the caller's responsibility to free the returned JsonValue using `json_free_value` to avoid memory leaks.
      */
     JsonValue *json_parse(const char *json);
 
+    /**
+     * @brief Creates a reusable parser.
+     *
+     * A JsonParser keeps its node pool and container stack between calls to
+     * json_parser_parse(), so once it has seen the largest document in a
+     * workload, parsing further documents performs no allocations.
+     *
+     * @param[in] options Parser options, or NULL for the defaults.
+     * @return Pointer to the new JsonParser, or NULL if allocation fails.
+     *
+     * @note A JsonParser must not be used by more than one thread at a time.
+     *       Free it with `json_parser_free`.
+     */
+    JsonParser *json_parser_new(const JsonParserOptions *options);
+
+    /**
+     * @brief Parses a JSON document using a reusable parser.
+     *
+     * @param[in,out] parser Pointer to the JsonParser.
+     * @param[in]     json   The JSON text to parse. Need not be null-terminated.
+     * @param[in]     length Number of bytes of JSON text.
+     * @return Pointer to the root JsonValue if parsing is successful, NULL otherwise.
+     *
+     * @note The returned tree is owned by the parser. It stays valid until the
+     *       next call to `json_parser_parse` or `json_parser_free` on the same
+     *       parser, and must not be passed to `json_free_value`.
+     */
+    JsonValue *json_parser_parse(JsonParser *parser, const char *json, size_t length);
+
+    /**
+     * @brief Returns the arena holding a parser's documents.
+     *
+     * Pass it to the json_builder.h functions to edit the last parsed
+     * document in place; whatever they allocate is released along with the
+     * document.
+     *
+     * @param[in] parser Pointer to the JsonParser.
+     * @return Pointer to the parser's arena.
+     */
+    JsonArena *json_parser_arena(JsonParser *parser);
+
+    /**
+     * @brief Frees the buffers a parser keeps for parsing its next document.
+     *
+     * The last parsed document is kept. Useful when a parser is retained
+     * only to own that document; the buffers are reallocated if it parses
+     * again.
+     *
+     * @param[in,out] parser Pointer to the JsonParser.
+     */
+    void json_parser_trim(JsonParser *parser);
+
+    /**
+     * @brief Frees a parser, its buffers and the last document it parsed.
+     *
+     * @param[in,out] parser Pointer to the JsonParser to free. May be NULL.
+     */
+    void json_parser_free(JsonParser *parser);
+
     /**
      * @brief Frees the memory allocated for a JsonValue and its nested structures.
      *
-     * This function recursively frees all memory associated with a JsonValue,
-     * including any nested JsonObjects or JsonArrays.
+     * This function frees all memory associated with a JsonValue, including
+     * any nested JsonObjects or JsonArrays. The tree is walked iteratively,
+     * so arbitrarily deep documents can be freed without exhausting the stack.
      *
      * @param[in,out] value Pointer to the JsonValue to free.
      *
@@ -41,6 +129,35 @@ extern "C"
      */
     void json_free_value(JsonValue *value);
 
+    /**
+     * @brief Queues a JsonValue to be freed later by json_reclaim_deferred().
+     *
+     * Hands ownership of the tree to a process-wide reclamation queue so the
+     * cost of tearing down a large document is taken off the caller's
+     * critical path. Scalars are freed immediately. Safe to call from any
+     * number of threads concurrently.
+     *
+     * @param[in] value Pointer to the JsonValue to free. May be NULL.
+     *
+     * @note The tree must not be accessed after this call. If the queue entry
+     *       cannot be allocated the tree is freed synchronously instead.
+     */
+    void json_free_value_deferred(JsonValue *value);
+
+    /**
+     * @brief Frees trees queued by json_free_value_deferred().
+     *
+     * Intended to be called from an idle hook or a dedicated background
+     * thread. Work is resumable: a large tree may be freed across several
+     * calls when a node budget is given.
+     *
+     * @param[in] max_nodes Maximum number of JsonValue nodes to free in this
+     *                      call, or 0 to drain the queue completely.
+     * @return Number of JsonValue nodes freed. Returns 0 immediately if
+     *         another thread is already reclaiming.
+     */
+    size_t json_reclaim_deferred(size_t max_nodes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,107 @@
+#ifndef JSON_PATCH_H
+#define JSON_PATCH_H
+
+#include "json_types.h"
+#include "json_arena.h"
+#include <stddef.h>
+
+/**
+ * @file json_patch.h
+ * @brief Declares JSON Patch (RFC 6902), JSON Merge Patch (RFC 7386) and diffing.
+ *
+ * Patches are applied to the document in place with the json_builder.h
+ * functions, so a patch costs time in proportion to the patch and the
+ * containers it touches, not to the size of the document. Values taken
+ * from a patch are copied into the document's allocator. Like the builder,
+ * every function takes the document's arena, or NULL for a heap document.
+ *
+ * Applying is atomic: each change is recorded, and if an operation fails
+ * the changes made before it are undone, leaving the document as it was.
+ * Containers the builder moved to growable storage on the way stay moved.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @enum JsonPatchErrorCode
+     * @brief Reasons a patch is rejected.
+     */
+    typedef enum
+    {
+        JSON_PATCH_ERROR_NONE,         /**< No error. */
+        JSON_PATCH_ERROR_INVALID,      /**< The patch or an operation is malformed. */
+        JSON_PATCH_ERROR_NOT_FOUND,    /**< A path does not resolve in the document. */
+        JSON_PATCH_ERROR_TEST_FAILED,  /**< A `test` operation did not match. */
+        JSON_PATCH_ERROR_OUT_OF_MEMORY /**< Allocation failed. */
+    } JsonPatchErrorCode;
+
+    /**
+     * @struct JsonPatchError
+     * @brief Describes why and where a patch was rejected.
+     */
+    typedef struct
+    {
+        JsonPatchErrorCode code; /**< What went wrong. */
+        size_t operation;        /**< Index of the failing operation in the patch. */
+    } JsonPatchError;
+
+    /**
+     * @brief Applies a JSON Patch (RFC 6902) to a document in place.
+     *
+     * The patch is an array of operation objects (`add`, `remove`,
+     * `replace`, `move`, `copy` and `test`) applied in order. Paths are JSON
+     * Pointers; `-` appends to an array.
+     *
+     * @param[in,out] arena    The document's arena, or NULL for the heap.
+     * @param[in,out] document The root of the document; replaced when an
+     *                         operation targets the root (`""`).
+     * @param[in]     patch    The patch. It is not modified.
+     * @param[out]    err      Optional; receives the failure, with code
+     *                         JSON_PATCH_ERROR_NONE on success.
+     * @return 1 if every operation succeeded, 0 otherwise (the document is
+     *         then unchanged).
+     */
+    int json_patch_apply(JsonArena *arena, JsonValue **document, const JsonValue *patch, JsonPatchError *err);
+
+    /**
+     * @brief Applies a JSON Merge Patch (RFC 7386) to a document in place.
+     *
+     * Members of an object patch are merged recursively into the document;
+     * `null` members remove the corresponding member. Any other patch
+     * replaces the document.
+     *
+     * @param[in,out] arena    The document's arena, or NULL for the heap.
+     * @param[in,out] document The root of the document; replaced unless the
+     *                         patch and the document are both objects.
+     * @param[in]     patch    The patch. It is not modified.
+     * @return 1 on success, 0 if allocation fails (the document is then
+     *         unchanged).
+     */
+    int json_merge_patch(JsonArena *arena, JsonValue **document, const JsonValue *patch);
+
+    /**
+     * @brief Computes a JSON Patch that turns one value into another.
+     *
+     * Objects are compared member by member and arrays element by element,
+     * after skipping their common prefix and suffix, so an insertion or
+     * removal at any one place in an array, or a change deep in a tree,
+     * yields a single operation. The patch is small but not always the
+     * shortest possible: it never uses `move` or `copy`.
+     *
+     * @param[in,out] arena Arena to allocate the patch from, or NULL for the
+     *                      heap (free it with json_free_value()).
+     * @param[in]     from  The original value.
+     * @param[in]     to    The value to reach.
+     * @return The patch, an array that is empty if the values are equal, or
+     *         NULL if allocation fails.
+     */
+    JsonValue *json_diff(JsonArena *arena, const JsonValue *from, const JsonValue *to);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_PATCH_H
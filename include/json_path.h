@@ -0,0 +1,141 @@
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+#include "json_types.h"
+#include "json_stream.h"
+#include <stddef.h>
+
+/**
+ * @file json_path.h
+ * @brief Declares compiled JSONPath expressions.
+ *
+ * An expression is compiled once into a JsonPath, a list of steps that is
+ * run as an automaton over the keys and indices on the way to each value,
+ * and can then be evaluated any number of times.
+ *
+ * Supported syntax:
+ * - `$` for the root, which must start the expression;
+ * - `.name` and `['name']` (or `["name"]`) for an object member; unquoted
+ *   names hold ASCII letters, digits, `_` and non-ASCII bytes, and inside
+ *   quotes a backslash makes the next character literal;
+ * - `[n]` for the array element at a non-negative index;
+ * - `.*` and `[*]` for every member or element;
+ * - `..name`, `..*` and `..[...]` for the same selections at any depth;
+ * - `[?expr]` or `[?(expr)]` for every member or element for which a
+ *   filter expression is true.
+ *
+ * Filter expressions combine comparisons (`==`, `!=`, `<`, `<=`, `>`,
+ * `>=`) and existence tests with `!`, `&&`, `||` and parentheses. Operands
+ * are numbers, quoted strings, `true`, `false`, `null`, and singular
+ * queries: `@` (the value being tested) or `$` (the root) followed by
+ * `.name`, `['name']` or `[n]` steps. Only a query may stand alone as an
+ * existence test. A query that selects nothing is only equal to another
+ * such query; only numbers and strings are ordered; arrays and objects are
+ * only equal to themselves. Filters are compiled into a small stack
+ * program, so evaluating one allocates nothing.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Maximum number of steps in one expression. */
+#define JSON_PATH_MAX_STEPS 63
+
+/** Maximum operand stack depth, and nesting of `(` and `!`, in a filter. */
+#define JSON_PATH_MAX_STACK 32
+
+    /**
+     * @brief A compiled JSONPath expression. Immutable, so it can be shared
+     *        between threads.
+     */
+    typedef struct JsonPath JsonPath;
+
+    /**
+     * @brief Receives one match.
+     *
+     * @param[in] context The context pointer given to the evaluator.
+     * @param[in] json    The matched value as compact JSON text. Not
+     *                    null-terminated, and only valid during the call.
+     * @param[in] length  Length of `json`.
+     * @return Non-zero to continue, 0 to stop evaluating.
+     */
+    typedef int (*JsonPathCallback)(void *context, const char *json, size_t length);
+
+    /**
+     * @brief Receives one match from json_path_eval().
+     *
+     * @param[in] context The context pointer given to json_path_eval().
+     * @param[in] value   The matched value. Items of packed numeric arrays
+     *                    are passed as temporaries, valid only during the call.
+     * @return Non-zero to continue, 0 to stop evaluating.
+     */
+    typedef int (*JsonPathValueCallback)(void *context, const JsonValue *value);
+
+    /**
+     * @brief Compiles a JSONPath expression.
+     *
+     * @param[in]  expression The null-terminated expression.
+     * @param[out] err        Receives the position and reason of a syntax
+     *                        error (JSON_ERROR_TOO_DEEP for more than
+     *                        JSON_PATH_MAX_STEPS steps or a filter nested
+     *                        beyond JSON_PATH_MAX_STACK). May be NULL.
+     * @return The compiled path, or NULL on a syntax error or allocation
+     *         failure.
+     *
+     * @note Free the path with json_path_free().
+     */
+    JsonPath *json_path_compile(const char *expression, JsonError *err);
+
+    /**
+     * @brief Frees a compiled path.
+     *
+     * @param[in] path The path to free. May be NULL.
+     */
+    void json_path_free(JsonPath *path);
+
+    /**
+     * @brief Evaluates a path over a document read from a stream.
+     *
+     * No document tree is built. Subtrees that cannot contain a match are
+     * skipped by bracket matching alone; matched values are copied into one
+     * buffer while they are read. Memory therefore depends on the nesting
+     * depth and the size of the matches, not the size of the document.
+     *
+     * Matches are delivered as soon as they are complete, so a match nested
+     * inside another (e.g. with `$..a`) is delivered before the one
+     * containing it.
+     *
+     * @param[in] path     The compiled path.
+     * @param[in] reader   The input source.
+     * @param[in] callback Receives each match.
+     * @param[in] context  Context pointer passed to `callback`.
+     * @return 1 if the document was read to the end or the callback stopped
+     *         the evaluation; 0 if the path has filters (which need the whole
+     *         value under test), the input is malformed or too deep, or
+     *         allocation fails.
+     */
+    int json_path_stream(const JsonPath *path, const JsonReader *reader, JsonPathCallback callback, void *context);
+
+    /**
+     * @brief Evaluates a path over a parsed document.
+     *
+     * Matches are delivered in document order as they are found; no list of
+     * intermediate results is built and nothing is allocated. Member names
+     * are looked up through JsonKey hashes and object shapes.
+     *
+     * @param[in] path     The compiled path.
+     * @param[in] root     The document.
+     * @param[in] callback Receives each match, or NULL to only count them.
+     * @param[in] context  Context pointer passed to `callback`.
+     * @return The number of matches delivered (including the one for which
+     *         the callback asked to stop).
+     */
+    size_t json_path_eval(const JsonPath *path, const JsonValue *root, JsonPathValueCallback callback, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_PATH_H
@@ -2,6 +2,7 @@
 #define JSON_PRINTER_H
 
 #include "json_types.h"
+#include "json_writer.h"
 
 /**
  * @file json_printer.h
@@ -16,14 +17,85 @@ extern "C"
 {
 #endif
 
+    /**
+     * @enum JsonIndentStyle
+     * @brief Character used to indent pretty-printed output.
+     */
+    typedef enum
+    {
+        JSON_INDENT_SPACES, /**< Indent with spaces. */
+        JSON_INDENT_TABS    /**< Indent with tabs. */
+    } JsonIndentStyle;
+
+    /**
+     * @struct JsonPrintOptions
+     * @brief Layout options for the pretty printer.
+     *
+     * Zero-initialize the structure and set only the fields of interest;
+     * a zero field selects the default.
+     */
+    typedef struct
+    {
+        size_t indent_width;          /**< Indent characters per nesting level (default 2). */
+        JsonIndentStyle indent_style; /**< Whether to indent with spaces (default) or tabs. */
+        size_t base_indent;           /**< Indent characters added before every line. */
+    } JsonPrintOptions;
+
+    /**
+     * @brief Pretty-prints a JsonValue into a writer.
+     *
+     * Each array item and object member goes on its own line, indented one
+     * level deeper than its container; empty containers are written as `{}`
+     * and `[]`. Strings are escaped and numbers formatted as by
+     * json_serialize(). The output ends with a newline and is produced in
+     * one forward pass, with indentation copied from a precomputed run.
+     *
+     * @param[in,out] writer  The writer receiving the output.
+     * @param[in]     value   The value to print; NULL is printed as null.
+     * @param[in]     options Layout options, or NULL for the defaults.
+     * @return 1 on success, 0 if the writer has run out of memory.
+     */
+    int json_print_to(JsonWriter *writer, const JsonValue *value, const JsonPrintOptions *options);
+
+    /**
+     * @brief Writes a line break and the indentation for a nesting depth.
+     *
+     * Lets formatters that do not build a JsonValue, such as json_reformat(),
+     * lay out their output exactly like json_print_to().
+     *
+     * @param[in,out] writer  The writer receiving the output.
+     * @param[in]     options Layout options, or NULL for the defaults.
+     * @param[in]     depth   Nesting depth of the new line.
+     */
+    void json_print_newline(JsonWriter *writer, const JsonPrintOptions *options, size_t depth);
+
+    /**
+     * @brief Writes the base indentation that starts the first line.
+     *
+     * @param[in,out] writer  The writer receiving the output.
+     * @param[in]     options Layout options, or NULL for the defaults.
+     */
+    void json_print_indent(JsonWriter *writer, const JsonPrintOptions *options);
+
+    /**
+     * @brief Pretty-prints a JsonValue into a new string.
+     *
+     * @param[in] value   The value to print.
+     * @param[in] options Layout options, or NULL for the defaults.
+     * @return The output, or NULL if memory runs out. The caller is
+     *         responsible for freeing it with `json_free`.
+     */
+    char *json_print_string(const JsonValue *value, const JsonPrintOptions *options);
+
     /**
      * @brief Prints the JSON parse tree starting from the given JsonValue.
      *
-     * This function traverses the JsonValue hierarchy and prints the JSON structure
-     * with proper indentation for readability.
+     * The tree is formatted with json_print_to() using two-space indentation
+     * and written to stdout with a single fwrite, so the output is correct on
+     * pipes and terminals too.
      *
      * @param[in] value  Pointer to the root JsonValue to print.
-     * @param[in] indent Current indentation level (number of spaces).
+     * @param[in] indent Number of spaces to add before every line.
      */
     void json_print(const JsonValue *value, int indent);
 
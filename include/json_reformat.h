@@ -0,0 +1,75 @@
+#ifndef JSON_REFORMAT_H
+#define JSON_REFORMAT_H
+
+#include "json_stream.h"
+#include "json_writer.h"
+#include "json_printer.h"
+
+/**
+ * @file json_reformat.h
+ * @brief Declares DOM-free reformatting of JSON text.
+ *
+ * json_reformat() passes the token stream of its input straight to its
+ * output, so documents of any size are minified, pretty-printed or
+ * normalized without building a JsonValue tree. Memory use is bounded by
+ * the longest token and JSON_STREAM_MAX_DEPTH, not by the document size.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @enum JsonFormatMode
+     * @brief Output layout produced by json_reformat().
+     */
+    typedef enum
+    {
+        JSON_FORMAT_MINIFY,   /**< No whitespace; tokens copied as written. */
+        JSON_FORMAT_PRETTY,   /**< Laid out like json_print_to(); tokens copied as written. */
+        JSON_FORMAT_CANONICAL /**< No whitespace, with strings and numbers normalized. */
+    } JsonFormatMode;
+
+    /**
+     * @struct JsonFormatOptions
+     * @brief Options for json_reformat().
+     *
+     * Zero-initialize the structure and set only the fields of interest.
+     */
+    typedef struct
+    {
+        JsonFormatMode mode;     /**< Output layout (default JSON_FORMAT_MINIFY). */
+        JsonPrintOptions layout; /**< Indentation for JSON_FORMAT_PRETTY. */
+    } JsonFormatOptions;
+
+    /**
+     * @brief Reformats a JSON document from a reader into a writer.
+     *
+     * The input is checked against the JSON grammar while it is copied,
+     * including number syntax, escapes and unescaped control characters in
+     * strings, so the output is valid JSON whenever 1 is returned.
+     * Member order is always preserved. In JSON_FORMAT_CANONICAL mode:
+     * - strings are decoded and re-escaped minimally (only `"`, `\` and
+     *   control characters; `/` and non-ASCII text are written as-is);
+     * - integer literals are copied, except that `-0` becomes `0`;
+     * - other numbers are written in the shortest `%g` form that reads back
+     *   as the same double, with no `+` or leading zeros in the exponent.
+     *
+     * Output is flushed to the writer's sink, if it has one, before
+     * returning. On failure, output already passed to a sink is not
+     * retracted.
+     *
+     * @param[in]     reader  The input source.
+     * @param[in,out] writer  The writer receiving the output.
+     * @param[in]     options Format options, or NULL to minify.
+     * @return 1 on success; 0 if the input is malformed, nested deeper than
+     *         JSON_STREAM_MAX_DEPTH, or memory or the sink fails.
+     */
+    int json_reformat(const JsonReader *reader, JsonWriter *writer, const JsonFormatOptions *options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_REFORMAT_H
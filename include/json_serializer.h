@@ -16,6 +16,17 @@ extern "C"
 {
 #endif
 
+    /**
+     * @struct JsonSerializeOptions
+     * @brief Output options for json_serialize_with().
+     *
+     * Zero-initialize the structure and set only the fields of interest.
+     */
+    typedef struct
+    {
+        int literal_slashes; /**< Write '/' as-is instead of as `\/`. */
+    } JsonSerializeOptions;
+
     /**
      * @brief Serializes a JsonValue into a JSON-formatted string.
      *
@@ -28,6 +39,20 @@ extern "C"
      */
     char *json_serialize(const JsonValue *value);
 
+    /**
+     * @brief Serializes a JsonValue with the given output options.
+     *
+     * The document is written in a single pass into one growing buffer.
+     *
+     * @param[in] value   The JsonValue to serialize.
+     * @param[in] options Output options, or NULL for the defaults used by
+     *                    json_serialize().
+     * @return A dynamically allocated string representing the JsonValue, or
+     *         NULL if memory runs out. The caller is responsible for freeing
+     *         the returned string.
+     */
+    char *json_serialize_with(const JsonValue *value, const JsonSerializeOptions *options);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,111 @@
+#ifndef JSON_SHAPE_H
+#define JSON_SHAPE_H
+
+#include "json_types.h"
+#include <stdint.h>
+
+/**
+ * @file json_shape.h
+ * @brief Declares shared key layouts ("shapes") for JSON objects.
+ *
+ * Records produced by one source usually carry the same keys in the same
+ * order. A JsonShape holds such a key sequence once, together with a hash
+ * index from key to slot. Objects created with a shape point their pairs'
+ * keys into the shape instead of owning copies (JSON_FLAG_SHARED_KEYS), and
+ * accessors resolve a key to its slot through the index instead of
+ * scanning the pairs.
+ *
+ * Shapes are created by a JsonParser with JsonParserOptions.cache_shapes
+ * set and are immutable once sealed.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Slot returned when a shape does not contain a key. */
+#define JSON_SHAPE_NO_SLOT ((size_t)-1)
+
+    /**
+     * @struct JsonShape
+     * @brief An immutable key sequence shared by objects with the same layout.
+     */
+    struct JsonShape
+    {
+        size_t count;      /**< Number of keys. */
+        uint32_t hash;     /**< Hash of the whole key sequence (see json_shape_mix()). */
+        size_t index_mask; /**< Number of index entries minus one. */
+        JsonPair *keys;    /**< Template pairs with key, key_length and key_hash set. */
+        uint32_t *index;   /**< Open-addressed slot + 1 per key hash, 0 when empty. */
+        char *storage;     /**< Next free byte for key text (used while building). */
+        JsonShape *next;   /**< Next shape in the owning cache's bucket. */
+    };
+
+    /**
+     * @brief Allocates a shape with room for its keys.
+     *
+     * Keys are then added in order with json_shape_add_key() and the shape
+     * is made usable with json_shape_seal().
+     *
+     * @param[in] count     Number of keys.
+     * @param[in] keys_size Total length of all keys in bytes.
+     * @return Pointer to the new shape, or NULL on allocation failure.
+     *         Free it with `json_shape_free`.
+     */
+    JsonShape *json_shape_new(size_t count, size_t keys_size);
+
+    /**
+     * @brief Appends the next key to a shape under construction.
+     *
+     * @param[in,out] shape  The shape being built.
+     * @param[in]     slot   Position of the key (0 for the first).
+     * @param[in]     key    The key text. Need not be null-terminated.
+     * @param[in]     length Length of the key in bytes.
+     * @param[in]     hash   json_hash_key() of the key.
+     */
+    void json_shape_add_key(JsonShape *shape, size_t slot, const char *key, size_t length, uint32_t hash);
+
+    /**
+     * @brief Finishes a shape by building its key index.
+     *
+     * @param[in,out] shape The shape whose keys have all been added.
+     */
+    void json_shape_seal(JsonShape *shape);
+
+    /**
+     * @brief Frees a shape.
+     *
+     * Objects using the shape must not be accessed afterwards.
+     *
+     * @param[in,out] shape The shape to free. May be NULL.
+     */
+    void json_shape_free(JsonShape *shape);
+
+    /**
+     * @brief Folds one key into a key sequence hash.
+     *
+     * @param[in] sequence Hash of the keys before this one (0 to start).
+     * @param[in] key_hash json_hash_key() of the key.
+     * @return Hash of the sequence extended with the key.
+     */
+    uint32_t json_shape_mix(uint32_t sequence, uint32_t key_hash);
+
+    /**
+     * @brief Finds the slot of a key in a shape.
+     *
+     * When a key occurs more than once, the first slot is returned.
+     *
+     * @param[in] shape  The shape to search.
+     * @param[in] key    The key text. Need not be null-terminated.
+     * @param[in] length Length of the key in bytes.
+     * @param[in] hash   json_hash_key() of the key.
+     * @return Index of the key's pair, or JSON_SHAPE_NO_SLOT if absent.
+     */
+    size_t json_shape_slot(const JsonShape *shape, const char *key, size_t length, uint32_t hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_SHAPE_H
@@ -0,0 +1,139 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include "json_tokenizer.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file json_stream.h
+ * @brief Declares incremental tokenization of input read in chunks.
+ *
+ * A JsonReader supplies input a chunk at a time, from a file, a socket or
+ * any other source. A JsonStream tokenizes that input without holding all
+ * of it: its buffer only ever needs to hold the current token, so memory
+ * use is bounded by the longest token rather than the document size.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @struct JsonReader
+     * @brief A source of input read in chunks.
+     */
+    typedef struct
+    {
+        /**
+         * Reads up to `size` bytes into `buffer`. Returns the number of bytes
+         * read, or 0 at the end of the input (or on error).
+         */
+        size_t (*read)(void *context, char *buffer, size_t size);
+        void *context; /**< Context pointer passed to `read`. */
+    } JsonReader;
+
+    /**
+     * @struct JsonMemorySource
+     * @brief Read position within an in-memory input, for json_reader_init_memory().
+     */
+    typedef struct
+    {
+        const char *data; /**< The input. */
+        size_t length;    /**< Number of bytes of input. */
+        size_t position;  /**< Number of bytes already read. */
+    } JsonMemorySource;
+
+    /**
+     * @struct JsonStream
+     * @brief Tokenizer state over a JsonReader.
+     */
+    typedef struct
+    {
+        JsonReader reader; /**< The input source. */
+        char *buffer;      /**< Input read but not yet consumed, from `start`. */
+        size_t capacity;   /**< Number of bytes allocated for `buffer`. */
+        size_t start;      /**< Offset in `buffer` of the first unconsumed byte. */
+        size_t length;     /**< Number of bytes of `buffer` holding input. */
+        size_t offset;     /**< Input offset of `buffer[0]`. */
+        int eof;           /**< Whether the reader has reported the end of input. */
+        int failed;        /**< Non-zero once an allocation has failed. */
+        int escaped;       /**< Whether the last TOKEN_STRING contains escape sequences. */
+    } JsonStream;
+
+    /**
+     * @brief Initializes a reader over a stdio stream.
+     *
+     * @param[out] reader Pointer to the JsonReader to initialize.
+     * @param[in]  file   The stream to read from.
+     */
+    void json_reader_init_file(JsonReader *reader, FILE *file);
+
+    /**
+     * @brief Initializes a reader over a buffer in memory.
+     *
+     * @param[out] reader Pointer to the JsonReader to initialize.
+     * @param[out] source Read position; must outlive the reader.
+     * @param[in]  data   The input. Need not be null-terminated.
+     * @param[in]  length Number of bytes of input.
+     */
+    void json_reader_init_memory(JsonReader *reader, JsonMemorySource *source, const char *data, size_t length);
+
+    /**
+     * @brief Initializes a token stream over a reader.
+     *
+     * @param[out] stream Pointer to the JsonStream to initialize.
+     * @param[in]  reader The input source (copied).
+     */
+    void json_stream_init(JsonStream *stream, const JsonReader *reader);
+
+    /**
+     * @brief Frees the stream's buffer.
+     *
+     * @param[in,out] stream Pointer to the JsonStream.
+     */
+    void json_stream_free(JsonStream *stream);
+
+    /**
+     * @brief Reads the next token.
+     *
+     * Follows the conventions of json_scan_token(): `text` points at a
+     * string's contents (escapes left as-is; see `stream->escaped`) or at a
+     * number's literal text. The text stays valid until the next call.
+     *
+     * @param[in,out] stream Pointer to the JsonStream.
+     * @param[out]    text   Receives the token's text.
+     * @param[out]    length Receives the length of the token's text.
+     * @return The token's type; TOKEN_EOF at the end of input, TOKEN_ERROR
+     *         on a lexical error or allocation failure.
+     */
+    JsonTokenType json_stream_next(JsonStream *stream, const char **text, size_t *length);
+
+    /**
+     * @brief Skips the rest of an array or object.
+     *
+     * Call after json_stream_next() has returned the opening `[` or `{`.
+     * The input is only bracket-matched, skipping over strings, so it is
+     * much faster than reading the contents token by token but does not
+     * check them against the JSON grammar.
+     *
+     * @param[in,out] stream Pointer to the JsonStream.
+     * @return 1 once the matching `]` or `}` has been consumed, 0 if the input
+     *         ends first or an allocation fails.
+     */
+    int json_stream_skip(JsonStream *stream);
+
+    /**
+     * @brief Returns the input offset of the next unconsumed byte.
+     *
+     * @param[in] stream Pointer to the JsonStream.
+     * @return The offset, counted from the start of the input.
+     */
+    size_t json_stream_offset(const JsonStream *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,205 @@
+#ifndef JSON_TAPE_H
+#define JSON_TAPE_H
+
+#include "json_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file json_tape.h
+ * @brief Declares the compact, read-only "tape" document representation.
+ *
+ * A JsonTape stores a whole document as one contiguous array of 16-byte
+ * nodes in depth-first order, plus a single arena holding every string.
+ * Each node records the size of its subtree, so stepping to the next
+ * sibling is a single addition and a full traversal is a linear scan.
+ *
+ * Nodes are addressed by index; the root is always node 0. An object's
+ * children alternate between a key node (of type JSON_STRING) and the
+ * member's value node.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Node index returned when a lookup finds nothing. */
+#define JSON_TAPE_NONE ((size_t)-1)
+
+    /**
+     * @struct JsonTapeNode
+     * @brief A single value on a JsonTape.
+     */
+    typedef struct
+    {
+        uint32_t type; /**< The JsonType of the node. */
+        uint32_t skip; /**< Number of nodes in this node's subtree, itself included. */
+        union
+        {
+            double number; /**< Numeric value if type is JSON_NUMBER. */
+            int boolean;   /**< Boolean value if type is JSON_BOOL. */
+            uint32_t count; /**< Number of items or members if type is JSON_ARRAY or JSON_OBJECT. */
+            struct
+            {
+                uint32_t offset; /**< Offset of the string in the tape's string arena. */
+                uint32_t length; /**< Length of the string in bytes. */
+            } string;            /**< String location if type is JSON_STRING. */
+        } value;                 /**< The value data based on the type. */
+    } JsonTapeNode;
+
+    /**
+     * @struct JsonTape
+     * @brief A parsed document in tape form.
+     */
+    typedef struct
+    {
+        JsonTapeNode *nodes; /**< Nodes in depth-first order. */
+        size_t count;        /**< Number of nodes. */
+        char *strings;       /**< Null-terminated strings referenced by string nodes. */
+        size_t strings_size; /**< Size of the string arena in bytes. */
+    } JsonTape;
+
+    /**
+     * @brief Parses JSON text into a tape document.
+     *
+     * @param[in] json   The JSON text to parse. Need not be null-terminated.
+     * @param[in] length Number of bytes of JSON text.
+     * @return Pointer to the new JsonTape, or NULL if the text is malformed
+     *         or memory runs out. Free it with `json_tape_free`.
+     */
+    JsonTape *json_tape_parse(const char *json, size_t length);
+
+    /**
+     * @brief Frees a tape document.
+     *
+     * @param[in,out] tape Pointer to the JsonTape to free. May be NULL.
+     */
+    void json_tape_free(JsonTape *tape);
+
+    /**
+     * @brief Returns the type of a node.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node.
+     * @return The JsonType of the node, or JSON_NULL for JSON_TAPE_NONE.
+     */
+    JsonType json_tape_type(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Returns the number of items or members in a container node.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of an array or object node.
+     * @return The number of items or members, 0 for other nodes.
+     */
+    size_t json_tape_count(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Returns the index one past the end of a node's subtree, in O(1).
+     *
+     * The children of a container are the nodes from `node + 1` up to the
+     * container's end; each child's end is the index of its next sibling.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node.
+     * @return Index of the node following the subtree, or JSON_TAPE_NONE if
+     *         `node` is out of range.
+     */
+    size_t json_tape_end(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Returns an item of an array node.
+     *
+     * @param[in] tape  Pointer to the JsonTape.
+     * @param[in] array Index of an array node.
+     * @param[in] index Position of the item.
+     * @return Index of the item, or JSON_TAPE_NONE if out of range.
+     */
+    size_t json_tape_at(const JsonTape *tape, size_t array, size_t index);
+
+    /**
+     * @brief Finds a member of an object node by key.
+     *
+     * @param[in] tape   Pointer to the JsonTape.
+     * @param[in] object Index of an object node.
+     * @param[in] key    The key string to search for.
+     * @return Index of the member's value, or JSON_TAPE_NONE if not found.
+     */
+    size_t json_tape_find(const JsonTape *tape, size_t object, const char *key);
+
+    /**
+     * @brief Returns the contents of a string node.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node.
+     * @return The null-terminated string, or NULL if the node is not a string.
+     */
+    const char *json_tape_string(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Returns the value of a number node.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node.
+     * @return The number, or 0.0 if the node is not a number.
+     */
+    double json_tape_number(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Returns the value of a boolean node.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node.
+     * @return The boolean, or false if the node is not a boolean.
+     */
+    bool json_tape_bool(const JsonTape *tape, size_t node);
+
+    /**
+     * @brief Retrieves a string value from an object node by key.
+     *
+     * @param[in] tape   Pointer to the JsonTape.
+     * @param[in] object Index of an object node.
+     * @param[in] key    The key string to search for.
+     * @return The string if found and of type JSON_STRING, NULL otherwise.
+     */
+    const char *json_tape_get_string(const JsonTape *tape, size_t object, const char *key);
+
+    /**
+     * @brief Retrieves a number value from an object node by key.
+     *
+     * @param[in] tape   Pointer to the JsonTape.
+     * @param[in] object Index of an object node.
+     * @param[in] key    The key string to search for.
+     * @return The number if found and of type JSON_NUMBER, 0.0 otherwise.
+     */
+    double json_tape_get_number(const JsonTape *tape, size_t object, const char *key);
+
+    /**
+     * @brief Retrieves a boolean value from an object node by key.
+     *
+     * @param[in] tape   Pointer to the JsonTape.
+     * @param[in] object Index of an object node.
+     * @param[in] key    The key string to search for.
+     * @return true if the value is true and of type JSON_BOOL, false otherwise.
+     */
+    bool json_tape_get_bool(const JsonTape *tape, size_t object, const char *key);
+
+    /**
+     * @brief Serializes a node and its subtree into a JSON-formatted string.
+     *
+     * Produces the same text json_serialize() produces for the equivalent
+     * JsonValue tree.
+     *
+     * @param[in] tape Pointer to the JsonTape.
+     * @param[in] node Index of the node to serialize (0 for the whole document).
+     * @return A dynamically allocated string, or NULL on failure.
+     *         The caller is responsible for freeing it with `json_free`.
+     */
+    char *json_tape_serialize(const JsonTape *tape, size_t node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_TAPE_H
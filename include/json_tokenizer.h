@@ -2,6 +2,7 @@
 #define JSON_TOKENIZER_H
 
 #include "json_types.h"
+#include <stdint.h>
 
 /**
  * @file json_tokenizer.h
@@ -46,7 +47,7 @@ typedef enum
 typedef struct
 {
     JsonTokenType type; /**< The type of the token, as defined in JsonTokenType. */
-    char *value;        /**< The string value of the token, if applicable. For example, the actual string content or number in string form. */
+    char *value;        /**< The string value of the token, if applicable. For example, the decoded string content or number in string form. */
 } JsonToken;
 
 /**
@@ -60,8 +61,37 @@ typedef struct
 {
     const char *json; /**< Pointer to the JSON string being tokenized. */
     size_t pos;       /**< Current position (index) within the JSON string. */
+    size_t length;    /**< Length of the input in bytes. */
+    int escaped;      /**< Whether the last TOKEN_STRING scanned contains escape sequences. */
 } JsonTokenizer;
 
+/**
+ * @struct JsonTapeToken
+ * @brief A token recorded on a JsonTokenTape.
+ *
+ * Tape tokens refer back into the input instead of owning a copy of their
+ * text. `offset` and `length` follow the conventions of json_scan_token().
+ */
+typedef struct
+{
+    size_t offset;   /**< Offset of the token's text within the input. */
+    uint32_t length; /**< Length of the token's text in bytes. */
+    uint32_t type;   /**< The JsonTokenType of the token. */
+} JsonTapeToken;
+
+/**
+ * @struct JsonTokenTape
+ * @brief A contiguous array of tokens produced by json_tokenize_all().
+ *
+ * A tape can be reused across inputs; its storage is kept between calls.
+ */
+typedef struct
+{
+    JsonTapeToken *tokens; /**< The recorded tokens. */
+    size_t count;          /**< Number of tokens on the tape. */
+    size_t capacity;       /**< Number of tokens the storage can hold. */
+} JsonTokenTape;
+
 /**
  * @brief Converts a JsonTokenType to its string representation.
  *
@@ -79,10 +109,41 @@ const char *json_token_type_to_string(JsonTokenType token_type);
  * This function sets up the tokenizer to begin parsing a new JSON string.
  *
  * @param[in,out] tokenizer Pointer to the JsonTokenizer instance to initialize.
- * @param[in]     json      The JSON string to tokenize.
+ * @param[in]     json      The null-terminated JSON string to tokenize.
  */
 void json_tokenizer_init(JsonTokenizer *tokenizer, const char *json);
 
+/**
+ * @brief Initializes the JSON tokenizer with a length-delimited buffer.
+ *
+ * Unlike json_tokenizer_init(), the input does not need to be null-terminated;
+ * the tokenizer never reads at or beyond `json + length`.
+ *
+ * @param[in,out] tokenizer Pointer to the JsonTokenizer instance to initialize.
+ * @param[in]     json      The JSON text to tokenize.
+ * @param[in]     length    Number of bytes of JSON text.
+ */
+void json_tokenizer_init_range(JsonTokenizer *tokenizer, const char *json, size_t length);
+
+/**
+ * @brief Scans the next token without allocating.
+ *
+ * Instead of copying the token's text, reports where it lies in the input:
+ * the contents between the quotes for TOKEN_STRING (escapes left as-is), or
+ * the literal text for TOKEN_NUMBER. For other tokens `length` is 0.
+ *
+ * String contents must be well-formed UTF-8; ASCII runs are checked 16
+ * bytes at a time. After a TOKEN_STRING, `tokenizer->escaped` tells whether
+ * the text needs json_unescape(); escape sequences themselves are checked
+ * only when they are decoded.
+ *
+ * @param[in,out] tokenizer Pointer to the JsonTokenizer instance.
+ * @param[out]    start     Offset of the token's text within the input.
+ * @param[out]    length    Length of the token's text in bytes.
+ * @return The type of the token scanned.
+ */
+JsonTokenType json_scan_token(JsonTokenizer *tokenizer, size_t *start, size_t *length);
+
 /**
  * @brief Retrieves the next token from the JSON string.
  *
@@ -117,4 +178,34 @@ void json_tokenizer_reset(JsonTokenizer *tokenizer, const char *json);
  */
 void json_token_free(JsonToken *token);
 
+/**
+ * @brief Initializes an empty token tape.
+ *
+ * @param[out] tape Pointer to the JsonTokenTape to initialize.
+ */
+void json_token_tape_init(JsonTokenTape *tape);
+
+/**
+ * @brief Frees the storage owned by a token tape.
+ *
+ * @param[in,out] tape Pointer to the JsonTokenTape to free. It is left empty
+ *                     and may be reused.
+ */
+void json_token_tape_free(JsonTokenTape *tape);
+
+/**
+ * @brief Tokenizes an entire input onto a token tape.
+ *
+ * Lexes the input in a single pass without allocating per token. The tape
+ * is cleared first and always ends with a TOKEN_EOF token on success, or a
+ * TOKEN_ERROR token at the offending offset on failure. Only lexical errors
+ * are detected; the token sequence is not checked against the JSON grammar.
+ *
+ * @param[in]     json   The JSON text to tokenize. Need not be null-terminated.
+ * @param[in]     length Number of bytes of JSON text.
+ * @param[in,out] out    The tape to fill.
+ * @return 1 on success, 0 on a lexical error or allocation failure.
+ */
+int json_tokenize_all(const char *json, size_t length, JsonTokenTape *out);
+
 #endif // JSON_TOKENIZER_H
@@ -2,6 +2,7 @@
 #define JSON_TYPES_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * @file json_types.h
@@ -39,10 +40,30 @@ typedef struct JsonValue JsonValue;
 typedef struct JsonArray JsonArray;
 typedef struct JsonPair JsonPair;
 typedef struct JsonObject JsonObject;
+typedef struct JsonShape JsonShape;
+
+/**
+ * @name JsonValue storage flags
+ * Describe how a JsonValue's storage was allocated. Values created by hand
+ * must set `flags` to 0, meaning every part is a separate allocation.
+ * @{
+ */
+/** The string's bytes follow the JsonValue in the same allocation. */
+#define JSON_FLAG_INLINE_STRING 0x1u
+/** The container header, its pairs/items array and (for objects) its key
+ *  strings follow the JsonValue in the same allocation. */
+#define JSON_FLAG_INLINE_CHILDREN 0x2u
+/** The array's items are stored as a packed `double` array in
+ *  JsonArray.numbers instead of JsonArray.items (see json_array_as_doubles()). */
+#define JSON_FLAG_PACKED_NUMBERS 0x4u
+/** The object's keys belong to its JsonObject.shape and are not freed with it. */
+#define JSON_FLAG_SHARED_KEYS 0x8u
+/** @} */
 
 struct JsonValue
 {
-    JsonType type; /**< The type of the JSON value. */
+    JsonType type;      /**< The type of the JSON value. */
+    unsigned int flags; /**< Storage flags (JSON_FLAG_*), 0 for separate allocations. */
     union
     {
         double number;      /**< Numeric value if type is JSON_NUMBER. */
@@ -61,8 +82,10 @@ struct JsonValue
  */
 struct JsonPair
 {
-    char *key;        /**< The key string. */
-    JsonValue *value; /**< Pointer to the corresponding JSON value. */
+    char *key;           /**< The key string. */
+    JsonValue *value;    /**< Pointer to the corresponding JSON value. */
+    uint32_t key_length; /**< Length of the key, valid when key_hash is non-zero. */
+    uint32_t key_hash;   /**< json_hash_key() of the key, or 0 if not computed. */
 };
 
 /**
@@ -70,11 +93,15 @@ struct JsonPair
  * @brief Represents a JSON object containing multiple JsonPair elements.
  *
  * A JsonObject consists of an array of JsonPairs and a count of how many pairs it contains.
+ * `capacity` is only used by the builder (json_builder.h) to grow `pairs` in
+ * place; containers created by hand should set it to 0.
  */
 struct JsonObject
 {
-    JsonPair *pairs; /**< Array of key-value pairs. */
-    size_t count;    /**< Number of key-value pairs. */
+    JsonPair *pairs;        /**< Array of key-value pairs. */
+    size_t count;           /**< Number of key-value pairs. */
+    const JsonShape *shape; /**< Shared key layout (see json_shape.h), or NULL. */
+    size_t capacity;        /**< Pairs allocated in a separately allocated `pairs` array, 0 if fixed. */
 };
 
 /**
@@ -82,11 +109,45 @@ struct JsonObject
  * @brief Represents a JSON array containing multiple JsonValue elements.
  *
  * A JsonArray consists of an array of JsonValues and a count of how many values it contains.
+ * Arrays made only of numbers may instead be stored packed, as a contiguous
+ * array of doubles, when the parser is asked to do so. `capacity` is only used
+ * by the builder (json_builder.h); containers created by hand should set it to 0.
  */
 struct JsonArray
 {
-    JsonValue **items; /**< Dynamic array of pointers to JSON values. */
+    JsonValue **items; /**< Dynamic array of pointers to JSON values (NULL when packed). */
     size_t count;      /**< Number of items in the array. */
+    double *numbers;   /**< Packed numeric items if the array is flagged JSON_FLAG_PACKED_NUMBERS, NULL otherwise. */
+    size_t capacity;   /**< Items allocated in a separately allocated `items` array, 0 if fixed. */
 };
 
+/**
+ * @enum JsonErrorCode
+ * @brief Reasons a JSON text is rejected.
+ */
+typedef enum
+{
+    JSON_ERROR_NONE,            /**< No error. */
+    JSON_ERROR_UNEXPECTED_END,  /**< The input ended inside a value. */
+    JSON_ERROR_UNEXPECTED_CHAR, /**< A character that cannot start or continue the expected token. */
+    JSON_ERROR_INVALID_NUMBER,  /**< A number that does not follow the JSON number grammar. */
+    JSON_ERROR_INVALID_STRING,  /**< An unescaped control character inside a string. */
+    JSON_ERROR_INVALID_ESCAPE,  /**< An unknown escape, bad `\u` digits, or an unpaired surrogate. */
+    JSON_ERROR_INVALID_UTF8,    /**< Bytes that are not well-formed UTF-8. */
+    JSON_ERROR_TOO_DEEP,        /**< Nesting deeper than the configured limit. */
+    JSON_ERROR_TRAILING_DATA    /**< Non-whitespace after the top-level value. */
+} JsonErrorCode;
+
+/**
+ * @struct JsonError
+ * @brief Describes where and why a JSON text was rejected.
+ */
+typedef struct
+{
+    JsonErrorCode code; /**< What went wrong. */
+    size_t offset;      /**< Byte offset of the error in the input. */
+    size_t line;        /**< 1-based line of the error. */
+    size_t column;      /**< 1-based column (in bytes) of the error. */
+} JsonError;
+
 #endif // JSON_TYPES_H
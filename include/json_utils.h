@@ -2,6 +2,8 @@
 #define JSON_UTILS_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include "json_types.h"
 #include <stdlib.h>
 
 /**
@@ -82,6 +84,202 @@ char *json_strdup(const char *s);
  */
 char *json_strdup_range(const char *s, size_t len);
 
+/**
+ * @brief Converts a range of characters holding a JSON number to a double.
+ *
+ * The range does not need to be null-terminated; conversion never reads
+ * past `s + len`.
+ *
+ * @param[in] s   The number text.
+ * @param[in] len The number of characters in the number text.
+ * @return The converted value, or 0.0 if the text cannot be converted.
+ */
+double json_number_from_range(const char *s, size_t len);
+
+/**
+ * @brief Hashes an object key for fast lookups.
+ *
+ * Used by the parser to fill in JsonPair::key_hash and by json_key() to
+ * precompute lookup handles. The result is never 0, which marks a pair
+ * whose hash has not been computed.
+ *
+ * @param[in] s   The key text. Need not be null-terminated.
+ * @param[in] len The number of characters in the key.
+ * @return The 32-bit hash of the key.
+ */
+uint32_t json_hash_key(const char *s, size_t len);
+
+/**
+ * @brief Measures a well-formed UTF-8 sequence.
+ *
+ * Rejects overlong encodings, encoded surrogates (U+D800..U+DFFF) and code
+ * points above U+10FFFF, as required by RFC 3629.
+ *
+ * @param[in] s     The bytes to check.
+ * @param[in] avail Number of bytes available at `s` (at least 1).
+ * @return Length of the sequence starting at `s` (1 to 4), or 0 if it is
+ *         not well-formed or is truncated.
+ */
+size_t json_utf8_sequence_length(const unsigned char *s, size_t avail);
+
+/**
+ * @brief Skips the bytes of a string's contents that need no attention.
+ *
+ * Stops at the first quote, backslash, control character or non-ASCII
+ * byte. Uses SSE2 to examine 16 bytes at a time where the compiler
+ * provides it; never reads at or beyond `end`.
+ *
+ * @param[in] p   Where to start scanning.
+ * @param[in] end One past the last byte that may be read.
+ * @return The first byte needing attention, or `end`.
+ */
+const char *json_scan_string_run(const char *p, const char *end);
+
+/**
+ * @brief Reads the four hex digits of a `\u` escape.
+ *
+ * @param[in] s     The digits (after `\u`).
+ * @param[in] avail Number of bytes available at `s`.
+ * @return The UTF-16 code unit, or -1 if the digits are missing or invalid.
+ */
+long json_parse_hex4(const char *s, size_t avail);
+
+/**
+ * @brief Measures the number at the start of some text, following the JSON grammar.
+ *
+ * An optional `-`, then `0` or a digit sequence not starting with `0`, an
+ * optional fraction and an optional exponent, each of which must have at
+ * least one digit. The caller decides what may follow the number; a token
+ * is a well-formed number when the returned length equals its own.
+ *
+ * @param[in] s   The text. Need not be null-terminated.
+ * @param[in] len Number of bytes at `s`.
+ * @return Length of the number, or 0 if the text does not start with a
+ *         well-formed one (for example `-`, `.5`, `1.` or `1e`).
+ */
+size_t json_number_length(const char *s, size_t len);
+
+/**
+ * @brief Checks whether text holds raw control characters (below 0x20).
+ *
+ * JSON strings must escape them, so string contents containing one are
+ * malformed.
+ *
+ * @param[in] s   The contents between the quotes. Need not be null-terminated.
+ * @param[in] len Number of bytes at `s`.
+ * @return 1 if a control character is present, 0 otherwise.
+ */
+int json_has_control_chars(const char *s, size_t len);
+
+/**
+ * @brief Decodes the escape sequences in a string's contents.
+ *
+ * Runs without escapes are copied with memcpy. `\u` escapes are written as
+ * UTF-8, and surrogate pairs are combined into one code point; a lone
+ * surrogate is an error. `\u0000` decodes to a NUL byte, so such a string
+ * appears truncated to C string functions.
+ *
+ * Decoding never makes a string longer, so `out` needs at most `len + 1`
+ * bytes.
+ *
+ * @param[in]  s   The contents between the quotes. Need not be null-terminated.
+ * @param[in]  len Number of bytes at `s`.
+ * @param[out] out Receives the decoded, null-terminated text. Must not
+ *                 overlap `s`.
+ * @return Length of the decoded text, or SIZE_MAX if an escape is invalid.
+ */
+size_t json_unescape(const char *s, size_t len, char *out);
+
+/**
+ * @brief Decodes the next reference token of a JSON Pointer (RFC 6901).
+ *
+ * `~0` decodes to `~` and `~1` to `/`.
+ *
+ * @param[in]  p      Start of the token (after its '/').
+ * @param[out] token  Receives the decoded, null-terminated token; must have
+ *                    room for the rest of the pointer.
+ * @param[out] length Receives the length of the decoded token.
+ * @return Pointer past the token (at the next '/' or the end), or NULL if
+ *         it has an invalid escape.
+ */
+const char *json_pointer_token(const char *p, char *token, size_t *length);
+
+/**
+ * @brief Reads an array index from a JSON Pointer token.
+ *
+ * @param[in] token  The decoded token.
+ * @param[in] length Length of the token.
+ * @return The index, or SIZE_MAX if the token is not a canonical decimal
+ *         (no sign or leading zeros).
+ */
+size_t json_pointer_index(const char *token, size_t length);
+
+/**
+ * @brief Returns the length of a pair's key.
+ *
+ * Pairs built by hand carry no hash, and so no length.
+ *
+ * @param[in] pair The pair.
+ * @return Length of the key in bytes.
+ */
+size_t json_pair_key_length(const JsonPair *pair);
+
+/**
+ * @brief Finds the position of a key in an object.
+ *
+ * Shaped objects are looked up through their shape. Otherwise pairs
+ * carrying a hash are rejected on hash and length alone, and the key bytes
+ * are only compared for likely matches.
+ *
+ * @param[in] object The object.
+ * @param[in] key    The key. Need not be null-terminated.
+ * @param[in] length Length of the key.
+ * @param[in] hash   json_hash_key() of the key.
+ * @return Index of the key's pair, or SIZE_MAX if absent.
+ */
+size_t json_object_slot(const JsonObject *object, const char *key, size_t length, uint32_t hash);
+
+/**
+ * @brief Checks whether two pairs have the same key.
+ *
+ * @param[in] a The first pair.
+ * @param[in] b The second pair.
+ * @return 1 if the keys are equal, 0 otherwise.
+ */
+int json_same_key(const JsonPair *a, const JsonPair *b);
+
+/**
+ * @brief Finds the position of the member with the same key as a pair.
+ *
+ * The pair at `hint` is tried before looking the key up, since documents
+ * of one kind usually list their members in the same order; pass the
+ * pair's position in its own object, or SIZE_MAX for no hint.
+ *
+ * @param[in] object The object to search.
+ * @param[in] pair   A pair, typically from another object.
+ * @param[in] hint   The position to try first.
+ * @return Index of the matching pair, or SIZE_MAX if absent.
+ */
+size_t json_object_pair_slot(const JsonObject *object, const JsonPair *pair, size_t hint);
+
+/**
+ * @brief Returns an item of an array, making a value for a packed number.
+ *
+ * @param[in]  array   The array.
+ * @param[in]  index   Position of the item, less than the item count.
+ * @param[out] scratch Receives the item when the array is packed.
+ * @return The item, or `scratch`, valid while the array and `scratch` are.
+ */
+const JsonValue *json_array_item(const JsonValue *array, size_t index, JsonValue *scratch);
+
+/**
+ * @brief Returns a short description of an error code.
+ *
+ * @param[in] code The error code.
+ * @return A static, human-readable string.
+ */
+const char *json_error_string(JsonErrorCode code);
+
 /**
  * @brief Checks if a character is considered whitespace in JSON.
  *
@@ -0,0 +1,49 @@
+#ifndef JSON_VALIDATE_H
+#define JSON_VALIDATE_H
+
+#include "json_types.h"
+#include <stddef.h>
+
+/**
+ * @file json_validate.h
+ * @brief Declares a validation-only pass over JSON text.
+ *
+ * json_validate() checks a text against the full RFC 8259 grammar without
+ * building a document or allocating memory, for callers that only need to
+ * accept or reject input.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Checks that a text is a single, well-formed JSON value.
+     *
+     * Validation is strict:
+     * - numbers must follow the JSON number grammar (no leading zeros,
+     *   `+` signs, bare `.`, `NaN` or `Infinity`);
+     * - strings must not contain unescaped control characters, must use only
+     *   the escapes defined by RFC 8259, must pair `\u` surrogate escapes,
+     *   and must be well-formed UTF-8;
+     * - only space, tab, line feed and carriage return count as whitespace,
+     *   and nothing but whitespace may follow the value.
+     *
+     * String contents are scanned 16 bytes at a time with SSE2 where the
+     * compiler provides it. Nesting is tracked in a fixed bit stack, so
+     * documents deeper than JSON_VALIDATE_MAX_DEPTH are rejected.
+     *
+     * @param[in]  json   The JSON text. Need not be null-terminated.
+     * @param[in]  length Number of bytes of JSON text.
+     * @param[out] err    Receives the error location and reason. May be NULL.
+     *                    Its code is JSON_ERROR_NONE on success.
+     * @return 1 if the text is valid JSON, 0 otherwise.
+     */
+    int json_validate(const char *json, size_t length, JsonError *err);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_VALIDATE_H
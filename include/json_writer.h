@@ -0,0 +1,163 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file json_writer.h
+ * @brief Growable output buffer used to produce JSON text.
+ *
+ * A JsonWriter accumulates output in a single buffer that grows
+ * geometrically, so emitting a document is linear in its size. A writer
+ * with a sink instead hands its buffer to the sink whenever it fills, so
+ * output of any size passes through a bounded buffer.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Receives output flushed by a JsonWriter.
+     *
+     * @param[in] context The sink's context pointer.
+     * @param[in] data    Bytes to consume.
+     * @param[in] length  Number of bytes.
+     * @return 1 on success, 0 to fail the writer.
+     */
+    typedef int (*JsonWriterSink)(void *context, const char *data, size_t length);
+
+    /**
+     * @struct JsonWriter
+     * @brief An output buffer for JSON text.
+     */
+    typedef struct
+    {
+        char *data;          /**< Buffer holding the output written so far. */
+        size_t length;       /**< Number of bytes written. */
+        size_t capacity;     /**< Number of bytes allocated for `data`. */
+        int failed;          /**< Non-zero once an allocation or the sink has failed. */
+        int literal_slashes; /**< Write '/' as-is instead of as `\/` (0 after json_writer_init()). */
+        JsonWriterSink sink; /**< Receives the buffer when it fills, or NULL to keep all output. */
+        void *sink_context;  /**< Context pointer passed to `sink`. */
+    } JsonWriter;
+
+    /**
+     * @brief Initializes an empty writer.
+     *
+     * @param[out] writer Pointer to the JsonWriter to initialize.
+     */
+    void json_writer_init(JsonWriter *writer);
+
+    /**
+     * @brief Initializes an empty writer that passes its output to a sink.
+     *
+     * Output is collected in a buffer of about JSON_STREAM_BUFFER_SIZE bytes
+     * (larger only if a single write needs it) and handed to the sink when
+     * the buffer fills and on json_writer_flush(). Call json_writer_flush()
+     * and then json_writer_free() when done.
+     *
+     * @param[out] writer  Pointer to the JsonWriter to initialize.
+     * @param[in]  sink    The function receiving output.
+     * @param[in]  context Context pointer passed to `sink`.
+     */
+    void json_writer_init_sink(JsonWriter *writer, JsonWriterSink sink, void *context);
+
+    /**
+     * @brief Initializes an empty writer whose output goes to a stdio stream.
+     *
+     * @param[out] writer Pointer to the JsonWriter to initialize.
+     * @param[in]  file   The stream to write to.
+     */
+    void json_writer_init_file(JsonWriter *writer, FILE *file);
+
+    /**
+     * @brief Hands buffered output to the writer's sink.
+     *
+     * Does nothing for a writer without a sink.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @return 1 on success, 0 if the writer or its sink has failed.
+     */
+    int json_writer_flush(JsonWriter *writer);
+
+    /**
+     * @brief Frees the writer's buffer.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter. It is left empty and may be
+     *                       reused; its options are kept.
+     */
+    void json_writer_free(JsonWriter *writer);
+
+    /**
+     * @brief Ensures room for at least `extra` more bytes.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     extra  Number of bytes about to be written.
+     * @return 1 on success, 0 if the buffer could not grow.
+     */
+    int json_writer_reserve(JsonWriter *writer, size_t extra);
+
+    /**
+     * @brief Appends bytes to the output.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     data   Bytes to append.
+     * @param[in]     length Number of bytes to append.
+     */
+    void json_writer_write(JsonWriter *writer, const char *data, size_t length);
+
+    /**
+     * @brief Appends a null-terminated string to the output.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     str    String to append.
+     */
+    void json_writer_puts(JsonWriter *writer, const char *str);
+
+    /**
+     * @brief Appends a single character to the output.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     c      Character to append.
+     */
+    void json_writer_putc(JsonWriter *writer, char c);
+
+    /**
+     * @brief Appends string contents with JSON escaping applied (without quotes).
+     *
+     * Quotes, backslashes and control characters are escaped, and so is '/'
+     * unless `literal_slashes` is set. Runs that need no escaping are found
+     * 32 or 16 bytes at a time (AVX2 or SSE2, where the compiler provides
+     * them) and copied in bulk.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     str    Characters to escape.
+     * @param[in]     length Number of characters.
+     */
+    void json_writer_write_escaped(JsonWriter *writer, const char *str, size_t length);
+
+    /**
+     * @brief Appends a number formatted the way json_serialize() formats numbers.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @param[in]     number The number to append.
+     */
+    void json_writer_write_number(JsonWriter *writer, double number);
+
+    /**
+     * @brief Returns the output as a null-terminated string and resets the writer.
+     *
+     * @param[in,out] writer Pointer to the JsonWriter.
+     * @return The output, or NULL if any write failed. The caller is
+     *         responsible for freeing the returned string with `json_free`.
+     */
+    char *json_writer_finish(JsonWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_WRITER_H
@@ -1,6 +1,19 @@
 #include "json_accessor.h"
+#include "json_utils.h"
+#include "json_shape.h"
 #include <string.h>
 
+/**
+ * @brief Resolves a key through the shape index of a shaped object.
+ *
+ * @return Pointer to the JsonPair if found, NULL otherwise.
+ */
+static JsonPair *find_shaped_pair(const JsonObject *object, const char *key, size_t length, uint32_t hash)
+{
+    size_t slot = json_shape_slot(object->shape, key, length, hash);
+    return slot == JSON_SHAPE_NO_SLOT ? NULL : &object->pairs[slot];
+}
+
 /**
  * @brief Helper function to find a JsonPair by key in a JsonObject.
  *
@@ -15,6 +28,12 @@ static JsonPair *find_pair(const JsonValue *object, const char *key)
         return NULL;
     }
 
+    if (object->value.object->shape)
+    {
+        size_t length = strlen(key);
+        return find_shaped_pair(object->value.object, key, length, json_hash_key(key, length));
+    }
+
     for (size_t i = 0; i < object->value.object->count; i++)
     {
         if (strcmp(object->value.object->pairs[i].key, key) == 0)
@@ -26,6 +45,58 @@ static JsonPair *find_pair(const JsonValue *object, const char *key)
     return NULL;
 }
 
+/**
+ * @brief Helper function to find a JsonPair by precomputed key.
+ *
+ * Pairs carrying a hash are rejected on hash and length alone; the key
+ * bytes are only compared for likely matches. Pairs without a hash (built
+ * by hand) are compared in full.
+ *
+ * @param[in] object Pointer to the JsonValue object (must be of type JSON_OBJECT).
+ * @param[in] key    The precomputed key.
+ * @return Pointer to the JsonPair if found, NULL otherwise.
+ */
+static JsonPair *find_pair_k(const JsonValue *object, JsonKey key)
+{
+    if (!object || object->type != JSON_OBJECT || !key.str)
+    {
+        return NULL;
+    }
+
+    if (object->value.object->shape)
+    {
+        return find_shaped_pair(object->value.object, key.str, key.length, key.hash);
+    }
+
+    JsonPair *pairs = object->value.object->pairs;
+    for (size_t i = 0; i < object->value.object->count; i++)
+    {
+        if (pairs[i].key_hash)
+        {
+            if (pairs[i].key_hash == key.hash && pairs[i].key_length == key.length &&
+                memcmp(pairs[i].key, key.str, key.length) == 0)
+            {
+                return &pairs[i];
+            }
+        }
+        else if (strcmp(pairs[i].key, key.str) == 0)
+        {
+            return &pairs[i];
+        }
+    }
+
+    return NULL;
+}
+
+JsonKey json_key(const char *key)
+{
+    JsonKey handle;
+    handle.str = key;
+    handle.length = key ? strlen(key) : 0;
+    handle.hash = key ? json_hash_key(key, handle.length) : 0;
+    return handle;
+}
+
 const char *json_get_string(const JsonValue *object, const char *key)
 {
     JsonPair *pair = find_pair(object, key);
@@ -85,3 +156,155 @@ bool json_is_null(const JsonValue *object, const char *key)
     }
     return false;
 }
+
+JsonValue *json_get_value(const JsonValue *object, const char *key)
+{
+    JsonPair *pair = find_pair(object, key);
+    return pair ? pair->value : NULL;
+}
+
+const char *json_get_string_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_STRING)
+    {
+        return pair->value->value.string;
+    }
+    return NULL;
+}
+
+double json_get_number_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_NUMBER)
+    {
+        return pair->value->value.number;
+    }
+    return 0.0;
+}
+
+bool json_get_bool_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_BOOL)
+    {
+        return pair->value->value.boolean ? true : false;
+    }
+    return false;
+}
+
+JsonValue *json_get_array_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_ARRAY)
+    {
+        return pair->value;
+    }
+    return NULL;
+}
+
+JsonValue *json_get_object_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_OBJECT)
+    {
+        return pair->value;
+    }
+    return NULL;
+}
+
+bool json_is_null_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    if (pair && pair->value->type == JSON_NULL)
+    {
+        return true;
+    }
+    return false;
+}
+
+JsonValue *json_get_value_k(const JsonValue *object, JsonKey key)
+{
+    JsonPair *pair = find_pair_k(object, key);
+    return pair ? pair->value : NULL;
+}
+
+/* Specs resolved per pass of json_get_many (one bit each). */
+#define GET_MANY_BATCH 64
+
+size_t json_get_many(const JsonValue *object, const JsonFieldSpec specs[], size_t n, JsonValue *out[])
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = NULL;
+    if (!object || object->type != JSON_OBJECT)
+        return 0;
+
+    const JsonPair *pairs = object->value.object->pairs;
+    size_t count = object->value.object->count;
+    size_t filled = 0;
+
+    if (object->value.object->shape)
+    {
+        /* Each spec resolves straight to its slot */
+        for (size_t i = 0; i < n; i++)
+        {
+            const JsonPair *pair = find_shaped_pair(object->value.object, specs[i].key.str, specs[i].key.length,
+                                                    specs[i].key.hash);
+            if (pair && (!specs[i].types || (specs[i].types & JSON_TYPE_BIT(pair->value->type))))
+            {
+                out[i] = pair->value;
+                filled++;
+            }
+        }
+        return filled;
+    }
+
+    for (size_t base = 0; base < n; base += GET_MANY_BATCH)
+    {
+        size_t batch = n - base < GET_MANY_BATCH ? n - base : GET_MANY_BATCH;
+        uint64_t pending = batch == 64 ? ~(uint64_t)0 : (((uint64_t)1 << batch) - 1);
+
+        for (size_t p = 0; p < count && pending; p++)
+        {
+            uint32_t hash = pairs[p].key_hash;
+            size_t length = pairs[p].key_length;
+            if (!hash)
+            {
+                /* Hand-built pair: hash it once for all specs */
+                length = strlen(pairs[p].key);
+                hash = json_hash_key(pairs[p].key, length);
+            }
+
+            for (size_t i = 0; i < batch; i++)
+            {
+                const JsonFieldSpec *spec = &specs[base + i];
+                if (!(pending & ((uint64_t)1 << i)) || spec->key.hash != hash || spec->key.length != length ||
+                    memcmp(pairs[p].key, spec->key.str, length) != 0)
+                    continue;
+
+                /* First member with the key wins, whatever its type */
+                pending &= ~((uint64_t)1 << i);
+                if (!spec->types || (spec->types & JSON_TYPE_BIT(pairs[p].value->type)))
+                {
+                    out[base + i] = pairs[p].value;
+                    filled++;
+                }
+            }
+        }
+    }
+
+    return filled;
+}
+
+const double *json_array_as_doubles(const JsonValue *array, size_t *length)
+{
+    if (!array || array->type != JSON_ARRAY || !(array->flags & JSON_FLAG_PACKED_NUMBERS))
+    {
+        if (length)
+            *length = 0;
+        return NULL;
+    }
+    if (length)
+        *length = array->value.array->count;
+    return array->value.array->numbers;
+}
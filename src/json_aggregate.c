@@ -0,0 +1,226 @@
+#include "json_aggregate.h"
+#include "json_utils.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Number of values gathered from an unpacked array per reduction. */
+#define AGGREGATE_BLOCK_SIZE 256
+
+/* Path keys resolved without allocating. */
+#define AGGREGATE_INLINE_SEGMENTS 8
+
+/* One key of a dotted path. */
+typedef struct
+{
+    const char *key; /**< Start of the key within the path string. */
+    size_t length;   /**< Length of the key. */
+} PathSegment;
+
+/* Running totals across reduced blocks. */
+typedef struct
+{
+    size_t count; /**< Values reduced so far. */
+    double sum;   /**< Sum of the values. */
+    double min;   /**< Smallest value (valid once count > 0). */
+    double max;   /**< Largest value (valid once count > 0). */
+} Accumulator;
+
+/**
+ * @brief Reduces a block of doubles into the accumulator.
+ *
+ * @param[in]     values      The values to reduce.
+ * @param[in]     n           Number of values.
+ * @param[in]     need_minmax Whether min and max are required.
+ * @param[in,out] acc         The running totals.
+ */
+static void reduce_block(const double *values, size_t n, int need_minmax, Accumulator *acc)
+{
+    if (n == 0)
+        return;
+
+    size_t i = 0;
+    double sum = 0.0;
+    double min = values[0];
+    double max = values[0];
+
+#if defined(__SSE2__)
+    if (n >= 4)
+    {
+        /* Two vectors per operation hide the latency of the dependent adds */
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+        __m128d min0 = _mm_loadu_pd(values);
+        __m128d min1 = _mm_loadu_pd(values + 2);
+        __m128d max0 = min0;
+        __m128d max1 = min1;
+
+        if (need_minmax)
+        {
+            for (; i + 4 <= n; i += 4)
+            {
+                __m128d a = _mm_loadu_pd(values + i);
+                __m128d b = _mm_loadu_pd(values + i + 2);
+                sum0 = _mm_add_pd(sum0, a);
+                sum1 = _mm_add_pd(sum1, b);
+                min0 = _mm_min_pd(min0, a);
+                min1 = _mm_min_pd(min1, b);
+                max0 = _mm_max_pd(max0, a);
+                max1 = _mm_max_pd(max1, b);
+            }
+        }
+        else
+        {
+            for (; i + 4 <= n; i += 4)
+            {
+                sum0 = _mm_add_pd(sum0, _mm_loadu_pd(values + i));
+                sum1 = _mm_add_pd(sum1, _mm_loadu_pd(values + i + 2));
+            }
+        }
+
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+        sum = lanes[0] + lanes[1];
+        _mm_storeu_pd(lanes, _mm_min_pd(min0, min1));
+        min = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+        _mm_storeu_pd(lanes, _mm_max_pd(max0, max1));
+        max = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        sum += values[i];
+        if (values[i] < min)
+            min = values[i];
+        if (values[i] > max)
+            max = values[i];
+    }
+
+    if (acc->count == 0 || min < acc->min)
+        acc->min = min;
+    if (acc->count == 0 || max > acc->max)
+        acc->max = max;
+    acc->sum += sum;
+    acc->count += n;
+}
+
+/**
+ * @brief Follows a dotted path of keys from a value.
+ *
+ * @return The value at the end of the path, or NULL if any key is missing.
+ */
+static const JsonValue *resolve_path(const JsonValue *value, const PathSegment *segments, size_t count)
+{
+    for (size_t s = 0; s < count && value; s++)
+    {
+        if (value->type != JSON_OBJECT)
+            return NULL;
+
+        const JsonObject *object = value->value.object;
+        const JsonValue *found = NULL;
+        for (size_t i = 0; i < object->count; i++)
+        {
+            const char *key = object->pairs[i].key;
+            if (strncmp(key, segments[s].key, segments[s].length) == 0 && key[segments[s].length] == '\0')
+            {
+                found = object->pairs[i].value;
+                break;
+            }
+        }
+        value = found;
+    }
+    return value;
+}
+
+int json_array_aggregate(const JsonValue *array, const char *path, unsigned int ops, JsonAggregate *out)
+{
+    if (!array || array->type != JSON_ARRAY || !out)
+        return 0;
+
+    Accumulator acc = {0, 0.0, 0.0, 0.0};
+    int need_minmax = (ops & (JSON_AGG_MIN | JSON_AGG_MAX)) != 0;
+    const JsonArray *items = array->value.array;
+
+    if (!path || !*path)
+    {
+        if (array->flags & JSON_FLAG_PACKED_NUMBERS)
+        {
+            /* Packed arrays are reduced in place */
+            reduce_block(items->numbers, items->count, need_minmax, &acc);
+        }
+        else
+        {
+            double block[AGGREGATE_BLOCK_SIZE];
+            size_t filled = 0;
+            for (size_t i = 0; i < items->count; i++)
+            {
+                if (items->items[i]->type != JSON_NUMBER)
+                    continue;
+                block[filled++] = items->items[i]->value.number;
+                if (filled == AGGREGATE_BLOCK_SIZE)
+                {
+                    reduce_block(block, filled, need_minmax, &acc);
+                    filled = 0;
+                }
+            }
+            reduce_block(block, filled, need_minmax, &acc);
+        }
+    }
+    else if (!(array->flags & JSON_FLAG_PACKED_NUMBERS))
+    {
+        /* Split the path once rather than per item */
+        PathSegment inline_segments[AGGREGATE_INLINE_SEGMENTS];
+        PathSegment *segments = inline_segments;
+        size_t segment_count = 1;
+        for (const char *p = path; *p; p++)
+        {
+            if (*p == '.')
+                segment_count++;
+        }
+        if (segment_count > AGGREGATE_INLINE_SEGMENTS)
+        {
+            segments = json_alloc(sizeof(PathSegment) * segment_count);
+            if (!segments)
+                return 0;
+        }
+        const char *start = path;
+        for (size_t s = 0; s < segment_count; s++)
+        {
+            const char *end = strchr(start, '.');
+            size_t length = end ? (size_t)(end - start) : strlen(start);
+            segments[s].key = start;
+            segments[s].length = length;
+            start += length + 1;
+        }
+
+        /* Gather the field from each item, then reduce whole blocks */
+        double block[AGGREGATE_BLOCK_SIZE];
+        size_t filled = 0;
+        for (size_t i = 0; i < items->count; i++)
+        {
+            const JsonValue *value = resolve_path(items->items[i], segments, segment_count);
+            if (!value || value->type != JSON_NUMBER)
+                continue;
+            block[filled++] = value->value.number;
+            if (filled == AGGREGATE_BLOCK_SIZE)
+            {
+                reduce_block(block, filled, need_minmax, &acc);
+                filled = 0;
+            }
+        }
+        reduce_block(block, filled, need_minmax, &acc);
+
+        if (segments != inline_segments)
+            json_free(segments);
+    }
+
+    out->count = acc.count;
+    out->sum = (ops & (JSON_AGG_SUM | JSON_AGG_MEAN)) ? acc.sum : 0.0;
+    out->min = (ops & JSON_AGG_MIN) ? acc.min : 0.0;
+    out->max = (ops & JSON_AGG_MAX) ? acc.max : 0.0;
+    out->mean = ((ops & JSON_AGG_MEAN) && acc.count) ? acc.sum / (double)acc.count : 0.0;
+    return 1;
+}
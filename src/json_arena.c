@@ -0,0 +1,128 @@
+#include "json_arena.h"
+#include "json_utils.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Default block size when none is requested. */
+#define ARENA_DEFAULT_BLOCK_SIZE 65536
+
+/* Alignment of every allocation handed out by the arena. */
+#define ARENA_ALIGNMENT 16
+
+struct JsonArenaBlock
+{
+    JsonArenaBlock *next; /**< Next block in the chain. */
+    size_t size;          /**< Usable bytes in this block. */
+    size_t used;          /**< Bytes already handed out. */
+};
+
+/* Usable memory starts after the header, rounded up to the alignment. */
+#define ARENA_HEADER_SIZE \
+    ((sizeof(JsonArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+/**
+ * @brief Returns the first usable byte of a block.
+ */
+static char *block_data(JsonArenaBlock *block)
+{
+    return (char *)block + ARENA_HEADER_SIZE;
+}
+
+void json_arena_init(JsonArena *arena, size_t block_size)
+{
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+void *json_arena_alloc(JsonArena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    JsonArenaBlock *block = arena->current;
+    if (block && block->size - block->used >= size)
+    {
+        void *ptr = block_data(block) + block->used;
+        block->used += size;
+        return ptr;
+    }
+
+    /* Reuse blocks retained by a previous reset before allocating new ones */
+    JsonArenaBlock *prev = block;
+    JsonArenaBlock *next = block ? block->next : arena->first;
+    while (next && next->size < size)
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    if (!next)
+    {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        next = json_alloc(ARENA_HEADER_SIZE + block_size);
+        if (!next)
+            return NULL;
+        next->size = block_size;
+        next->next = NULL;
+        if (prev)
+            prev->next = next;
+        else
+            arena->first = next;
+    }
+
+    next->used = size;
+    arena->current = next;
+    return block_data(next);
+}
+
+char *json_arena_strdup_range(JsonArena *arena, const char *s, size_t len)
+{
+    char *dup = json_arena_alloc(arena, len + 1);
+    if (dup)
+    {
+        memcpy(dup, s, len);
+        dup[len] = '\0';
+    }
+    return dup;
+}
+
+int json_arena_owns(const JsonArena *arena, const void *ptr)
+{
+    uintptr_t address = (uintptr_t)ptr;
+    /* Blocks up to the current one are in use; any after it are left over from a reset */
+    for (JsonArenaBlock *block = arena->current ? arena->first : NULL; block; block = block->next)
+    {
+        uintptr_t start = (uintptr_t)block_data(block);
+        if (address >= start && address < start + block->used)
+            return 1;
+        if (block == arena->current)
+            break;
+    }
+    return 0;
+}
+
+size_t json_arena_size(const JsonArena *arena)
+{
+    size_t size = 0;
+    for (JsonArenaBlock *block = arena->first; block; block = block->next)
+        size += ARENA_HEADER_SIZE + block->size;
+    return size;
+}
+
+void json_arena_reset(JsonArena *arena)
+{
+    arena->current = NULL;
+}
+
+void json_arena_destroy(JsonArena *arena)
+{
+    JsonArenaBlock *block = arena->first;
+    while (block)
+    {
+        JsonArenaBlock *next = block->next;
+        json_free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
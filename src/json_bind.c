@@ -0,0 +1,437 @@
+#include "json_bind.h"
+#include "json_tokenizer.h"
+#include "json_utils.h"
+#include "json_logging.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Binder state: the current token, read straight from the input. */
+typedef struct
+{
+    JsonTokenizer tokenizer; /**< The tokenizer instance. */
+    JsonTokenType token;     /**< Type of the current token. */
+    size_t token_start;      /**< Offset of the current token's text in the input. */
+    size_t token_length;     /**< Length of the current token's text. */
+} BindState;
+
+/**
+ * @brief Advances to the next token.
+ */
+static void bind_advance(BindState *state)
+{
+    state->token = json_scan_token(&state->tokenizer, &state->token_start, &state->token_length);
+}
+
+/**
+ * @brief Returns the text of the current token within the input.
+ */
+static const char *bind_token_text(const BindState *state)
+{
+    return state->tokenizer.json + state->token_start;
+}
+
+/**
+ * @brief Skips the current value, including any nested containers.
+ *
+ * Containers are skipped by counting brackets, so skipping never recurses.
+ *
+ * @param[in,out] state Pointer to the BindState instance.
+ * @return 1 on success, 0 if the input ends or a token is invalid.
+ */
+static int skip_value(BindState *state)
+{
+    size_t depth = 0;
+    do
+    {
+        switch (state->token)
+        {
+        case TOKEN_LEFT_BRACE:
+        case TOKEN_LEFT_BRACKET:
+            depth++;
+            break;
+        case TOKEN_RIGHT_BRACE:
+        case TOKEN_RIGHT_BRACKET:
+            if (depth == 0)
+                return 0;
+            depth--;
+            break;
+        case TOKEN_EOF:
+        case TOKEN_ERROR:
+            return 0;
+        default:
+            break;
+        }
+        bind_advance(state);
+    } while (depth > 0);
+    return 1;
+}
+
+/**
+ * @brief Converts an integer literal exactly.
+ *
+ * @param[in]  s   The number text.
+ * @param[in]  len Length of the number text.
+ * @param[out] out Receives the value.
+ * @return 1 on success, 0 if the number has a fraction or exponent, or
+ *         does not fit in an int64_t.
+ */
+static int parse_int_range(const char *s, size_t len, int64_t *out)
+{
+    size_t i = 0;
+    int negative = 0;
+    if (i < len && s[i] == '-')
+    {
+        negative = 1;
+        i++;
+    }
+    if (i == len)
+        return 0;
+
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t value = 0;
+    for (; i < len; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return 0;
+        uint64_t digit = (uint64_t)(s[i] - '0');
+        if (value > (limit - digit) / 10)
+            return 0;
+        value = value * 10 + digit;
+    }
+
+    *out = negative ? (int64_t)(0 - value) : (int64_t)value;
+    return 1;
+}
+
+/* Escaped keys up to this length are decoded without allocating. */
+#define BIND_KEY_BUFFER_SIZE 64
+
+/**
+ * @brief Finds the descriptor entry for a key.
+ */
+static const JsonFieldDesc *find_field_range(const JsonStructDesc *desc, const char *key, size_t length)
+{
+    for (size_t i = 0; i < desc->count; i++)
+    {
+        const char *name = desc->fields[i].key;
+        if (strncmp(name, key, length) == 0 && name[length] == '\0')
+            return &desc->fields[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the descriptor entry for the current key token.
+ *
+ * @param[in]  state Pointer to the BindState instance.
+ * @param[in]  desc  Descriptor of the struct.
+ * @param[out] field Receives the entry, or NULL if the key is not described.
+ * @return 1 on success, 0 if the key holds an invalid escape or memory runs out.
+ */
+static int find_field(const BindState *state, const JsonStructDesc *desc, const JsonFieldDesc **field)
+{
+    if (!state->tokenizer.escaped)
+    {
+        *field = find_field_range(desc, bind_token_text(state), state->token_length);
+        return 1;
+    }
+
+    char buffer[BIND_KEY_BUFFER_SIZE];
+    char *key = state->token_length < sizeof(buffer) ? buffer : json_alloc(state->token_length + 1);
+    if (!key)
+        return 0;
+    size_t length = json_unescape(bind_token_text(state), state->token_length, key);
+    if (length != SIZE_MAX)
+        *field = find_field_range(desc, key, length);
+    if (key != buffer)
+        json_free(key);
+    return length != SIZE_MAX;
+}
+
+static int bind_object(BindState *state, const JsonStructDesc *desc, char *base);
+
+/**
+ * @brief Returns a struct member to its zero value, freeing what it holds.
+ *
+ * Used for null and before a repeated key is bound again, so that the last
+ * value wins whole.
+ */
+static void reset_field(const JsonFieldDesc *field, void *member)
+{
+    switch (field->type)
+    {
+    case JSON_FIELD_BOOL:
+        *(bool *)member = false;
+        break;
+    case JSON_FIELD_INT:
+        *(int64_t *)member = 0;
+        break;
+    case JSON_FIELD_DOUBLE:
+        *(double *)member = 0;
+        break;
+    case JSON_FIELD_STRING:
+        json_free(*(char **)member);
+        *(char **)member = NULL;
+        break;
+    case JSON_FIELD_OBJECT:
+        if (field->nested)
+        {
+            json_bind_free(field->nested, member);
+            memset(member, 0, field->nested->size);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Stores the current value into a struct member and consumes it.
+ *
+ * @param[in,out] state Pointer to the BindState instance.
+ * @param[in]     field The member's descriptor entry.
+ * @param[in]     base  Start of the struct containing the member.
+ * @return 1 on success, 0 on a type mismatch or allocation failure.
+ */
+static int bind_field(BindState *state, const JsonFieldDesc *field, char *base)
+{
+    void *member = base + field->offset;
+
+    if (state->token == TOKEN_NULL)
+    {
+        /* Null leaves the member at its zero value */
+        reset_field(field, member);
+        bind_advance(state);
+        return 1;
+    }
+
+    switch (field->type)
+    {
+    case JSON_FIELD_BOOL:
+        if (state->token != TOKEN_TRUE && state->token != TOKEN_FALSE)
+            break;
+        *(bool *)member = state->token == TOKEN_TRUE;
+        bind_advance(state);
+        return 1;
+    case JSON_FIELD_INT:
+        if (state->token != TOKEN_NUMBER ||
+            !parse_int_range(bind_token_text(state), state->token_length, (int64_t *)member))
+            break;
+        bind_advance(state);
+        return 1;
+    case JSON_FIELD_DOUBLE:
+        if (state->token != TOKEN_NUMBER)
+            break;
+        *(double *)member = json_number_from_range(bind_token_text(state), state->token_length);
+        bind_advance(state);
+        return 1;
+    case JSON_FIELD_STRING:
+    {
+        if (state->token != TOKEN_STRING)
+            break;
+        char *copy = json_alloc(state->token_length + 1);
+        if (!copy)
+        {
+            ERROR_LOG("Bind: Memory allocation failed for field '%s'\n", field->key);
+            return 0;
+        }
+        if (!state->tokenizer.escaped)
+        {
+            memcpy(copy, bind_token_text(state), state->token_length);
+            copy[state->token_length] = '\0';
+        }
+        else if (json_unescape(bind_token_text(state), state->token_length, copy) == SIZE_MAX)
+        {
+            ERROR_LOG("Bind: Invalid escape sequence in field '%s'\n", field->key);
+            json_free(copy);
+            return 0;
+        }
+        json_free(*(char **)member);
+        *(char **)member = copy;
+        bind_advance(state);
+        return 1;
+    }
+    case JSON_FIELD_OBJECT:
+        if (state->token != TOKEN_LEFT_BRACE || !field->nested)
+            break;
+        reset_field(field, member);
+        return bind_object(state, field->nested, member);
+    }
+
+    ERROR_LOG("Bind: Unexpected %s for field '%s'\n", json_token_type_to_string(state->token), field->key);
+    return 0;
+}
+
+/**
+ * @brief Binds the object starting at the current token into a struct.
+ *
+ * Recursion follows the nesting of the descriptors, not of the input;
+ * unknown containers are skipped iteratively.
+ *
+ * @param[in,out] state Pointer to the BindState instance.
+ * @param[in]     desc  Descriptor of the struct.
+ * @param[in]     base  Start of the struct.
+ * @return 1 on success, 0 on failure.
+ */
+static int bind_object(BindState *state, const JsonStructDesc *desc, char *base)
+{
+    if (state->token != TOKEN_LEFT_BRACE)
+        return 0;
+    bind_advance(state);
+    if (state->token == TOKEN_RIGHT_BRACE)
+    {
+        bind_advance(state);
+        return 1;
+    }
+
+    while (1)
+    {
+        if (state->token != TOKEN_STRING)
+        {
+            ERROR_LOG("Bind: Expected key but got %s\n", json_token_type_to_string(state->token));
+            return 0;
+        }
+        const JsonFieldDesc *field = NULL;
+        if (!find_field(state, desc, &field))
+            return 0;
+        bind_advance(state);
+        if (state->token != TOKEN_COLON)
+            return 0;
+        bind_advance(state);
+
+        if (!(field ? bind_field(state, field, base) : skip_value(state)))
+            return 0;
+
+        if (state->token == TOKEN_COMMA)
+        {
+            bind_advance(state);
+            continue;
+        }
+        if (state->token == TOKEN_RIGHT_BRACE)
+        {
+            bind_advance(state);
+            return 1;
+        }
+        ERROR_LOG("Bind: Expected ',' or '}' but got %s\n", json_token_type_to_string(state->token));
+        return 0;
+    }
+}
+
+int json_bind(const char *json, size_t length, const JsonStructDesc *desc, void *out)
+{
+    if (!json || !desc || !out)
+        return 0;
+
+    memset(out, 0, desc->size);
+
+    BindState state;
+    json_tokenizer_init_range(&state.tokenizer, json, length);
+    bind_advance(&state);
+
+    if (!bind_object(&state, desc, out) || state.token != TOKEN_EOF)
+    {
+        json_bind_free(desc, out);
+        return 0;
+    }
+    return 1;
+}
+
+void json_bind_free(const JsonStructDesc *desc, void *out)
+{
+    if (!desc || !out)
+        return;
+
+    char *base = out;
+    for (size_t i = 0; i < desc->count; i++)
+    {
+        const JsonFieldDesc *field = &desc->fields[i];
+        if (field->type == JSON_FIELD_STRING)
+        {
+            json_free(*(char **)(base + field->offset));
+            *(char **)(base + field->offset) = NULL;
+        }
+        else if (field->type == JSON_FIELD_OBJECT && field->nested)
+        {
+            json_bind_free(field->nested, base + field->offset);
+        }
+    }
+}
+
+/**
+ * @brief Writes an integer in decimal.
+ */
+static void write_int64(JsonWriter *writer, int64_t value)
+{
+    char digits[24];
+    size_t n = sizeof(digits);
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    do
+    {
+        digits[--n] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+        digits[--n] = '-';
+    json_writer_write(writer, digits + n, sizeof(digits) - n);
+}
+
+int json_emit_struct(const JsonStructDesc *desc, const void *obj, JsonWriter *writer)
+{
+    const char *base = obj;
+
+    json_writer_putc(writer, '{');
+    for (size_t i = 0; i < desc->count; i++)
+    {
+        const JsonFieldDesc *field = &desc->fields[i];
+        const void *member = base + field->offset;
+
+        /* The fragment starts with the separator, dropped for the first member */
+        if (field->fragment)
+        {
+            json_writer_write(writer, field->fragment + (i == 0), field->fragment_length - (i == 0));
+        }
+        else
+        {
+            if (i > 0)
+                json_writer_putc(writer, ',');
+            json_writer_putc(writer, '\"');
+            json_writer_write_escaped(writer, field->key, strlen(field->key));
+            json_writer_write(writer, "\":", 2);
+        }
+
+        switch (field->type)
+        {
+        case JSON_FIELD_BOOL:
+            if (*(const bool *)member)
+                json_writer_write(writer, "true", 4);
+            else
+                json_writer_write(writer, "false", 5);
+            break;
+        case JSON_FIELD_INT:
+            write_int64(writer, *(const int64_t *)member);
+            break;
+        case JSON_FIELD_DOUBLE:
+            json_writer_write_number(writer, *(const double *)member);
+            break;
+        case JSON_FIELD_STRING:
+        {
+            const char *str = *(char *const *)member;
+            if (!str)
+            {
+                json_writer_write(writer, "null", 4);
+                break;
+            }
+            json_writer_putc(writer, '\"');
+            json_writer_write_escaped(writer, str, strlen(str));
+            json_writer_putc(writer, '\"');
+            break;
+        }
+        case JSON_FIELD_OBJECT:
+            if (field->nested)
+                json_emit_struct(field->nested, member, writer);
+            else
+                json_writer_write(writer, "null", 4);
+            break;
+        }
+    }
+    json_writer_putc(writer, '}');
+    return !writer->failed;
+}
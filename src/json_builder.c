@@ -0,0 +1,591 @@
+#include "json_builder.h"
+#include "json_parser.h"
+#include "json_utils.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Capacity given to a container the first time it grows. */
+#define BUILD_MIN_CAPACITY 4
+
+/**
+ * @brief Allocates from the arena, or from the heap without one.
+ */
+static void *build_alloc(JsonArena *arena, size_t size)
+{
+    return arena ? json_arena_alloc(arena, size) : json_alloc(size);
+}
+
+/**
+ * @brief Frees a heap allocation; arena memory is left alone.
+ */
+static void build_free(JsonArena *arena, void *ptr)
+{
+    if (!arena)
+        json_free(ptr);
+}
+
+/**
+ * @brief Allocates a JsonValue followed by `extra` bytes.
+ */
+static JsonValue *new_value(JsonArena *arena, JsonType type, size_t extra)
+{
+    JsonValue *value = build_alloc(arena, sizeof(JsonValue) + extra);
+    if (!value)
+    {
+        ERROR_LOG("Builder: Memory allocation failed for JsonValue (type %d)\n", (int)type);
+        return NULL;
+    }
+    value->type = type;
+    value->flags = 0;
+    return value;
+}
+
+/**
+ * @brief Computes the capacity a container needs to hold `needed` children.
+ *
+ * Doubles the current capacity (or the fixed size of a container laid out
+ * by the parser) until it is large enough, so that appends are amortized
+ * O(1).
+ *
+ * @return The new capacity, or 0 if it would overflow an allocation size.
+ */
+static size_t grown_capacity(size_t capacity, size_t count, size_t needed, size_t item_size)
+{
+    if (capacity < count)
+        capacity = count;
+    if (capacity < BUILD_MIN_CAPACITY)
+        capacity = BUILD_MIN_CAPACITY;
+    while (capacity < needed)
+    {
+        if (capacity > SIZE_MAX / 2)
+            return 0;
+        capacity *= 2;
+    }
+    return capacity > SIZE_MAX / item_size ? 0 : capacity;
+}
+
+/**
+ * @brief Moves an array's items to a separately allocated array of `capacity` slots.
+ *
+ * Inline arrays get their own header, and packed arrays are unpacked into
+ * number values.
+ *
+ * @param[in,out] arena    The array's arena, or NULL for the heap.
+ * @param[in,out] array    The array (capacity at least its count).
+ * @param[in]     capacity Number of slots to allocate.
+ * @return 1 on success, 0 if allocation fails (the array is unchanged).
+ */
+static int array_resize(JsonArena *arena, JsonValue *array, size_t capacity)
+{
+    JsonArray *header = array->value.array;
+    size_t count = header->count;
+    JsonValue **items;
+
+    if (!arena && !(array->flags & JSON_FLAG_INLINE_CHILDREN))
+    {
+        items = json_realloc(header->items, sizeof(JsonValue *) * capacity);
+        if (!items)
+        {
+            ERROR_LOG("Builder: Memory allocation failed for array items\n");
+            return 0;
+        }
+        header->items = items;
+        header->capacity = capacity;
+        return 1;
+    }
+
+    JsonArray *detached = NULL;
+    if (array->flags & JSON_FLAG_INLINE_CHILDREN)
+    {
+        detached = build_alloc(arena, sizeof(JsonArray));
+        if (!detached)
+        {
+            ERROR_LOG("Builder: Memory allocation failed for JsonArray\n");
+            return 0;
+        }
+    }
+    items = build_alloc(arena, sizeof(JsonValue *) * capacity);
+    if (!items)
+    {
+        ERROR_LOG("Builder: Memory allocation failed for array items\n");
+        build_free(arena, detached);
+        return 0;
+    }
+
+    if (array->flags & JSON_FLAG_PACKED_NUMBERS)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            items[i] = json_new_number(arena, header->numbers[i]);
+            if (!items[i])
+            {
+                while (!arena && i--)
+                    json_free(items[i]);
+                build_free(arena, items);
+                build_free(arena, detached);
+                return 0;
+            }
+        }
+    }
+    else if (count)
+    {
+        memcpy(items, header->items, sizeof(JsonValue *) * count);
+    }
+
+    if (detached)
+    {
+        *detached = *header;
+        array->value.array = header = detached;
+        array->flags &= ~(JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_PACKED_NUMBERS);
+    }
+    header->items = items;
+    header->numbers = NULL;
+    header->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Makes room for an array to hold `needed` items, growing geometrically.
+ */
+static int array_grow(JsonArena *arena, JsonValue *array, size_t needed)
+{
+    JsonArray *header = array->value.array;
+    if (!(array->flags & JSON_FLAG_INLINE_CHILDREN) && needed <= header->capacity)
+        return 1;
+    size_t capacity = grown_capacity(header->capacity, header->count, needed, sizeof(JsonValue *));
+    return capacity && array_resize(arena, array, capacity);
+}
+
+/**
+ * @brief Moves an object's pairs to a separately allocated array of `capacity` slots.
+ *
+ * Inline objects get their own header and their own copies of the keys,
+ * which until now lived in the object's allocation or in its shape.
+ *
+ * @param[in,out] arena    The object's arena, or NULL for the heap.
+ * @param[in,out] object   The object (capacity at least its count).
+ * @param[in]     capacity Number of slots to allocate.
+ * @return 1 on success, 0 if allocation fails (the object is unchanged).
+ */
+static int object_resize(JsonArena *arena, JsonValue *object, size_t capacity)
+{
+    JsonObject *header = object->value.object;
+    size_t count = header->count;
+    JsonPair *pairs;
+
+    if (!arena && !(object->flags & JSON_FLAG_INLINE_CHILDREN))
+    {
+        pairs = json_realloc(header->pairs, sizeof(JsonPair) * capacity);
+        if (!pairs)
+        {
+            ERROR_LOG("Builder: Memory allocation failed for object pairs\n");
+            return 0;
+        }
+        header->pairs = pairs;
+        header->capacity = capacity;
+        return 1;
+    }
+
+    JsonObject *detached = NULL;
+    if (object->flags & JSON_FLAG_INLINE_CHILDREN)
+    {
+        detached = build_alloc(arena, sizeof(JsonObject));
+        if (!detached)
+        {
+            ERROR_LOG("Builder: Memory allocation failed for JsonObject\n");
+            return 0;
+        }
+    }
+    pairs = build_alloc(arena, sizeof(JsonPair) * capacity);
+    if (!pairs)
+    {
+        ERROR_LOG("Builder: Memory allocation failed for object pairs\n");
+        build_free(arena, detached);
+        return 0;
+    }
+    if (count)
+        memcpy(pairs, header->pairs, sizeof(JsonPair) * count);
+
+    if (detached)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t length = json_pair_key_length(&pairs[i]);
+            pairs[i].key = arena ? json_arena_strdup_range(arena, pairs[i].key, length)
+                                 : json_strdup_range(pairs[i].key, length);
+            if (!pairs[i].key)
+            {
+                ERROR_LOG("Builder: Memory allocation failed for object key\n");
+                while (!arena && i--)
+                    json_free(pairs[i].key);
+                build_free(arena, pairs);
+                build_free(arena, detached);
+                return 0;
+            }
+        }
+        *detached = *header;
+        object->value.object = header = detached;
+        object->flags &= ~(JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_SHARED_KEYS);
+    }
+    header->pairs = pairs;
+    header->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Makes room for an object to hold `needed` pairs, growing geometrically.
+ */
+static int object_grow(JsonArena *arena, JsonValue *object, size_t needed)
+{
+    JsonObject *header = object->value.object;
+    if (!(object->flags & JSON_FLAG_INLINE_CHILDREN) && needed <= header->capacity)
+        return 1;
+    size_t capacity = grown_capacity(header->capacity, header->count, needed, sizeof(JsonPair));
+    return capacity && object_resize(arena, object, capacity);
+}
+
+JsonValue *json_new_null(JsonArena *arena)
+{
+    return new_value(arena, JSON_NULL, 0);
+}
+
+JsonValue *json_new_bool(JsonArena *arena, int boolean)
+{
+    JsonValue *value = new_value(arena, JSON_BOOL, 0);
+    if (value)
+        value->value.boolean = boolean ? 1 : 0;
+    return value;
+}
+
+JsonValue *json_new_number(JsonArena *arena, double number)
+{
+    JsonValue *value = new_value(arena, JSON_NUMBER, 0);
+    if (value)
+        value->value.number = number;
+    return value;
+}
+
+JsonValue *json_new_string(JsonArena *arena, const char *s, size_t length)
+{
+    if (length == SIZE_MAX)
+        return NULL;
+    JsonValue *value = new_value(arena, JSON_STRING, length + 1);
+    if (!value)
+        return NULL;
+    value->flags = JSON_FLAG_INLINE_STRING;
+    value->value.string = (char *)(value + 1);
+    if (length)
+        memcpy(value->value.string, s, length);
+    value->value.string[length] = '\0';
+    return value;
+}
+
+JsonValue *json_new_string_move(JsonArena *arena, char *s)
+{
+    if (!s)
+        return NULL;
+    JsonValue *value = new_value(arena, JSON_STRING, 0);
+    if (value)
+        value->value.string = s;
+    return value;
+}
+
+JsonValue *json_new_array(JsonArena *arena)
+{
+    JsonValue *value = new_value(arena, JSON_ARRAY, 0);
+    if (!value)
+        return NULL;
+    value->value.array = build_alloc(arena, sizeof(JsonArray));
+    if (!value->value.array)
+    {
+        ERROR_LOG("Builder: Memory allocation failed for JsonArray\n");
+        build_free(arena, value);
+        return NULL;
+    }
+    memset(value->value.array, 0, sizeof(JsonArray));
+    return value;
+}
+
+JsonValue *json_new_object(JsonArena *arena)
+{
+    JsonValue *value = new_value(arena, JSON_OBJECT, 0);
+    if (!value)
+        return NULL;
+    value->value.object = build_alloc(arena, sizeof(JsonObject));
+    if (!value->value.object)
+    {
+        ERROR_LOG("Builder: Memory allocation failed for JsonObject\n");
+        build_free(arena, value);
+        return NULL;
+    }
+    memset(value->value.object, 0, sizeof(JsonObject));
+    return value;
+}
+
+int json_object_set(JsonArena *arena, JsonValue *object, const char *key, JsonValue *value, unsigned int flags)
+{
+    if (!object || object->type != JSON_OBJECT || !key || !value)
+        return 0;
+
+    size_t length = strlen(key);
+    uint32_t hash = json_hash_key(key, length);
+    JsonObject *header = object->value.object;
+    size_t slot = json_object_slot(header, key, length, hash);
+
+    if (slot != SIZE_MAX)
+    {
+        JsonValue *old = header->pairs[slot].value;
+        header->pairs[slot].value = value;
+        if (old != value)
+            json_release(arena, old);
+        if (flags & JSON_BUILD_MOVE_KEY)
+            build_free(arena, (char *)key);
+        return 1;
+    }
+
+    if (!object_grow(arena, object, header->count + 1))
+        return 0;
+    header = object->value.object;
+
+    char *owned = (char *)key;
+    if (!(flags & JSON_BUILD_MOVE_KEY))
+    {
+        owned = arena ? json_arena_strdup_range(arena, key, length) : json_strdup_range(key, length);
+        if (!owned)
+        {
+            ERROR_LOG("Builder: Memory allocation failed for object key\n");
+            return 0;
+        }
+    }
+
+    JsonPair *pair = &header->pairs[header->count++];
+    pair->key = owned;
+    pair->value = value;
+    pair->key_length = length > UINT32_MAX ? 0 : (uint32_t)length;
+    pair->key_hash = length > UINT32_MAX ? 0 : hash;
+    header->shape = NULL;
+    return 1;
+}
+
+int json_object_remove(JsonArena *arena, JsonValue *object, const char *key, JsonValue **removed)
+{
+    if (!object || object->type != JSON_OBJECT || !key)
+        return 0;
+
+    size_t length = strlen(key);
+    JsonObject *header = object->value.object;
+    size_t slot = json_object_slot(header, key, length, json_hash_key(key, length));
+    if (slot == SIZE_MAX)
+        return 0;
+
+    JsonPair pair = header->pairs[slot];
+    memmove(&header->pairs[slot], &header->pairs[slot + 1], sizeof(JsonPair) * (header->count - slot - 1));
+    header->count--;
+    header->shape = NULL;
+
+    /* Keys of inline objects live in the object's allocation or its shape */
+    if (!(object->flags & (JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_SHARED_KEYS)))
+        build_free(arena, pair.key);
+    if (removed)
+        *removed = pair.value;
+    else
+        json_release(arena, pair.value);
+    return 1;
+}
+
+int json_object_reserve(JsonArena *arena, JsonValue *object, size_t capacity)
+{
+    if (!object || object->type != JSON_OBJECT)
+        return 0;
+    JsonObject *header = object->value.object;
+    if (capacity <= header->count || (!(object->flags & JSON_FLAG_INLINE_CHILDREN) && capacity <= header->capacity))
+        return 1;
+    if (capacity > SIZE_MAX / sizeof(JsonPair))
+        return 0;
+    return object_resize(arena, object, capacity);
+}
+
+int json_array_push(JsonArena *arena, JsonValue *array, JsonValue *value)
+{
+    if (!array || array->type != JSON_ARRAY)
+        return 0;
+    return json_array_insert(arena, array, array->value.array->count, value);
+}
+
+int json_array_insert(JsonArena *arena, JsonValue *array, size_t index, JsonValue *value)
+{
+    if (!array || array->type != JSON_ARRAY || !value || index > array->value.array->count)
+        return 0;
+    if (!array_grow(arena, array, array->value.array->count + 1))
+        return 0;
+
+    JsonArray *header = array->value.array;
+    memmove(&header->items[index + 1], &header->items[index], sizeof(JsonValue *) * (header->count - index));
+    header->items[index] = value;
+    header->count++;
+    return 1;
+}
+
+int json_array_remove(JsonArena *arena, JsonValue *array, size_t index, JsonValue **removed)
+{
+    if (!array || array->type != JSON_ARRAY || index >= array->value.array->count)
+        return 0;
+
+    JsonArray *header = array->value.array;
+    size_t after = header->count - index - 1;
+    if (array->flags & JSON_FLAG_PACKED_NUMBERS)
+    {
+        /* Packed numbers can simply be shifted; a value is only made if asked for */
+        if (removed && !(*removed = json_new_number(arena, header->numbers[index])))
+            return 0;
+        memmove(&header->numbers[index], &header->numbers[index + 1], sizeof(double) * after);
+        header->count--;
+        return 1;
+    }
+
+    JsonValue *item = header->items[index];
+    memmove(&header->items[index], &header->items[index + 1], sizeof(JsonValue *) * after);
+    header->count--;
+    if (removed)
+        *removed = item;
+    else
+        json_release(arena, item);
+    return 1;
+}
+
+int json_array_reserve(JsonArena *arena, JsonValue *array, size_t capacity)
+{
+    if (!array || array->type != JSON_ARRAY)
+        return 0;
+    JsonArray *header = array->value.array;
+    if (capacity <= header->count || (!(array->flags & JSON_FLAG_INLINE_CHILDREN) && capacity <= header->capacity))
+        return 1;
+    if (capacity > SIZE_MAX / sizeof(JsonValue *))
+        return 0;
+    return array_resize(arena, array, capacity);
+}
+
+/**
+ * @brief Copies an array into one allocation, cloning its items.
+ */
+static JsonValue *clone_array(JsonArena *arena, const JsonValue *value)
+{
+    const JsonArray *array = value->value.array;
+    size_t count = array->count;
+    int packed = (value->flags & JSON_FLAG_PACKED_NUMBERS) != 0;
+    size_t item_size = packed ? sizeof(double) : sizeof(JsonValue *);
+    if (count > (SIZE_MAX - sizeof(JsonValue) - sizeof(JsonArray)) / item_size)
+        return NULL;
+
+    JsonValue *copy = new_value(arena, JSON_ARRAY, sizeof(JsonArray) + item_size * count);
+    if (!copy)
+        return NULL;
+    copy->flags = JSON_FLAG_INLINE_CHILDREN | (packed ? JSON_FLAG_PACKED_NUMBERS : 0);
+    JsonArray *header = copy->value.array = (JsonArray *)(copy + 1);
+    header->items = NULL;
+    header->numbers = NULL;
+    header->count = count;
+    header->capacity = 0;
+    if (packed)
+    {
+        header->numbers = (double *)(header + 1);
+        if (count)
+            memcpy(header->numbers, array->numbers, sizeof(double) * count);
+        return copy;
+    }
+
+    header->items = count ? (JsonValue **)(header + 1) : NULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        header->items[i] = json_clone(arena, array->items[i]);
+        if (!header->items[i])
+        {
+            /* Free what was copied so far */
+            header->count = i;
+            json_release(arena, copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+/**
+ * @brief Copies an object into one allocation with its keys, cloning its values.
+ */
+static JsonValue *clone_object(JsonArena *arena, const JsonValue *value)
+{
+    const JsonObject *object = value->value.object;
+    size_t count = object->count;
+    size_t size = sizeof(JsonObject);
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t length = json_pair_key_length(&object->pairs[i]);
+        if (length >= SIZE_MAX - sizeof(JsonValue) - size - sizeof(JsonPair))
+            return NULL;
+        size += sizeof(JsonPair) + length + 1;
+    }
+
+    JsonValue *copy = new_value(arena, JSON_OBJECT, size);
+    if (!copy)
+        return NULL;
+    copy->flags = JSON_FLAG_INLINE_CHILDREN;
+    JsonObject *header = copy->value.object = (JsonObject *)(copy + 1);
+    JsonPair *pairs = (JsonPair *)(header + 1);
+    char *keys = (char *)(pairs + count);
+    header->pairs = count ? pairs : NULL;
+    header->count = count;
+    header->shape = NULL;
+    header->capacity = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const JsonPair *pair = &object->pairs[i];
+        size_t length = json_pair_key_length(pair);
+        memcpy(keys, pair->key, length);
+        keys[length] = '\0';
+        pairs[i].key = keys;
+        pairs[i].key_length = length > UINT32_MAX ? 0 : (uint32_t)length;
+        pairs[i].key_hash = length > UINT32_MAX ? 0 : (pair->key_hash ? pair->key_hash : json_hash_key(keys, length));
+        keys += length + 1;
+
+        pairs[i].value = json_clone(arena, pair->value);
+        if (!pairs[i].value)
+        {
+            header->count = i;
+            json_release(arena, copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+void json_release(JsonArena *arena, JsonValue *value)
+{
+    if (!arena)
+        json_free_value(value);
+}
+
+JsonValue *json_clone(JsonArena *arena, const JsonValue *value)
+{
+    if (!value)
+        return NULL;
+
+    switch (value->type)
+    {
+    case JSON_NULL:
+        return json_new_null(arena);
+    case JSON_BOOL:
+        return json_new_bool(arena, value->value.boolean);
+    case JSON_NUMBER:
+        return json_new_number(arena, value->value.number);
+    case JSON_STRING:
+        return json_new_string(arena, value->value.string, strlen(value->value.string));
+    case JSON_ARRAY:
+        return clone_array(arena, value);
+    case JSON_OBJECT:
+        return clone_object(arena, value);
+    }
+    return NULL;
+}
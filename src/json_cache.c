@@ -0,0 +1,316 @@
+#include "json_cache.h"
+#include "json_compare.h"
+#include "json_config.h"
+#include "json_utils.h"
+#include "json_atomic.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Buckets in a new cache's table; it doubles as entries are added. */
+#define CACHE_INITIAL_BUCKETS 16
+
+/* Bounds of the node pool block size picked for a document from its text. */
+#define CACHE_MIN_POOL_BLOCK 1024
+#define CACHE_MAX_POOL_BLOCK 65536
+
+typedef struct CacheEntry CacheEntry;
+
+struct CacheEntry
+{
+    CacheEntry *chain;      /**< Next entry in the same bucket. */
+    CacheEntry *newer;      /**< Next more recently used entry, or NULL. */
+    CacheEntry *older;      /**< Next less recently used entry, or NULL. */
+    uint64_t hash;          /**< Hash of the text. */
+    size_t length;          /**< Number of bytes of text. */
+    size_t size;            /**< Memory charged to the entry. */
+    JsonDocument *document; /**< The cache's reference to the document. */
+    char text[];            /**< Copy of the text the document was parsed from. */
+};
+
+struct JsonParseCache
+{
+    JsonParseCacheOptions options; /**< Options with defaults filled in. */
+    uint64_t seed;                 /**< Hash seed, varying between caches. */
+    CacheEntry **buckets;          /**< Hash table of entries, chained. */
+    size_t bucket_count;           /**< Number of buckets, a power of two. */
+    CacheEntry *newest;            /**< Most recently used entry. */
+    CacheEntry *oldest;            /**< Least recently used entry, evicted first. */
+    JsonParseCacheStats stats;     /**< Counters, guarded by `lock`. */
+    unsigned char lock;            /**< Spinlock guarding everything above. */
+};
+
+/**
+ * @brief Spins until the cache's lock is taken.
+ */
+static void cache_lock(JsonParseCache *cache)
+{
+    while (!JSON_ATOMIC_TRY_LOCK(&cache->lock))
+        JSON_ATOMIC_PAUSE();
+}
+
+/**
+ * @brief Releases the cache's lock.
+ */
+static void cache_unlock(JsonParseCache *cache)
+{
+    JSON_ATOMIC_UNLOCK(&cache->lock);
+}
+
+JsonParseCache *json_parse_cache_new(const JsonParseCacheOptions *options)
+{
+    JsonParseCache *cache = json_alloc(sizeof(JsonParseCache));
+    if (!cache)
+    {
+        ERROR_LOG("Cache: Memory allocation failed for JsonParseCache\n");
+        return NULL;
+    }
+    memset(cache, 0, sizeof(JsonParseCache));
+    if (options)
+        cache->options = *options;
+    if (!cache->options.max_bytes)
+        cache->options.max_bytes = JSON_PARSE_CACHE_DEFAULT_BYTES;
+    /* Where the cache lives is unknown to senders, and differs between runs */
+    cache->seed = json_hash_bytes(&cache, sizeof(cache), (uint64_t)(uintptr_t)cache);
+
+    cache->buckets = json_alloc(sizeof(CacheEntry *) * CACHE_INITIAL_BUCKETS);
+    if (!cache->buckets)
+    {
+        ERROR_LOG("Cache: Memory allocation failed for buckets\n");
+        json_free(cache);
+        return NULL;
+    }
+    memset(cache->buckets, 0, sizeof(CacheEntry *) * CACHE_INITIAL_BUCKETS);
+    cache->bucket_count = CACHE_INITIAL_BUCKETS;
+    return cache;
+}
+
+/**
+ * @brief Frees a list of entries linked through `chain`, and their documents.
+ */
+static void free_entries(CacheEntry *entry)
+{
+    while (entry)
+    {
+        CacheEntry *next = entry->chain;
+        json_document_release(entry->document);
+        json_free(entry);
+        entry = next;
+    }
+}
+
+/**
+ * @brief Removes every entry, returning them linked through `chain`.
+ */
+static CacheEntry *detach_all(JsonParseCache *cache)
+{
+    CacheEntry *list = NULL;
+    for (CacheEntry *entry = cache->newest; entry; entry = entry->older)
+    {
+        entry->chain = list;
+        list = entry;
+    }
+    memset(cache->buckets, 0, sizeof(CacheEntry *) * cache->bucket_count);
+    cache->newest = cache->oldest = NULL;
+    cache->stats.entries = 0;
+    cache->stats.bytes = 0;
+    return list;
+}
+
+void json_parse_cache_free(JsonParseCache *cache)
+{
+    if (!cache)
+        return;
+    free_entries(detach_all(cache));
+    json_free(cache->buckets);
+    json_free(cache);
+}
+
+void json_parse_cache_clear(JsonParseCache *cache)
+{
+    cache_lock(cache);
+    CacheEntry *list = detach_all(cache);
+    cache_unlock(cache);
+    free_entries(list);
+}
+
+void json_parse_cache_stats(JsonParseCache *cache, JsonParseCacheStats *stats)
+{
+    cache_lock(cache);
+    *stats = cache->stats;
+    cache_unlock(cache);
+}
+
+/**
+ * @brief Finds the entry for some text.
+ */
+static CacheEntry *find_entry(JsonParseCache *cache, uint64_t hash, const char *json, size_t length)
+{
+    CacheEntry *entry = cache->buckets[hash & (cache->bucket_count - 1)];
+    while (entry && !(entry->hash == hash && entry->length == length && memcmp(entry->text, json, length) == 0))
+        entry = entry->chain;
+    return entry;
+}
+
+/**
+ * @brief Unlinks an entry from the recency list.
+ */
+static void lru_unlink(JsonParseCache *cache, CacheEntry *entry)
+{
+    if (entry->newer)
+        entry->newer->older = entry->older;
+    else
+        cache->newest = entry->older;
+    if (entry->older)
+        entry->older->newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+}
+
+/**
+ * @brief Links an entry into the recency list as the most recently used.
+ */
+static void lru_push(JsonParseCache *cache, CacheEntry *entry)
+{
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest)
+        cache->newest->newer = entry;
+    else
+        cache->oldest = entry;
+    cache->newest = entry;
+}
+
+/**
+ * @brief Doubles the hash table, keeping the old one if allocation fails.
+ */
+static void grow_buckets(JsonParseCache *cache)
+{
+    size_t count = cache->bucket_count * 2;
+    CacheEntry **buckets = json_alloc(sizeof(CacheEntry *) * count);
+    if (!buckets)
+        return;
+    memset(buckets, 0, sizeof(CacheEntry *) * count);
+    for (size_t i = 0; i < cache->bucket_count; i++)
+    {
+        CacheEntry *entry = cache->buckets[i];
+        while (entry)
+        {
+            CacheEntry *next = entry->chain;
+            CacheEntry **bucket = &buckets[entry->hash & (count - 1)];
+            entry->chain = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    json_free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = count;
+}
+
+/**
+ * @brief Removes the least recently used entry.
+ */
+static CacheEntry *evict_oldest(JsonParseCache *cache)
+{
+    CacheEntry *victim = cache->oldest;
+    CacheEntry **link = &cache->buckets[victim->hash & (cache->bucket_count - 1)];
+    while (*link != victim)
+        link = &(*link)->chain;
+    *link = victim->chain;
+    lru_unlink(cache, victim);
+    cache->stats.entries--;
+    cache->stats.bytes -= victim->size;
+    cache->stats.evictions++;
+    return victim;
+}
+
+/**
+ * @brief Parses text the cache has not seen.
+ *
+ * Unless the caller chose a pool block size, the pool starts with a block
+ * in proportion to the text, so that small documents do not each hold a
+ * full default block.
+ */
+static JsonDocument *parse_document(const JsonParseCache *cache, const char *json, size_t length)
+{
+    JsonParserOptions options = cache->options.parser;
+    if (!options.pool_block_size)
+    {
+        size_t block = length < CACHE_MAX_POOL_BLOCK / 4 ? length * 4 : CACHE_MAX_POOL_BLOCK;
+        options.pool_block_size = block < CACHE_MIN_POOL_BLOCK ? CACHE_MIN_POOL_BLOCK : block;
+    }
+    return json_document_parse(json, length, &options);
+}
+
+JsonDocument *json_parse_cached(JsonParseCache *cache, const char *json, size_t length)
+{
+    uint64_t hash = json_hash_bytes(json, length, cache->seed);
+
+    cache_lock(cache);
+    CacheEntry *entry = find_entry(cache, hash, json, length);
+    if (entry)
+    {
+        lru_unlink(cache, entry);
+        lru_push(cache, entry);
+        cache->stats.hits++;
+        JsonDocument *document = json_document_retain(entry->document);
+        cache_unlock(cache);
+        return document;
+    }
+    cache->stats.misses++;
+    cache_unlock(cache);
+
+    /* Parse without holding the lock; other threads may do the same meanwhile */
+    JsonDocument *document = parse_document(cache, json, length);
+    if (!document)
+        return NULL;
+    size_t size = sizeof(CacheEntry) + length + json_document_size(document);
+    if (size > cache->options.max_bytes)
+        return document;
+    entry = json_alloc(sizeof(CacheEntry) + length);
+    if (!entry)
+    {
+        ERROR_LOG("Cache: Memory allocation failed for CacheEntry\n");
+        return document;
+    }
+    entry->hash = hash;
+    entry->length = length;
+    entry->size = size;
+    entry->document = json_document_retain(document);
+    memcpy(entry->text, json, length);
+
+    CacheEntry *evicted = NULL;
+    cache_lock(cache);
+    CacheEntry *existing = find_entry(cache, hash, json, length);
+    if (existing)
+    {
+        /* Another thread cached the text first; share its document instead */
+        JsonDocument *shared = json_document_retain(existing->document);
+        cache_unlock(cache);
+        entry->chain = NULL;
+        free_entries(entry);
+        json_document_release(document);
+        return shared;
+    }
+    if (cache->stats.entries >= cache->bucket_count)
+        grow_buckets(cache);
+    CacheEntry **bucket = &cache->buckets[hash & (cache->bucket_count - 1)];
+    entry->chain = *bucket;
+    *bucket = entry;
+    lru_push(cache, entry);
+    cache->stats.entries++;
+    cache->stats.bytes += size;
+    while (cache->stats.bytes > cache->options.max_bytes)
+    {
+        CacheEntry *victim = evict_oldest(cache);
+        victim->chain = evicted;
+        evicted = victim;
+    }
+    cache_unlock(cache);
+
+    /* Documents are freed outside the lock */
+    free_entries(evicted);
+    return document;
+}
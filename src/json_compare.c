@@ -0,0 +1,266 @@
+#include "json_compare.h"
+#include "json_utils.h"
+#include <string.h>
+
+/* Mixing constants (from wyhash). */
+#define HASH_P0 0xa0761d6478bd642full
+#define HASH_P1 0xe7037ed1a0b428dbull
+#define HASH_P2 0x8ebc6af09c88c6e3ull
+#define HASH_P3 0x589965cc75374cc3ull
+
+/**
+ * @brief Counts the members of an object with the same key as a pair, and
+ *        also the same value if `value` is set.
+ */
+static size_t count_members(const JsonObject *object, const JsonPair *pair, int value)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < object->count; i++)
+    {
+        if (json_same_key(&object->pairs[i], pair) && (!value || json_equal(object->pairs[i].value, pair->value)))
+            count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Compares objects of the same size as multisets of members.
+ *
+ * Needed once a key is repeated, when members cannot be matched up by key;
+ * this is what json_hash() sums over.
+ */
+static int multisets_equal(const JsonObject *a, const JsonObject *b)
+{
+    for (size_t j = 0; j < a->count; j++)
+    {
+        if (count_members(a, &a->pairs[j], 1) != count_members(b, &a->pairs[j], 1))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Compares two objects, whatever the order of their members.
+ */
+static int objects_equal(const JsonObject *a, const JsonObject *b)
+{
+    if (a->count != b->count)
+        return 0;
+
+    /* Members in the same positions, as with a shared shape, are compared pairwise first */
+    size_t i = 0;
+    if (a->shape && a->shape == b->shape)
+        i = a->count;
+    else
+    {
+        while (i < a->count && json_same_key(&a->pairs[i], &b->pairs[i]))
+            i++;
+    }
+    size_t j = 0;
+    while (j < i && json_equal(a->pairs[j].value, b->pairs[j].value))
+        j++;
+    if (j == i)
+    {
+        for (; j < a->count; j++)
+        {
+            if (json_object_pair_slot(a, &a->pairs[j], SIZE_MAX) != j)
+                return multisets_equal(a, b);
+            size_t slot = json_object_pair_slot(b, &a->pairs[j], j);
+            if (slot == SIZE_MAX || !json_equal(a->pairs[j].value, b->pairs[slot].value))
+                break;
+        }
+        /* Every key of a was found once in b, so b, as large, has no other keys */
+        if (j == a->count)
+            return 1;
+    }
+    /* A member that differs may still be matched by another with the same key */
+    return count_members(a, &a->pairs[j], 0) > 1 && multisets_equal(a, b);
+}
+
+int json_equal(const JsonValue *a, const JsonValue *b)
+{
+    if (a == b)
+        return 1;
+    if (!a || !b || a->type != b->type)
+        return 0;
+
+    switch (a->type)
+    {
+    case JSON_NULL:
+        return 1;
+    case JSON_BOOL:
+        return !a->value.boolean == !b->value.boolean;
+    case JSON_NUMBER:
+        return a->value.number == b->value.number;
+    case JSON_STRING:
+        return strcmp(a->value.string, b->value.string) == 0;
+    case JSON_ARRAY:
+    {
+        size_t count = a->value.array->count;
+        if (count != b->value.array->count)
+            return 0;
+        if ((a->flags & b->flags) & JSON_FLAG_PACKED_NUMBERS)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (a->value.array->numbers[i] != b->value.array->numbers[i])
+                    return 0;
+            }
+            return 1;
+        }
+        JsonValue scratch_a, scratch_b;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!json_equal(json_array_item(a, i, &scratch_a), json_array_item(b, i, &scratch_b)))
+                return 0;
+        }
+        return 1;
+    }
+    case JSON_OBJECT:
+        return objects_equal(a->value.object, b->value.object);
+    }
+    return 0;
+}
+
+/**
+ * @brief Multiplies two 64-bit words and folds the 128-bit product.
+ */
+static uint64_t mum(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t middle = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    uint64_t low = (middle << 32) | (uint32_t)ll;
+    uint64_t high = hh + (hl >> 32) + (lh >> 32) + (middle >> 32);
+    return low ^ high;
+#endif
+}
+
+/**
+ * @brief Reads 8 bytes in native byte order.
+ */
+static uint64_t read64(const unsigned char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Reads 4 bytes in native byte order.
+ */
+static uint64_t read32(const unsigned char *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t json_hash_bytes(const void *data, size_t length, uint64_t seed)
+{
+    const unsigned char *p = data;
+    size_t left = length;
+    uint64_t a, b;
+
+    seed ^= HASH_P0;
+    while (left > 16)
+    {
+        seed = mum(read64(p) ^ HASH_P1, read64(p + 8) ^ seed);
+        p += 16;
+        left -= 16;
+    }
+    /* The last 1 to 16 bytes, read as two possibly overlapping words */
+    if (left >= 8)
+    {
+        a = read64(p);
+        b = read64(p + left - 8);
+    }
+    else if (left >= 4)
+    {
+        a = read32(p);
+        b = read32(p + left - 4);
+    }
+    else if (left > 0)
+    {
+        a = ((uint64_t)p[0] << 16) | ((uint64_t)p[left / 2] << 8) | p[left - 1];
+        b = 0;
+    }
+    else
+    {
+        a = b = 0;
+    }
+    return mum(HASH_P1 ^ length, mum(a ^ HASH_P1, b ^ seed));
+}
+
+/**
+ * @brief Hashes a number so that values comparing equal hash equally.
+ */
+static uint64_t hash_number(double number, uint64_t seed)
+{
+    uint64_t bits;
+    if (number == 0)
+        number = 0; /* -0 equals 0 */
+    memcpy(&bits, &number, sizeof(bits));
+    return mum(seed ^ HASH_P2, bits ^ HASH_P3);
+}
+
+/**
+ * @brief Hashes a value, chaining from `seed`.
+ */
+static uint64_t hash_value(const JsonValue *value, uint64_t seed)
+{
+    switch (value->type)
+    {
+    case JSON_NULL:
+        return mum(seed ^ HASH_P0, HASH_P3 ^ 1);
+    case JSON_BOOL:
+        return mum(seed ^ HASH_P0, HASH_P3 ^ (value->value.boolean ? 3 : 2));
+    case JSON_NUMBER:
+        return hash_number(value->value.number, seed);
+    case JSON_STRING:
+        return json_hash_bytes(value->value.string, strlen(value->value.string), seed ^ HASH_P3);
+    case JSON_ARRAY:
+    {
+        const JsonArray *array = value->value.array;
+        uint64_t hash = mum(seed ^ HASH_P1, array->count ^ HASH_P0);
+        for (size_t i = 0; i < array->count; i++)
+        {
+            if (value->flags & JSON_FLAG_PACKED_NUMBERS)
+                hash = hash_number(array->numbers[i], hash);
+            else
+                hash = hash_value(array->items[i], hash);
+        }
+        return hash;
+    }
+    case JSON_OBJECT:
+    {
+        /* Members are hashed independently and summed, so order does not matter */
+        const JsonObject *object = value->value.object;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < object->count; i++)
+        {
+            const JsonPair *pair = &object->pairs[i];
+            uint64_t key = json_hash_bytes(pair->key, json_pair_key_length(pair), seed);
+            sum += mum(key ^ HASH_P0, hash_value(pair->value, seed) ^ HASH_P1);
+        }
+        return mum(sum ^ seed ^ HASH_P1, object->count ^ HASH_P2);
+    }
+    }
+    return seed;
+}
+
+uint64_t json_hash(const JsonValue *value)
+{
+    return json_hash_seeded(value, 0);
+}
+
+uint64_t json_hash_seeded(const JsonValue *value, uint64_t seed)
+{
+    if (!value)
+        return mum(seed ^ HASH_P1, HASH_P2);
+    return hash_value(value, seed);
+}
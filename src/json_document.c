@@ -0,0 +1,303 @@
+#include "json_document.h"
+#include "json_builder.h"
+#include "json_utils.h"
+#include "json_atomic.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Block size of a draft's arena, which only holds the containers it copies. */
+#define DRAFT_BLOCK_SIZE 4096
+
+struct JsonDocument
+{
+    size_t refs;          /**< Number of references, updated atomically. */
+    JsonValue *root;      /**< Root of the tree. */
+    JsonDocument *base;   /**< Document whose nodes this one shares, or NULL. */
+    JsonParser *parser;   /**< Parser owning the nodes of a parsed document, or NULL. */
+    JsonArena arena;      /**< Nodes allocated by a draft. */
+    int frozen;           /**< Whether the tree may no longer be modified. */
+};
+
+/**
+ * @brief Allocates a document with one reference.
+ */
+static JsonDocument *document_new(JsonValue *root, JsonDocument *base, int frozen)
+{
+    JsonDocument *document = json_alloc(sizeof(JsonDocument));
+    if (!document)
+    {
+        ERROR_LOG("Document: Memory allocation failed for JsonDocument\n");
+        return NULL;
+    }
+    document->refs = 1;
+    document->root = root;
+    document->base = base ? json_document_retain(base) : NULL;
+    document->parser = NULL;
+    json_arena_init(&document->arena, DRAFT_BLOCK_SIZE);
+    document->frozen = frozen;
+    return document;
+}
+
+JsonDocument *json_document_parse(const char *json, size_t length, const JsonParserOptions *options)
+{
+    JsonParser *parser = json_parser_new(options);
+    if (!parser)
+        return NULL;
+    JsonValue *root = json_parser_parse(parser, json, length);
+    JsonDocument *document = root ? document_new(root, NULL, 1) : NULL;
+    if (!document)
+    {
+        json_parser_free(parser);
+        return NULL;
+    }
+    /* The parser is kept only for its node pool */
+    json_parser_trim(parser);
+    document->parser = parser;
+    return document;
+}
+
+const JsonValue *json_document_root(const JsonDocument *document)
+{
+    return document->root;
+}
+
+size_t json_document_size(const JsonDocument *document)
+{
+    size_t size = sizeof(JsonDocument) + json_arena_size(&document->arena);
+    if (document->parser)
+        size += json_arena_size(json_parser_arena(document->parser));
+    return size;
+}
+
+JsonDocument *json_document_retain(JsonDocument *document)
+{
+    JSON_ATOMIC_ADD(&document->refs, 1);
+    return document;
+}
+
+void json_document_release(JsonDocument *document)
+{
+    /* Walk down the chain of bases iteratively; it grows with every version */
+    while (document && JSON_ATOMIC_SUB(&document->refs, 1) == 0)
+    {
+        JsonDocument *base = document->base;
+        json_parser_free(document->parser);
+        json_arena_destroy(&document->arena);
+        json_free(document);
+        document = base;
+    }
+}
+
+JsonDocument *json_document_subtree(JsonDocument *document, const JsonValue *value)
+{
+    if (!document->frozen || !value)
+        return NULL;
+    return document_new((JsonValue *)value, document, 1);
+}
+
+JsonDocument *json_document_edit(JsonDocument *base)
+{
+    if (!base->frozen)
+        return NULL;
+    return document_new(base->root, base, 0);
+}
+
+JsonArena *json_document_arena(JsonDocument *draft)
+{
+    return &draft->arena;
+}
+
+/**
+ * @brief Makes a shallow copy of a container in a draft's arena.
+ *
+ * Children are shared with the original. Packed arrays stay packed, and
+ * objects keep their shape, since the copy has the same layout.
+ *
+ * @return The copy, or NULL if allocation fails.
+ */
+static JsonValue *copy_container(JsonArena *arena, const JsonValue *value)
+{
+    JsonValue *copy;
+    if (value->type == JSON_ARRAY)
+    {
+        const JsonArray *array = value->value.array;
+        if (value->flags & JSON_FLAG_PACKED_NUMBERS)
+        {
+            copy = json_arena_alloc(arena, sizeof(JsonValue) + sizeof(JsonArray) + sizeof(double) * array->count);
+            if (!copy)
+                return NULL;
+            copy->type = JSON_ARRAY;
+            copy->flags = JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_PACKED_NUMBERS;
+            copy->value.array = (JsonArray *)(copy + 1);
+            copy->value.array->items = NULL;
+            copy->value.array->count = array->count;
+            copy->value.array->numbers = (double *)(copy->value.array + 1);
+            copy->value.array->capacity = 0;
+            memcpy(copy->value.array->numbers, array->numbers, sizeof(double) * array->count);
+            return copy;
+        }
+        copy = json_new_array(arena);
+        if (!copy || !json_array_reserve(arena, copy, array->count))
+            return NULL;
+        if (array->count)
+            memcpy(copy->value.array->items, array->items, sizeof(JsonValue *) * array->count);
+        copy->value.array->count = array->count;
+        return copy;
+    }
+
+    const JsonObject *object = value->value.object;
+    copy = json_new_object(arena);
+    if (!copy || !json_object_reserve(arena, copy, object->count))
+        return NULL;
+    if (object->count)
+        memcpy(copy->value.object->pairs, object->pairs, sizeof(JsonPair) * object->count);
+    copy->value.object->count = object->count;
+    copy->value.object->shape = object->shape;
+    return copy;
+}
+
+/**
+ * @brief Returns a container owned by the draft, copying it if it is shared.
+ *
+ * @param[in,out] draft  The draft.
+ * @param[in,out] slot   Where the container is referenced from; updated to
+ *                       point at the copy.
+ * @return The owned container, or NULL if allocation fails.
+ */
+static JsonValue *own_container(JsonDocument *draft, JsonValue **slot)
+{
+    if (json_arena_owns(&draft->arena, *slot))
+        return *slot;
+    JsonValue *copy = copy_container(&draft->arena, *slot);
+    if (!copy)
+    {
+        ERROR_LOG("Document: Memory allocation failed while unsharing a container\n");
+        return NULL;
+    }
+    *slot = copy;
+    return copy;
+}
+
+/**
+ * @brief Finds where a child of a container is referenced from.
+ *
+ * @return The slot holding the child, or NULL if there is no such child.
+ */
+static JsonValue **child_slot(JsonValue *node, const char *token, size_t length)
+{
+    if (node->type == JSON_ARRAY)
+    {
+        size_t index = json_pointer_index(token, length);
+        /* Packed arrays only hold numbers, so nothing below them can be unshared */
+        if (index >= node->value.array->count || (node->flags & JSON_FLAG_PACKED_NUMBERS))
+            return NULL;
+        return &node->value.array->items[index];
+    }
+
+    JsonObject *object = node->value.object;
+    size_t slot = json_object_slot(object, token, length, json_hash_key(token, length));
+    return slot == SIZE_MAX ? NULL : &object->pairs[slot].value;
+}
+
+JsonValue *json_document_unshare(JsonDocument *draft, const char *pointer)
+{
+    if (draft->frozen || !pointer || (*pointer && *pointer != '/'))
+        return NULL;
+
+    JsonValue *node = draft->root;
+    if (!node || (node->type != JSON_ARRAY && node->type != JSON_OBJECT))
+        return NULL;
+    if (!(node = own_container(draft, &draft->root)))
+        return NULL;
+    if (!*pointer)
+        return node;
+
+    /* Decoded tokens are never longer than the pointer */
+    char *token = json_alloc(strlen(pointer) + 1);
+    if (!token)
+        return NULL;
+
+    const char *p = pointer;
+    while (node && *p == '/')
+    {
+        size_t length;
+        JsonValue **slot = NULL;
+        if ((p = json_pointer_token(p + 1, token, &length)))
+            slot = child_slot(node, token, length);
+        if (!slot || ((*slot)->type != JSON_ARRAY && (*slot)->type != JSON_OBJECT))
+            node = NULL;
+        else
+            node = own_container(draft, slot);
+    }
+    json_free(token);
+    return node;
+}
+
+int json_document_set_root(JsonDocument *draft, JsonValue *root)
+{
+    if (draft->frozen || !root)
+        return 0;
+    draft->root = root;
+    return 1;
+}
+
+JsonDocument *json_document_freeze(JsonDocument *draft)
+{
+    draft->frozen = 1;
+    return draft;
+}
+
+void json_document_slot_init(JsonDocumentSlot *slot, JsonDocument *document)
+{
+    slot->current = document ? json_document_retain(document) : NULL;
+    slot->epoch = 0;
+    slot->readers[0] = 0;
+    slot->readers[1] = 0;
+}
+
+JsonDocument *json_document_slot_acquire(JsonDocumentSlot *slot)
+{
+    /* The writer does not release a version while a reader of its epoch is counted in */
+    size_t *readers;
+    while (1)
+    {
+        size_t epoch = JSON_ATOMIC_LOAD(&slot->epoch);
+        readers = &slot->readers[epoch & 1];
+        JSON_ATOMIC_ADD(readers, 1);
+        JSON_ATOMIC_FENCE();
+        /* Counted in under an epoch that has since ended, no writer is waiting for this reader */
+        if (JSON_ATOMIC_LOAD(&slot->epoch) == epoch)
+            break;
+        JSON_ATOMIC_SUB(readers, 1);
+    }
+    JsonDocument *document = JSON_ATOMIC_LOAD(&slot->current);
+    if (document)
+        json_document_retain(document);
+    JSON_ATOMIC_SUB(readers, 1);
+    return document;
+}
+
+void json_document_slot_publish(JsonDocumentSlot *slot, JsonDocument *document)
+{
+    if (document)
+        json_document_retain(document);
+    JsonDocument *old = JSON_ATOMIC_EXCHANGE(&slot->current, document);
+
+    /* Readers that see the new epoch also see the new version */
+    size_t epoch = slot->epoch;
+    JSON_ATOMIC_STORE(&slot->epoch, epoch + 1);
+    JSON_ATOMIC_FENCE();
+
+    /* Readers counted in under the old epoch may hold the old pointer without a reference yet */
+    while (JSON_ATOMIC_LOAD(&slot->readers[epoch & 1]) != 0)
+        JSON_ATOMIC_PAUSE();
+    json_document_release(old);
+}
+
+void json_document_slot_clear(JsonDocumentSlot *slot)
+{
+    json_document_release(slot->current);
+    slot->current = NULL;
+}
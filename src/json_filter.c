@@ -0,0 +1,588 @@
+#include "json_filter.h"
+#include "json_validate.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Text written for a redacted value when a rule gives none. */
+#define DEFAULT_REPLACEMENT "\"[REDACTED]\""
+
+/* One key of a compiled path. */
+typedef struct
+{
+    const char *text; /**< The key. */
+    size_t length;    /**< Length of the key. */
+    uint32_t hash;    /**< json_hash_key() of the key. */
+    int wildcard;     /**< Whether the segment is `*`. */
+} FilterSegment;
+
+/* A compiled rule. */
+typedef struct
+{
+    const FilterSegment *segments; /**< The path's keys. */
+    size_t segment_count;          /**< Number of keys in the path. */
+    const char *replacement;       /**< Text written for a redacted value. */
+    size_t replacement_length;     /**< Length of `replacement`. */
+} FilterRule;
+
+struct JsonFilter
+{
+    FilterRule *rules;       /**< The rules, in the order given. */
+    size_t count;            /**< Number of rules. */
+    uint64_t include_mask;   /**< One bit per JSON_FILTER_INCLUDE rule. */
+    uint64_t exclude_mask;   /**< One bit per JSON_FILTER_EXCLUDE rule. */
+    uint64_t redact_mask;    /**< One bit per JSON_FILTER_REDACT rule. */
+    FilterSegment *segments; /**< Storage for all rules' segments. */
+    char *text;              /**< Storage for all keys and replacements. */
+};
+
+void json_filter_free(JsonFilter *filter)
+{
+    if (!filter)
+        return;
+    json_free(filter->rules);
+    json_free(filter->segments);
+    json_free(filter->text);
+    json_free(filter);
+}
+
+JsonFilter *json_filter_compile(const JsonFilterRule *rules, size_t count)
+{
+    if (count > JSON_FILTER_MAX_RULES)
+    {
+        ERROR_LOG("Filter: More than %d rules\n", JSON_FILTER_MAX_RULES);
+        return NULL;
+    }
+
+    /* Size the storage: every path's text, its segments and every replacement */
+    size_t text_size = 0, segment_total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *path = rules[i].path;
+        if (!path || !*path)
+        {
+            ERROR_LOG("Filter: Rule %zu has an empty path\n", i);
+            return NULL;
+        }
+        text_size += strlen(path) + 1;
+        segment_total++;
+        for (const char *p = path; *p; p++)
+            segment_total += *p == '.';
+
+        if (rules[i].action == JSON_FILTER_REDACT && rules[i].replacement)
+        {
+            size_t length = strlen(rules[i].replacement);
+            if (!json_validate(rules[i].replacement, length, NULL))
+            {
+                ERROR_LOG("Filter: Rule %zu has a replacement that is not valid JSON\n", i);
+                return NULL;
+            }
+            text_size += length + 1;
+        }
+    }
+
+    JsonFilter *filter = json_alloc(sizeof(JsonFilter));
+    if (!filter)
+    {
+        ERROR_LOG("Filter: Memory allocation failed for filter\n");
+        return NULL;
+    }
+    memset(filter, 0, sizeof(JsonFilter));
+    filter->count = count;
+    filter->rules = json_alloc(count * sizeof(FilterRule) + 1);
+    filter->segments = json_alloc(segment_total * sizeof(FilterSegment) + 1);
+    filter->text = json_alloc(text_size + 1);
+    if (!filter->rules || !filter->segments || !filter->text)
+    {
+        ERROR_LOG("Filter: Memory allocation failed for rules\n");
+        json_filter_free(filter);
+        return NULL;
+    }
+
+    char *text = filter->text;
+    FilterSegment *segment = filter->segments;
+    for (size_t i = 0; i < count; i++)
+    {
+        FilterRule *rule = &filter->rules[i];
+        uint64_t bit = (uint64_t)1 << i;
+        switch (rules[i].action)
+        {
+        case JSON_FILTER_INCLUDE:
+            filter->include_mask |= bit;
+            break;
+        case JSON_FILTER_EXCLUDE:
+            filter->exclude_mask |= bit;
+            break;
+        case JSON_FILTER_REDACT:
+            filter->redact_mask |= bit;
+            break;
+        }
+
+        /* Split the path in place in its copy */
+        size_t path_length = strlen(rules[i].path);
+        memcpy(text, rules[i].path, path_length + 1);
+        rule->segments = segment;
+        rule->segment_count = 0;
+        char *key = text;
+        while (1)
+        {
+            char *dot = strchr(key, '.');
+            size_t length = dot ? (size_t)(dot - key) : strlen(key);
+            segment->text = key;
+            segment->length = length;
+            segment->hash = json_hash_key(key, length);
+            segment->wildcard = length == 1 && key[0] == '*';
+            segment++;
+            rule->segment_count++;
+            if (!dot)
+                break;
+            *dot = '\0';
+            key = dot + 1;
+        }
+        text += path_length + 1;
+
+        rule->replacement = DEFAULT_REPLACEMENT;
+        rule->replacement_length = sizeof(DEFAULT_REPLACEMENT) - 1;
+        if (rules[i].action == JSON_FILTER_REDACT && rules[i].replacement)
+        {
+            size_t length = strlen(rules[i].replacement);
+            memcpy(text, rules[i].replacement, length + 1);
+            rule->replacement = text;
+            rule->replacement_length = length;
+            text += length + 1;
+        }
+    }
+    return filter;
+}
+
+/* What to do with the next value. */
+typedef enum
+{
+    FILTER_KEEP,
+    FILTER_DROP,
+    FILTER_REDACT
+} FilterDecision;
+
+/* Rule state for a container whose contents are still being filtered. */
+typedef struct
+{
+    uint64_t alive;   /**< Rules whose first `key_depth` segments match the path here. */
+    size_t key_depth; /**< Number of object keys on the path to the container. */
+    int included;     /**< Whether the container is kept in full (unless excluded or redacted). */
+} FilterFrame;
+
+/* Filter state: the current token, the pending key and the open containers. */
+typedef struct
+{
+    const JsonFilter *filter;                       /**< The compiled filter. */
+    JsonStream stream;                              /**< Token source. */
+    JsonWriter *writer;                             /**< Output. */
+    JsonTokenType token;                            /**< Type of the current token. */
+    const char *text;                               /**< Text of the current token. */
+    size_t length;                                  /**< Length of the current token's text. */
+    char *key;                                      /**< The pending member's key, as written. */
+    size_t key_length;                              /**< Length of `key`. */
+    size_t key_capacity;                            /**< Number of bytes allocated for `key`. */
+    char *decoded;                                  /**< The pending key with escapes decoded. */
+    size_t decoded_capacity;                        /**< Number of bytes allocated for `decoded`. */
+    FilterFrame child;                              /**< Rule state for the pending value, if a container. */
+    const FilterRule *redaction;                    /**< Rule redacting the pending value. */
+    unsigned char kinds[JSON_STREAM_MAX_DEPTH / 8]; /**< One bit per open container, set for objects. */
+    unsigned char wrote[JSON_STREAM_MAX_DEPTH / 8]; /**< One bit per open container, set once it has output. */
+    size_t depth;                                   /**< Number of open containers. */
+    FilterFrame frames[JSON_FILTER_MAX_DEPTH];      /**< Rule state for the outermost containers. */
+    size_t active;                                  /**< Number of leading containers still being filtered. */
+} Filterer;
+
+/**
+ * @brief Advances to the next token.
+ */
+static void filter_advance(Filterer *f)
+{
+    f->token = json_stream_next(&f->stream, &f->text, &f->length);
+}
+
+/**
+ * @brief Grows a scratch buffer to hold at least `size` bytes.
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int reserve(char **buffer, size_t *capacity, size_t size)
+{
+    if (size <= *capacity)
+        return 1;
+    char *grown = json_realloc(*buffer, size);
+    if (!grown)
+    {
+        ERROR_LOG("Filter: Memory allocation failed for key buffer\n");
+        return 0;
+    }
+    *buffer = grown;
+    *capacity = size;
+    return 1;
+}
+
+/**
+ * @brief Checks the contents of a string token before it is copied.
+ *
+ * The stream's tokenizer lets raw control characters and bad escapes
+ * through, so both are checked here; escapes are decoded into the scratch
+ * buffer only to be validated.
+ *
+ * @return 1 if the string is well formed, 0 if it is malformed or
+ *         allocation fails.
+ */
+static int check_string(Filterer *f, const char *text, size_t length, int escaped)
+{
+    if (json_has_control_chars(text, length))
+        return 0;
+    if (!escaped)
+        return 1;
+    if (!reserve(&f->decoded, &f->decoded_capacity, length + 1))
+        return 0;
+    return json_unescape(text, length, f->decoded) != SIZE_MAX;
+}
+
+/**
+ * @brief Matches the pending key against the live rules of its object.
+ *
+ * @param[in]  f       Pointer to the Filterer; the current token is the value.
+ * @param[in]  frame   Rule state of the object.
+ * @param[in]  escaped Whether the key contains escape sequences.
+ * @param[out] ok      Set to 0 if the key is malformed or allocation fails.
+ * @return The decision for the member's value, which is the current token.
+ *         FILTER_KEEP fills in `f->child`; FILTER_REDACT sets `f->redaction`.
+ */
+static FilterDecision match_key(Filterer *f, const FilterFrame *frame, int escaped, int *ok)
+{
+    const JsonFilter *filter = f->filter;
+    const char *key = f->key;
+    size_t key_length = f->key_length;
+    if (escaped)
+    {
+        if (!reserve(&f->decoded, &f->decoded_capacity, key_length + 1))
+        {
+            *ok = 0;
+            return FILTER_DROP;
+        }
+        key_length = json_unescape(key, key_length, f->decoded);
+        if (key_length == SIZE_MAX)
+        {
+            *ok = 0;
+            return FILTER_DROP;
+        }
+        key = f->decoded;
+    }
+
+    uint32_t hash = json_hash_key(key, key_length);
+    uint64_t hits = 0, advanced = 0;
+    for (uint64_t alive = frame->alive; alive; alive &= alive - 1)
+    {
+        size_t i = (size_t)__builtin_ctzll(alive);
+        const FilterRule *rule = &filter->rules[i];
+        const FilterSegment *segment = &rule->segments[frame->key_depth];
+        if (!segment->wildcard &&
+            (segment->hash != hash || segment->length != key_length || memcmp(segment->text, key, key_length) != 0))
+            continue;
+        if (frame->key_depth + 1 == rule->segment_count)
+            hits |= alive & -alive;
+        else
+            advanced |= alive & -alive;
+    }
+
+    if (hits & filter->exclude_mask)
+        return FILTER_DROP;
+    if (hits & filter->redact_mask)
+    {
+        f->redaction = &filter->rules[__builtin_ctzll(hits & filter->redact_mask)];
+        return FILTER_REDACT;
+    }
+
+    f->child.alive = advanced;
+    f->child.key_depth = frame->key_depth + 1;
+    f->child.included = frame->included || (hits & filter->include_mask) != 0;
+    if (f->child.included)
+        return FILTER_KEEP;
+
+    /* Outside included values, only containers on the way to an include are kept */
+    int container = f->token == TOKEN_LEFT_BRACE || f->token == TOKEN_LEFT_BRACKET;
+    return container && (advanced & filter->include_mask) ? FILTER_KEEP : FILTER_DROP;
+}
+
+/**
+ * @brief Decides what to do with an array element, which is the current token.
+ */
+static FilterDecision match_element(Filterer *f, const FilterFrame *frame)
+{
+    f->child = *frame;
+    if (frame->included)
+        return FILTER_KEEP;
+    int container = f->token == TOKEN_LEFT_BRACE || f->token == TOKEN_LEFT_BRACKET;
+    return container && (frame->alive & f->filter->include_mask) ? FILTER_KEEP : FILTER_DROP;
+}
+
+/**
+ * @brief Reads the next member of the innermost object, up to its value,
+ *        and decides what to do with the value.
+ */
+static FilterDecision next_member(Filterer *f, int *ok)
+{
+    if (f->token != TOKEN_STRING)
+    {
+        *ok = 0;
+        return FILTER_DROP;
+    }
+
+    /* The token's text does not survive reading the next token */
+    if (!reserve(&f->key, &f->key_capacity, f->length + 1))
+    {
+        *ok = 0;
+        return FILTER_DROP;
+    }
+    memcpy(f->key, f->text, f->length);
+    f->key_length = f->length;
+    int escaped = f->stream.escaped;
+    if (!check_string(f, f->key, f->key_length, escaped))
+    {
+        *ok = 0;
+        return FILTER_DROP;
+    }
+
+    filter_advance(f);
+    if (f->token != TOKEN_COLON)
+    {
+        *ok = 0;
+        return FILTER_DROP;
+    }
+    filter_advance(f);
+
+    if (f->depth > f->active)
+        return FILTER_KEEP;
+    return match_key(f, &f->frames[f->depth - 1], escaped, ok);
+}
+
+/**
+ * @brief Decides what to do with the next element of the innermost array.
+ */
+static FilterDecision next_element(Filterer *f)
+{
+    if (f->depth > f->active)
+        return FILTER_KEEP;
+    return match_element(f, &f->frames[f->depth - 1]);
+}
+
+/**
+ * @brief Writes the comma and key that precede a kept value.
+ */
+static void write_prefix(Filterer *f)
+{
+    if (f->depth == 0)
+        return;
+    size_t top = f->depth - 1;
+    unsigned char bit = (unsigned char)(1u << (top % 8));
+    if (f->wrote[top / 8] & bit)
+        json_writer_putc(f->writer, ',');
+    f->wrote[top / 8] |= bit;
+    if (f->kinds[top / 8] & bit)
+    {
+        json_writer_putc(f->writer, '\"');
+        json_writer_write(f->writer, f->key, f->key_length);
+        json_writer_write(f->writer, "\":", 2);
+    }
+}
+
+/**
+ * @brief Consumes the rest of the current value without writing it.
+ *
+ * @return 1 on success, 0 if the value is malformed.
+ */
+static int skip_value(Filterer *f)
+{
+    switch (f->token)
+    {
+    case TOKEN_LEFT_BRACE:
+    case TOKEN_LEFT_BRACKET:
+        return json_stream_skip(&f->stream);
+    case TOKEN_STRING:
+    case TOKEN_NUMBER:
+    case TOKEN_TRUE:
+    case TOKEN_FALSE:
+    case TOKEN_NULL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Copies one document from the stream to the writer, applying the
+ *        filter.
+ *
+ * Nesting is tracked in bit stacks rather than by recursion; rule state is
+ * only kept for the leading containers that still need it.
+ *
+ * @return 1 on success, 0 on malformed input.
+ */
+static int filter_document(Filterer *f)
+{
+    JsonWriter *writer = f->writer;
+    int ok = 1;
+
+    /* The root: every rule is live, and it is kept in full unless some rule includes */
+    filter_advance(f);
+    f->child.alive = f->filter->count == JSON_FILTER_MAX_RULES ? ~(uint64_t)0 : ((uint64_t)1 << f->filter->count) - 1;
+    f->child.key_depth = 0;
+    f->child.included = f->filter->include_mask == 0;
+    FilterDecision decision = FILTER_KEEP;
+
+    while (1)
+    {
+        /* A value is expected, with its fate already decided */
+        if (decision == FILTER_DROP)
+        {
+            if (!skip_value(f))
+                return 0;
+        }
+        else if (decision == FILTER_REDACT)
+        {
+            if (!skip_value(f))
+                return 0;
+            write_prefix(f);
+            json_writer_write(writer, f->redaction->replacement, f->redaction->replacement_length);
+        }
+        else
+        {
+            switch (f->token)
+            {
+            case TOKEN_LEFT_BRACE:
+            case TOKEN_LEFT_BRACKET:
+            {
+                if (f->depth == JSON_STREAM_MAX_DEPTH)
+                {
+                    ERROR_LOG("Filter: Nesting deeper than %d\n", JSON_STREAM_MAX_DEPTH);
+                    return 0;
+                }
+                int is_object = f->token == TOKEN_LEFT_BRACE;
+                write_prefix(f);
+                json_writer_putc(writer, is_object ? '{' : '[');
+
+                /* Containers with no live rules and nothing left to exclude are copied as they are */
+                if (f->depth == f->active && (f->child.alive || !f->child.included))
+                {
+                    if (f->active == JSON_FILTER_MAX_DEPTH)
+                    {
+                        ERROR_LOG("Filter: Rules still apply deeper than %d\n", JSON_FILTER_MAX_DEPTH);
+                        return 0;
+                    }
+                    f->frames[f->active++] = f->child;
+                }
+                unsigned char bit = (unsigned char)(1u << (f->depth % 8));
+                if (is_object)
+                    f->kinds[f->depth / 8] |= bit;
+                else
+                    f->kinds[f->depth / 8] &= (unsigned char)~bit;
+                f->wrote[f->depth / 8] &= (unsigned char)~bit;
+                f->depth++;
+
+                filter_advance(f);
+                if (f->token == (is_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+                {
+                    if (f->active == f->depth)
+                        f->active--;
+                    f->depth--;
+                    json_writer_putc(writer, is_object ? '}' : ']');
+                    break;
+                }
+                decision = is_object ? next_member(f, &ok) : next_element(f);
+                if (!ok)
+                    return 0;
+                continue;
+            }
+            case TOKEN_STRING:
+                if (!check_string(f, f->text, f->length, f->stream.escaped))
+                    return 0;
+                write_prefix(f);
+                json_writer_putc(writer, '\"');
+                json_writer_write(writer, f->text, f->length);
+                json_writer_putc(writer, '\"');
+                break;
+            case TOKEN_NUMBER:
+                /* The stream's tokenizer is lax about numbers */
+                if (json_number_length(f->text, f->length) != f->length)
+                    return 0;
+                write_prefix(f);
+                json_writer_write(writer, f->text, f->length);
+                break;
+            case TOKEN_TRUE:
+                write_prefix(f);
+                json_writer_write(writer, "true", 4);
+                break;
+            case TOKEN_FALSE:
+                write_prefix(f);
+                json_writer_write(writer, "false", 5);
+                break;
+            case TOKEN_NULL:
+                write_prefix(f);
+                json_writer_write(writer, "null", 4);
+                break;
+            default:
+                return 0;
+            }
+        }
+
+        /* A value is complete: close containers until one continues */
+        while (1)
+        {
+            filter_advance(f);
+            if (f->depth == 0)
+                return f->token == TOKEN_EOF;
+
+            int in_object = (f->kinds[(f->depth - 1) / 8] >> ((f->depth - 1) % 8)) & 1;
+            if (f->token == (in_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+            {
+                if (f->active == f->depth)
+                    f->active--;
+                f->depth--;
+                json_writer_putc(writer, in_object ? '}' : ']');
+                continue;
+            }
+            if (f->token != TOKEN_COMMA)
+                return 0;
+            filter_advance(f);
+            decision = in_object ? next_member(f, &ok) : next_element(f);
+            if (!ok)
+                return 0;
+            break;
+        }
+    }
+}
+
+int json_filter_apply(const JsonFilter *filter, const JsonReader *reader, JsonWriter *writer)
+{
+    Filterer f;
+    f.filter = filter;
+    json_stream_init(&f.stream, reader);
+    f.writer = writer;
+    f.token = TOKEN_NONE;
+    f.text = NULL;
+    f.length = 0;
+    f.key = NULL;
+    f.key_length = 0;
+    f.key_capacity = 0;
+    f.decoded = NULL;
+    f.decoded_capacity = 0;
+    f.redaction = NULL;
+    f.depth = 0;
+    f.active = 0;
+
+    int ok = filter_document(&f);
+    if (!ok)
+        ERROR_LOG("Filter: Malformed input near offset %zu\n", json_stream_offset(&f.stream));
+
+    json_stream_free(&f.stream);
+    json_free(f.key);
+    json_free(f.decoded);
+    return json_writer_flush(writer) && ok;
+}
@@ -1,24 +1,77 @@
 #include "json_parser.h"
 #include "json_tokenizer.h"
+#include "json_arena.h"
 #include "json_utils.h"
 #include "json_logging.h"
+#include "json_config.h"
+#include "json_atomic.h"
+#include "json_shape.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+
+/* Initial number of entries in the container stack. */
+#define PARSER_DEFAULT_STACK_CAPACITY 64
+
+/* Hash buckets in a parser's shape cache (a power of two). */
+#define SHAPE_CACHE_BUCKETS 64
+
+/* A child of a container that is still being parsed. */
+typedef struct
+{
+    JsonValue *value;  /**< The child value, or NULL for a number held in `number`. */
+    size_t key_start;  /**< Offset of the member's key in the input, or in the decoded
+                            key buffer if `key_decoded` is set (objects only). */
+    size_t key_length; /**< Length of the member's key (objects only). */
+    uint32_t key_hash; /**< json_hash_key() of the member's key (objects only). */
+    int key_decoded;   /**< Whether the key had escapes and was decoded (objects only). */
+    double number;     /**< Item of an array that may still be packed (value is NULL). */
+} PendingChild;
+
+/* Key layouts seen by a parser, shared by objects across documents. */
+typedef struct
+{
+    JsonShape *buckets[SHAPE_CACHE_BUCKETS]; /**< Shapes chained by sequence hash. */
+    size_t count;                            /**< Number of shapes held. */
+} ShapeCache;
 
 /* Parser State Structure */
 typedef struct
 {
     JsonTokenizer tokenizer; /**< The tokenizer instance. */
-    JsonToken current_token; /**< The current token being processed. */
+    JsonTokenType token;     /**< Type of the current token being processed. */
+    size_t token_start;      /**< Offset of the current token's text in the input. */
+    size_t token_length;     /**< Length of the current token's text. */
+    JsonArena *arena;        /**< Node pool for the document, or NULL to use json_alloc. */
+    PendingChild *stack;     /**< Children of every container still being parsed. */
+    size_t stack_top;        /**< Number of stack entries in use. */
+    size_t stack_capacity;   /**< Number of stack entries allocated. */
+    int pack_numbers;        /**< Store all-number arrays as packed doubles. */
+    ShapeCache *shapes;      /**< Shapes to share between objects, or NULL. */
+    char *keys;              /**< Decoded keys of escaped members still on the stack. */
+    size_t keys_length;      /**< Number of bytes of `keys` in use. */
+    size_t keys_capacity;    /**< Number of bytes of `keys` allocated. */
 } ParserState;
 
+/* Reusable Parser Structure */
+struct JsonParser
+{
+    JsonParserOptions options; /**< Options the parser was created with. */
+    JsonArena arena;           /**< Node pool reused by every parsed document. */
+    PendingChild *stack;       /**< Container stack retained between documents. */
+    size_t stack_capacity;     /**< Number of container stack entries allocated. */
+    ShapeCache shapes;         /**< Key layouts retained between documents. */
+    char *keys;                /**< Decoded key buffer retained between documents. */
+    size_t keys_capacity;      /**< Number of bytes of `keys` allocated. */
+};
+
 /* Function Prototypes */
 static JsonValue *parse_value(ParserState *state);
 static JsonValue *parse_object(ParserState *state);
 static JsonValue *parse_array(ParserState *state);
-static JsonValue *parse_string(ParserState *state, const char *str);
-static JsonValue *parse_number(ParserState *state, const char *num_str);
+static JsonValue *parse_string(ParserState *state);
+static JsonValue *parse_number(ParserState *state);
 static JsonValue *parse_true(ParserState *state);
 static JsonValue *parse_false(ParserState *state);
 static JsonValue *parse_null(ParserState *state);
@@ -26,64 +79,394 @@ static JsonValue *parse_null(ParserState *state);
 /**
  * @brief Advances to the next token.
  *
- * This function retrieves the next token from the tokenizer and updates the parser's state.
+ * This function scans the next token from the tokenizer and updates the parser's state.
+ * Token text is not copied; it is read from the input when needed.
  *
  * @param[in,out] state Pointer to the ParserState instance.
  */
 static void parser_advance(ParserState *state)
 {
-    json_token_free(&state->current_token);
-    state->current_token = json_get_next_token(&state->tokenizer);
+    state->token = json_scan_token(&state->tokenizer, &state->token_start, &state->token_length);
+}
+
+/**
+ * @brief Returns the text of the current token within the input.
+ *
+ * @param[in] state Pointer to the ParserState instance.
+ * @return Pointer to the first character of the token (not null-terminated).
+ */
+static const char *token_text(const ParserState *state)
+{
+    return state->tokenizer.json + state->token_start;
 }
 
 /**
  * @brief Expects the current token to be of a specific type and consumes it.
  *
  * If the current token matches the expected type, the parser advances to the next token.
- * Otherwise, it reports an error and terminates parsing.
+ * Otherwise, it reports an error.
  *
  * @param[in,out] state Pointer to the ParserState instance.
  * @param[in]     type  The expected JsonTokenType.
+ * @return 1 if the token was consumed, 0 on mismatch.
  */
-static void parser_expect(ParserState *state, JsonTokenType type)
+static int parser_expect(ParserState *state, JsonTokenType type)
 {
-    if (state->current_token.type != type)
+    if (state->token != type)
     {
         ERROR_LOG("Parser Error at position %zu: Expected token %s but found %s\n",
                   state->tokenizer.pos,
                   json_token_type_to_string(type),
-                  json_token_type_to_string(state->current_token.type));
-        json_free_value(NULL); // Adjust based on your cleanup strategy
-        exit(EXIT_FAILURE);
+                  json_token_type_to_string(state->token));
+        return 0;
     }
     parser_advance(state); // Consume the expected token
+    return 1;
+}
+
+/**
+ * @brief Allocates memory for the document being parsed.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     size  Number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL on failure.
+ */
+static void *parser_alloc(ParserState *state, size_t size)
+{
+    return state->arena ? json_arena_alloc(state->arena, size) : json_alloc(size);
+}
+
+/**
+ * @brief Copies a range of characters into the document as a string.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     s     The source characters.
+ * @param[in]     len   The number of characters to copy.
+ * @return Pointer to the null-terminated copy, or NULL on failure.
+ */
+static char *parser_strdup_range(ParserState *state, const char *s, size_t len)
+{
+    return state->arena ? json_arena_strdup_range(state->arena, s, len) : json_strdup_range(s, len);
+}
+
+/**
+ * @brief Releases a value tree built by the parser.
+ *
+ * Arena memory is reclaimed all at once, so this is a no-op in arena mode.
+ */
+static void parser_release_value(ParserState *state, JsonValue *value)
+{
+    if (!state->arena)
+        json_free_value(value);
+}
+
+/**
+ * @brief Allocates a JsonValue followed by `extra` bytes of inline storage.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     type  The type of the new value.
+ * @param[in]     extra Number of bytes to reserve directly after the JsonValue.
+ * @return Pointer to the new JsonValue, or NULL on failure.
+ */
+static JsonValue *parser_new_value_with(ParserState *state, JsonType type, size_t extra)
+{
+    JsonValue *value = parser_alloc(state, sizeof(JsonValue) + extra);
+    if (!value)
+    {
+        ERROR_LOG("Parser: Memory allocation failed for JsonValue (type %d)\n", (int)type);
+        return NULL;
+    }
+    value->type = type;
+    value->flags = 0;
+    return value;
+}
+
+/**
+ * @brief Allocates a JsonValue of the given type.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     type  The type of the new value.
+ * @return Pointer to the new JsonValue, or NULL on failure.
+ */
+static JsonValue *parser_new_value(ParserState *state, JsonType type)
+{
+    return parser_new_value_with(state, type, 0);
+}
+
+/**
+ * @brief Pushes a child of the container being parsed onto the container stack.
+ *
+ * Children are collected on the stack and copied into an exactly sized array
+ * once the container is closed, instead of growing the array per element.
+ * Member keys stay in the input until then, so small objects can store them
+ * alongside their pairs.
+ *
+ * @param[in,out] state      Pointer to the ParserState instance.
+ * @param[in]     key_start  Offset of the member's key in the input (objects only).
+ * @param[in]     key_length Length of the member's key (objects only).
+ * @param[in]     value      The child value.
+ * @return 1 on success, 0 if the stack could not grow.
+ */
+static int stack_push(ParserState *state, size_t key_start, size_t key_length, JsonValue *value)
+{
+    if (state->stack_top == state->stack_capacity)
+    {
+        size_t capacity = state->stack_capacity ? state->stack_capacity * 2 : PARSER_DEFAULT_STACK_CAPACITY;
+        PendingChild *stack = json_realloc(state->stack, sizeof(PendingChild) * capacity);
+        if (!stack)
+        {
+            ERROR_LOG("Parser: Memory allocation failed for container stack.\n");
+            return 0;
+        }
+        state->stack = stack;
+        state->stack_capacity = capacity;
+    }
+    state->stack[state->stack_top].value = value;
+    state->stack[state->stack_top].key_start = key_start;
+    state->stack[state->stack_top].key_length = key_length;
+    state->stack[state->stack_top].key_hash = 0;
+    state->stack[state->stack_top].key_decoded = 0;
+    state->stack[state->stack_top].number = 0.0;
+    state->stack_top++;
+    return 1;
+}
+
+/**
+ * @brief Turns numbers held on the stack for a packable array into JsonValues.
+ *
+ * Called once an array being packed turns out to contain a non-number.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     base  Stack index where the array's items start.
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int stack_unpack_numbers(ParserState *state, size_t base)
+{
+    for (size_t i = base; i < state->stack_top; i++)
+    {
+        if (state->stack[i].value)
+            continue;
+        JsonValue *value = parser_new_value(state, JSON_NUMBER);
+        if (!value)
+            return 0;
+        value->value.number = state->stack[i].number;
+        state->stack[i].value = value;
+    }
+    return 1;
+}
+
+/**
+ * @brief Releases the children of a container that failed to parse.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @param[in]     base  Stack index where the container's children start.
+ */
+static void stack_release(ParserState *state, size_t base)
+{
+    while (state->stack_top > base)
+    {
+        state->stack_top--;
+        parser_release_value(state, state->stack[state->stack_top].value);
+    }
+}
+
+/**
+ * @brief Decodes the current key token into the decoded key buffer.
+ *
+ * Keys with escapes cannot be copied straight from the input, so their
+ * decoded text is kept here until the object closes.
+ *
+ * @param[in,out] state Pointer to the ParserState instance.
+ * @return Offset of the decoded key in the buffer, or SIZE_MAX on an invalid
+ *         escape or allocation failure. The decoded length is stored in
+ *         `state->token_length`.
+ */
+static size_t decode_key(ParserState *state)
+{
+    /* Decoding never lengthens a key, so the raw length bounds the space needed */
+    size_t needed = state->keys_length + state->token_length + 1;
+    if (needed > state->keys_capacity)
+    {
+        size_t capacity = state->keys_capacity ? state->keys_capacity * 2 : 256;
+        while (capacity < needed)
+            capacity *= 2;
+        char *keys = json_realloc(state->keys, capacity);
+        if (!keys)
+        {
+            ERROR_LOG("Parser: Memory allocation failed for decoded key buffer.\n");
+            return SIZE_MAX;
+        }
+        state->keys = keys;
+        state->keys_capacity = capacity;
+    }
+
+    size_t offset = state->keys_length;
+    size_t length = json_unescape(token_text(state), state->token_length, state->keys + offset);
+    if (length == SIZE_MAX)
+    {
+        ERROR_LOG("Parser: Invalid escape sequence in object key '%.*s'\n",
+                  (int)state->token_length, token_text(state));
+        return SIZE_MAX;
+    }
+    state->keys_length += length + 1;
+    state->token_length = length;
+    return offset;
+}
+
+/**
+ * @brief Returns the text of a pending member's key (not null-terminated).
+ */
+static const char *child_key(const ParserState *state, const PendingChild *child)
+{
+    return (child->key_decoded ? state->keys : state->tokenizer.json) + child->key_start;
+}
+
+/**
+ * @brief Records the length and hash of a pair's materialized key.
+ *
+ * Keys too long for the 32-bit length field keep a zero hash, so lookups
+ * by JsonKey compare them in full.
+ *
+ * @param[out] pair  The pair whose key has just been stored.
+ * @param[in]  child The stack entry the pair was made from.
+ */
+static void set_key_hash(JsonPair *pair, const PendingChild *child)
+{
+    if (child->key_length > UINT32_MAX)
+    {
+        pair->key_length = 0;
+        pair->key_hash = 0;
+        return;
+    }
+    pair->key_length = (uint32_t)child->key_length;
+    pair->key_hash = child->key_hash;
+}
+
+/**
+ * @brief Finds or creates the shape for an object's key sequence.
+ *
+ * Keys are matched against cached shapes by sequence hash, then per key by
+ * hash and length; the key bytes are compared only to rule out collisions.
+ * Once the cache holds JSON_SHAPE_CACHE_MAX shapes, unseen layouts are
+ * stored without one.
+ *
+ * @param[in,out] state    Pointer to the ParserState instance.
+ * @param[in]     children The object's members on the container stack.
+ * @param[in]     count    Number of members.
+ * @return The shape, or NULL if the object should own its keys.
+ */
+static const JsonShape *shape_intern(ParserState *state, const PendingChild *children, size_t count)
+{
+    uint32_t hash = 0;
+    size_t keys_size = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (children[i].key_length > UINT32_MAX)
+            return NULL;
+        hash = json_shape_mix(hash, children[i].key_hash);
+        keys_size += children[i].key_length;
+    }
+
+    JsonShape **bucket = &state->shapes->buckets[hash & (SHAPE_CACHE_BUCKETS - 1)];
+    for (JsonShape *shape = *bucket; shape; shape = shape->next)
+    {
+        if (shape->hash != hash || shape->count != count)
+            continue;
+        size_t i = 0;
+        while (i < count && shape->keys[i].key_hash == children[i].key_hash &&
+               shape->keys[i].key_length == children[i].key_length &&
+               memcmp(shape->keys[i].key, child_key(state, &children[i]), children[i].key_length) == 0)
+            i++;
+        if (i == count)
+            return shape;
+    }
+
+    if (state->shapes->count >= JSON_SHAPE_CACHE_MAX)
+        return NULL;
+    JsonShape *shape = json_shape_new(count, keys_size);
+    if (!shape)
+        return NULL;
+    for (size_t i = 0; i < count; i++)
+        json_shape_add_key(shape, i, child_key(state, &children[i]), children[i].key_length, children[i].key_hash);
+    json_shape_seal(shape);
+
+    shape->next = *bucket;
+    *bucket = shape;
+    state->shapes->count++;
+    DEBUG_PRINT("Parser: Cached shape with %zu keys.\n", count);
+    return shape;
+}
+
+/**
+ * @brief Copies the current string token's text, decoding any escapes.
+ *
+ * Strings without escapes are copied with a single memcpy.
+ *
+ * @param[in]  state Pointer to the ParserState instance.
+ * @param[out] out   Buffer of at least `state->token_length + 1` bytes.
+ * @return 1 on success, 0 if an escape sequence is invalid.
+ */
+static int copy_string_token(const ParserState *state, char *out)
+{
+    if (!state->tokenizer.escaped)
+    {
+        memcpy(out, token_text(state), state->token_length);
+        out[state->token_length] = '\0';
+        return 1;
+    }
+    if (json_unescape(token_text(state), state->token_length, out) == SIZE_MAX)
+    {
+        ERROR_LOG("Parser: Invalid escape sequence in string '%.*s'\n",
+                  (int)state->token_length, token_text(state));
+        return 0;
+    }
+    return 1;
 }
 
 /**
  * @brief Parses a JSON string token.
  *
  * This function converts a string token into a JsonValue of type JSON_STRING.
+ * Escape sequences are decoded; the decoded text is never longer than the
+ * token, so its length bounds the allocation.
  *
  * @param[in,out] state Pointer to the ParserState instance.
- * @param[in]     str   The string value to parse.
  * @return Pointer to the parsed JsonValue, or NULL on failure.
  */
-static JsonValue *parse_string(ParserState *state, const char *str)
+static JsonValue *parse_string(ParserState *state)
 {
-    (void)state;
-    DEBUG_PRINT("Parser: Parsing string: '%s'\n", str);
-    JsonValue *value = json_alloc(sizeof(JsonValue));
+    DEBUG_PRINT("Parser: Parsing string: '%.*s'\n", (int)state->token_length, token_text(state));
+
+    /* Short strings live directly after their JsonValue */
+    if (state->token_length <= JSON_INLINE_STRING_MAX)
+    {
+        JsonValue *value = parser_new_value_with(state, JSON_STRING, state->token_length + 1);
+        if (!value)
+            return NULL;
+        value->flags = JSON_FLAG_INLINE_STRING;
+        value->value.string = (char *)(value + 1);
+        if (!copy_string_token(state, value->value.string))
+        {
+            parser_release_value(state, value);
+            return NULL;
+        }
+        return value;
+    }
+
+    JsonValue *value = parser_new_value(state, JSON_STRING);
     if (!value)
+        return NULL;
+    value->value.string = parser_alloc(state, state->token_length + 1);
+    if (!value->value.string)
     {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (STRING)\n");
+        ERROR_LOG("Parser: Memory allocation failed for string value '%.*s'\n",
+                  (int)state->token_length, token_text(state));
+        parser_release_value(state, value);
         return NULL;
     }
-    value->type = JSON_STRING;
-    value->value.string = json_strdup(str);
-    if (!value->value.string)
+    if (!copy_string_token(state, value->value.string))
     {
-        ERROR_LOG("Parser: Memory allocation failed for string value '%s'\n", str);
-        json_free(value);
+        parser_release_value(state, value);
         return NULL;
     }
     return value;
@@ -95,21 +478,16 @@ static JsonValue *parse_string(ParserState *state, const char *str)
  * This function converts a number token into a JsonValue of type JSON_NUMBER.
  *
  * @param[in,out] state Pointer to the ParserState instance.
- * @param[in]     num_str The number string to parse.
  * @return Pointer to the parsed JsonValue, or NULL on failure.
  */
-static JsonValue *parse_number(ParserState *state, const char *num_str)
+static JsonValue *parse_number(ParserState *state)
 {
-    (void)state;
-    DEBUG_PRINT("Parser: Parsing number: '%s'\n", num_str);
-    JsonValue *value = json_alloc(sizeof(JsonValue));
+    DEBUG_PRINT("Parser: Parsing number: '%.*s'\n", (int)state->token_length, token_text(state));
+    JsonValue *value = parser_new_value(state, JSON_NUMBER);
     if (!value)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (NUMBER)\n");
         return NULL;
-    }
-    value->type = JSON_NUMBER;
-    value->value.number = atof(num_str);
+
+    value->value.number = json_number_from_range(token_text(state), state->token_length);
     return value;
 }
 
@@ -121,16 +499,10 @@ static JsonValue *parse_number(ParserState *state, const char *num_str)
  */
 static JsonValue *parse_true(ParserState *state)
 {
-    (void)state;
     DEBUG_PRINT("Parser: Parsing true\n");
-    JsonValue *value = json_alloc(sizeof(JsonValue));
-    if (!value)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (TRUE)\n");
-        return NULL;
-    }
-    value->type = JSON_BOOL;
-    value->value.boolean = 1;
+    JsonValue *value = parser_new_value(state, JSON_BOOL);
+    if (value)
+        value->value.boolean = 1;
     return value;
 }
 
@@ -142,16 +514,10 @@ static JsonValue *parse_true(ParserState *state)
  */
 static JsonValue *parse_false(ParserState *state)
 {
-    (void)state;
     DEBUG_PRINT("Parser: Parsing false\n");
-    JsonValue *value = json_alloc(sizeof(JsonValue));
-    if (!value)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (FALSE)\n");
-        return NULL;
-    }
-    value->type = JSON_BOOL;
-    value->value.boolean = 0;
+    JsonValue *value = parser_new_value(state, JSON_BOOL);
+    if (value)
+        value->value.boolean = 0;
     return value;
 }
 
@@ -163,51 +529,30 @@ static JsonValue *parse_false(ParserState *state)
  */
 static JsonValue *parse_null(ParserState *state)
 {
-    (void)state;
     DEBUG_PRINT("Parser: Parsing null\n");
-    JsonValue *value = json_alloc(sizeof(JsonValue));
-    if (!value)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (NULL)\n");
-        return NULL;
-    }
-    value->type = JSON_NULL;
-    return value;
+    return parser_new_value(state, JSON_NULL);
 }
 
 /**
  * @brief Parses a JSON object.
  *
  * This function handles parsing of JSON objects, which are collections of key-value pairs.
+ * Members are gathered on the container stack and copied into the object when it closes.
  *
  * @param[in,out] state Pointer to the ParserState instance.
- * @return Pointer to the parsed JsonObject, or NULL on failure.
+ * @return Pointer to the parsed JsonValue (OBJECT), or NULL on failure.
  */
 static JsonValue *parse_object(ParserState *state)
 {
     DEBUG_PRINT("Parser: Starting to parse object.\n");
-    JsonValue *object = json_alloc(sizeof(JsonValue));
-    if (!object)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (OBJECT)\n");
-        return NULL;
-    }
-    object->type = JSON_OBJECT;
-    object->value.object = json_alloc(sizeof(JsonObject));
-    if (!object->value.object)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonObject\n");
-        json_free(object);
-        return NULL;
-    }
-    object->value.object->pairs = NULL;
-    object->value.object->count = 0;
+    size_t base = state->stack_top;
+    size_t keys_mark = state->keys_length;
 
     /* Expecting the opening '{' has already been consumed before calling parse_object */
 
     while (1)
     {
-        if (state->current_token.type == TOKEN_RIGHT_BRACE)
+        if (state->token == TOKEN_RIGHT_BRACE)
         {
             DEBUG_PRINT("Parser: Object parsing complete.\n");
             parser_advance(state);
@@ -215,78 +560,161 @@ static JsonValue *parse_object(ParserState *state)
         }
 
         // If not the first key-value pair, expect a comma
-        if (object->value.object->count > 0)
+        if (state->stack_top > base && !parser_expect(state, TOKEN_COMMA))
         {
-            parser_expect(state, TOKEN_COMMA); // Consume the comma
+            goto fail;
         }
 
         // Now, expect a key string
-        if (state->current_token.type != TOKEN_STRING)
+        if (state->token != TOKEN_STRING)
         {
             ERROR_LOG("Parser: Expected TOKEN_STRING for key, but got %s\n",
-                      json_token_type_to_string(state->current_token.type));
-            json_free_value(object);
-            exit(EXIT_FAILURE);
+                      json_token_type_to_string(state->token));
+            goto fail;
         }
 
-        // Duplicate the key string to ensure safe memory management
-        char *key = json_strdup(state->current_token.value);
-        if (!key)
-        {
-            ERROR_LOG("Parser: Memory allocation failed for key '%s'\n", state->current_token.value);
-            json_free_value(object);
-            exit(EXIT_FAILURE);
-        }
-        DEBUG_PRINT("Parser: Object key: '%s'\n", key);
+        // The key is copied out of the input when the object is complete
+        int key_decoded = state->tokenizer.escaped;
+        size_t key_start = key_decoded ? decode_key(state) : state->token_start;
+        if (key_start == SIZE_MAX)
+            goto fail;
+        size_t key_length = state->token_length;
+        const char *key = (key_decoded ? state->keys : state->tokenizer.json) + key_start;
+        uint32_t key_hash = json_hash_key(key, key_length);
+        DEBUG_PRINT("Parser: Object key: '%.*s'\n", (int)key_length, key);
         parser_advance(state); // Consume the string token
 
         // Expect colon
-        if (state->current_token.type != TOKEN_COLON)
+        if (state->token != TOKEN_COLON)
         {
-            ERROR_LOG("Parser: Expected TOKEN_COLON after key '%s', but got %s\n",
-                      key, json_token_type_to_string(state->current_token.type));
-            json_free(key);
-            json_free_value(object);
-            exit(EXIT_FAILURE);
+            ERROR_LOG("Parser: Expected TOKEN_COLON after key '%.*s', but got %s\n",
+                      (int)key_length, key, json_token_type_to_string(state->token));
+            goto fail;
         }
         parser_advance(state); // Consume the colon
-        DEBUG_PRINT("Parser: Successfully processed colon. Parsing value for key: '%s'\n", key);
+        DEBUG_PRINT("Parser: Successfully processed colon. Parsing value for key: '%.*s'\n", (int)key_length, key);
 
-        // Parse value
+        // Parse value (which may move the decoded key buffer)
         JsonValue *value = parse_value(state);
+        key = (key_decoded ? state->keys : state->tokenizer.json) + key_start;
         if (!value)
         {
-            ERROR_LOG("Parser: Failed to parse value for key '%s'\n", key);
-            json_free(key);
-            json_free_value(object);
-            exit(EXIT_FAILURE);
+            ERROR_LOG("Parser: Failed to parse value for key '%.*s'\n", (int)key_length, key);
+            goto fail;
         }
 
-        // Add key-value pair to object
-        JsonPair *new_pairs = json_realloc(object->value.object->pairs, sizeof(JsonPair) * (object->value.object->count + 1));
-        if (!new_pairs)
+        if (!stack_push(state, key_start, key_length, value))
         {
-            ERROR_LOG("Parser: Memory allocation failed for JsonPair array.\n");
-            json_free(key);
-            json_free_value(value);
-            json_free_value(object);
-            exit(EXIT_FAILURE);
+            parser_release_value(state, value);
+            goto fail;
         }
-        object->value.object->pairs = new_pairs;
-        object->value.object->pairs[object->value.object->count].key = key;
-        object->value.object->pairs[object->value.object->count].value = value;
-        object->value.object->count++;
+        state->stack[state->stack_top - 1].key_hash = key_hash;
+        state->stack[state->stack_top - 1].key_decoded = key_decoded;
+
+        DEBUG_PRINT("Parser: Added key-value pair: '%.*s': <value>\n", (int)key_length, key);
+    }
+
+    size_t count = state->stack_top - base;
+    PendingChild *children = &state->stack[base];
+    JsonValue *object;
+    JsonPair *pairs;
+    const JsonShape *shape = state->shapes && count ? shape_intern(state, children, count) : NULL;
 
-        DEBUG_PRINT("Parser: Added key-value pair: '%s': <value>\n", key);
+    if (shape)
+    {
+        /* Keys come from the shared shape; only the values are per object */
+        object = parser_new_value_with(state, JSON_OBJECT, sizeof(JsonObject) + sizeof(JsonPair) * count);
+        if (!object)
+            goto fail;
+        object->flags = JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_SHARED_KEYS;
+        object->value.object = (JsonObject *)(object + 1);
+        pairs = (JsonPair *)(object->value.object + 1);
+        memcpy(pairs, shape->keys, sizeof(JsonPair) * count);
+        for (size_t i = 0; i < count; i++)
+            pairs[i].value = children[i].value;
+    }
+    else if (count <= JSON_INLINE_CHILDREN_MAX)
+    {
+        /* Header, pairs and keys share the JsonValue's allocation */
+        size_t keys_size = 0;
+        for (size_t i = 0; i < count; i++)
+            keys_size += children[i].key_length + 1;
+        object = parser_new_value_with(state, JSON_OBJECT,
+                                       sizeof(JsonObject) + sizeof(JsonPair) * count + keys_size);
+        if (!object)
+            goto fail;
+        object->flags = JSON_FLAG_INLINE_CHILDREN;
+        object->value.object = (JsonObject *)(object + 1);
+        pairs = (JsonPair *)(object->value.object + 1);
+        char *keys = (char *)(pairs + count);
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(keys, child_key(state, &children[i]), children[i].key_length);
+            keys[children[i].key_length] = '\0';
+            pairs[i].key = keys;
+            pairs[i].value = children[i].value;
+            set_key_hash(&pairs[i], &children[i]);
+            keys += children[i].key_length + 1;
+        }
+    }
+    else
+    {
+        object = parser_new_value(state, JSON_OBJECT);
+        if (!object)
+            goto fail;
+        object->value.object = parser_alloc(state, sizeof(JsonObject));
+        pairs = parser_alloc(state, sizeof(JsonPair) * count);
+        if (!object->value.object || !pairs)
+        {
+            ERROR_LOG("Parser: Memory allocation failed for JsonObject\n");
+            if (!state->arena)
+            {
+                json_free(pairs);
+                json_free(object->value.object);
+                json_free(object);
+            }
+            goto fail;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            pairs[i].key = parser_strdup_range(state, child_key(state, &children[i]), children[i].key_length);
+            if (!pairs[i].key)
+            {
+                ERROR_LOG("Parser: Memory allocation failed for object key\n");
+                if (!state->arena)
+                {
+                    while (i--)
+                        json_free(pairs[i].key);
+                    json_free(pairs);
+                    json_free(object->value.object);
+                    json_free(object);
+                }
+                goto fail;
+            }
+            pairs[i].value = children[i].value;
+            set_key_hash(&pairs[i], &children[i]);
+        }
     }
 
+    object->value.object->pairs = count ? pairs : NULL;
+    object->value.object->count = count;
+    object->value.object->shape = shape;
+    object->value.object->capacity = (object->flags & JSON_FLAG_INLINE_CHILDREN) ? 0 : count;
+    state->stack_top = base;
+    state->keys_length = keys_mark;
     return object;
+
+fail:
+    stack_release(state, base);
+    state->keys_length = keys_mark;
+    return NULL;
 }
 
 /**
  * @brief Parses a JSON array.
  *
  * This function handles parsing of JSON arrays, which are ordered lists of JSON values.
+ * Items are gathered on the container stack and copied into the array when it closes.
  *
  * @param[in,out] state Pointer to the ParserState instance.
  * @return Pointer to the parsed JsonValue (ARRAY), or NULL on failure.
@@ -294,28 +722,14 @@ static JsonValue *parse_object(ParserState *state)
 static JsonValue *parse_array(ParserState *state)
 {
     DEBUG_PRINT("Parser: Starting to parse array.\n");
-    JsonValue *array = json_alloc(sizeof(JsonValue));
-    if (!array)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonValue (ARRAY)\n");
-        return NULL;
-    }
-    array->type = JSON_ARRAY;
-    array->value.array = json_alloc(sizeof(JsonArray));
-    if (!array->value.array)
-    {
-        ERROR_LOG("Parser: Memory allocation failed for JsonArray\n");
-        json_free(array);
-        return NULL;
-    }
-    array->value.array->items = NULL;
-    array->value.array->count = 0;
+    size_t base = state->stack_top;
+    int packed = state->pack_numbers;
 
     /* Expecting the opening '[' has already been consumed before calling parse_array */
 
     while (1)
     {
-        if (state->current_token.type == TOKEN_RIGHT_BRACKET)
+        if (state->token == TOKEN_RIGHT_BRACKET)
         {
             DEBUG_PRINT("Parser: Array parsing complete.\n");
             parser_advance(state); // Consume ']'
@@ -323,9 +737,26 @@ static JsonValue *parse_array(ParserState *state)
         }
 
         // If not the first element, expect a comma
-        if (array->value.array->count > 0)
+        if (state->stack_top > base && !parser_expect(state, TOKEN_COMMA))
         {
-            parser_expect(state, TOKEN_COMMA); // Ensures a comma is present and consumes it
+            goto fail;
+        }
+
+        // While the array may still be packed, keep numbers as plain doubles
+        if (packed && state->token == TOKEN_NUMBER)
+        {
+            double number = json_number_from_range(token_text(state), state->token_length);
+            parser_advance(state); // Consume TOKEN_NUMBER
+            if (!stack_push(state, 0, 0, NULL))
+                goto fail;
+            state->stack[state->stack_top - 1].number = number;
+            continue;
+        }
+        if (packed)
+        {
+            packed = 0;
+            if (!stack_unpack_numbers(state, base))
+                goto fail;
         }
 
         // Parse value
@@ -333,27 +764,86 @@ static JsonValue *parse_array(ParserState *state)
         if (!value)
         {
             ERROR_LOG("Parser: Failed to parse value in array.\n");
-            json_free_value(array);
-            exit(EXIT_FAILURE);
+            goto fail;
         }
 
-        // Add value to array
-        JsonValue **new_items = json_realloc(array->value.array->items, sizeof(JsonValue *) * (array->value.array->count + 1));
-        if (!new_items)
+        if (!stack_push(state, 0, 0, value))
         {
-            ERROR_LOG("Parser: Memory allocation failed for JsonArray items.\n");
-            json_free_value(value);
-            json_free_value(array);
-            exit(EXIT_FAILURE);
+            parser_release_value(state, value);
+            goto fail;
         }
-        array->value.array->items = new_items;
-        array->value.array->items[array->value.array->count] = value;
-        array->value.array->count++;
 
         DEBUG_PRINT("Parser: Added value to array.\n");
     }
 
+    size_t count = state->stack_top - base;
+    JsonValue *array;
+    JsonValue **items;
+
+    if (packed && count > 0)
+    {
+        /* Header and numbers share the JsonValue's allocation */
+        array = parser_new_value_with(state, JSON_ARRAY, sizeof(JsonArray) + sizeof(double) * count);
+        if (!array)
+            goto fail;
+        array->flags = JSON_FLAG_INLINE_CHILDREN | JSON_FLAG_PACKED_NUMBERS;
+        array->value.array = (JsonArray *)(array + 1);
+        array->value.array->items = NULL;
+        array->value.array->count = count;
+        array->value.array->numbers = (double *)(array->value.array + 1);
+        array->value.array->capacity = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            array->value.array->numbers[i] = state->stack[base + i].number;
+        }
+        state->stack_top = base;
+        DEBUG_PRINT("Parser: Packed %zu numbers.\n", count);
+        return array;
+    }
+
+    if (count <= JSON_INLINE_CHILDREN_MAX)
+    {
+        /* Header and items share the JsonValue's allocation */
+        array = parser_new_value_with(state, JSON_ARRAY, sizeof(JsonArray) + sizeof(JsonValue *) * count);
+        if (!array)
+            goto fail;
+        array->flags = JSON_FLAG_INLINE_CHILDREN;
+        array->value.array = (JsonArray *)(array + 1);
+        items = (JsonValue **)(array->value.array + 1);
+    }
+    else
+    {
+        array = parser_new_value(state, JSON_ARRAY);
+        if (!array)
+            goto fail;
+        array->value.array = parser_alloc(state, sizeof(JsonArray));
+        items = parser_alloc(state, sizeof(JsonValue *) * count);
+        if (!array->value.array || !items)
+        {
+            ERROR_LOG("Parser: Memory allocation failed for JsonArray\n");
+            if (!state->arena)
+            {
+                json_free(items);
+                json_free(array->value.array);
+                json_free(array);
+            }
+            goto fail;
+        }
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i] = state->stack[base + i].value;
+    }
+    array->value.array->items = count ? items : NULL;
+    array->value.array->count = count;
+    array->value.array->numbers = NULL;
+    array->value.array->capacity = (array->flags & JSON_FLAG_INLINE_CHILDREN) ? 0 : count;
+    state->stack_top = base;
     return array;
+
+fail:
+    stack_release(state, base);
+    return NULL;
 }
 
 /**
@@ -367,10 +857,10 @@ static JsonValue *parse_array(ParserState *state)
  */
 static JsonValue *parse_value(ParserState *state)
 {
-    DEBUG_PRINT("Parser: Entering parse_value. Current token: %s\n", json_token_type_to_string(state->current_token.type));
+    DEBUG_PRINT("Parser: Entering parse_value. Current token: %s\n", json_token_type_to_string(state->token));
     JsonValue *value = NULL;
 
-    switch (state->current_token.type)
+    switch (state->token)
     {
     case TOKEN_LEFT_BRACE:
         DEBUG_PRINT("Parser: Detected object.\n");
@@ -383,13 +873,13 @@ static JsonValue *parse_value(ParserState *state)
         value = parse_array(state);
         break;
     case TOKEN_STRING:
-        DEBUG_PRINT("Parser: Detected string '%s'\n", state->current_token.value);
-        value = parse_string(state, state->current_token.value);
+        DEBUG_PRINT("Parser: Detected string '%.*s'\n", (int)state->token_length, token_text(state));
+        value = parse_string(state);
         parser_advance(state); // Consume TOKEN_STRING
         break;
     case TOKEN_NUMBER:
-        DEBUG_PRINT("Parser: Detected number '%s'\n", state->current_token.value);
-        value = parse_number(state, state->current_token.value);
+        DEBUG_PRINT("Parser: Detected number '%.*s'\n", (int)state->token_length, token_text(state));
+        value = parse_number(state);
         parser_advance(state); // Consume TOKEN_NUMBER
         break;
     case TOKEN_TRUE:
@@ -409,33 +899,31 @@ static JsonValue *parse_value(ParserState *state)
         break;
     default:
         ERROR_LOG("Parser Error: Unexpected token %s while parsing value.\n",
-                  json_token_type_to_string(state->current_token.type));
-        exit(EXIT_FAILURE);
+                  json_token_type_to_string(state->token));
+        break;
     }
 
     return value;
 }
 
 /**
- * @brief Parses a JSON string and constructs a JsonValue.
+ * @brief Parses a complete document, rejecting trailing data.
  *
- * @param[in] json The JSON string to parse.
- * @return Pointer to the root JsonValue if parsing is successful, NULL otherwise.
+ * @param[in,out] state Pointer to an initialized ParserState.
+ * @return Pointer to the root JsonValue, or NULL on failure.
  */
-JsonValue *json_parse(const char *json)
+static JsonValue *parse_document(ParserState *state)
 {
     DEBUG_PRINT("Parser: Starting JSON parsing...\n");
-    ParserState state;
-    json_tokenizer_init(&state.tokenizer, json);
-    state.current_token = json_get_next_token(&state.tokenizer);
+    parser_advance(state);
 
-    JsonValue *root = parse_value(&state);
+    JsonValue *root = parse_value(state);
     if (root)
     {
-        if (state.current_token.type != TOKEN_EOF)
+        if (state->token != TOKEN_EOF)
         {
             ERROR_LOG("Parser Error: Extra data detected after JSON root.\n");
-            json_free_value(root);
+            parser_release_value(state, root);
             root = NULL;
         }
         else
@@ -448,44 +936,181 @@ JsonValue *json_parse(const char *json)
         ERROR_LOG("Parser: Failed to parse JSON.\n");
     }
 
-    json_token_free(&state.current_token);
     return root;
 }
 
 /**
- * @brief Frees the memory allocated for a JsonValue and its nested structures.
- *
- * This function recursively frees all memory associated with a JsonValue,
- * including any nested JsonObjects or JsonArrays.
+ * @brief Parses a JSON string and constructs a JsonValue.
  *
- * @param[in,out] value Pointer to the JsonValue to free.
+ * @param[in] json The JSON string to parse.
+ * @return Pointer to the root JsonValue if parsing is successful, NULL otherwise.
  */
-void json_free_value(JsonValue *value)
+JsonValue *json_parse(const char *json)
 {
-    if (!value)
+    if (!json)
+        return NULL;
+
+    ParserState state;
+    memset(&state, 0, sizeof(state));
+    json_tokenizer_init(&state.tokenizer, json);
+
+    JsonValue *root = parse_document(&state);
+    json_free(state.stack);
+    json_free(state.keys);
+    return root;
+}
+
+JsonParser *json_parser_new(const JsonParserOptions *options)
+{
+    JsonParser *parser = json_alloc(sizeof(JsonParser));
+    if (!parser)
+    {
+        ERROR_LOG("Parser: Memory allocation failed for JsonParser\n");
+        return NULL;
+    }
+    if (options)
+        parser->options = *options;
+    else
+        memset(&parser->options, 0, sizeof(parser->options));
+
+    json_arena_init(&parser->arena, parser->options.pool_block_size);
+    parser->stack = NULL;
+    parser->stack_capacity = 0;
+    parser->keys = NULL;
+    parser->keys_capacity = 0;
+    memset(&parser->shapes, 0, sizeof(parser->shapes));
+    if (parser->options.stack_capacity)
+    {
+        parser->stack = json_alloc(sizeof(PendingChild) * parser->options.stack_capacity);
+        if (parser->stack)
+            parser->stack_capacity = parser->options.stack_capacity;
+    }
+    return parser;
+}
+
+JsonValue *json_parser_parse(JsonParser *parser, const char *json, size_t length)
+{
+    if (!parser || !json)
+        return NULL;
+
+    /* The previous document's nodes are recycled for this one */
+    json_arena_reset(&parser->arena);
+
+    ParserState state;
+    memset(&state, 0, sizeof(state));
+    json_tokenizer_init_range(&state.tokenizer, json, length);
+    state.arena = &parser->arena;
+    state.stack = parser->stack;
+    state.stack_capacity = parser->stack_capacity;
+    state.pack_numbers = parser->options.pack_numeric_arrays;
+    state.shapes = parser->options.cache_shapes ? &parser->shapes : NULL;
+    state.keys = parser->keys;
+    state.keys_capacity = parser->keys_capacity;
+
+    JsonValue *root = parse_document(&state);
+
+    parser->stack = state.stack;
+    parser->stack_capacity = state.stack_capacity;
+    parser->keys = state.keys;
+    parser->keys_capacity = state.keys_capacity;
+    return root;
+}
+
+JsonArena *json_parser_arena(JsonParser *parser)
+{
+    return &parser->arena;
+}
+
+void json_parser_trim(JsonParser *parser)
+{
+    json_free(parser->stack);
+    json_free(parser->keys);
+    parser->stack = NULL;
+    parser->stack_capacity = 0;
+    parser->keys = NULL;
+    parser->keys_capacity = 0;
+}
+
+void json_parser_free(JsonParser *parser)
+{
+    if (!parser)
         return;
+    json_arena_destroy(&parser->arena);
+    json_free(parser->stack);
+    json_free(parser->keys);
+    for (size_t i = 0; i < SHAPE_CACHE_BUCKETS; i++)
+    {
+        JsonShape *shape = parser->shapes.buckets[i];
+        while (shape)
+        {
+            JsonShape *next = shape->next;
+            json_shape_free(shape);
+            shape = next;
+        }
+    }
+    json_free(parser);
+}
+
+/* Frames kept on the call stack before json_free_value spills to the heap. */
+#define FREE_STACK_INLINE_FRAMES 32
+
+/* A container whose children are still being released. */
+typedef struct
+{
+    JsonValue *node; /**< The container being torn down. */
+    size_t next;     /**< Index of the next child to release. */
+} FreeFrame;
+
+/* Explicit stack replacing recursion while freeing a tree. */
+typedef struct
+{
+    FreeFrame *frames; /**< Active frames (inline or heap storage). */
+    size_t depth;      /**< Number of frames in use. */
+    size_t capacity;   /**< Number of frames available. */
+} FreeStack;
+
+/**
+ * @brief Returns the number of child JsonValues of a container, 0 for scalars
+ *        and packed arrays.
+ */
+static size_t child_count(const JsonValue *value)
+{
+    if (value->type == JSON_ARRAY && (value->flags & JSON_FLAG_PACKED_NUMBERS))
+        return 0;
+    if (value->type == JSON_ARRAY)
+        return value->value.array->count;
+    if (value->type == JSON_OBJECT)
+        return value->value.object->count;
+    return 0;
+}
 
+/**
+ * @brief Frees a value whose children (if any) have already been released.
+ *
+ * Storage flagged as inline shares the JsonValue's allocation and is
+ * released together with it.
+ */
+static void free_node(JsonValue *value)
+{
     switch (value->type)
     {
     case JSON_STRING:
-        json_free(value->value.string);
+        if (!(value->flags & JSON_FLAG_INLINE_STRING))
+            json_free(value->value.string);
         break;
     case JSON_ARRAY:
-        for (size_t i = 0; i < value->value.array->count; i++)
+        if (!(value->flags & JSON_FLAG_INLINE_CHILDREN))
         {
-            json_free_value(value->value.array->items[i]); // Correctly free each JsonValue* in the array
+            json_free(value->value.array->items);
+            json_free(value->value.array);
         }
-        json_free(value->value.array->items);
-        json_free(value->value.array);
         break;
     case JSON_OBJECT:
-        for (size_t i = 0; i < value->value.object->count; i++)
+        if (!(value->flags & JSON_FLAG_INLINE_CHILDREN))
         {
-            json_free(value->value.object->pairs[i].key);
-            json_free_value(value->value.object->pairs[i].value); // Correctly free each JsonValue* in the object
+            json_free(value->value.object->pairs);
+            json_free(value->value.object);
         }
-        json_free(value->value.object->pairs);
-        json_free(value->value.object);
         break;
     case JSON_BOOL:
     case JSON_NUMBER:
@@ -500,3 +1125,233 @@ void json_free_value(JsonValue *value)
     /* Free the JsonValue struct itself */
     json_free(value);
 }
+
+/**
+ * @brief Recursively frees a subtree.
+ *
+ * Only used when the explicit stack cannot grow, so that running out of
+ * memory while freeing never leaks the remainder of the tree.
+ */
+static void free_value_recursive(JsonValue *value)
+{
+    if (!value)
+        return;
+
+    size_t count = child_count(value);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (value->type == JSON_ARRAY)
+        {
+            free_value_recursive(value->value.array->items[i]);
+        }
+        else
+        {
+            if (!(value->flags & JSON_FLAG_INLINE_CHILDREN))
+                json_free(value->value.object->pairs[i].key);
+            free_value_recursive(value->value.object->pairs[i].value);
+        }
+    }
+    free_node(value);
+}
+
+/**
+ * @brief Pushes a container onto the free stack, growing it if needed.
+ *
+ * @param[in,out] stack  The stack to push onto.
+ * @param[in]     inline_frames Caller-owned storage the stack started in, or
+ *                       NULL if the stack has always lived on the heap.
+ * @param[in]     node   The container to push.
+ * @return 1 on success, 0 if the stack could not grow.
+ */
+static int free_stack_push(FreeStack *stack, FreeFrame *inline_frames, JsonValue *node)
+{
+    if (stack->depth == stack->capacity)
+    {
+        size_t capacity = stack->capacity ? stack->capacity * 2 : FREE_STACK_INLINE_FRAMES;
+        FreeFrame *frames;
+        if (stack->frames && stack->frames != inline_frames)
+        {
+            frames = json_realloc(stack->frames, sizeof(FreeFrame) * capacity);
+        }
+        else
+        {
+            frames = json_alloc(sizeof(FreeFrame) * capacity);
+            if (frames && stack->frames)
+                memcpy(frames, stack->frames, sizeof(FreeFrame) * stack->depth);
+        }
+        if (!frames)
+            return 0;
+        stack->frames = frames;
+        stack->capacity = capacity;
+    }
+    stack->frames[stack->depth].node = node;
+    stack->frames[stack->depth].next = 0;
+    stack->depth++;
+    return 1;
+}
+
+/**
+ * @brief Releases nodes from the free stack depth-first.
+ *
+ * @param[in,out] stack  The stack of containers being torn down.
+ * @param[in]     inline_frames See free_stack_push().
+ * @param[in]     budget Maximum number of JsonValue nodes to free, 0 for no limit.
+ * @return Number of JsonValue nodes freed.
+ */
+static size_t free_stack_drain(FreeStack *stack, FreeFrame *inline_frames, size_t budget)
+{
+    size_t freed = 0;
+
+    while (stack->depth > 0 && (budget == 0 || freed < budget))
+    {
+        FreeFrame *frame = &stack->frames[stack->depth - 1];
+        JsonValue *node = frame->node;
+
+        if (frame->next == child_count(node))
+        {
+            stack->depth--;
+            free_node(node);
+            freed++;
+            continue;
+        }
+
+        JsonValue *child;
+        if (node->type == JSON_ARRAY)
+        {
+            child = node->value.array->items[frame->next];
+        }
+        else
+        {
+            if (!(node->flags & JSON_FLAG_INLINE_CHILDREN))
+                json_free(node->value.object->pairs[frame->next].key);
+            child = node->value.object->pairs[frame->next].value;
+        }
+        frame->next++;
+
+        if (!child)
+            continue;
+        if (child_count(child) == 0)
+        {
+            free_node(child);
+            freed++;
+        }
+        else if (!free_stack_push(stack, inline_frames, child))
+        {
+            free_value_recursive(child);
+            freed++;
+        }
+    }
+
+    return freed;
+}
+
+/**
+ * @brief Frees the memory allocated for a JsonValue and its nested structures.
+ *
+ * The tree is walked with an explicit stack rather than recursion, so the
+ * nesting depth of the document is not limited by the thread's call stack.
+ *
+ * @param[in,out] value Pointer to the JsonValue to free.
+ */
+void json_free_value(JsonValue *value)
+{
+    if (!value)
+        return;
+
+    if (child_count(value) == 0)
+    {
+        free_node(value);
+        return;
+    }
+
+    FreeFrame inline_frames[FREE_STACK_INLINE_FRAMES];
+    FreeStack stack = {inline_frames, 0, FREE_STACK_INLINE_FRAMES};
+    free_stack_push(&stack, inline_frames, value);
+    free_stack_drain(&stack, inline_frames, 0);
+    if (stack.frames != inline_frames)
+        json_free(stack.frames);
+}
+
+/* A tree handed to json_free_value_deferred, waiting for the reclaimer. */
+typedef struct DeferredNode
+{
+    struct DeferredNode *next; /**< Next tree in the queue. */
+    JsonValue *value;          /**< Root of the tree to free. */
+} DeferredNode;
+
+/* Trees queued by json_free_value_deferred (lock-free LIFO). */
+static DeferredNode *deferred_head = NULL;
+
+/* Set while a thread is inside json_reclaim_deferred. */
+static unsigned char reclaim_busy = 0;
+
+/* Partially freed tree carried over between json_reclaim_deferred calls. */
+static FreeStack reclaim_stack = {NULL, 0, 0};
+
+/* Trees taken from the queue but not yet started. */
+static DeferredNode *reclaim_batch = NULL;
+
+void json_free_value_deferred(JsonValue *value)
+{
+    if (!value)
+        return;
+
+    /* Scalars are as cheap to free now as they would be later */
+    if (child_count(value) == 0)
+    {
+        free_node(value);
+        return;
+    }
+
+    DeferredNode *node = json_alloc(sizeof(DeferredNode));
+    if (!node)
+    {
+        ERROR_LOG("Parser: Memory allocation failed for deferred free, freeing synchronously.\n");
+        json_free_value(value);
+        return;
+    }
+    node->value = value;
+    node->next = JSON_ATOMIC_LOAD(&deferred_head);
+    while (!JSON_ATOMIC_CAS(&deferred_head, &node->next, node))
+    {
+        /* node->next was refreshed by the failed exchange; retry */
+    }
+}
+
+size_t json_reclaim_deferred(size_t max_nodes)
+{
+    if (!JSON_ATOMIC_TRY_LOCK(&reclaim_busy))
+        return 0;
+
+    size_t freed = 0;
+    while (max_nodes == 0 || freed < max_nodes)
+    {
+        if (reclaim_stack.depth == 0)
+        {
+            if (!reclaim_batch)
+                reclaim_batch = JSON_ATOMIC_EXCHANGE(&deferred_head, (DeferredNode *)NULL);
+            if (!reclaim_batch)
+                break;
+
+            DeferredNode *node = reclaim_batch;
+            reclaim_batch = node->next;
+            if (!free_stack_push(&reclaim_stack, NULL, node->value))
+            {
+                free_value_recursive(node->value);
+                freed++;
+            }
+            json_free(node);
+        }
+        freed += free_stack_drain(&reclaim_stack, NULL, max_nodes ? max_nodes - freed : 0);
+    }
+
+    if (reclaim_stack.depth == 0 && reclaim_stack.frames)
+    {
+        json_free(reclaim_stack.frames);
+        reclaim_stack.frames = NULL;
+        reclaim_stack.capacity = 0;
+    }
+
+    JSON_ATOMIC_UNLOCK(&reclaim_busy);
+    return freed;
+}
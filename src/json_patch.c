@@ -0,0 +1,762 @@
+#include "json_patch.h"
+#include "json_builder.h"
+#include "json_compare.h"
+#include "json_accessor.h"
+#include "json_parser.h"
+#include "json_utils.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Kinds of change recorded while a patch is applied. */
+typedef enum
+{
+    UNDO_ROOT,    /**< The root was replaced; `value` is the old root. */
+    UNDO_REPLACE, /**< A child was replaced; `value` is the old child. */
+    UNDO_INSERT,  /**< A child was inserted at `index`. */
+    UNDO_REMOVE,  /**< A child was removed from `index`; `value` (and `pair`) is what was removed. */
+    UNDO_CREATED  /**< `value` was copied from the patch. */
+} UndoKind;
+
+typedef struct
+{
+    UndoKind kind;
+    int moved;            /**< A removed value that was added back elsewhere. */
+    JsonValue *container; /**< The array or object changed, or NULL. */
+    size_t index;         /**< Position of the child in the container. */
+    JsonValue *value;     /**< See UndoKind. */
+    JsonPair pair;        /**< Pair removed from an object, key included. */
+} UndoRecord;
+
+typedef struct
+{
+    JsonArena *arena;  /**< The document's arena, or NULL for the heap. */
+    JsonValue **root;  /**< The document. */
+    UndoRecord *log;   /**< Changes made so far, oldest first. */
+    size_t count;      /**< Number of records in `log`. */
+    size_t capacity;   /**< Number of records allocated. */
+    char *token;       /**< Decoded pointer token. */
+    size_t token_size; /**< Bytes allocated for `token`. */
+} Patcher;
+
+/* Where a pointer leads: a child of `parent`, or the root when `parent` is NULL. */
+typedef struct
+{
+    JsonValue *parent; /**< The array or object holding the target, or NULL. */
+    size_t index;      /**< Array index (the count for `-`), or object slot; SIZE_MAX if none. */
+    const char *key;   /**< The last token, decoded. */
+} Location;
+
+/**
+ * @brief Makes room to record one more change, before making it.
+ */
+static int log_reserve(Patcher *p)
+{
+    if (p->count < p->capacity)
+        return 1;
+    size_t capacity = p->capacity ? p->capacity * 2 : 16;
+    UndoRecord *log = json_realloc(p->log, sizeof(UndoRecord) * capacity);
+    if (!log)
+    {
+        ERROR_LOG("Patch: Memory allocation failed for undo log\n");
+        return 0;
+    }
+    p->log = log;
+    p->capacity = capacity;
+    return 1;
+}
+
+/**
+ * @brief Records a change; log_reserve() must have succeeded first.
+ */
+static UndoRecord *log_push(Patcher *p, UndoKind kind, JsonValue *container, size_t index, JsonValue *value)
+{
+    UndoRecord *record = &p->log[p->count++];
+    record->kind = kind;
+    record->moved = 0;
+    record->container = container;
+    record->index = index;
+    record->value = value;
+    return record;
+}
+
+/**
+ * @brief Moves a container to growable storage with room for one more child.
+ *
+ * Done before a container's first insertion or removal, so that undoing
+ * them later never allocates, and so that removed keys and numbers are
+ * separate allocations that can be kept aside.
+ */
+static int prepare(Patcher *p, JsonValue *container)
+{
+    int ok = container->type == JSON_ARRAY
+                 ? json_array_reserve(p->arena, container, container->value.array->count + 1)
+                 : json_object_reserve(p->arena, container, container->value.object->count + 1);
+    if (!ok)
+        ERROR_LOG("Patch: Memory allocation failed while preparing a container\n");
+    return ok;
+}
+
+/**
+ * @brief Returns the value at a location, or NULL if there is none.
+ */
+static const JsonValue *target(const Patcher *p, const Location *loc, JsonValue *scratch)
+{
+    if (!loc->parent)
+        return *p->root;
+    if (loc->parent->type == JSON_ARRAY)
+        return loc->index < loc->parent->value.array->count ? json_array_item(loc->parent, loc->index, scratch) : NULL;
+    return loc->index != SIZE_MAX ? loc->parent->value.object->pairs[loc->index].value : NULL;
+}
+
+/**
+ * @brief Resolves a JSON Pointer to a container and a position in it.
+ *
+ * Every token but the last must lead to an existing array or object; the
+ * last need not exist, so that `add` can create it.
+ */
+static JsonPatchErrorCode locate(Patcher *p, const char *path, Location *loc)
+{
+    loc->parent = NULL;
+    loc->index = SIZE_MAX;
+    loc->key = "";
+    if (!*path)
+        return JSON_PATCH_ERROR_NONE;
+    if (*path != '/')
+        return JSON_PATCH_ERROR_INVALID;
+
+    /* Decoded tokens are never longer than the pointer */
+    size_t size = strlen(path) + 1;
+    if (size > p->token_size)
+    {
+        char *token = json_realloc(p->token, size);
+        if (!token)
+            return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        p->token = token;
+        p->token_size = size;
+    }
+
+    JsonValue *node = *p->root;
+    const char *s = path;
+    for (;;)
+    {
+        size_t length;
+        if (!node || (node->type != JSON_ARRAY && node->type != JSON_OBJECT))
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        if (!(s = json_pointer_token(s + 1, p->token, &length)))
+            return JSON_PATCH_ERROR_INVALID;
+
+        size_t index;
+        if (node->type == JSON_ARRAY)
+        {
+            int append = length == 1 && p->token[0] == '-';
+            index = append ? node->value.array->count : json_pointer_index(p->token, length);
+        }
+        else
+        {
+            index = json_object_slot(node->value.object, p->token, length, json_hash_key(p->token, length));
+        }
+        if (!*s)
+        {
+            loc->parent = node;
+            loc->index = index;
+            loc->key = p->token;
+            return JSON_PATCH_ERROR_NONE;
+        }
+
+        /* Packed arrays hold only numbers, which have no children */
+        if (node->type == JSON_ARRAY)
+        {
+            if (index >= node->value.array->count || (node->flags & JSON_FLAG_PACKED_NUMBERS))
+                return JSON_PATCH_ERROR_NOT_FOUND;
+            node = node->value.array->items[index];
+        }
+        else
+        {
+            if (index == SIZE_MAX)
+                return JSON_PATCH_ERROR_NOT_FOUND;
+            node = node->value.object->pairs[index].value;
+        }
+    }
+}
+
+/**
+ * @brief Replaces the value at an existing location (or the root).
+ */
+static JsonPatchErrorCode replace_at(Patcher *p, const Location *loc, JsonValue *value)
+{
+    if (!log_reserve(p))
+        return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+    if (!loc->parent)
+    {
+        log_push(p, UNDO_ROOT, NULL, 0, *p->root);
+        *p->root = value;
+        return JSON_PATCH_ERROR_NONE;
+    }
+
+    JsonValue *parent = loc->parent;
+    if (parent->type == JSON_OBJECT)
+    {
+        JsonPair *pair = &parent->value.object->pairs[loc->index];
+        log_push(p, UNDO_REPLACE, parent, loc->index, pair->value);
+        pair->value = value;
+        return JSON_PATCH_ERROR_NONE;
+    }
+    if ((parent->flags & JSON_FLAG_PACKED_NUMBERS) && !prepare(p, parent))
+        return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+    JsonValue **item = &parent->value.array->items[loc->index];
+    log_push(p, UNDO_REPLACE, parent, loc->index, *item);
+    *item = value;
+    return JSON_PATCH_ERROR_NONE;
+}
+
+/**
+ * @brief Adds a value at a location, inserting into arrays and setting object members.
+ */
+static JsonPatchErrorCode add_at(Patcher *p, const Location *loc, JsonValue *value)
+{
+    JsonValue *parent = loc->parent;
+    if (!parent || (parent->type == JSON_OBJECT && loc->index != SIZE_MAX))
+        return replace_at(p, loc, value);
+    if (parent->type == JSON_ARRAY && loc->index > parent->value.array->count)
+        return JSON_PATCH_ERROR_NOT_FOUND;
+
+    if (!log_reserve(p) || !prepare(p, parent))
+        return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+    if (parent->type == JSON_ARRAY)
+    {
+        if (!json_array_insert(p->arena, parent, loc->index, value))
+            return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        log_push(p, UNDO_INSERT, parent, loc->index, value);
+        return JSON_PATCH_ERROR_NONE;
+    }
+    if (!json_object_set(p->arena, parent, loc->key, value, 0))
+        return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+    log_push(p, UNDO_INSERT, parent, parent->value.object->count - 1, value);
+    return JSON_PATCH_ERROR_NONE;
+}
+
+/**
+ * @brief Removes the value at an existing location, keeping it aside until the patch is done.
+ */
+static JsonPatchErrorCode remove_at(Patcher *p, const Location *loc, JsonValue **removed)
+{
+    JsonValue *parent = loc->parent;
+    if (!parent)
+        return JSON_PATCH_ERROR_INVALID;
+    if (!log_reserve(p) || !prepare(p, parent))
+        return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+
+    if (parent->type == JSON_ARRAY)
+    {
+        JsonArray *array = parent->value.array;
+        *removed = array->items[loc->index];
+        memmove(&array->items[loc->index], &array->items[loc->index + 1],
+                sizeof(JsonValue *) * (array->count - loc->index - 1));
+        array->count--;
+        log_push(p, UNDO_REMOVE, parent, loc->index, *removed);
+        return JSON_PATCH_ERROR_NONE;
+    }
+
+    /* The key is kept with the record, to be freed only once the patch succeeds */
+    JsonObject *object = parent->value.object;
+    JsonPair pair = object->pairs[loc->index];
+    memmove(&object->pairs[loc->index], &object->pairs[loc->index + 1],
+            sizeof(JsonPair) * (object->count - loc->index - 1));
+    object->count--;
+    object->shape = NULL;
+    *removed = pair.value;
+    log_push(p, UNDO_REMOVE, parent, loc->index, pair.value)->pair = pair;
+    return JSON_PATCH_ERROR_NONE;
+}
+
+/**
+ * @brief Copies a value from the patch into the document's allocator.
+ */
+static JsonValue *adopt(Patcher *p, const JsonValue *value)
+{
+    if (!log_reserve(p))
+        return NULL;
+    JsonValue *copy = json_clone(p->arena, value);
+    if (copy)
+        log_push(p, UNDO_CREATED, NULL, 0, copy);
+    return copy;
+}
+
+/**
+ * @brief Undoes every recorded change, newest first, and frees what the patch added.
+ *
+ * Containers were prepared before they changed, so nothing here allocates.
+ */
+static void rollback(Patcher *p)
+{
+    while (p->count)
+    {
+        UndoRecord *record = &p->log[--p->count];
+        JsonValue *container = record->container;
+        switch (record->kind)
+        {
+        case UNDO_ROOT:
+            *p->root = record->value;
+            break;
+        case UNDO_REPLACE:
+            if (container->type == JSON_ARRAY)
+                container->value.array->items[record->index] = record->value;
+            else
+                container->value.object->pairs[record->index].value = record->value;
+            break;
+        case UNDO_INSERT:
+            if (container->type == JSON_ARRAY)
+            {
+                JsonArray *array = container->value.array;
+                memmove(&array->items[record->index], &array->items[record->index + 1],
+                        sizeof(JsonValue *) * (array->count - record->index - 1));
+                array->count--;
+            }
+            else
+            {
+                /* Inserted members are always last */
+                JsonObject *object = container->value.object;
+                object->count--;
+                if (!p->arena)
+                    json_free(object->pairs[object->count].key);
+            }
+            break;
+        case UNDO_REMOVE:
+            if (container->type == JSON_ARRAY)
+            {
+                JsonArray *array = container->value.array;
+                memmove(&array->items[record->index + 1], &array->items[record->index],
+                        sizeof(JsonValue *) * (array->count - record->index));
+                array->items[record->index] = record->value;
+                array->count++;
+            }
+            else
+            {
+                JsonObject *object = container->value.object;
+                memmove(&object->pairs[record->index + 1], &object->pairs[record->index],
+                        sizeof(JsonPair) * (object->count - record->index));
+                object->pairs[record->index] = record->pair;
+                object->count++;
+            }
+            break;
+        case UNDO_CREATED:
+            json_release(p->arena, record->value);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Frees what the patch replaced or removed from the document.
+ */
+static void commit(Patcher *p)
+{
+    for (size_t i = 0; i < p->count; i++)
+    {
+        UndoRecord *record = &p->log[i];
+        if (record->kind == UNDO_ROOT || record->kind == UNDO_REPLACE)
+            json_release(p->arena, record->value);
+        else if (record->kind == UNDO_REMOVE)
+        {
+            if (!record->moved)
+                json_release(p->arena, record->value);
+            /* Prepared objects own their keys */
+            if (record->container->type == JSON_OBJECT && !p->arena)
+                json_free(record->pair.key);
+        }
+    }
+    p->count = 0;
+}
+
+/**
+ * @brief Finishes applying a patch, keeping or undoing its changes.
+ */
+static int finish(Patcher *p, JsonPatchErrorCode code)
+{
+    if (code == JSON_PATCH_ERROR_NONE)
+        commit(p);
+    else
+        rollback(p);
+    json_free(p->log);
+    json_free(p->token);
+    return code == JSON_PATCH_ERROR_NONE;
+}
+
+/**
+ * @brief Returns a string member of an operation, or NULL if it is missing or not a string.
+ */
+static const char *op_string(const JsonValue *op, const char *name)
+{
+    const JsonValue *member = json_get_value(op, name);
+    return member && member->type == JSON_STRING ? member->value.string : NULL;
+}
+
+/**
+ * @brief Applies one operation of a JSON Patch.
+ */
+static JsonPatchErrorCode apply_operation(Patcher *p, const JsonValue *op)
+{
+    if (op->type != JSON_OBJECT)
+        return JSON_PATCH_ERROR_INVALID;
+    const char *name = op_string(op, "op");
+    const char *path = op_string(op, "path");
+    const JsonValue *value = json_get_value(op, "value");
+    if (!name || !path)
+        return JSON_PATCH_ERROR_INVALID;
+
+    Location loc;
+    JsonValue scratch;
+    JsonValue *removed;
+    JsonPatchErrorCode code;
+
+    if (strcmp(name, "add") == 0 || strcmp(name, "replace") == 0)
+    {
+        int add = name[0] == 'a';
+        if (!value)
+            return JSON_PATCH_ERROR_INVALID;
+        if ((code = locate(p, path, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        if (!add && !target(p, &loc, &scratch))
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        JsonValue *copy = adopt(p, value);
+        if (!copy)
+            return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        return add ? add_at(p, &loc, copy) : replace_at(p, &loc, copy);
+    }
+    if (strcmp(name, "remove") == 0)
+    {
+        if ((code = locate(p, path, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        if (!target(p, &loc, &scratch))
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        return remove_at(p, &loc, &removed);
+    }
+    if (strcmp(name, "test") == 0)
+    {
+        if (!value)
+            return JSON_PATCH_ERROR_INVALID;
+        if ((code = locate(p, path, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        const JsonValue *current = target(p, &loc, &scratch);
+        if (!current)
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        return json_equal(current, value) ? JSON_PATCH_ERROR_NONE : JSON_PATCH_ERROR_TEST_FAILED;
+    }
+
+    const char *from = op_string(op, "from");
+    if (!from)
+        return JSON_PATCH_ERROR_INVALID;
+    if (strcmp(name, "copy") == 0)
+    {
+        if ((code = locate(p, from, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        const JsonValue *source = target(p, &loc, &scratch);
+        if (!source)
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        JsonValue *copy = adopt(p, source);
+        if (!copy)
+            return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        if ((code = locate(p, path, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        return add_at(p, &loc, copy);
+    }
+    if (strcmp(name, "move") == 0)
+    {
+        /* A value cannot be moved into one of its own children */
+        size_t from_length = strlen(from);
+        if (strncmp(path, from, from_length) == 0 && path[from_length] == '/')
+            return JSON_PATCH_ERROR_INVALID;
+        if ((code = locate(p, from, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        if (!target(p, &loc, &scratch))
+            return JSON_PATCH_ERROR_NOT_FOUND;
+        if (strcmp(path, from) == 0)
+            return JSON_PATCH_ERROR_NONE;
+        if ((code = remove_at(p, &loc, &removed)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        p->log[p->count - 1].moved = 1;
+        if ((code = locate(p, path, &loc)) != JSON_PATCH_ERROR_NONE)
+            return code;
+        return add_at(p, &loc, removed);
+    }
+    return JSON_PATCH_ERROR_INVALID;
+}
+
+int json_patch_apply(JsonArena *arena, JsonValue **document, const JsonValue *patch, JsonPatchError *err)
+{
+    Patcher p = {arena, document, NULL, 0, 0, NULL, 0};
+    JsonPatchErrorCode code = JSON_PATCH_ERROR_NONE;
+    size_t i = 0;
+
+    if (!patch || patch->type != JSON_ARRAY ||
+        (patch->value.array->count && (patch->flags & JSON_FLAG_PACKED_NUMBERS)))
+        code = JSON_PATCH_ERROR_INVALID;
+    for (; code == JSON_PATCH_ERROR_NONE && i < patch->value.array->count; i++)
+        code = apply_operation(&p, patch->value.array->items[i]);
+
+    if (err)
+    {
+        err->code = code;
+        err->operation = code == JSON_PATCH_ERROR_NONE ? 0 : (i ? i - 1 : 0);
+    }
+    return finish(&p, code);
+}
+
+/**
+ * @brief Merges an object patch into an object of the document.
+ */
+static JsonPatchErrorCode merge_object(Patcher *p, JsonValue *target_object, const JsonValue *patch)
+{
+    const JsonObject *members = patch->value.object;
+    for (size_t i = 0; i < members->count; i++)
+    {
+        const JsonPair *pair = &members->pairs[i];
+        const JsonValue *value = pair->value;
+        JsonPatchErrorCode code;
+        Location loc = {target_object, SIZE_MAX, pair->key};
+        loc.index = json_object_pair_slot(target_object->value.object, pair, SIZE_MAX);
+
+        if (value->type == JSON_NULL)
+        {
+            JsonValue *removed;
+            if (loc.index != SIZE_MAX && (code = remove_at(p, &loc, &removed)) != JSON_PATCH_ERROR_NONE)
+                return code;
+            continue;
+        }
+
+        JsonValue *member = loc.index != SIZE_MAX ? target_object->value.object->pairs[loc.index].value : NULL;
+        if (value->type == JSON_OBJECT && !(member && member->type == JSON_OBJECT))
+        {
+            /* Merging into an empty object drops the patch's null members */
+            if (!log_reserve(p) || !(member = json_new_object(p->arena)))
+                return JSON_PATCH_ERROR_OUT_OF_MEMORY;
+            log_push(p, UNDO_CREATED, NULL, 0, member);
+            if ((code = add_at(p, &loc, member)) != JSON_PATCH_ERROR_NONE)
+                return code;
+        }
+        if (value->type == JSON_OBJECT)
+            code = merge_object(p, member, value);
+        else
+        {
+            JsonValue *copy = adopt(p, value);
+            code = copy ? add_at(p, &loc, copy) : JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        }
+        if (code != JSON_PATCH_ERROR_NONE)
+            return code;
+    }
+    return JSON_PATCH_ERROR_NONE;
+}
+
+int json_merge_patch(JsonArena *arena, JsonValue **document, const JsonValue *patch)
+{
+    Patcher p = {arena, document, NULL, 0, 0, NULL, 0};
+    Location root = {NULL, SIZE_MAX, ""};
+    JsonPatchErrorCode code = JSON_PATCH_ERROR_NONE;
+
+    if (!patch)
+        return 0;
+    if (patch->type != JSON_OBJECT)
+    {
+        JsonValue *copy = adopt(&p, patch);
+        code = copy ? replace_at(&p, &root, copy) : JSON_PATCH_ERROR_OUT_OF_MEMORY;
+        return finish(&p, code);
+    }
+    if (!*document || (*document)->type != JSON_OBJECT)
+    {
+        JsonValue *object = log_reserve(&p) ? json_new_object(arena) : NULL;
+        if (!object)
+            return finish(&p, JSON_PATCH_ERROR_OUT_OF_MEMORY);
+        log_push(&p, UNDO_CREATED, NULL, 0, object);
+        code = replace_at(&p, &root, object);
+    }
+    if (code == JSON_PATCH_ERROR_NONE)
+        code = merge_object(&p, *document, patch);
+    return finish(&p, code);
+}
+
+typedef struct
+{
+    JsonArena *arena; /**< Arena the patch is allocated from, or NULL. */
+    JsonValue *patch; /**< The operations produced so far. */
+    char *path;       /**< JSON Pointer of the values being compared. */
+    size_t length;    /**< Length of `path`. */
+    size_t capacity;  /**< Bytes allocated for `path`. */
+} Differ;
+
+/**
+ * @brief Appends a reference token to the current path, escaping `~` and `/`.
+ */
+static int path_push(Differ *d, const char *token, size_t length)
+{
+    /* Each byte takes at most two characters, plus the '/' and a terminator */
+    size_t needed = d->length + 2 * length + 2;
+    if (needed > d->capacity)
+    {
+        size_t capacity = d->capacity ? d->capacity : 64;
+        while (capacity < needed)
+            capacity *= 2;
+        char *path = json_realloc(d->path, capacity);
+        if (!path)
+        {
+            ERROR_LOG("Patch: Memory allocation failed for diff path\n");
+            return 0;
+        }
+        d->path = path;
+        d->capacity = capacity;
+    }
+    d->path[d->length++] = '/';
+    for (size_t i = 0; i < length; i++)
+    {
+        if (token[i] == '~' || token[i] == '/')
+        {
+            d->path[d->length++] = '~';
+            d->path[d->length++] = token[i] == '~' ? '0' : '1';
+        }
+        else
+            d->path[d->length++] = token[i];
+    }
+    d->path[d->length] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Appends an array index to the current path.
+ */
+static int path_push_index(Differ *d, size_t index)
+{
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%zu", index);
+    return path_push(d, digits, (size_t)length);
+}
+
+/**
+ * @brief Sets a member of an operation, freeing the value if that fails.
+ */
+static int put_member(JsonArena *arena, JsonValue *op, const char *key, JsonValue *value)
+{
+    if (!value)
+        return 0;
+    if (json_object_set(arena, op, key, value, 0))
+        return 1;
+    json_release(arena, value);
+    return 0;
+}
+
+/**
+ * @brief Appends an operation on the current path to the patch.
+ */
+static int emit(Differ *d, const char *name, const JsonValue *value)
+{
+    JsonValue *op = json_new_object(d->arena);
+    if (!op)
+        return 0;
+    int ok = put_member(d->arena, op, "op", json_new_string(d->arena, name, strlen(name))) &&
+             put_member(d->arena, op, "path", json_new_string(d->arena, d->path ? d->path : "", d->length)) &&
+             (!value || put_member(d->arena, op, "value", json_clone(d->arena, value))) &&
+             json_array_push(d->arena, d->patch, op);
+    if (!ok)
+        json_release(d->arena, op);
+    return ok;
+}
+
+static int diff_value(Differ *d, const JsonValue *from, const JsonValue *to);
+
+/**
+ * @brief Compares two objects member by member.
+ */
+static int diff_object(Differ *d, const JsonObject *from, const JsonObject *to)
+{
+    size_t base = d->length;
+    for (size_t i = 0; i < from->count; i++)
+    {
+        const JsonPair *pair = &from->pairs[i];
+        size_t slot = json_object_pair_slot(to, pair, i);
+        if (!path_push(d, pair->key, json_pair_key_length(pair)))
+            return 0;
+        int ok = slot == SIZE_MAX ? emit(d, "remove", NULL) : diff_value(d, pair->value, to->pairs[slot].value);
+        d->length = base;
+        if (!ok)
+            return 0;
+    }
+    for (size_t i = 0; i < to->count; i++)
+    {
+        const JsonPair *pair = &to->pairs[i];
+        if (json_object_pair_slot(from, pair, i) != SIZE_MAX)
+            continue;
+        if (!path_push(d, pair->key, json_pair_key_length(pair)))
+            return 0;
+        int ok = emit(d, "add", pair->value);
+        d->length = base;
+        if (!ok)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Compares two arrays, past their common prefix and suffix, element by element.
+ */
+static int diff_array(Differ *d, const JsonValue *from, const JsonValue *to)
+{
+    size_t n = from->value.array->count, m = to->value.array->count;
+    size_t shorter = n < m ? n : m;
+    JsonValue scratch_a, scratch_b;
+    size_t start = 0, end = 0;
+    while (start < shorter && json_equal(json_array_item(from, start, &scratch_a), json_array_item(to, start, &scratch_b)))
+        start++;
+    while (end < shorter - start &&
+           json_equal(json_array_item(from, n - 1 - end, &scratch_a), json_array_item(to, m - 1 - end, &scratch_b)))
+        end++;
+
+    size_t base = d->length;
+    size_t common = shorter - start - end;
+    int ok = 1;
+    for (size_t i = start; ok && i < start + common; i++)
+    {
+        ok = path_push_index(d, i) && diff_value(d, json_array_item(from, i, &scratch_a), json_array_item(to, i, &scratch_b));
+        d->length = base;
+    }
+    /* Surplus elements of `from` are removed one by one from the same index */
+    for (size_t i = start + common; ok && i < n - end; i++)
+    {
+        ok = path_push_index(d, start + common) && emit(d, "remove", NULL);
+        d->length = base;
+    }
+    for (size_t i = start + common; ok && i < m - end; i++)
+    {
+        ok = path_push_index(d, i) && emit(d, "add", json_array_item(to, i, &scratch_b));
+        d->length = base;
+    }
+    return ok;
+}
+
+/**
+ * @brief Adds the operations turning `from` into `to` at the current path.
+ */
+static int diff_value(Differ *d, const JsonValue *from, const JsonValue *to)
+{
+    if (from->type == JSON_OBJECT && to->type == JSON_OBJECT)
+        return diff_object(d, from->value.object, to->value.object);
+    if (from->type == JSON_ARRAY && to->type == JSON_ARRAY)
+        return diff_array(d, from, to);
+    return json_equal(from, to) || emit(d, "replace", to);
+}
+
+JsonValue *json_diff(JsonArena *arena, const JsonValue *from, const JsonValue *to)
+{
+    Differ d = {arena, json_new_array(arena), NULL, 0, 0};
+    if (!d.patch || !from || !to)
+    {
+        json_release(arena, d.patch);
+        return NULL;
+    }
+    if (!diff_value(&d, from, to))
+    {
+        json_release(arena, d.patch);
+        d.patch = NULL;
+    }
+    json_free(d.path);
+    return d.patch;
+}
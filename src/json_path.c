@@ -0,0 +1,1367 @@
+#include "json_path.h"
+#include "json_accessor.h"
+#include "json_writer.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include "json_logging.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Initial number of container frames kept by json_path_stream. */
+#define PATH_INITIAL_FRAMES 16
+
+/* The kinds of step. */
+typedef enum
+{
+    STEP_NAME,     /**< An object member with a given key. */
+    STEP_INDEX,    /**< An array element at a given index. */
+    STEP_WILDCARD, /**< Any member or element. */
+    STEP_FILTER    /**< Any member or element for which a filter program is true. */
+} PathStepType;
+
+/* One step of a compiled path. */
+typedef struct
+{
+    PathStepType type;  /**< What the step selects. */
+    int descendant;     /**< Whether the step may match at any depth (`..`). */
+    JsonKey key;        /**< Key for STEP_NAME. */
+    size_t index;       /**< Index for STEP_INDEX. */
+    size_t code;        /**< First instruction of the program, for STEP_FILTER. */
+    size_t code_length; /**< Number of instructions in the program. */
+} PathStep;
+
+/* Filter instructions, run on a stack of operands. */
+typedef enum
+{
+    OP_CURRENT,       /**< Push the value of query `operand`, relative to `@`. */
+    OP_ROOT,          /**< Push the value of query `operand`, relative to `$`. */
+    OP_CONSTANT,      /**< Push constant `operand`. */
+    OP_EXISTS,        /**< Replace the top operand with whether it is present. */
+    OP_NOT,           /**< Negate the top operand. */
+    OP_EQ,            /**< Replace the top two operands with a comparison of them. */
+    OP_NE,            /**< As OP_EQ. */
+    OP_LT,            /**< As OP_EQ. */
+    OP_LE,            /**< As OP_EQ. */
+    OP_GT,            /**< As OP_EQ. */
+    OP_GE,            /**< As OP_EQ. */
+    OP_JUMP_IF_FALSE, /**< Jump to `operand` if the top operand is false; otherwise pop it. */
+    OP_JUMP_IF_TRUE   /**< Jump to `operand` if the top operand is true; otherwise pop it. */
+} PathOp;
+
+/* One filter instruction. */
+typedef struct
+{
+    PathOp op;      /**< The operation. */
+    size_t operand; /**< Query, constant or jump target (relative to the program). */
+} PathInstruction;
+
+/* A singular query inside a filter: a run of name and index steps. */
+typedef struct
+{
+    size_t first; /**< First step in JsonPath::query_steps. */
+    size_t count; /**< Number of steps. */
+} PathQuery;
+
+/* A filter operand: a constant, a queried value, or a logical result. */
+typedef struct
+{
+    int present;           /**< 0 when a query selects nothing. */
+    JsonType type;         /**< Type of the value; JSON_BOOL for logical results. */
+    double number;         /**< Value of a number. */
+    int boolean;           /**< Value of a boolean. */
+    const char *string;    /**< Contents of a string. */
+    size_t length;         /**< Length of `string`. */
+    const JsonValue *node; /**< An array or object, compared by identity. */
+} PathOperand;
+
+struct JsonPath
+{
+    PathStep *steps;           /**< The steps, in order. */
+    size_t count;              /**< Number of steps. */
+    PathStep *query_steps;     /**< Steps of the filters' queries. */
+    size_t query_step_count;   /**< Number of query steps. */
+    PathQuery *queries;        /**< The filters' queries. */
+    size_t query_count;        /**< Number of queries. */
+    PathInstruction *code;     /**< The filters' programs. */
+    size_t code_length;        /**< Number of instructions. */
+    PathOperand *constants;    /**< The filters' constants. */
+    size_t constant_count;     /**< Number of constants. */
+    char *names;               /**< Storage for keys and string constants. */
+    int has_filters;           /**< Whether any step is STEP_FILTER. */
+};
+
+/* Compiler state. */
+typedef struct
+{
+    JsonPath *path;         /**< The path being built. */
+    const char *expression; /**< The whole expression. */
+    const char *p;          /**< The next character. */
+    char *names;            /**< Next free byte of JsonPath::names. */
+    size_t stack;           /**< Operands on the filter stack at this point. */
+    size_t nesting;         /**< Depth of `(` and `!` being parsed. */
+    JsonError *err;         /**< Where to report an error, or NULL. */
+} PathCompiler;
+
+/**
+ * @brief Records a syntax error at a position in the expression.
+ *
+ * @return Always 0, for use in return statements.
+ */
+static int syntax_error(PathCompiler *c, const char *at, JsonErrorCode code)
+{
+    ERROR_LOG("Path: %s at offset %zu\n", json_error_string(code), (size_t)(at - c->expression));
+    if (c->err)
+    {
+        c->err->code = code;
+        c->err->offset = (size_t)(at - c->expression);
+        c->err->line = 1;
+        c->err->column = c->err->offset + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reports an unexpected character, or the end of the expression.
+ */
+static int unexpected(PathCompiler *c)
+{
+    return syntax_error(c, c->p, *c->p ? JSON_ERROR_UNEXPECTED_CHAR : JSON_ERROR_UNEXPECTED_END);
+}
+
+/**
+ * @brief Skips spaces inside a filter.
+ */
+static void skip_spaces(PathCompiler *c)
+{
+    while (*c->p == ' ' || *c->p == '\t')
+        c->p++;
+}
+
+/**
+ * @brief Finishes a key copied to the name storage.
+ */
+static JsonKey finish_key(PathCompiler *c, char *start)
+{
+    JsonKey key;
+    key.str = start;
+    key.length = (size_t)(c->names - start);
+    key.hash = json_hash_key(start, key.length);
+    *c->names++ = '\0';
+    return key;
+}
+
+/**
+ * @brief Parses a quoted name or string; a backslash makes the next
+ *        character literal.
+ */
+static int parse_quoted(PathCompiler *c, JsonKey *key)
+{
+    char quote = *c->p++;
+    char *start = c->names;
+    while (*c->p && *c->p != quote)
+    {
+        if (*c->p == '\\' && c->p[1])
+            c->p++;
+        *c->names++ = *c->p++;
+    }
+    if (!*c->p)
+        return unexpected(c);
+    c->p++;
+    *key = finish_key(c, start);
+    return 1;
+}
+
+/**
+ * @brief Parses a non-negative array index.
+ */
+static int parse_index(PathCompiler *c, size_t *index)
+{
+    *index = 0;
+    while (*c->p >= '0' && *c->p <= '9')
+    {
+        size_t digit = (size_t)(*c->p - '0');
+        if (*index > (SIZE_MAX - digit) / 10)
+            return syntax_error(c, c->p, JSON_ERROR_INVALID_NUMBER);
+        *index = *index * 10 + digit;
+        c->p++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks whether a character may appear in an unquoted name.
+ */
+static int is_name_char(char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_' ||
+           (unsigned char)ch >= 0x80;
+}
+
+/**
+ * @brief Appends an instruction to the program.
+ *
+ * @return Offset of the instruction.
+ */
+static size_t emit(PathCompiler *c, PathOp op, size_t operand)
+{
+    c->path->code[c->path->code_length].op = op;
+    c->path->code[c->path->code_length].operand = operand;
+    return c->path->code_length++;
+}
+
+/**
+ * @brief Accounts for an operand pushed by the program.
+ */
+static int push_operand(PathCompiler *c)
+{
+    if (++c->stack > JSON_PATH_MAX_STACK)
+        return syntax_error(c, c->p, JSON_ERROR_TOO_DEEP);
+    return 1;
+}
+
+/**
+ * @brief Parses the steps of a singular query after `@` or `$`.
+ */
+static int parse_query(PathCompiler *c, size_t *query)
+{
+    JsonPath *path = c->path;
+    PathQuery *q = &path->queries[path->query_count];
+    q->first = path->query_step_count;
+    q->count = 0;
+
+    while (*c->p == '.' || *c->p == '[')
+    {
+        PathStep step;
+        memset(&step, 0, sizeof(step));
+        if (*c->p == '.')
+        {
+            c->p++;
+            char *start = c->names;
+            while (is_name_char(*c->p))
+                *c->names++ = *c->p++;
+            if (c->names == start)
+                return unexpected(c);
+            step.type = STEP_NAME;
+            step.key = finish_key(c, start);
+        }
+        else
+        {
+            c->p++;
+            if (*c->p == '\'' || *c->p == '"')
+            {
+                step.type = STEP_NAME;
+                if (!parse_quoted(c, &step.key))
+                    return 0;
+            }
+            else if (*c->p >= '0' && *c->p <= '9')
+            {
+                step.type = STEP_INDEX;
+                if (!parse_index(c, &step.index))
+                    return 0;
+            }
+            else
+            {
+                return unexpected(c);
+            }
+            if (*c->p != ']')
+                return unexpected(c);
+            c->p++;
+        }
+        path->query_steps[path->query_step_count++] = step;
+        q->count++;
+    }
+    *query = path->query_count++;
+    return 1;
+}
+
+/**
+ * @brief Parses a filter operand and emits the instruction pushing it.
+ */
+static int parse_operand(PathCompiler *c)
+{
+    JsonPath *path = c->path;
+    skip_spaces(c);
+    if (!push_operand(c))
+        return 0;
+
+    if (*c->p == '@' || *c->p == '$')
+    {
+        PathOp op = *c->p == '@' ? OP_CURRENT : OP_ROOT;
+        size_t query;
+        c->p++;
+        if (!parse_query(c, &query))
+            return 0;
+        emit(c, op, query);
+        return 1;
+    }
+
+    PathOperand *constant = &path->constants[path->constant_count];
+    memset(constant, 0, sizeof(*constant));
+    constant->present = 1;
+    if (*c->p == '\'' || *c->p == '"')
+    {
+        JsonKey text;
+        if (!parse_quoted(c, &text))
+            return 0;
+        constant->type = JSON_STRING;
+        constant->string = text.str;
+        constant->length = text.length;
+    }
+    else if (*c->p == '-' || (*c->p >= '0' && *c->p <= '9'))
+    {
+        const char *start = c->p;
+        if (*c->p == '-')
+            c->p++;
+        if (*c->p < '0' || *c->p > '9')
+            return syntax_error(c, start, JSON_ERROR_INVALID_NUMBER);
+        while (*c->p >= '0' && *c->p <= '9')
+            c->p++;
+        if (*c->p == '.')
+        {
+            c->p++;
+            if (*c->p < '0' || *c->p > '9')
+                return syntax_error(c, start, JSON_ERROR_INVALID_NUMBER);
+            while (*c->p >= '0' && *c->p <= '9')
+                c->p++;
+        }
+        if (*c->p == 'e' || *c->p == 'E')
+        {
+            c->p++;
+            if (*c->p == '+' || *c->p == '-')
+                c->p++;
+            if (*c->p < '0' || *c->p > '9')
+                return syntax_error(c, start, JSON_ERROR_INVALID_NUMBER);
+            while (*c->p >= '0' && *c->p <= '9')
+                c->p++;
+        }
+        constant->type = JSON_NUMBER;
+        constant->number = json_number_from_range(start, (size_t)(c->p - start));
+    }
+    else if (strncmp(c->p, "true", 4) == 0 || strncmp(c->p, "false", 5) == 0)
+    {
+        constant->type = JSON_BOOL;
+        constant->boolean = *c->p == 't';
+        c->p += constant->boolean ? 4 : 5;
+    }
+    else if (strncmp(c->p, "null", 4) == 0)
+    {
+        constant->type = JSON_NULL;
+        c->p += 4;
+    }
+    else
+    {
+        return unexpected(c);
+    }
+    emit(c, OP_CONSTANT, path->constant_count++);
+    return 1;
+}
+
+static int parse_or(PathCompiler *c);
+
+/**
+ * @brief Parses a negation, a parenthesized expression, a comparison or an
+ *        existence test.
+ */
+static int parse_unary(PathCompiler *c)
+{
+    skip_spaces(c);
+    if (*c->p == '!' || *c->p == '(')
+    {
+        if (++c->nesting > JSON_PATH_MAX_STACK)
+            return syntax_error(c, c->p, JSON_ERROR_TOO_DEEP);
+        if (*c->p++ == '!')
+        {
+            if (!parse_unary(c))
+                return 0;
+            emit(c, OP_NOT, 0);
+        }
+        else
+        {
+            if (!parse_or(c))
+                return 0;
+            skip_spaces(c);
+            if (*c->p != ')')
+                return unexpected(c);
+            c->p++;
+        }
+        c->nesting--;
+        return 1;
+    }
+
+    if (!parse_operand(c))
+        return 0;
+    skip_spaces(c);
+
+    PathOp op;
+    const char *p = c->p;
+    if (p[0] == '=' && p[1] == '=')
+        op = OP_EQ;
+    else if (p[0] == '!' && p[1] == '=')
+        op = OP_NE;
+    else if (p[0] == '<')
+        op = p[1] == '=' ? OP_LE : OP_LT;
+    else if (p[0] == '>')
+        op = p[1] == '=' ? OP_GE : OP_GT;
+    else
+    {
+        /* A literal is always present, so as in RFC 9535 only queries may stand alone */
+        if (c->path->code[c->path->code_length - 1].op == OP_CONSTANT)
+            return unexpected(c);
+        emit(c, OP_EXISTS, 0);
+        return 1;
+    }
+    c->p += (op == OP_LT || op == OP_GT) ? 1 : 2;
+    if (!parse_operand(c))
+        return 0;
+    emit(c, op, 0);
+    c->stack--;
+    return 1;
+}
+
+/**
+ * @brief Parses operands joined by `&&`, jumping past the rest once one is false.
+ */
+static int parse_and(PathCompiler *c)
+{
+    if (!parse_unary(c))
+        return 0;
+    while (1)
+    {
+        skip_spaces(c);
+        if (c->p[0] != '&' || c->p[1] != '&')
+            return 1;
+        c->p += 2;
+        size_t jump = emit(c, OP_JUMP_IF_FALSE, 0);
+        c->stack--;
+        if (!parse_unary(c))
+            return 0;
+        c->path->code[jump].operand = c->path->code_length;
+    }
+}
+
+/**
+ * @brief Parses operands joined by `||`, jumping past the rest once one is true.
+ */
+static int parse_or(PathCompiler *c)
+{
+    if (!parse_and(c))
+        return 0;
+    while (1)
+    {
+        skip_spaces(c);
+        if (c->p[0] != '|' || c->p[1] != '|')
+            return 1;
+        c->p += 2;
+        size_t jump = emit(c, OP_JUMP_IF_TRUE, 0);
+        c->stack--;
+        if (!parse_and(c))
+            return 0;
+        c->path->code[jump].operand = c->path->code_length;
+    }
+}
+
+/**
+ * @brief Parses a filter `?...` up to its closing bracket.
+ */
+static int parse_filter(PathCompiler *c, PathStep *step)
+{
+    JsonPath *path = c->path;
+    step->type = STEP_FILTER;
+    step->code = path->code_length;
+    c->stack = 0;
+    c->nesting = 0;
+    if (!parse_or(c))
+        return 0;
+    skip_spaces(c);
+
+    /* Jump targets were recorded as absolute offsets; make them relative */
+    step->code_length = path->code_length - step->code;
+    for (size_t i = step->code; i < path->code_length; i++)
+    {
+        if (path->code[i].op == OP_JUMP_IF_FALSE || path->code[i].op == OP_JUMP_IF_TRUE)
+            path->code[i].operand -= step->code;
+    }
+    path->has_filters = 1;
+    return 1;
+}
+
+/**
+ * @brief Parses one step of the path.
+ */
+static int parse_step(PathCompiler *c, PathStep *step)
+{
+    memset(step, 0, sizeof(*step));
+    if (*c->p == '.')
+    {
+        c->p++;
+        if (*c->p == '.')
+        {
+            step->descendant = 1;
+            c->p++;
+        }
+    }
+    else if (*c->p != '[')
+    {
+        return unexpected(c);
+    }
+
+    if (*c->p == '[')
+    {
+        c->p++;
+        if (*c->p == '*')
+        {
+            step->type = STEP_WILDCARD;
+            c->p++;
+        }
+        else if (*c->p >= '0' && *c->p <= '9')
+        {
+            step->type = STEP_INDEX;
+            if (!parse_index(c, &step->index))
+                return 0;
+        }
+        else if (*c->p == '\'' || *c->p == '"')
+        {
+            step->type = STEP_NAME;
+            if (!parse_quoted(c, &step->key))
+                return 0;
+        }
+        else if (*c->p == '?')
+        {
+            c->p++;
+            if (!parse_filter(c, step))
+                return 0;
+        }
+        else
+        {
+            return unexpected(c);
+        }
+        if (*c->p != ']')
+            return unexpected(c);
+        c->p++;
+    }
+    else if (*c->p == '*')
+    {
+        step->type = STEP_WILDCARD;
+        c->p++;
+    }
+    else
+    {
+        char *start = c->names;
+        while (is_name_char(*c->p))
+            *c->names++ = *c->p++;
+        if (c->names == start)
+            return unexpected(c);
+        step->type = STEP_NAME;
+        step->key = finish_key(c, start);
+    }
+    return 1;
+}
+
+void json_path_free(JsonPath *path)
+{
+    if (!path)
+        return;
+    json_free(path->steps);
+    json_free(path->query_steps);
+    json_free(path->queries);
+    json_free(path->code);
+    json_free(path->constants);
+    json_free(path->names);
+    json_free(path);
+}
+
+JsonPath *json_path_compile(const char *expression, JsonError *err)
+{
+    if (err)
+        memset(err, 0, sizeof(*err));
+
+    JsonPath *path = json_alloc(sizeof(JsonPath));
+    if (path)
+    {
+        /* Every step, query, operand and key takes at least one byte of the expression */
+        size_t length = strlen(expression) + 1;
+        memset(path, 0, sizeof(JsonPath));
+        path->steps = json_alloc(length * sizeof(PathStep));
+        path->query_steps = json_alloc(length * sizeof(PathStep));
+        path->queries = json_alloc(length * sizeof(PathQuery));
+        path->code = json_alloc(2 * length * sizeof(PathInstruction));
+        path->constants = json_alloc(length * sizeof(PathOperand));
+        path->names = json_alloc(2 * length);
+    }
+    if (!path || !path->steps || !path->query_steps || !path->queries || !path->code || !path->constants ||
+        !path->names)
+    {
+        ERROR_LOG("Path: Memory allocation failed for path\n");
+        json_path_free(path);
+        return NULL;
+    }
+
+    PathCompiler c;
+    c.path = path;
+    c.expression = expression;
+    c.p = expression;
+    c.names = path->names;
+    c.stack = 0;
+    c.nesting = 0;
+    c.err = err;
+
+    if (*c.p != '$')
+    {
+        unexpected(&c);
+        json_path_free(path);
+        return NULL;
+    }
+    c.p++;
+
+    while (*c.p)
+    {
+        const char *start = c.p;
+        PathStep step;
+        if (!parse_step(&c, &step))
+        {
+            json_path_free(path);
+            return NULL;
+        }
+        if (path->count == JSON_PATH_MAX_STEPS)
+        {
+            syntax_error(&c, start, JSON_ERROR_TOO_DEEP);
+            json_path_free(path);
+            return NULL;
+        }
+        path->steps[path->count++] = step;
+    }
+    return path;
+}
+
+/**
+ * @brief Runs the path's automaton across one member or element.
+ *
+ * State `i` means the first `i` steps have matched the keys and indices on
+ * the way to a value; state `count` means the whole path has.
+ *
+ * @param[in] path   The compiled path.
+ * @param[in] states States live at the container.
+ * @param[in] key    The member's key, or NULL for an array element.
+ * @param[in] length Length of `key`.
+ * @param[in] index  The element's index (ignored for members).
+ * @return States live at the member or element.
+ */
+static uint64_t path_step(const JsonPath *path, uint64_t states, const char *key, size_t length, size_t index)
+{
+    uint64_t next = 0;
+    for (; states; states &= states - 1)
+    {
+        size_t i = (size_t)__builtin_ctzll(states);
+        if (i == path->count)
+            continue;
+        const PathStep *step = &path->steps[i];
+        if (step->descendant)
+            next |= (uint64_t)1 << i;
+
+        int matches;
+        switch (step->type)
+        {
+        case STEP_NAME:
+            matches = key && step->key.length == length && memcmp(step->key.str, key, length) == 0;
+            break;
+        case STEP_INDEX:
+            matches = !key && step->index == index;
+            break;
+        default:
+            matches = 1;
+            break;
+        }
+        if (matches)
+            next |= (uint64_t)1 << (i + 1);
+    }
+    return next;
+}
+
+/* Streaming state for one open container. */
+typedef struct
+{
+    uint64_t states; /**< States live at the container. */
+    size_t index;    /**< Index of the current element, for arrays. */
+    size_t capture;  /**< Offset of the container's text in the capture buffer, or SIZE_MAX if it is not a match. */
+    int is_object;   /**< Whether the container is an object. */
+} PathFrame;
+
+/* Streaming evaluator state. */
+typedef struct
+{
+    const JsonPath *path;      /**< The compiled path. */
+    JsonStream stream;         /**< Token source. */
+    JsonPathCallback callback; /**< Receives matches. */
+    void *context;             /**< Context pointer for `callback`. */
+    JsonTokenType token;       /**< Type of the current token. */
+    const char *text;          /**< Text of the current token. */
+    size_t length;             /**< Length of the current token's text. */
+    PathFrame *frames;         /**< The open containers. */
+    size_t depth;              /**< Number of open containers. */
+    size_t frames_capacity;    /**< Number of frames allocated. */
+    JsonWriter capture;        /**< Text of the matches being read. */
+    size_t captures;           /**< Number of matches being read. */
+    size_t token_start;        /**< Offset of the current token in the capture buffer. */
+    char *decoded;             /**< Buffer for decoded keys. */
+    size_t decoded_capacity;   /**< Number of bytes allocated for `decoded`. */
+    int stopped;               /**< Set once the callback asks to stop. */
+} PathStreamer;
+
+/**
+ * @brief Writes a token as compact JSON text.
+ */
+static void write_token(JsonWriter *writer, JsonTokenType token, const char *text, size_t length)
+{
+    switch (token)
+    {
+    case TOKEN_STRING:
+        json_writer_putc(writer, '\"');
+        json_writer_write(writer, text, length);
+        json_writer_putc(writer, '\"');
+        break;
+    case TOKEN_NUMBER:
+        json_writer_write(writer, text, length);
+        break;
+    case TOKEN_TRUE:
+        json_writer_write(writer, "true", 4);
+        break;
+    case TOKEN_FALSE:
+        json_writer_write(writer, "false", 5);
+        break;
+    case TOKEN_NULL:
+        json_writer_write(writer, "null", 4);
+        break;
+    case TOKEN_LEFT_BRACE:
+        json_writer_putc(writer, '{');
+        break;
+    case TOKEN_RIGHT_BRACE:
+        json_writer_putc(writer, '}');
+        break;
+    case TOKEN_LEFT_BRACKET:
+        json_writer_putc(writer, '[');
+        break;
+    case TOKEN_RIGHT_BRACKET:
+        json_writer_putc(writer, ']');
+        break;
+    case TOKEN_COMMA:
+        json_writer_putc(writer, ',');
+        break;
+    case TOKEN_COLON:
+        json_writer_putc(writer, ':');
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Grows the buffer for decoded keys to hold at least `size` bytes.
+ *
+ * @return 1 on success, 0 on allocation failure.
+ */
+static int reserve_decoded(PathStreamer *s, size_t size)
+{
+    if (size <= s->decoded_capacity)
+        return 1;
+    char *decoded = json_realloc(s->decoded, size);
+    if (!decoded)
+    {
+        ERROR_LOG("Path: Memory allocation failed for key buffer\n");
+        return 0;
+    }
+    s->decoded = decoded;
+    s->decoded_capacity = size;
+    return 1;
+}
+
+/**
+ * @brief Checks the current token before it is copied into a match.
+ *
+ * The stream's tokenizer is lax about numbers and lets raw control
+ * characters and bad escapes through in strings, none of which may reach
+ * the compact JSON text handed to the callback.
+ *
+ * @return 1 if the token is well formed, 0 if it is malformed or
+ *         allocation fails.
+ */
+static int check_token(PathStreamer *s)
+{
+    if (s->token == TOKEN_NUMBER)
+        return json_number_length(s->text, s->length) == s->length;
+    if (s->token != TOKEN_STRING)
+        return 1;
+    if (json_has_control_chars(s->text, s->length))
+        return 0;
+    if (!s->stream.escaped)
+        return 1;
+    return reserve_decoded(s, s->length + 1) && json_unescape(s->text, s->length, s->decoded) != SIZE_MAX;
+}
+
+/**
+ * @brief Advances to the next token, copying it to the capture buffer while
+ *        a match is being read.
+ *
+ * A malformed token inside a match is turned into TOKEN_ERROR.
+ */
+static void streamer_advance(PathStreamer *s)
+{
+    s->token = json_stream_next(&s->stream, &s->text, &s->length);
+    if (s->captures)
+    {
+        if (!check_token(s))
+        {
+            s->token = TOKEN_ERROR;
+            return;
+        }
+        s->token_start = s->capture.length;
+        write_token(&s->capture, s->token, s->text, s->length);
+    }
+}
+
+/**
+ * @brief Starts capturing at the current token, which begins a match.
+ *
+ * @return Offset of the match in the capture buffer.
+ */
+static size_t begin_capture(PathStreamer *s)
+{
+    /* Inside another match the token has already been copied */
+    if (s->captures++)
+        return s->token_start;
+    write_token(&s->capture, s->token, s->text, s->length);
+    return 0;
+}
+
+/**
+ * @brief Delivers a complete match and closes its capture.
+ *
+ * @return 1 to continue, 0 if the callback stopped the evaluation or the
+ *         capture buffer could not be allocated.
+ */
+static int end_capture(PathStreamer *s, size_t start)
+{
+    int more = 0;
+    if (s->capture.failed)
+        ERROR_LOG("Path: Memory allocation failed for match buffer\n");
+    else if (!(more = s->callback(s->context, s->capture.data + start, s->capture.length - start)))
+        s->stopped = 1;
+    if (--s->captures == 0)
+        s->capture.length = 0;
+    return more;
+}
+
+/**
+ * @brief Reads one value and, if it is an array or object, opens it.
+ *
+ * @param[in,out] s      Pointer to the PathStreamer; the current token
+ *                       starts the value.
+ * @param[in]     states States live at the value.
+ * @return 1 if the value is complete (a scalar, an empty or skipped
+ *         container), 2 if a container was opened, 0 on failure or stop.
+ */
+static int enter_value(PathStreamer *s, uint64_t states)
+{
+    const JsonPath *path = s->path;
+    uint64_t done = (uint64_t)1 << path->count;
+    int matched = (states & done) != 0;
+    states &= ~done;
+
+    switch (s->token)
+    {
+    case TOKEN_LEFT_BRACE:
+    case TOKEN_LEFT_BRACKET:
+    {
+        int is_object = s->token == TOKEN_LEFT_BRACE;
+        if (!matched && !states && !s->captures)
+            return json_stream_skip(&s->stream);
+
+        if (s->depth == JSON_STREAM_MAX_DEPTH)
+        {
+            ERROR_LOG("Path: Nesting deeper than %d\n", JSON_STREAM_MAX_DEPTH);
+            return 0;
+        }
+        if (s->depth == s->frames_capacity)
+        {
+            size_t capacity = s->frames_capacity ? s->frames_capacity * 2 : PATH_INITIAL_FRAMES;
+            PathFrame *frames = json_realloc(s->frames, capacity * sizeof(PathFrame));
+            if (!frames)
+            {
+                ERROR_LOG("Path: Memory allocation failed for container stack\n");
+                return 0;
+            }
+            s->frames = frames;
+            s->frames_capacity = capacity;
+        }
+        PathFrame *frame = &s->frames[s->depth++];
+        frame->states = states;
+        frame->index = 0;
+        frame->is_object = is_object;
+        frame->capture = matched ? begin_capture(s) : SIZE_MAX;
+        return 2;
+    }
+    case TOKEN_STRING:
+    case TOKEN_NUMBER:
+    case TOKEN_TRUE:
+    case TOKEN_FALSE:
+    case TOKEN_NULL:
+        if (!matched)
+            return 1;
+        /* Inside another match the token was checked as it was copied */
+        if (!s->captures && !check_token(s))
+            return 0;
+        return end_capture(s, begin_capture(s));
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Reads the key and colon of the next member of the innermost object.
+ *
+ * @param[in,out] s      Pointer to the PathStreamer; the current token is
+ *                       the key.
+ * @param[out]    states Receives the states live at the member's value.
+ * @return 1 on success, 0 if the key or colon is missing or invalid.
+ */
+static int read_key(PathStreamer *s, uint64_t *states)
+{
+    if (s->token != TOKEN_STRING)
+        return 0;
+    PathFrame *frame = &s->frames[s->depth - 1];
+    *states = 0;
+    if (frame->states)
+    {
+        const char *key = s->text;
+        size_t length = s->length;
+        if (s->stream.escaped)
+        {
+            if (!reserve_decoded(s, length + 1))
+                return 0;
+            length = json_unescape(key, length, s->decoded);
+            if (length == SIZE_MAX)
+                return 0;
+            key = s->decoded;
+        }
+        *states = path_step(s->path, frame->states, key, length, 0);
+    }
+
+    streamer_advance(s);
+    if (s->token != TOKEN_COLON)
+        return 0;
+    streamer_advance(s);
+    return 1;
+}
+
+/**
+ * @brief Reads the whole document, delivering matches.
+ *
+ * @return 1 on success or stop, 0 on malformed input or failure.
+ */
+static int stream_document(PathStreamer *s)
+{
+    uint64_t states = 1; /* Only state 0 is live at the root */
+    streamer_advance(s);
+
+    while (1)
+    {
+        /* A value is expected */
+        int entered = enter_value(s, states);
+        if (!entered)
+            return s->stopped;
+        if (entered == 2)
+        {
+            PathFrame *frame = &s->frames[s->depth - 1];
+            streamer_advance(s);
+            if (s->token != (frame->is_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+            {
+                if (frame->is_object)
+                {
+                    if (!read_key(s, &states))
+                        return 0;
+                }
+                else
+                {
+                    states = frame->states ? path_step(s->path, frame->states, NULL, 0, 0) : 0;
+                }
+                continue;
+            }
+
+            /* Empty container */
+            s->depth--;
+            if (frame->capture != SIZE_MAX && !end_capture(s, frame->capture))
+                return s->stopped;
+        }
+
+        /* A value is complete: close containers until one continues */
+        while (1)
+        {
+            streamer_advance(s);
+            if (s->depth == 0)
+                return s->token == TOKEN_EOF;
+
+            PathFrame *frame = &s->frames[s->depth - 1];
+            if (s->token == (frame->is_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+            {
+                s->depth--;
+                if (frame->capture != SIZE_MAX && !end_capture(s, frame->capture))
+                    return s->stopped;
+                continue;
+            }
+            if (s->token != TOKEN_COMMA)
+                return 0;
+            streamer_advance(s);
+            if (frame->is_object)
+            {
+                if (!read_key(s, &states))
+                    return 0;
+            }
+            else
+            {
+                frame->index++;
+                states = frame->states ? path_step(s->path, frame->states, NULL, 0, frame->index) : 0;
+            }
+            break;
+        }
+    }
+}
+
+int json_path_stream(const JsonPath *path, const JsonReader *reader, JsonPathCallback callback, void *context)
+{
+    if (path->has_filters)
+    {
+        ERROR_LOG("Path: Filters cannot be evaluated over a stream\n");
+        return 0;
+    }
+
+    PathStreamer s;
+    s.path = path;
+    json_stream_init(&s.stream, reader);
+    s.callback = callback;
+    s.context = context;
+    s.token = TOKEN_NONE;
+    s.text = NULL;
+    s.length = 0;
+    s.frames = NULL;
+    s.depth = 0;
+    s.frames_capacity = 0;
+    json_writer_init(&s.capture);
+    s.captures = 0;
+    s.token_start = 0;
+    s.decoded = NULL;
+    s.decoded_capacity = 0;
+    s.stopped = 0;
+
+    int ok = stream_document(&s);
+    if (!ok)
+        ERROR_LOG("Path: Malformed input near offset %zu\n", json_stream_offset(&s.stream));
+
+    json_stream_free(&s.stream);
+    json_writer_free(&s.capture);
+    json_free(s.frames);
+    json_free(s.decoded);
+    return ok;
+}
+
+/* DOM evaluator state. */
+typedef struct
+{
+    const JsonPath *path;           /**< The compiled path. */
+    const JsonValue *root;          /**< The document, for `$` in filters. */
+    JsonPathValueCallback callback; /**< Receives matches, or NULL. */
+    void *context;                  /**< Context pointer for `callback`. */
+    size_t count;                   /**< Number of matches delivered. */
+} PathEval;
+
+/**
+ * @brief Returns the number of children of an array or object, 0 otherwise.
+ */
+static size_t child_count(const JsonValue *value)
+{
+    if (value->type == JSON_ARRAY)
+        return value->value.array->count;
+    if (value->type == JSON_OBJECT)
+        return value->value.object->count;
+    return 0;
+}
+
+/**
+ * @brief Returns child `i` of an array or object.
+ *
+ * Items of a packed numeric array have no JsonValue of their own, so they
+ * are written to `scratch`.
+ */
+static const JsonValue *child_at(const JsonValue *value, size_t i, JsonValue *scratch)
+{
+    if (value->type == JSON_OBJECT)
+        return value->value.object->pairs[i].value;
+    return json_array_item(value, i, scratch);
+}
+
+/**
+ * @brief Describes a value as a filter operand.
+ */
+static void operand_from_value(const JsonValue *value, PathOperand *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!value)
+        return;
+    out->present = 1;
+    out->type = value->type;
+    switch (value->type)
+    {
+    case JSON_NUMBER:
+        out->number = value->value.number;
+        break;
+    case JSON_BOOL:
+        out->boolean = value->value.boolean != 0;
+        break;
+    case JSON_STRING:
+        out->string = value->value.string;
+        out->length = strlen(value->value.string);
+        break;
+    case JSON_ARRAY:
+    case JSON_OBJECT:
+        out->node = value;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Resolves a filter's singular query to an operand.
+ */
+static void resolve_query(const JsonPath *path, const PathQuery *query, const JsonValue *value, PathOperand *out)
+{
+    JsonValue scratch;
+    for (size_t i = 0; i < query->count && value; i++)
+    {
+        const PathStep *step = &path->query_steps[query->first + i];
+        if (step->type == STEP_NAME)
+            value = value->type == JSON_OBJECT ? json_get_value_k(value, step->key) : NULL;
+        else if (value->type == JSON_ARRAY && step->index < value->value.array->count)
+            value = child_at(value, step->index, &scratch);
+        else
+            value = NULL;
+    }
+    operand_from_value(value, out);
+}
+
+/**
+ * @brief Sets an operand to a logical result.
+ */
+static void set_bool(PathOperand *operand, int result)
+{
+    memset(operand, 0, sizeof(*operand));
+    operand->present = 1;
+    operand->type = JSON_BOOL;
+    operand->boolean = result;
+}
+
+/**
+ * @brief Checks two operands for equality.
+ *
+ * Two missing operands are equal. Arrays and objects are only equal to
+ * themselves.
+ */
+static int operands_equal(const PathOperand *a, const PathOperand *b)
+{
+    if (!a->present || !b->present)
+        return a->present == b->present;
+    if (a->type != b->type)
+        return 0;
+    switch (a->type)
+    {
+    case JSON_NUMBER:
+        return a->number == b->number;
+    case JSON_BOOL:
+        return a->boolean == b->boolean;
+    case JSON_STRING:
+        return a->length == b->length && memcmp(a->string, b->string, a->length) == 0;
+    case JSON_NULL:
+        return 1;
+    default:
+        return a->node == b->node;
+    }
+}
+
+/**
+ * @brief Checks whether `a` orders before `b`. Only numbers and strings
+ *        (compared bytewise) are ordered.
+ */
+static int operand_less(const PathOperand *a, const PathOperand *b)
+{
+    if (!a->present || !b->present || a->type != b->type)
+        return 0;
+    if (a->type == JSON_NUMBER)
+        return a->number < b->number;
+    if (a->type == JSON_STRING)
+    {
+        size_t length = a->length < b->length ? a->length : b->length;
+        int order = memcmp(a->string, b->string, length);
+        return order < 0 || (order == 0 && a->length < b->length);
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs a filter step's program with `@` bound to a value.
+ *
+ * @return Whether the filter selects the value.
+ */
+static int run_filter(const PathEval *e, const PathStep *step, const JsonValue *current)
+{
+    const JsonPath *path = e->path;
+    const PathInstruction *code = path->code + step->code;
+    PathOperand stack[JSON_PATH_MAX_STACK];
+    size_t top = 0;
+
+    for (size_t pc = 0; pc < step->code_length;)
+    {
+        const PathInstruction *in = &code[pc++];
+        switch (in->op)
+        {
+        case OP_CURRENT:
+            resolve_query(path, &path->queries[in->operand], current, &stack[top++]);
+            break;
+        case OP_ROOT:
+            resolve_query(path, &path->queries[in->operand], e->root, &stack[top++]);
+            break;
+        case OP_CONSTANT:
+            stack[top++] = path->constants[in->operand];
+            break;
+        case OP_EXISTS:
+            set_bool(&stack[top - 1], stack[top - 1].present);
+            break;
+        case OP_NOT:
+            set_bool(&stack[top - 1], !stack[top - 1].boolean);
+            break;
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_IF_TRUE:
+            if (stack[top - 1].boolean == (in->op == OP_JUMP_IF_TRUE))
+                pc = in->operand;
+            else
+                top--;
+            break;
+        default:
+        {
+            const PathOperand *b = &stack[--top];
+            PathOperand *a = &stack[top - 1];
+            int result;
+            switch (in->op)
+            {
+            case OP_EQ:
+                result = operands_equal(a, b);
+                break;
+            case OP_NE:
+                result = !operands_equal(a, b);
+                break;
+            case OP_LT:
+                result = operand_less(a, b);
+                break;
+            case OP_LE:
+                result = operand_less(a, b) || operands_equal(a, b);
+                break;
+            case OP_GT:
+                result = operand_less(b, a);
+                break;
+            default:
+                result = operand_less(b, a) || operands_equal(a, b);
+                break;
+            }
+            set_bool(a, result);
+            break;
+        }
+        }
+    }
+    return stack[0].boolean;
+}
+
+static int eval_step(PathEval *e, const JsonValue *value, size_t i);
+
+/**
+ * @brief Applies step `i` to the children of a value, continuing with the
+ *        next step from each child it selects.
+ *
+ * @return 1 to continue, 0 once the callback has asked to stop.
+ */
+static int select_children(PathEval *e, const JsonValue *value, size_t i)
+{
+    const PathStep *step = &e->path->steps[i];
+    JsonValue scratch;
+    switch (step->type)
+    {
+    case STEP_NAME:
+    {
+        const JsonValue *child = value->type == JSON_OBJECT ? json_get_value_k(value, step->key) : NULL;
+        return child ? eval_step(e, child, i + 1) : 1;
+    }
+    case STEP_INDEX:
+        if (value->type == JSON_ARRAY && step->index < value->value.array->count)
+            return eval_step(e, child_at(value, step->index, &scratch), i + 1);
+        return 1;
+    default:
+    {
+        size_t count = child_count(value);
+        for (size_t j = 0; j < count; j++)
+        {
+            const JsonValue *child = child_at(value, j, &scratch);
+            if (step->type == STEP_FILTER && !run_filter(e, step, child))
+                continue;
+            if (!eval_step(e, child, i + 1))
+                return 0;
+        }
+        return 1;
+    }
+    }
+}
+
+/**
+ * @brief Applies a `..` step to a value and every value below it, in
+ *        document order.
+ */
+static int select_descendants(PathEval *e, const JsonValue *value, size_t i)
+{
+    if (!select_children(e, value, i))
+        return 0;
+    size_t count = child_count(value);
+    for (size_t j = 0; j < count; j++)
+    {
+        JsonValue scratch;
+        const JsonValue *child = child_at(value, j, &scratch);
+        if ((child->type == JSON_ARRAY || child->type == JSON_OBJECT) && !select_descendants(e, child, i))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Evaluates the steps from `i` on, starting at a value.
+ *
+ * @return 1 to continue, 0 once the callback has asked to stop.
+ */
+static int eval_step(PathEval *e, const JsonValue *value, size_t i)
+{
+    if (i == e->path->count)
+    {
+        e->count++;
+        return !e->callback || e->callback(e->context, value);
+    }
+    if (e->path->steps[i].descendant)
+        return select_descendants(e, value, i);
+    return select_children(e, value, i);
+}
+
+size_t json_path_eval(const JsonPath *path, const JsonValue *root, JsonPathValueCallback callback, void *context)
+{
+    if (!path || !root)
+        return 0;
+    PathEval e;
+    e.path = path;
+    e.root = root;
+    e.callback = callback;
+    e.context = context;
+    e.count = 0;
+    eval_step(&e, root, 0);
+    return e.count;
+}
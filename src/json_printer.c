@@ -1,123 +1,209 @@
 #include "json_printer.h"
 #include <stdio.h>
+#include <string.h>
+
+/* Default indent characters per nesting level. */
+#define PRINTER_DEFAULT_INDENT_WIDTH 2
+
+/* Runs that indentation is copied from, a chunk at a time. */
+static const char spaces[] = "                                                                ";
+static const char tabs[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+/* Printer state: the output and the indentation layout. */
+typedef struct
+{
+    JsonWriter *writer; /**< The writer receiving the output. */
+    const char *run;    /**< Precomputed run of the indent character. */
+    size_t run_length;  /**< Length of `run`. */
+    size_t width;       /**< Indent characters per nesting level. */
+    size_t base;        /**< Indent characters before every line. */
+} Printer;
 
 /**
- * @brief Prints indentation spaces.
+ * @brief Writes indentation, copying it from the precomputed run.
  *
- * @param[in] indent Number of spaces to indent.
+ * @param[in,out] printer Pointer to the Printer instance.
+ * @param[in]     indent  Number of indent characters.
  */
-static void print_indent(int indent)
+static void print_indent(Printer *printer, size_t indent)
 {
-    for (int i = 0; i < indent; i++)
+    while (indent > 0)
     {
-        printf(" ");
+        size_t chunk = indent < printer->run_length ? indent : printer->run_length;
+        json_writer_write(printer->writer, printer->run, chunk);
+        indent -= chunk;
     }
 }
 
 /**
- * @brief Recursively prints the JSON parse tree.
+ * @brief Starts a new line indented for a nesting depth.
  *
- * @param[in] value  Pointer to the current JsonValue.
- * @param[in] indent Current indentation level.
+ * @param[in,out] printer Pointer to the Printer instance.
+ * @param[in]     depth   Nesting depth of the line.
  */
-void json_print(const JsonValue *value, int indent)
+static void print_newline(Printer *printer, size_t depth)
 {
+    json_writer_putc(printer->writer, '\n');
+    print_indent(printer, printer->base + depth * printer->width);
+}
+
+/**
+ * @brief Writes a string with its quotes, escaping its contents.
+ */
+static void print_string(Printer *printer, const char *str)
+{
+    json_writer_putc(printer->writer, '\"');
+    if (str)
+        json_writer_write_escaped(printer->writer, str, strlen(str));
+    json_writer_putc(printer->writer, '\"');
+}
+
+/**
+ * @brief Prints a value whose first line has already been indented.
+ *
+ * Commas are written before each item after the first, so no output ever
+ * has to be taken back.
+ *
+ * @param[in,out] printer Pointer to the Printer instance.
+ * @param[in]     value   The value to print.
+ * @param[in]     depth   Nesting depth of the value.
+ */
+static void print_value(Printer *printer, const JsonValue *value, size_t depth)
+{
+    JsonWriter *writer = printer->writer;
     if (!value)
     {
-        print_indent(indent);
-        printf("null\n");
+        json_writer_write(writer, "null", 4);
         return;
     }
 
     switch (value->type)
     {
     case JSON_NULL:
-        print_indent(indent);
-        printf("null\n");
+        json_writer_write(writer, "null", 4);
         break;
-
     case JSON_BOOL:
-        print_indent(indent);
-        printf(value->value.boolean ? "true\n" : "false\n");
+        if (value->value.boolean)
+            json_writer_write(writer, "true", 4);
+        else
+            json_writer_write(writer, "false", 5);
         break;
-
     case JSON_NUMBER:
-        print_indent(indent);
-        printf("%lf\n", value->value.number);
+        json_writer_write_number(writer, value->value.number);
         break;
-
     case JSON_STRING:
-        print_indent(indent);
-        printf("\"%s\"\n", value->value.string);
+        print_string(printer, value->value.string);
         break;
-
     case JSON_ARRAY:
-        print_indent(indent);
-        printf("[\n");
-        for (size_t i = 0; i < value->value.array->count; i++)
+    {
+        size_t count = value->value.array->count;
+        json_writer_putc(writer, '[');
+        for (size_t i = 0; i < count; i++)
         {
-            json_print(value->value.array->items[i], indent + 2);
-            if (i < value->value.array->count - 1)
-            {
-                // Replace the last newline with a comma
-                fseek(stdout, -1, SEEK_CUR);
-                printf(",\n");
-            }
+            if (i > 0)
+                json_writer_putc(writer, ',');
+            print_newline(printer, depth + 1);
+            if (value->flags & JSON_FLAG_PACKED_NUMBERS)
+                json_writer_write_number(writer, value->value.array->numbers[i]);
+            else
+                print_value(printer, value->value.array->items[i], depth + 1);
         }
-        print_indent(indent);
-        printf("]\n");
+        if (count > 0)
+            print_newline(printer, depth);
+        json_writer_putc(writer, ']');
         break;
-
+    }
     case JSON_OBJECT:
-        print_indent(indent);
-        printf("{\n");
-        for (size_t i = 0; i < value->value.object->count; i++)
+    {
+        size_t count = value->value.object->count;
+        json_writer_putc(writer, '{');
+        for (size_t i = 0; i < count; i++)
         {
-            print_indent(indent + 2);
-            printf("\"%s\": ", value->value.object->pairs[i].key);
-            // Determine if the value is a primitive type to format accordingly
-            if (value->value.object->pairs[i].value->type == JSON_OBJECT ||
-                value->value.object->pairs[i].value->type == JSON_ARRAY)
-            {
-                printf("\n");
-                json_print(value->value.object->pairs[i].value, indent + 4);
-            }
-            else
-            {
-                // For primitive types, print inline
-                switch (value->value.object->pairs[i].value->type)
-                {
-                case JSON_NULL:
-                    printf("null\n");
-                    break;
-                case JSON_BOOL:
-                    printf(value->value.object->pairs[i].value->value.boolean ? "true\n" : "false\n");
-                    break;
-                case JSON_NUMBER:
-                    printf("%lf\n", value->value.object->pairs[i].value->value.number);
-                    break;
-                case JSON_STRING:
-                    printf("\"%s\"\n", value->value.object->pairs[i].value->value.string);
-                    break;
-                default:
-                    printf("null\n"); // Fallback for unexpected types
-                    break;
-                }
-            }
-            if (i < value->value.object->count - 1)
-            {
-                // Replace the last newline with a comma
-                fseek(stdout, -1, SEEK_CUR);
-                printf(",\n");
-            }
+            if (i > 0)
+                json_writer_putc(writer, ',');
+            print_newline(printer, depth + 1);
+            print_string(printer, value->value.object->pairs[i].key);
+            json_writer_write(writer, ": ", 2);
+            print_value(printer, value->value.object->pairs[i].value, depth + 1);
         }
-        print_indent(indent);
-        printf("}\n");
+        if (count > 0)
+            print_newline(printer, depth);
+        json_writer_putc(writer, '}');
         break;
-
+    }
     default:
-        print_indent(indent);
-        printf("null\n"); // Fallback for unknown types
+        json_writer_write(writer, "null", 4); // Fallback for unknown types
         break;
     }
 }
+
+/**
+ * @brief Sets up a Printer from layout options.
+ *
+ * @param[out] printer Pointer to the Printer to initialize.
+ * @param[in]  writer  The writer receiving the output.
+ * @param[in]  options Layout options, or NULL for the defaults.
+ */
+static void printer_init(Printer *printer, JsonWriter *writer, const JsonPrintOptions *options)
+{
+    printer->writer = writer;
+    if (options && options->indent_style == JSON_INDENT_TABS)
+    {
+        printer->run = tabs;
+        printer->run_length = sizeof(tabs) - 1;
+    }
+    else
+    {
+        printer->run = spaces;
+        printer->run_length = sizeof(spaces) - 1;
+    }
+    printer->width = options && options->indent_width ? options->indent_width : PRINTER_DEFAULT_INDENT_WIDTH;
+    printer->base = options ? options->base_indent : 0;
+}
+
+int json_print_to(JsonWriter *writer, const JsonValue *value, const JsonPrintOptions *options)
+{
+    Printer printer;
+    printer_init(&printer, writer, options);
+
+    /* The first line is indented like every other line */
+    print_indent(&printer, printer.base);
+    print_value(&printer, value, 0);
+    json_writer_putc(writer, '\n');
+    return !writer->failed;
+}
+
+void json_print_newline(JsonWriter *writer, const JsonPrintOptions *options, size_t depth)
+{
+    Printer printer;
+    printer_init(&printer, writer, options);
+    print_newline(&printer, depth);
+}
+
+void json_print_indent(JsonWriter *writer, const JsonPrintOptions *options)
+{
+    Printer printer;
+    printer_init(&printer, writer, options);
+    print_indent(&printer, printer.base);
+}
+
+char *json_print_string(const JsonValue *value, const JsonPrintOptions *options)
+{
+    JsonWriter writer;
+    json_writer_init(&writer);
+    json_print_to(&writer, value, options);
+    return json_writer_finish(&writer);
+}
+
+void json_print(const JsonValue *value, int indent)
+{
+    JsonPrintOptions options;
+    memset(&options, 0, sizeof(options));
+    options.base_indent = indent > 0 ? (size_t)indent : 0;
+
+    JsonWriter writer;
+    json_writer_init(&writer);
+    if (json_print_to(&writer, value, &options))
+        fwrite(writer.data, 1, writer.length, stdout);
+    json_writer_free(&writer);
+}
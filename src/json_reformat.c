@@ -0,0 +1,317 @@
+#include "json_reformat.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include "json_logging.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Reformatter state: the current token and the open containers. */
+typedef struct
+{
+    JsonStream stream;                              /**< Token source. */
+    JsonWriter *writer;                             /**< Output. */
+    const JsonFormatOptions *options;               /**< Format options. */
+    JsonTokenType token;                            /**< Type of the current token. */
+    const char *text;                               /**< Text of the current token. */
+    size_t length;                                  /**< Length of the current token's text. */
+    char *scratch;                                  /**< Buffer for decoded strings. */
+    size_t scratch_capacity;                        /**< Number of bytes allocated for `scratch`. */
+    unsigned char kinds[JSON_STREAM_MAX_DEPTH / 8]; /**< One bit per open container, set for objects. */
+    size_t depth;                                   /**< Number of open containers. */
+} Reformatter;
+
+/**
+ * @brief Advances to the next token.
+ */
+static void reformat_advance(Reformatter *r)
+{
+    r->token = json_stream_next(&r->stream, &r->text, &r->length);
+}
+
+/**
+ * @brief Decodes the current string token into the scratch buffer.
+ *
+ * @return Length of the decoded text, or SIZE_MAX on an invalid escape or
+ *         allocation failure.
+ */
+static size_t decode_string(Reformatter *r)
+{
+    if (r->length + 1 > r->scratch_capacity)
+    {
+        char *scratch = json_realloc(r->scratch, r->length + 1);
+        if (!scratch)
+        {
+            ERROR_LOG("Reformat: Memory allocation failed for string buffer\n");
+            return SIZE_MAX;
+        }
+        r->scratch = scratch;
+        r->scratch_capacity = r->length + 1;
+    }
+    return json_unescape(r->text, r->length, r->scratch);
+}
+
+/**
+ * @brief Writes the current string token.
+ *
+ * Strings are copied as written unless canonicalizing; raw control
+ * characters and escapes are still checked, so the output is always valid
+ * JSON.
+ *
+ * @return 1 on success, 0 on a control character, an invalid escape or
+ *         allocation failure.
+ */
+static int write_string(Reformatter *r)
+{
+    JsonWriter *writer = r->writer;
+    if (json_has_control_chars(r->text, r->length))
+        return 0;
+    if (r->options->mode != JSON_FORMAT_CANONICAL)
+    {
+        if (r->stream.escaped && decode_string(r) == SIZE_MAX)
+            return 0;
+        json_writer_putc(writer, '\"');
+        json_writer_write(writer, r->text, r->length);
+        json_writer_putc(writer, '\"');
+        return 1;
+    }
+
+    const char *text = r->text;
+    size_t length = r->length;
+    if (r->stream.escaped)
+    {
+        length = decode_string(r);
+        if (length == SIZE_MAX)
+            return 0;
+        text = r->scratch;
+    }
+    int literal_slashes = writer->literal_slashes;
+    writer->literal_slashes = 1;
+    json_writer_putc(writer, '\"');
+    json_writer_write_escaped(writer, text, length);
+    json_writer_putc(writer, '\"');
+    writer->literal_slashes = literal_slashes;
+    return 1;
+}
+
+/**
+ * @brief Writes the current number token.
+ *
+ * The stream's tokenizer is lax about numbers, so each one is checked
+ * against the JSON grammar before it is copied.
+ *
+ * @return 1 on success, 0 if the number is malformed.
+ */
+static int write_number(Reformatter *r)
+{
+    if (json_number_length(r->text, r->length) != r->length)
+        return 0;
+    if (r->options->mode != JSON_FORMAT_CANONICAL)
+    {
+        json_writer_write(r->writer, r->text, r->length);
+        return 1;
+    }
+
+    /* Integer literals are already canonical, apart from negative zero */
+    if (!memchr(r->text, '.', r->length) && !memchr(r->text, 'e', r->length) && !memchr(r->text, 'E', r->length))
+    {
+        if (r->length == 2 && r->text[0] == '-' && r->text[1] == '0')
+            json_writer_putc(r->writer, '0');
+        else
+            json_writer_write(r->writer, r->text, r->length);
+        return 1;
+    }
+
+    double number = json_number_from_range(r->text, r->length);
+    if (!isfinite(number))
+    {
+        json_writer_write(r->writer, r->text, r->length);
+        return 1;
+    }
+    if (number == 0)
+    {
+        json_writer_putc(r->writer, '0');
+        return 1;
+    }
+
+    /* The shortest precision that reads back as the same double */
+    char buffer[32];
+    for (int precision = 1; precision <= 17; precision++)
+    {
+        snprintf(buffer, sizeof(buffer), "%.*g", precision, number);
+        if (strtod(buffer, NULL) == number)
+            break;
+    }
+
+    /* "1e+07" becomes "1e7" */
+    char *exponent = strchr(buffer, 'e');
+    if (exponent)
+    {
+        char *digits = exponent + 1;
+        char *out = digits;
+        if (*digits == '+' || *digits == '-')
+        {
+            if (*digits == '-')
+                out++;
+            digits++;
+        }
+        while (*digits == '0' && digits[1] != '\0')
+            digits++;
+        memmove(out, digits, strlen(digits) + 1);
+    }
+    json_writer_puts(r->writer, buffer);
+    return 1;
+}
+
+/**
+ * @brief Writes an object member's key and colon, and moves to its value.
+ *
+ * @return 1 on success, 0 if the key or colon is missing or invalid.
+ */
+static int write_key(Reformatter *r)
+{
+    if (r->token != TOKEN_STRING || !write_string(r))
+        return 0;
+    reformat_advance(r);
+    if (r->token != TOKEN_COLON)
+        return 0;
+    if (r->options->mode == JSON_FORMAT_PRETTY)
+        json_writer_write(r->writer, ": ", 2);
+    else
+        json_writer_putc(r->writer, ':');
+    reformat_advance(r);
+    return 1;
+}
+
+/**
+ * @brief Starts a new pretty-printed line at the current depth.
+ */
+static void write_newline(Reformatter *r)
+{
+    if (r->options->mode == JSON_FORMAT_PRETTY)
+        json_print_newline(r->writer, &r->options->layout, r->depth);
+}
+
+/**
+ * @brief Copies one complete document from the stream to the writer.
+ *
+ * Nesting is tracked in a bit stack rather than by recursion.
+ *
+ * @return 1 on success, 0 on malformed input.
+ */
+static int reformat_document(Reformatter *r)
+{
+    JsonWriter *writer = r->writer;
+    reformat_advance(r);
+
+    while (1)
+    {
+        /* A value is expected */
+        switch (r->token)
+        {
+        case TOKEN_LEFT_BRACE:
+        case TOKEN_LEFT_BRACKET:
+        {
+            if (r->depth == JSON_STREAM_MAX_DEPTH)
+            {
+                ERROR_LOG("Reformat: Nesting deeper than %d\n", JSON_STREAM_MAX_DEPTH);
+                return 0;
+            }
+            int is_object = r->token == TOKEN_LEFT_BRACE;
+            if (is_object)
+                r->kinds[r->depth / 8] |= (unsigned char)(1u << (r->depth % 8));
+            else
+                r->kinds[r->depth / 8] &= (unsigned char)~(1u << (r->depth % 8));
+            r->depth++;
+            json_writer_putc(writer, is_object ? '{' : '[');
+
+            reformat_advance(r);
+            if (r->token == (is_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+            {
+                /* Empty containers stay on one line */
+                r->depth--;
+                json_writer_putc(writer, is_object ? '}' : ']');
+                break;
+            }
+            write_newline(r);
+            if (is_object && !write_key(r))
+                return 0;
+            continue;
+        }
+        case TOKEN_STRING:
+            if (!write_string(r))
+                return 0;
+            break;
+        case TOKEN_NUMBER:
+            if (!write_number(r))
+                return 0;
+            break;
+        case TOKEN_TRUE:
+            json_writer_write(writer, "true", 4);
+            break;
+        case TOKEN_FALSE:
+            json_writer_write(writer, "false", 5);
+            break;
+        case TOKEN_NULL:
+            json_writer_write(writer, "null", 4);
+            break;
+        default:
+            return 0;
+        }
+
+        /* A value is complete: close containers until one continues */
+        while (1)
+        {
+            reformat_advance(r);
+            if (r->depth == 0)
+                return r->token == TOKEN_EOF;
+
+            int in_object = (r->kinds[(r->depth - 1) / 8] >> ((r->depth - 1) % 8)) & 1;
+            if (r->token == (in_object ? TOKEN_RIGHT_BRACE : TOKEN_RIGHT_BRACKET))
+            {
+                r->depth--;
+                write_newline(r);
+                json_writer_putc(writer, in_object ? '}' : ']');
+                continue;
+            }
+            if (r->token != TOKEN_COMMA)
+                return 0;
+            json_writer_putc(writer, ',');
+            write_newline(r);
+            reformat_advance(r);
+            if (in_object && !write_key(r))
+                return 0;
+            break;
+        }
+    }
+}
+
+int json_reformat(const JsonReader *reader, JsonWriter *writer, const JsonFormatOptions *options)
+{
+    JsonFormatOptions defaults;
+    memset(&defaults, 0, sizeof(defaults));
+
+    Reformatter r;
+    json_stream_init(&r.stream, reader);
+    r.writer = writer;
+    r.options = options ? options : &defaults;
+    r.token = TOKEN_NONE;
+    r.text = NULL;
+    r.length = 0;
+    r.scratch = NULL;
+    r.scratch_capacity = 0;
+    r.depth = 0;
+
+    if (r.options->mode == JSON_FORMAT_PRETTY)
+        json_print_indent(writer, &r.options->layout);
+    int ok = reformat_document(&r);
+    if (!ok)
+        ERROR_LOG("Reformat: Malformed input near offset %zu\n", json_stream_offset(&r.stream));
+    if (ok && r.options->mode == JSON_FORMAT_PRETTY)
+        json_writer_putc(writer, '\n');
+
+    json_stream_free(&r.stream);
+    json_free(r.scratch);
+    return json_writer_flush(writer) && ok;
+}
@@ -2,249 +2,96 @@
 
 #include "json_serializer.h"
 #include "json_utils.h"
+#include "json_writer.h"
 #include "json_types.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 /**
- * @brief Helper function to escape special characters in a string for JSON serialization.
+ * @brief Writes a string with its quotes, escaping its contents.
  *
- * @param[in] str The input string to escape.
- * @return A new dynamically allocated string with escaped characters.
- *         The caller must free the returned string.
+ * @param[in,out] writer The writer receiving the output.
+ * @param[in]     str    The string to write; NULL is written as "".
  */
-static char *escape_string(const char *str)
+static void write_string(JsonWriter *writer, const char *str)
 {
-    if (!str)
-        return json_strdup("");
-
-    size_t len = 0;
-    const char *p = str;
-
-    // First pass: calculate the length of the escaped string
-    while (*p)
-    {
-        switch (*p)
-        {
-        case '\"':
-        case '\\':
-        case '/':
-        case '\b':
-        case '\f':
-        case '\n':
-        case '\r':
-        case '\t':
-            len += 2; // These characters become two-character sequences
-            break;
-        default:
-            if ((unsigned char)*p < 0x20)
-            {
-                len += 6; // Control characters become \uXXXX
-            }
-            else
-            {
-                len += 1;
-            }
-            break;
-        }
-        p++;
-    }
-
-    // Allocate memory for the escaped string
-    char *escaped_str = json_alloc(len + 1); // +1 for null terminator
-    if (!escaped_str)
-        return NULL;
-
-    const char *src = str;
-    char *dst = escaped_str;
-
-    // Second pass: copy characters and apply escaping
-    while (*src)
-    {
-        switch (*src)
-        {
-        case '\"':
-            *dst++ = '\\';
-            *dst++ = '\"';
-            break;
-        case '\\':
-            *dst++ = '\\';
-            *dst++ = '\\';
-            break;
-        case '/':
-            *dst++ = '\\';
-            *dst++ = '/';
-            break;
-        case '\b':
-            *dst++ = '\\';
-            *dst++ = 'b';
-            break;
-        case '\f':
-            *dst++ = '\\';
-            *dst++ = 'f';
-            break;
-        case '\n':
-            *dst++ = '\\';
-            *dst++ = 'n';
-            break;
-        case '\r':
-            *dst++ = '\\';
-            *dst++ = 'r';
-            break;
-        case '\t':
-            *dst++ = '\\';
-            *dst++ = 't';
-            break;
-        default:
-            if ((unsigned char)*src < 0x20)
-            {
-                // Control characters (less than ASCII 0x20)
-                sprintf(dst, "\\u%04x", (unsigned char)*src);
-                dst += 6;
-            }
-            else
-            {
-                *dst++ = *src;
-            }
-            break;
-        }
-        src++;
-    }
-
-    *dst = '\0'; // Null-terminate the string
-
-    return escaped_str;
+    json_writer_putc(writer, '\"');
+    if (str)
+        json_writer_write_escaped(writer, str, strlen(str));
+    json_writer_putc(writer, '\"');
 }
 
-char *json_serialize(const JsonValue *value)
+/**
+ * @brief Writes a value and its children.
+ *
+ * @param[in,out] writer The writer receiving the output.
+ * @param[in]     value  The value to write; NULL is written as null.
+ */
+static void write_value(JsonWriter *writer, const JsonValue *value)
 {
     if (!value)
-        return json_strdup("null");
-
-    char *result = NULL;
-    char buffer[64];
+    {
+        json_writer_write(writer, "null", 4);
+        return;
+    }
 
     switch (value->type)
     {
     case JSON_STRING:
-    {
-        char *escaped_str = escape_string(value->value.string);
-        if (!escaped_str)
-            return NULL;
-        size_t len = strlen(escaped_str) + 3; // For quotes and null terminator
-        result = json_alloc(len);
-        if (!result)
-        {
-            json_free(escaped_str);
-            return NULL;
-        }
-        snprintf(result, len, "\"%s\"", escaped_str);
-        json_free(escaped_str);
+        write_string(writer, value->value.string);
         break;
-    }
     case JSON_NUMBER:
-        snprintf(buffer, sizeof(buffer), "%g", value->value.number);
-        result = json_strdup(buffer);
+        json_writer_write_number(writer, value->value.number);
         break;
     case JSON_BOOL:
-        result = json_strdup(value->value.boolean ? "true" : "false");
-        break;
-    case JSON_NULL:
-        result = json_strdup("null");
+        if (value->value.boolean)
+            json_writer_write(writer, "true", 4);
+        else
+            json_writer_write(writer, "false", 5);
         break;
     case JSON_OBJECT:
-    {
-        result = json_strdup("{");
-        if (!result)
-            return NULL;
-
+        json_writer_putc(writer, '{');
         for (size_t i = 0; i < value->value.object->count; i++)
         {
-            char *key = escape_string(value->value.object->pairs[i].key);
-            char *val = json_serialize(value->value.object->pairs[i].value);
-            if (!key || !val)
-            {
-                json_free(key);
-                json_free(val);
-                json_free(result);
-                return NULL;
-            }
-            size_t new_len = strlen(result) + strlen(key) + strlen(val) + 5; // For quotes, colon, comma
-            char *new_result = json_realloc(result, new_len);
-            if (!new_result)
-            {
-                json_free(key);
-                json_free(val);
-                json_free(result);
-                return NULL;
-            }
-            result = new_result;
-            strcat(result, "\"");
-            strcat(result, key);
-            strcat(result, "\":");
-            strcat(result, val);
-            if (i < value->value.object->count - 1)
-                strcat(result, ",");
-            json_free(key);
-            json_free(val);
-        }
-        // Add closing brace
-        size_t final_len = strlen(result) + 2; // For closing brace and null terminator
-        char *final_result = json_realloc(result, final_len);
-        if (!final_result)
-        {
-            json_free(result);
-            return NULL;
+            if (i > 0)
+                json_writer_putc(writer, ',');
+            write_string(writer, value->value.object->pairs[i].key);
+            json_writer_putc(writer, ':');
+            write_value(writer, value->value.object->pairs[i].value);
         }
-        result = final_result;
-        strcat(result, "}");
+        json_writer_putc(writer, '}');
         break;
-    }
     case JSON_ARRAY:
-    {
-        result = json_strdup("[");
-        if (!result)
-            return NULL;
-
+        json_writer_putc(writer, '[');
         for (size_t i = 0; i < value->value.array->count; i++)
         {
-            char *val = json_serialize(value->value.array->items[i]);
-            if (!val)
-            {
-                json_free(result);
-                return NULL;
-            }
-            size_t new_len = strlen(result) + strlen(val) + 2; // For comma
-            char *new_result = json_realloc(result, new_len);
-            if (!new_result)
-            {
-                json_free(val);
-                json_free(result);
-                return NULL;
-            }
-            result = new_result;
-            strcat(result, val);
-            if (i < value->value.array->count - 1)
-                strcat(result, ",");
-            json_free(val);
-        }
-        // Add closing bracket
-        size_t final_len = strlen(result) + 2; // For closing bracket and null terminator
-        char *final_result = json_realloc(result, final_len);
-        if (!final_result)
-        {
-            json_free(result);
-            return NULL;
+            if (i > 0)
+                json_writer_putc(writer, ',');
+            if (value->flags & JSON_FLAG_PACKED_NUMBERS)
+                json_writer_write_number(writer, value->value.array->numbers[i]);
+            else
+                write_value(writer, value->value.array->items[i]);
         }
-        result = final_result;
-        strcat(result, "]");
+        json_writer_putc(writer, ']');
         break;
-    }
     default:
-        result = json_strdup("null");
+        json_writer_write(writer, "null", 4);
         break;
     }
+}
 
-    return result;
+char *json_serialize(const JsonValue *value)
+{
+    return json_serialize_with(value, NULL);
+}
+
+char *json_serialize_with(const JsonValue *value, const JsonSerializeOptions *options)
+{
+    JsonWriter writer;
+    json_writer_init(&writer);
+    if (options)
+        writer.literal_slashes = options->literal_slashes;
+    write_value(&writer, value);
+    return json_writer_finish(&writer);
 }
@@ -0,0 +1,91 @@
+#include "json_shape.h"
+#include "json_utils.h"
+#include <string.h>
+
+JsonShape *json_shape_new(size_t count, size_t keys_size)
+{
+    /* Keep the index at most half full so probes stay short */
+    size_t index_size = 2;
+    while (index_size < count * 2)
+        index_size *= 2;
+
+    JsonShape *shape = json_alloc(sizeof(JsonShape) + sizeof(JsonPair) * count +
+                                  sizeof(uint32_t) * index_size + keys_size + count);
+    if (!shape)
+        return NULL;
+
+    shape->count = count;
+    shape->hash = 0;
+    shape->index_mask = index_size - 1;
+    shape->keys = (JsonPair *)(shape + 1);
+    shape->index = (uint32_t *)(shape->keys + count);
+    shape->storage = (char *)(shape->index + index_size);
+    shape->next = NULL;
+    memset(shape->index, 0, sizeof(uint32_t) * index_size);
+    return shape;
+}
+
+void json_shape_add_key(JsonShape *shape, size_t slot, const char *key, size_t length, uint32_t hash)
+{
+    memcpy(shape->storage, key, length);
+    shape->storage[length] = '\0';
+
+    JsonPair *pair = &shape->keys[slot];
+    pair->key = shape->storage;
+    pair->value = NULL;
+    pair->key_length = (uint32_t)length;
+    pair->key_hash = hash;
+
+    shape->storage += length + 1;
+    shape->hash = json_shape_mix(shape->hash, hash);
+}
+
+void json_shape_seal(JsonShape *shape)
+{
+    for (size_t slot = 0; slot < shape->count; slot++)
+    {
+        const JsonPair *pair = &shape->keys[slot];
+        size_t i = pair->key_hash & shape->index_mask;
+        for (;;)
+        {
+            uint32_t entry = shape->index[i];
+            if (!entry)
+            {
+                shape->index[i] = (uint32_t)(slot + 1);
+                break;
+            }
+            /* Duplicate keys keep their first slot, as the accessors do */
+            const JsonPair *other = &shape->keys[entry - 1];
+            if (other->key_hash == pair->key_hash && other->key_length == pair->key_length &&
+                memcmp(other->key, pair->key, pair->key_length) == 0)
+                break;
+            i = (i + 1) & shape->index_mask;
+        }
+    }
+    shape->storage = NULL;
+}
+
+void json_shape_free(JsonShape *shape)
+{
+    json_free(shape);
+}
+
+uint32_t json_shape_mix(uint32_t sequence, uint32_t key_hash)
+{
+    return (sequence ^ key_hash) * 16777619u + 0x9e3779b9u;
+}
+
+size_t json_shape_slot(const JsonShape *shape, const char *key, size_t length, uint32_t hash)
+{
+    size_t i = hash & shape->index_mask;
+    for (;;)
+    {
+        uint32_t entry = shape->index[i];
+        if (!entry)
+            return JSON_SHAPE_NO_SLOT;
+        const JsonPair *pair = &shape->keys[entry - 1];
+        if (pair->key_hash == hash && pair->key_length == length && memcmp(pair->key, key, length) == 0)
+            return entry - 1;
+        i = (i + 1) & shape->index_mask;
+    }
+}
@@ -0,0 +1,265 @@
+#include "json_stream.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include "json_logging.h"
+#include <string.h>
+
+/**
+ * @brief Reader callback for a stdio stream.
+ */
+static size_t file_read(void *context, char *buffer, size_t size)
+{
+    return fread(buffer, 1, size, (FILE *)context);
+}
+
+void json_reader_init_file(JsonReader *reader, FILE *file)
+{
+    reader->read = file_read;
+    reader->context = file;
+}
+
+/**
+ * @brief Reader callback for a buffer in memory.
+ */
+static size_t memory_read(void *context, char *buffer, size_t size)
+{
+    JsonMemorySource *source = context;
+    size_t n = source->length - source->position;
+    if (n > size)
+        n = size;
+    memcpy(buffer, source->data + source->position, n);
+    source->position += n;
+    return n;
+}
+
+void json_reader_init_memory(JsonReader *reader, JsonMemorySource *source, const char *data, size_t length)
+{
+    source->data = data;
+    source->length = length;
+    source->position = 0;
+    reader->read = memory_read;
+    reader->context = source;
+}
+
+void json_stream_init(JsonStream *stream, const JsonReader *reader)
+{
+    stream->reader = *reader;
+    stream->buffer = NULL;
+    stream->capacity = 0;
+    stream->start = 0;
+    stream->length = 0;
+    stream->offset = 0;
+    stream->eof = 0;
+    stream->failed = 0;
+    stream->escaped = 0;
+}
+
+void json_stream_free(JsonStream *stream)
+{
+    json_free(stream->buffer);
+    stream->buffer = NULL;
+    stream->capacity = 0;
+    stream->start = 0;
+    stream->length = 0;
+}
+
+size_t json_stream_offset(const JsonStream *stream)
+{
+    return stream->offset + stream->start;
+}
+
+/**
+ * @brief Reads more input after the unconsumed bytes.
+ *
+ * Consumed bytes are dropped first; the buffer only grows when the
+ * unconsumed bytes already fill it, i.e. for a token longer than the buffer.
+ *
+ * @param[in,out] stream Pointer to the JsonStream.
+ * @return 1 if input was read or the end was reached, 0 on allocation failure.
+ */
+static int stream_fill(JsonStream *stream)
+{
+    if (stream->start > 0)
+    {
+        memmove(stream->buffer, stream->buffer + stream->start, stream->length - stream->start);
+        stream->length -= stream->start;
+        stream->offset += stream->start;
+        stream->start = 0;
+    }
+    if (stream->length == stream->capacity)
+    {
+        size_t capacity = stream->capacity ? stream->capacity * 2 : JSON_STREAM_BUFFER_SIZE;
+        char *buffer = json_realloc(stream->buffer, capacity);
+        if (!buffer)
+        {
+            ERROR_LOG("Stream: Memory allocation failed for input buffer\n");
+            stream->failed = 1;
+            return 0;
+        }
+        stream->buffer = buffer;
+        stream->capacity = capacity;
+    }
+
+    size_t read = stream->reader.read(stream->reader.context, stream->buffer + stream->length,
+                                      stream->capacity - stream->length);
+    if (read == 0)
+        stream->eof = 1;
+    stream->length += read;
+    return 1;
+}
+
+/**
+ * @brief Checks whether a string starting at `p` (its opening quote) is
+ *        closed before `end`.
+ */
+static int has_closing_quote(const char *p, const char *end)
+{
+    for (p++; p < end; p++)
+    {
+        if (*p == '\\')
+            p++;
+        else if (*p == '"')
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks whether a scanned token may continue past the buffered input.
+ *
+ * @param[in] type   Type reported by json_scan_token().
+ * @param[in] p      First byte of the token (after whitespace).
+ * @param[in] end    One past the last buffered byte.
+ * @param[in] stop   Where the scan stopped.
+ */
+static int may_continue(JsonTokenType type, const char *p, const char *end, const char *stop)
+{
+    switch (type)
+    {
+    case TOKEN_EOF:
+        return 1;
+    case TOKEN_NUMBER:
+        return stop == end;
+    case TOKEN_ERROR:
+        if (p == end)
+            return 1;
+        if (*p == '"')
+            return !has_closing_quote(p, end);
+        if (*p == 't' || *p == 'n')
+            return end - p < 4;
+        if (*p == 'f')
+            return end - p < 5;
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+JsonTokenType json_stream_next(JsonStream *stream, const char **text, size_t *length)
+{
+    *text = NULL;
+    *length = 0;
+    while (1)
+    {
+        size_t available = stream->length - stream->start;
+        if (available == 0)
+        {
+            if (stream->eof)
+                return TOKEN_EOF;
+            if (!stream_fill(stream))
+                return TOKEN_ERROR;
+            continue;
+        }
+
+        const char *window = stream->buffer + stream->start;
+        const char *end = window + available;
+        JsonTokenizer tokenizer;
+        size_t start;
+        json_tokenizer_init_range(&tokenizer, window, available);
+        JsonTokenType type = json_scan_token(&tokenizer, &start, length);
+
+        /* A token cut off by the end of the buffer is scanned again with more input */
+        if (!stream->eof)
+        {
+            const char *p = window;
+            while (p < end && json_is_whitespace(*p))
+                p++;
+            if (may_continue(type, p, end, window + tokenizer.pos))
+            {
+                if (!stream_fill(stream))
+                    return TOKEN_ERROR;
+                continue;
+            }
+        }
+
+        *text = window + start;
+        stream->escaped = tokenizer.escaped;
+        if (type != TOKEN_ERROR)
+            stream->start += tokenizer.pos;
+        return type;
+    }
+}
+
+int json_stream_skip(JsonStream *stream)
+{
+    size_t depth = 1;
+    int in_string = 0;
+    while (1)
+    {
+        if (stream->start == stream->length)
+        {
+            if (stream->eof)
+            {
+                ERROR_LOG("Stream: Input ended inside a skipped value\n");
+                return 0;
+            }
+            if (!stream_fill(stream))
+                return 0;
+            continue;
+        }
+
+        const char *p = stream->buffer + stream->start;
+        const char *end = stream->buffer + stream->length;
+        while (p < end)
+        {
+            if (in_string)
+            {
+                p = json_scan_string_run(p, end);
+                if (p == end)
+                    break;
+                if (*p == '\\')
+                {
+                    /* Keep a trailing backslash so its escaped byte is seen with it */
+                    if (end - p < 2)
+                        break;
+                    p += 2;
+                    continue;
+                }
+                if (*p == '"')
+                    in_string = 0;
+                p++;
+                continue;
+            }
+
+            char c = *p++;
+            if (c == '"')
+                in_string = 1;
+            else if (c == '[' || c == '{')
+                depth++;
+            else if ((c == ']' || c == '}') && --depth == 0)
+            {
+                stream->start = (size_t)(p - stream->buffer);
+                return 1;
+            }
+        }
+
+        stream->start = (size_t)(p - stream->buffer);
+        if (stream->eof)
+        {
+            ERROR_LOG("Stream: Input ended inside a skipped value\n");
+            return 0;
+        }
+        if (!stream_fill(stream))
+            return 0;
+    }
+}
@@ -0,0 +1,487 @@
+#include "json_tape.h"
+#include "json_tokenizer.h"
+#include "json_writer.h"
+#include "json_utils.h"
+#include "json_logging.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Container nesting handled without allocating a stack on the heap. */
+#define TAPE_INLINE_DEPTH 64
+
+/* What the tape builder accepts next. */
+typedef enum
+{
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_CLOSE,
+    EXPECT_KEY,
+    EXPECT_KEY_OR_CLOSE,
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_CLOSE,
+    EXPECT_EOF
+} TapeExpect;
+
+/* A container opened but not yet closed while building or serializing a tape. */
+typedef struct
+{
+    size_t node;    /**< Index of the container node. */
+    size_t emitted; /**< Number of child nodes written so far (serializer only). */
+} TapeFrame;
+
+/* Open containers, innermost last. */
+typedef struct
+{
+    TapeFrame *items;        /**< The open containers. */
+    size_t depth;            /**< Number of open containers. */
+    size_t capacity;         /**< Number of entries allocated for `items`. */
+    TapeFrame *inline_items; /**< Initial storage owned by the caller. */
+} TapeStack;
+
+/**
+ * @brief Pushes a container onto a TapeStack, moving it to the heap when full.
+ *
+ * @return 1 on success, 0 if the stack could not grow.
+ */
+static int tape_stack_push(TapeStack *stack, size_t node)
+{
+    if (stack->depth == stack->capacity)
+    {
+        size_t capacity = stack->capacity * 2;
+        TapeFrame *items;
+        if (stack->items == stack->inline_items)
+        {
+            items = json_alloc(sizeof(TapeFrame) * capacity);
+            if (items)
+                memcpy(items, stack->inline_items, sizeof(TapeFrame) * stack->depth);
+        }
+        else
+        {
+            items = json_realloc(stack->items, sizeof(TapeFrame) * capacity);
+        }
+        if (!items)
+            return 0;
+        stack->items = items;
+        stack->capacity = capacity;
+    }
+    stack->items[stack->depth].node = node;
+    stack->items[stack->depth].emitted = 0;
+    stack->depth++;
+    return 1;
+}
+
+/**
+ * @brief Frees any heap storage used by a TapeStack.
+ */
+static void tape_stack_free(TapeStack *stack)
+{
+    if (stack->items != stack->inline_items)
+        json_free(stack->items);
+}
+
+/**
+ * @brief Checks whether a token begins a JSON value (and so gets a node).
+ */
+static int starts_value(uint32_t type)
+{
+    switch (type)
+    {
+    case TOKEN_STRING:
+    case TOKEN_NUMBER:
+    case TOKEN_TRUE:
+    case TOKEN_FALSE:
+    case TOKEN_NULL:
+    case TOKEN_LEFT_BRACE:
+    case TOKEN_LEFT_BRACKET:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Decodes a string token into the tape's string arena.
+ *
+ * Escape-free runs are copied with memcpy. The arena was sized from the raw
+ * token lengths, which bound the decoded lengths.
+ *
+ * @param[in,out] tape  The tape being built.
+ * @param[out]    node  The string node to fill in.
+ * @param[in,out] str   Next free offset in the string arena.
+ * @param[in]     json  The JSON text the token refers to.
+ * @param[in]     token The string token.
+ * @return 1 on success, 0 if the string holds an invalid escape.
+ */
+static int tape_store_string(JsonTape *tape, JsonTapeNode *node, size_t *str, const char *json,
+                             const JsonTapeToken *token)
+{
+    size_t length = json_unescape(json + token->offset, token->length, tape->strings + *str);
+    if (length == SIZE_MAX)
+        return 0;
+    node->value.string.offset = (uint32_t)*str;
+    node->value.string.length = (uint32_t)length;
+    *str += length + 1;
+    return 1;
+}
+
+/**
+ * @brief Builds the tape's nodes and string arena from a token tape.
+ *
+ * The token sequence is checked against the JSON grammar while building.
+ *
+ * @param[in,out] tape   Tape with `nodes` and `strings` sized for the input.
+ * @param[in]     json   The JSON text the tokens refer to.
+ * @param[in]     tokens The token tape for `json`.
+ * @return 1 on success, 0 if the document is malformed or memory runs out.
+ */
+static int tape_build(JsonTape *tape, const char *json, const JsonTokenTape *tokens)
+{
+    TapeFrame inline_items[TAPE_INLINE_DEPTH];
+    TapeStack stack = {inline_items, 0, TAPE_INLINE_DEPTH, inline_items};
+    TapeExpect expect = EXPECT_VALUE;
+    size_t n = 0;
+    size_t str = 0;
+    int ok = 0;
+
+    for (size_t t = 0; t < tokens->count; t++)
+    {
+        const JsonTapeToken *token = &tokens->tokens[t];
+        JsonTapeNode *node = &tape->nodes[n];
+        int close = 0;
+
+        switch (expect)
+        {
+        case EXPECT_KEY_OR_CLOSE:
+            if (token->type == TOKEN_RIGHT_BRACE)
+            {
+                close = 1;
+                break;
+            }
+            /* fall through */
+        case EXPECT_KEY:
+            if (token->type != TOKEN_STRING)
+                goto done;
+            node->type = JSON_STRING;
+            node->skip = 1;
+            if (!tape_store_string(tape, node, &str, json, token))
+                goto done;
+            n++;
+            expect = EXPECT_COLON;
+            continue;
+        case EXPECT_COLON:
+            if (token->type != TOKEN_COLON)
+                goto done;
+            expect = EXPECT_VALUE;
+            continue;
+        case EXPECT_VALUE_OR_CLOSE:
+            if (token->type == TOKEN_RIGHT_BRACKET)
+            {
+                close = 1;
+                break;
+            }
+            /* fall through */
+        case EXPECT_VALUE:
+            /* Nodes were only counted for value tokens; reject anything else first */
+            if (!starts_value(token->type))
+                goto done;
+            if (stack.depth)
+                tape->nodes[stack.items[stack.depth - 1].node].value.count++;
+            node->skip = 1;
+            switch (token->type)
+            {
+            case TOKEN_STRING:
+                node->type = JSON_STRING;
+                if (!tape_store_string(tape, node, &str, json, token))
+                    goto done;
+                break;
+            case TOKEN_NUMBER:
+                node->type = JSON_NUMBER;
+                node->value.number = json_number_from_range(json + token->offset, token->length);
+                break;
+            case TOKEN_TRUE:
+            case TOKEN_FALSE:
+                node->type = JSON_BOOL;
+                node->value.boolean = token->type == TOKEN_TRUE;
+                break;
+            case TOKEN_NULL:
+                node->type = JSON_NULL;
+                break;
+            case TOKEN_LEFT_BRACE:
+            case TOKEN_LEFT_BRACKET:
+                node->type = token->type == TOKEN_LEFT_BRACE ? JSON_OBJECT : JSON_ARRAY;
+                node->value.count = 0;
+                if (!tape_stack_push(&stack, n))
+                    goto done;
+                n++;
+                expect = node->type == JSON_OBJECT ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+                continue;
+            default:
+                goto done;
+            }
+            n++;
+            expect = stack.depth ? EXPECT_COMMA_OR_CLOSE : EXPECT_EOF;
+            continue;
+        case EXPECT_COMMA_OR_CLOSE:
+        {
+            uint32_t type = tape->nodes[stack.items[stack.depth - 1].node].type;
+            if (token->type == TOKEN_COMMA)
+            {
+                expect = type == JSON_OBJECT ? EXPECT_KEY : EXPECT_VALUE;
+                continue;
+            }
+            if ((token->type == TOKEN_RIGHT_BRACE && type == JSON_OBJECT) ||
+                (token->type == TOKEN_RIGHT_BRACKET && type == JSON_ARRAY))
+            {
+                close = 1;
+                break;
+            }
+            goto done;
+        }
+        case EXPECT_EOF:
+            ok = token->type == TOKEN_EOF;
+            goto done;
+        }
+
+        if (close)
+        {
+            size_t container = stack.items[--stack.depth].node;
+            tape->nodes[container].skip = (uint32_t)(n - container);
+            expect = stack.depth ? EXPECT_COMMA_OR_CLOSE : EXPECT_EOF;
+        }
+    }
+
+done:
+    tape_stack_free(&stack);
+    if (!ok)
+        ERROR_LOG("Tape: Malformed JSON document.\n");
+    return ok;
+}
+
+JsonTape *json_tape_parse(const char *json, size_t length)
+{
+    if (!json)
+        return NULL;
+
+    JsonTokenTape tokens;
+    json_token_tape_init(&tokens);
+    if (!json_tokenize_all(json, length, &tokens))
+    {
+        ERROR_LOG("Tape: Failed to tokenize JSON document.\n");
+        json_token_tape_free(&tokens);
+        return NULL;
+    }
+
+    /* Size the tape exactly: one node per key or value, one arena slot per string */
+    size_t node_count = 0;
+    size_t strings_size = 0;
+    for (size_t t = 0; t < tokens.count; t++)
+    {
+        if (starts_value(tokens.tokens[t].type))
+            node_count++;
+        if (tokens.tokens[t].type == TOKEN_STRING)
+            strings_size += tokens.tokens[t].length + 1;
+    }
+    if (node_count > UINT32_MAX || strings_size > UINT32_MAX)
+    {
+        ERROR_LOG("Tape: Document too large for the tape format.\n");
+        json_token_tape_free(&tokens);
+        return NULL;
+    }
+
+    /* Header, nodes and strings share a single allocation */
+    size_t header_size = (sizeof(JsonTape) + sizeof(JsonTapeNode) - 1) / sizeof(JsonTapeNode) * sizeof(JsonTapeNode);
+    JsonTape *tape = json_alloc(header_size + sizeof(JsonTapeNode) * node_count + strings_size);
+    if (!tape)
+    {
+        ERROR_LOG("Tape: Memory allocation failed for JsonTape\n");
+        json_token_tape_free(&tokens);
+        return NULL;
+    }
+    tape->nodes = (JsonTapeNode *)((char *)tape + header_size);
+    tape->count = node_count;
+    tape->strings = (char *)(tape->nodes + node_count);
+    tape->strings_size = strings_size;
+
+    int ok = tape_build(tape, json, &tokens);
+    json_token_tape_free(&tokens);
+    if (!ok)
+    {
+        json_free(tape);
+        return NULL;
+    }
+    return tape;
+}
+
+void json_tape_free(JsonTape *tape)
+{
+    json_free(tape);
+}
+
+JsonType json_tape_type(const JsonTape *tape, size_t node)
+{
+    if (!tape || node >= tape->count)
+        return JSON_NULL;
+    return (JsonType)tape->nodes[node].type;
+}
+
+size_t json_tape_count(const JsonTape *tape, size_t node)
+{
+    JsonType type = json_tape_type(tape, node);
+    if (type != JSON_ARRAY && type != JSON_OBJECT)
+        return 0;
+    return tape->nodes[node].value.count;
+}
+
+size_t json_tape_end(const JsonTape *tape, size_t node)
+{
+    if (!tape || node >= tape->count)
+        return JSON_TAPE_NONE;
+    return node + tape->nodes[node].skip;
+}
+
+size_t json_tape_at(const JsonTape *tape, size_t array, size_t index)
+{
+    if (json_tape_type(tape, array) != JSON_ARRAY || index >= tape->nodes[array].value.count)
+        return JSON_TAPE_NONE;
+
+    size_t node = array + 1;
+    while (index--)
+        node += tape->nodes[node].skip;
+    return node;
+}
+
+size_t json_tape_find(const JsonTape *tape, size_t object, const char *key)
+{
+    if (json_tape_type(tape, object) != JSON_OBJECT || !key)
+        return JSON_TAPE_NONE;
+
+    size_t key_length = strlen(key);
+    size_t end = json_tape_end(tape, object);
+    for (size_t node = object + 1; node < end; node += 1 + tape->nodes[node + 1].skip)
+    {
+        const JsonTapeNode *k = &tape->nodes[node];
+        if (k->value.string.length == key_length &&
+            memcmp(tape->strings + k->value.string.offset, key, key_length) == 0)
+        {
+            return node + 1;
+        }
+    }
+    return JSON_TAPE_NONE;
+}
+
+const char *json_tape_string(const JsonTape *tape, size_t node)
+{
+    if (json_tape_type(tape, node) != JSON_STRING)
+        return NULL;
+    return tape->strings + tape->nodes[node].value.string.offset;
+}
+
+double json_tape_number(const JsonTape *tape, size_t node)
+{
+    if (json_tape_type(tape, node) != JSON_NUMBER)
+        return 0.0;
+    return tape->nodes[node].value.number;
+}
+
+bool json_tape_bool(const JsonTape *tape, size_t node)
+{
+    if (json_tape_type(tape, node) != JSON_BOOL)
+        return false;
+    return tape->nodes[node].value.boolean ? true : false;
+}
+
+const char *json_tape_get_string(const JsonTape *tape, size_t object, const char *key)
+{
+    return json_tape_string(tape, json_tape_find(tape, object, key));
+}
+
+double json_tape_get_number(const JsonTape *tape, size_t object, const char *key)
+{
+    return json_tape_number(tape, json_tape_find(tape, object, key));
+}
+
+bool json_tape_get_bool(const JsonTape *tape, size_t object, const char *key)
+{
+    return json_tape_bool(tape, json_tape_find(tape, object, key));
+}
+
+/**
+ * @brief Writes a scalar node or the opening bracket of a container.
+ */
+static void write_node_open(JsonWriter *writer, const JsonTape *tape, size_t node)
+{
+    const JsonTapeNode *n = &tape->nodes[node];
+    switch (n->type)
+    {
+    case JSON_STRING:
+        json_writer_putc(writer, '"');
+        json_writer_write_escaped(writer, tape->strings + n->value.string.offset, n->value.string.length);
+        json_writer_putc(writer, '"');
+        break;
+    case JSON_NUMBER:
+        json_writer_write_number(writer, n->value.number);
+        break;
+    case JSON_BOOL:
+        json_writer_puts(writer, n->value.boolean ? "true" : "false");
+        break;
+    case JSON_ARRAY:
+        json_writer_putc(writer, '[');
+        break;
+    case JSON_OBJECT:
+        json_writer_putc(writer, '{');
+        break;
+    default:
+        json_writer_puts(writer, "null");
+        break;
+    }
+}
+
+char *json_tape_serialize(const JsonTape *tape, size_t node)
+{
+    if (!tape || node >= tape->count)
+        return json_strdup("null");
+
+    TapeFrame inline_items[TAPE_INLINE_DEPTH];
+    TapeStack stack = {inline_items, 0, TAPE_INLINE_DEPTH, inline_items};
+    JsonWriter writer;
+    json_writer_init(&writer);
+
+    size_t end = json_tape_end(tape, node);
+    for (size_t i = node; i < end; i++)
+    {
+        /* Close every container whose subtree ends before this node */
+        while (stack.depth && json_tape_end(tape, stack.items[stack.depth - 1].node) <= i)
+        {
+            size_t container = stack.items[--stack.depth].node;
+            json_writer_putc(&writer, tape->nodes[container].type == JSON_OBJECT ? '}' : ']');
+        }
+
+        if (stack.depth)
+        {
+            TapeFrame *parent = &stack.items[stack.depth - 1];
+            if (tape->nodes[parent->node].type == JSON_OBJECT && parent->emitted % 2 == 1)
+                json_writer_putc(&writer, ':');
+            else if (parent->emitted > 0)
+                json_writer_putc(&writer, ',');
+            parent->emitted++;
+        }
+
+        write_node_open(&writer, tape, i);
+        if (tape->nodes[i].type == JSON_ARRAY || tape->nodes[i].type == JSON_OBJECT)
+        {
+            if (!tape_stack_push(&stack, i))
+            {
+                json_writer_free(&writer);
+                tape_stack_free(&stack);
+                return NULL;
+            }
+        }
+    }
+    while (stack.depth)
+    {
+        size_t container = stack.items[--stack.depth].node;
+        json_writer_putc(&writer, tape->nodes[container].type == JSON_OBJECT ? '}' : ']');
+    }
+
+    tape_stack_free(&stack);
+    return json_writer_finish(&writer);
+}
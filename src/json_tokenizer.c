@@ -3,6 +3,7 @@
 #include "json_utils.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 
 const char *json_token_type_to_string(JsonTokenType token_type)
 {
@@ -42,68 +43,142 @@ const char *json_token_type_to_string(JsonTokenType token_type)
 }
 
 void json_tokenizer_init(JsonTokenizer *tokenizer, const char *json)
+{
+    json_tokenizer_init_range(tokenizer, json, strlen(json));
+}
+
+void json_tokenizer_init_range(JsonTokenizer *tokenizer, const char *json, size_t length)
 {
     tokenizer->json = json;
     tokenizer->pos = 0;
+    tokenizer->length = length;
+    tokenizer->escaped = 0;
 }
 
 void json_tokenizer_reset(JsonTokenizer *tokenizer, const char *json)
 {
-    tokenizer->json = json;
-    tokenizer->pos = 0;
+    json_tokenizer_init(tokenizer, json);
+}
+
+/**
+ * @brief Returns the character at a position, or '\0' past the end of the input.
+ */
+static char char_at(const JsonTokenizer *tokenizer, size_t pos)
+{
+    return pos < tokenizer->length ? tokenizer->json[pos] : '\0';
+}
+
+/**
+ * @brief Checks whether a literal keyword starts at the current position.
+ */
+static int match_literal(const JsonTokenizer *tokenizer, const char *literal, size_t length)
+{
+    return tokenizer->length - tokenizer->pos >= length &&
+           strncmp(&tokenizer->json[tokenizer->pos], literal, length) == 0;
+}
+
+/**
+ * @brief Finds the closing quote of a string whose contents start at `p`.
+ *
+ * ASCII runs are skipped with json_scan_string_run() and multi-byte
+ * sequences must be well-formed UTF-8. Escapes are skipped, not decoded.
+ *
+ * @param[in]  p       First byte of the string's contents.
+ * @param[in]  end     One past the last byte of the input.
+ * @param[out] escaped Set to 1 if the string contains an escape, 0 otherwise.
+ * @return Pointer to the closing quote, or NULL if the string is
+ *         unterminated or holds a NUL byte or invalid UTF-8.
+ */
+static const char *scan_string(const char *p, const char *end, int *escaped)
+{
+    *escaped = 0;
+    while (1)
+    {
+        p = json_scan_string_run(p, end);
+        if (p == end)
+            return NULL;
+
+        unsigned char c = (unsigned char)*p;
+        if (c == '"')
+            return p;
+        if (c == '\\')
+        {
+            if (end - p < 2 || p[1] == '\0')
+                return NULL;
+            *escaped = 1;
+            p += 2;
+        }
+        else if (c >= 0x80)
+        {
+            size_t length = json_utf8_sequence_length((const unsigned char *)p, (size_t)(end - p));
+            if (!length)
+                return NULL;
+            p += length;
+        }
+        else if (c == '\0')
+        {
+            return NULL;
+        }
+        else
+        {
+            p++; /* Other control characters are tolerated */
+        }
+    }
 }
 
 static void skip_whitespace(JsonTokenizer *tokenizer)
 {
-    while (json_is_whitespace(tokenizer->json[tokenizer->pos]))
+    while (json_is_whitespace(char_at(tokenizer, tokenizer->pos)))
     {
         DEBUG_PRINT("Tokenizer: Skipping whitespace at position %zu\n", tokenizer->pos);
         tokenizer->pos++;
     }
 }
 
-JsonToken json_get_next_token(JsonTokenizer *tokenizer)
+JsonTokenType json_scan_token(JsonTokenizer *tokenizer, size_t *start, size_t *length)
 {
     skip_whitespace(tokenizer);
-    JsonToken token;
-    token.value = NULL;
+    JsonTokenType type;
 
-    char current = tokenizer->json[tokenizer->pos];
+    char current = char_at(tokenizer, tokenizer->pos);
     DEBUG_PRINT("Tokenizer: Current char '%c' at position %zu\n", current, tokenizer->pos);
 
+    *start = tokenizer->pos;
+    *length = 0;
+
     switch (current)
     {
     case '\0':
-        token.type = TOKEN_EOF;
+        type = TOKEN_EOF;
         DEBUG_PRINT("Tokenizer: TOKEN_EOF\n");
         break;
     case '{':
-        token.type = TOKEN_LEFT_BRACE;
+        type = TOKEN_LEFT_BRACE;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_LEFT_BRACE\n");
         break;
     case '}':
-        token.type = TOKEN_RIGHT_BRACE;
+        type = TOKEN_RIGHT_BRACE;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_RIGHT_BRACE\n");
         break;
     case '[':
-        token.type = TOKEN_LEFT_BRACKET;
+        type = TOKEN_LEFT_BRACKET;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_LEFT_BRACKET\n");
         break;
     case ']':
-        token.type = TOKEN_RIGHT_BRACKET;
+        type = TOKEN_RIGHT_BRACKET;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_RIGHT_BRACKET\n");
         break;
     case ':':
-        token.type = TOKEN_COLON;
+        type = TOKEN_COLON;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_COLON\n");
         break;
     case ',':
-        token.type = TOKEN_COMMA;
+        type = TOKEN_COMMA;
         tokenizer->pos++;
         DEBUG_PRINT("Tokenizer: TOKEN_COMMA\n");
         break;
@@ -111,70 +186,59 @@ JsonToken json_get_next_token(JsonTokenizer *tokenizer)
     {
         // Parse string
         tokenizer->pos++; // Skip opening quote
-        size_t start = tokenizer->pos;
-        while (tokenizer->json[tokenizer->pos] != '"' && tokenizer->json[tokenizer->pos] != '\0')
-        {
-            if (tokenizer->json[tokenizer->pos] == '\\')
-            {
-                DEBUG_PRINT("Tokenizer: Escaped character '\\' at position %zu\n", tokenizer->pos);
-                tokenizer->pos += 2; // Skip escaped character
-            }
-            else
-            {
-                tokenizer->pos++;
-            }
-        }
-        size_t length = tokenizer->pos - start;
-        if (tokenizer->json[tokenizer->pos] == '"')
+        *start = tokenizer->pos;
+        const char *end = tokenizer->json + tokenizer->length;
+        const char *quote = scan_string(tokenizer->json + tokenizer->pos, end, &tokenizer->escaped);
+        if (quote)
         {
-            token.type = TOKEN_STRING;
-            token.value = json_strdup_range(tokenizer->json + start, length);
-            tokenizer->pos++; // Skip closing quote
-            DEBUG_PRINT("Tokenizer: TOKEN_STRING with value '%s'\n", token.value);
+            type = TOKEN_STRING;
+            *length = (size_t)(quote - (tokenizer->json + *start));
+            tokenizer->pos = *start + *length + 1; // Skip closing quote
+            DEBUG_PRINT("Tokenizer: TOKEN_STRING with value '%.*s'\n", (int)*length, tokenizer->json + *start);
         }
         else
         {
-            token.type = TOKEN_ERROR;
+            type = TOKEN_ERROR;
             DEBUG_PRINT("Tokenizer: TOKEN_ERROR while parsing string at position %zu\n", tokenizer->pos);
         }
         break;
     }
     case 't':
-        if (strncmp(&tokenizer->json[tokenizer->pos], "true", 4) == 0)
+        if (match_literal(tokenizer, "true", 4))
         {
-            token.type = TOKEN_TRUE;
+            type = TOKEN_TRUE;
             tokenizer->pos += 4;
             DEBUG_PRINT("Tokenizer: TOKEN_TRUE\n");
         }
         else
         {
-            token.type = TOKEN_ERROR;
+            type = TOKEN_ERROR;
             DEBUG_PRINT("Tokenizer: TOKEN_ERROR while parsing 't' at position %zu\n", tokenizer->pos);
         }
         break;
     case 'f':
-        if (strncmp(&tokenizer->json[tokenizer->pos], "false", 5) == 0)
+        if (match_literal(tokenizer, "false", 5))
         {
-            token.type = TOKEN_FALSE;
+            type = TOKEN_FALSE;
             tokenizer->pos += 5;
             DEBUG_PRINT("Tokenizer: TOKEN_FALSE\n");
         }
         else
         {
-            token.type = TOKEN_ERROR;
+            type = TOKEN_ERROR;
             DEBUG_PRINT("Tokenizer: TOKEN_ERROR while parsing 'f' at position %zu\n", tokenizer->pos);
         }
         break;
     case 'n':
-        if (strncmp(&tokenizer->json[tokenizer->pos], "null", 4) == 0)
+        if (match_literal(tokenizer, "null", 4))
         {
-            token.type = TOKEN_NULL;
+            type = TOKEN_NULL;
             tokenizer->pos += 4;
             DEBUG_PRINT("Tokenizer: TOKEN_NULL\n");
         }
         else
         {
-            token.type = TOKEN_ERROR;
+            type = TOKEN_ERROR;
             DEBUG_PRINT("Tokenizer: TOKEN_ERROR while parsing 'n' at position %zu\n", tokenizer->pos);
         }
         break;
@@ -182,37 +246,228 @@ JsonToken json_get_next_token(JsonTokenizer *tokenizer)
         if ((current >= '0' && current <= '9') || current == '-')
         {
             // Parse number
-            size_t start = tokenizer->pos;
             if (current == '-')
                 tokenizer->pos++;
-            while (tokenizer->json[tokenizer->pos] >= '0' && tokenizer->json[tokenizer->pos] <= '9')
+            while (char_at(tokenizer, tokenizer->pos) >= '0' && char_at(tokenizer, tokenizer->pos) <= '9')
+            {
+                tokenizer->pos++;
+            }
+            if (char_at(tokenizer, tokenizer->pos) == '.')
             {
                 tokenizer->pos++;
+                while (char_at(tokenizer, tokenizer->pos) >= '0' && char_at(tokenizer, tokenizer->pos) <= '9')
+                {
+                    tokenizer->pos++;
+                }
             }
-            if (tokenizer->json[tokenizer->pos] == '.')
+            if (char_at(tokenizer, tokenizer->pos) == 'e' || char_at(tokenizer, tokenizer->pos) == 'E')
             {
                 tokenizer->pos++;
-                while (tokenizer->json[tokenizer->pos] >= '0' && tokenizer->json[tokenizer->pos] <= '9')
+                if (char_at(tokenizer, tokenizer->pos) == '+' || char_at(tokenizer, tokenizer->pos) == '-')
+                    tokenizer->pos++;
+                while (char_at(tokenizer, tokenizer->pos) >= '0' && char_at(tokenizer, tokenizer->pos) <= '9')
                 {
                     tokenizer->pos++;
                 }
             }
-            size_t length = tokenizer->pos - start;
-            token.type = TOKEN_NUMBER;
-            token.value = json_strdup_range(tokenizer->json + start, length);
-            DEBUG_PRINT("Tokenizer: TOKEN_NUMBER with value '%s'\n", token.value);
+            *length = tokenizer->pos - *start;
+            type = TOKEN_NUMBER;
+            DEBUG_PRINT("Tokenizer: TOKEN_NUMBER with value '%.*s'\n", (int)*length, tokenizer->json + *start);
         }
         else
         {
-            token.type = TOKEN_ERROR;
+            type = TOKEN_ERROR;
             DEBUG_PRINT("Tokenizer: TOKEN_ERROR with unrecognized character '%c' at position %zu\n", current, tokenizer->pos);
         }
         break;
     }
 
+    return type;
+}
+
+JsonToken json_get_next_token(JsonTokenizer *tokenizer)
+{
+    JsonToken token;
+    size_t start;
+    size_t length;
+
+    token.type = json_scan_token(tokenizer, &start, &length);
+    token.value = NULL;
+    if (token.type == TOKEN_STRING && tokenizer->escaped)
+    {
+        token.value = json_alloc(length + 1);
+        if (token.value && json_unescape(tokenizer->json + start, length, token.value) == SIZE_MAX)
+        {
+            json_free(token.value);
+            token.value = NULL;
+            token.type = TOKEN_ERROR;
+        }
+    }
+    else if (token.type == TOKEN_STRING || token.type == TOKEN_NUMBER)
+    {
+        token.value = json_strdup_range(tokenizer->json + start, length);
+    }
+
     return token;
 }
 
+void json_token_tape_init(JsonTokenTape *tape)
+{
+    tape->tokens = NULL;
+    tape->count = 0;
+    tape->capacity = 0;
+}
+
+void json_token_tape_free(JsonTokenTape *tape)
+{
+    json_free(tape->tokens);
+    json_token_tape_init(tape);
+}
+
+/* Cap on the tokens reserved up front (1 MiB of tape), whatever the input size. */
+#define TAPE_MAX_INITIAL_TOKENS 65536
+
+/**
+ * @brief Ensures the tape can hold at least `needed` tokens.
+ */
+static int tape_reserve(JsonTokenTape *tape, size_t needed)
+{
+    if (needed <= tape->capacity)
+        return 1;
+
+    size_t capacity = tape->capacity ? tape->capacity : 64;
+    while (capacity < needed)
+        capacity *= 2;
+    JsonTapeToken *tokens = json_realloc(tape->tokens, sizeof(JsonTapeToken) * capacity);
+    if (!tokens)
+        return 0;
+    tape->tokens = tokens;
+    tape->capacity = capacity;
+    return 1;
+}
+
+int json_tokenize_all(const char *json, size_t length, JsonTokenTape *out)
+{
+    const char *p = json;
+    const char *end = json + length;
+
+    out->count = 0;
+    /* A rough guess that avoids most regrowth on small documents; large ones grow geometrically */
+    size_t guess = length / 8 + 2;
+    if (!tape_reserve(out, guess < TAPE_MAX_INITIAL_TOKENS ? guess : TAPE_MAX_INITIAL_TOKENS))
+        return 0;
+
+    while (1)
+    {
+        while (p < end && json_is_whitespace(*p))
+            p++;
+
+        if (out->count == out->capacity && !tape_reserve(out, out->count + 1))
+            return 0;
+        JsonTapeToken *token = &out->tokens[out->count++];
+        token->offset = (size_t)(p - json);
+        token->length = 0;
+
+        if (p == end || *p == '\0')
+        {
+            token->type = TOKEN_EOF;
+            return 1;
+        }
+
+        switch (*p)
+        {
+        case '{':
+            token->type = TOKEN_LEFT_BRACE;
+            p++;
+            continue;
+        case '}':
+            token->type = TOKEN_RIGHT_BRACE;
+            p++;
+            continue;
+        case '[':
+            token->type = TOKEN_LEFT_BRACKET;
+            p++;
+            continue;
+        case ']':
+            token->type = TOKEN_RIGHT_BRACKET;
+            p++;
+            continue;
+        case ':':
+            token->type = TOKEN_COLON;
+            p++;
+            continue;
+        case ',':
+            token->type = TOKEN_COMMA;
+            p++;
+            continue;
+        case '"':
+        {
+            const char *start = ++p;
+            int escaped;
+            const char *quote = scan_string(p, end, &escaped);
+            if (!quote || (size_t)(quote - start) > UINT32_MAX)
+                break;
+            p = quote;
+            token->type = TOKEN_STRING;
+            token->offset = (size_t)(start - json);
+            token->length = (uint32_t)(p - start);
+            p++;
+            continue;
+        }
+        case 't':
+            if (end - p < 4 || memcmp(p, "true", 4) != 0)
+                break;
+            token->type = TOKEN_TRUE;
+            p += 4;
+            continue;
+        case 'f':
+            if (end - p < 5 || memcmp(p, "false", 5) != 0)
+                break;
+            token->type = TOKEN_FALSE;
+            p += 5;
+            continue;
+        case 'n':
+            if (end - p < 4 || memcmp(p, "null", 4) != 0)
+                break;
+            token->type = TOKEN_NULL;
+            p += 4;
+            continue;
+        default:
+            if ((*p >= '0' && *p <= '9') || *p == '-')
+            {
+                const char *start = p;
+                if (*p == '-')
+                    p++;
+                while (p < end && *p >= '0' && *p <= '9')
+                    p++;
+                if (p < end && *p == '.')
+                {
+                    p++;
+                    while (p < end && *p >= '0' && *p <= '9')
+                        p++;
+                }
+                if (p < end && (*p == 'e' || *p == 'E'))
+                {
+                    p++;
+                    if (p < end && (*p == '+' || *p == '-'))
+                        p++;
+                    while (p < end && *p >= '0' && *p <= '9')
+                        p++;
+                }
+                token->type = TOKEN_NUMBER;
+                token->length = (uint32_t)(p - start);
+                continue;
+            }
+            break;
+        }
+
+        /* Only reached on a lexical error */
+        token->type = TOKEN_ERROR;
+        token->offset = (size_t)(p - json);
+        return 0;
+    }
+}
+
 void json_token_free(JsonToken *token)
 {
     if (token->value)
@@ -1,6 +1,11 @@
 #include "json_utils.h"
+#include "json_shape.h"
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* Allocates memory of the specified size. */
 void *json_alloc(size_t size)
 {
@@ -43,6 +48,407 @@ char *json_strdup_range(const char *s, size_t len)
     return dup;
 }
 
+/* Number literals up to this length are converted without allocating. */
+#define NUMBER_BUFFER_SIZE 64
+
+/* Converts a range of characters holding a JSON number to a double. */
+double json_number_from_range(const char *s, size_t len)
+{
+    char buffer[NUMBER_BUFFER_SIZE];
+    char *num_str = buffer;
+    if (len >= sizeof(buffer))
+    {
+        num_str = json_alloc(len + 1);
+        if (!num_str)
+            return 0.0;
+    }
+    memcpy(num_str, s, len);
+    num_str[len] = '\0';
+    double number = atof(num_str);
+    if (num_str != buffer)
+        json_free(num_str);
+    return number;
+}
+
+/* Hashes an object key (32-bit FNV-1a, with 0 reserved). */
+uint32_t json_hash_key(const char *s, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+/* Measures a well-formed UTF-8 sequence (RFC 3629, Unicode Table 3-7). */
+size_t json_utf8_sequence_length(const unsigned char *s, size_t avail)
+{
+    unsigned char c = s[0];
+    if (c < 0x80)
+        return 1;
+
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF; /* Range of the second byte */
+    if (c >= 0xC2 && c <= 0xDF)
+        length = 2;
+    else if (c >= 0xE0 && c <= 0xEF)
+    {
+        length = 3;
+        if (c == 0xE0)
+            low = 0xA0; /* Overlong */
+        else if (c == 0xED)
+            high = 0x9F; /* Surrogates */
+    }
+    else if (c >= 0xF0 && c <= 0xF4)
+    {
+        length = 4;
+        if (c == 0xF0)
+            low = 0x90; /* Overlong */
+        else if (c == 0xF4)
+            high = 0x8F; /* Above U+10FFFF */
+    }
+    else
+        return 0;
+
+    if (avail < length || s[1] < low || s[1] > high)
+        return 0;
+    for (size_t i = 2; i < length; i++)
+    {
+        if (s[i] < 0x80 || s[i] > 0xBF)
+            return 0;
+    }
+    return length;
+}
+
+/* Skips string bytes that are not a quote, backslash, control or non-ASCII byte. */
+const char *json_scan_string_run(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(0x20);
+    while (end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        /* Signed compare: bytes >= 0x80 are negative and so also below 0x20 */
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmplt_epi8(chunk, space));
+        int mask = _mm_movemask_epi8(special);
+        if (mask)
+            return p + __builtin_ctz((unsigned int)mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20 && (unsigned char)*p < 0x80)
+        p++;
+    return p;
+}
+
+/* Measures the number at the start of some text, following the JSON grammar. */
+size_t json_number_length(const char *s, size_t len)
+{
+    const char *p = s;
+    const char *end = s + len;
+
+    if (p < end && *p == '-')
+        p++;
+    if (p == end)
+        return 0;
+    if (*p == '0')
+    {
+        p++;
+    }
+    else if (*p >= '1' && *p <= '9')
+    {
+        while (p < end && *p >= '0' && *p <= '9')
+            p++;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (p == end || *p < '0' || *p > '9')
+            return 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            p++;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+            p++;
+        if (p == end || *p < '0' || *p > '9')
+            return 0;
+        while (p < end && *p >= '0' && *p <= '9')
+            p++;
+    }
+    return (size_t)(p - s);
+}
+
+/* Checks whether text holds raw control characters. */
+int json_has_control_chars(const char *s, size_t len)
+{
+    const char *end = s + len;
+    for (const char *p = json_scan_string_run(s, end); p < end; p = json_scan_string_run(p + 1, end))
+    {
+        if ((unsigned char)*p < 0x20)
+            return 1;
+    }
+    return 0;
+}
+
+/* Reads the four hex digits of a \u escape. */
+long json_parse_hex4(const char *s, size_t avail)
+{
+    if (avail < 4)
+        return -1;
+    long value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = s[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            value |= c - 'A' + 10;
+        else
+            return -1;
+    }
+    return value;
+}
+
+/**
+ * @brief Writes a code point as UTF-8.
+ *
+ * @return Number of bytes written (1 to 4).
+ */
+static size_t utf8_encode(unsigned long cp, char *out)
+{
+    if (cp < 0x80)
+    {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800)
+    {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000)
+    {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* Decodes the escape sequences in a string's contents. */
+size_t json_unescape(const char *s, size_t len, char *out)
+{
+    const char *end = s + len;
+    char *dst = out;
+
+    while (1)
+    {
+        /* Copy the run up to the next escape in one go */
+        const char *backslash = memchr(s, '\\', (size_t)(end - s));
+        size_t run = (size_t)((backslash ? backslash : end) - s);
+        memcpy(dst, s, run);
+        dst += run;
+        if (!backslash)
+            break;
+
+        s = backslash;
+        if (end - s < 2)
+            return SIZE_MAX;
+        char c = s[1];
+        s += 2;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            *dst++ = c;
+            break;
+        case 'b':
+            *dst++ = '\b';
+            break;
+        case 'f':
+            *dst++ = '\f';
+            break;
+        case 'n':
+            *dst++ = '\n';
+            break;
+        case 'r':
+            *dst++ = '\r';
+            break;
+        case 't':
+            *dst++ = '\t';
+            break;
+        case 'u':
+        {
+            long unit = json_parse_hex4(s, (size_t)(end - s));
+            if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF))
+                return SIZE_MAX;
+            s += 4;
+            unsigned long cp = (unsigned long)unit;
+            if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                /* A high surrogate must be followed by an escaped low surrogate */
+                long low = (end - s >= 6 && s[0] == '\\' && s[1] == 'u') ? json_parse_hex4(s + 2, 4) : -1;
+                if (low < 0xDC00 || low > 0xDFFF)
+                    return SIZE_MAX;
+                s += 6;
+                cp = 0x10000 + (((unsigned long)unit - 0xD800) << 10) + ((unsigned long)low - 0xDC00);
+            }
+            dst += utf8_encode(cp, dst);
+            break;
+        }
+        default:
+            return SIZE_MAX;
+        }
+    }
+
+    *dst = '\0';
+    return (size_t)(dst - out);
+}
+
+/* Decodes the next reference token of a JSON Pointer. */
+const char *json_pointer_token(const char *p, char *token, size_t *length)
+{
+    size_t n = 0;
+    for (; *p && *p != '/'; p++)
+    {
+        char c = *p;
+        if (c == '~')
+        {
+            if (p[1] != '0' && p[1] != '1')
+                return NULL;
+            c = p[1] == '0' ? '~' : '/';
+            p++;
+        }
+        token[n++] = c;
+    }
+    token[n] = '\0';
+    *length = n;
+    return p;
+}
+
+/* Reads an array index from a JSON Pointer token. */
+size_t json_pointer_index(const char *token, size_t length)
+{
+    if (length == 0 || (length > 1 && token[0] == '0'))
+        return SIZE_MAX;
+    size_t index = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (token[i] < '0' || token[i] > '9' || index > (SIZE_MAX - 10) / 10)
+            return SIZE_MAX;
+        index = index * 10 + (size_t)(token[i] - '0');
+    }
+    return index;
+}
+
+/* Returns the length of a pair's key. */
+size_t json_pair_key_length(const JsonPair *pair)
+{
+    return pair->key_hash ? pair->key_length : strlen(pair->key);
+}
+
+/* Finds the position of a key in an object. */
+size_t json_object_slot(const JsonObject *object, const char *key, size_t length, uint32_t hash)
+{
+    if (object->shape)
+        return json_shape_slot(object->shape, key, length, hash);
+
+    for (size_t i = 0; i < object->count; i++)
+    {
+        const JsonPair *pair = &object->pairs[i];
+        if (pair->key_hash ? pair->key_hash == hash && pair->key_length == length
+                           : strlen(pair->key) == length)
+        {
+            if (memcmp(pair->key, key, length) == 0)
+                return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+/* Checks whether two pairs have the same key. */
+int json_same_key(const JsonPair *a, const JsonPair *b)
+{
+    if (a->key_hash && b->key_hash)
+    {
+        return a->key_hash == b->key_hash && a->key_length == b->key_length &&
+               memcmp(a->key, b->key, a->key_length) == 0;
+    }
+    return strcmp(a->key, b->key) == 0;
+}
+
+/* Finds the position of the member with the same key as a pair. */
+size_t json_object_pair_slot(const JsonObject *object, const JsonPair *pair, size_t hint)
+{
+    if (hint < object->count && json_same_key(&object->pairs[hint], pair))
+        return hint;
+    size_t length = json_pair_key_length(pair);
+    uint32_t hash = pair->key_hash ? pair->key_hash : json_hash_key(pair->key, length);
+    return json_object_slot(object, pair->key, length, hash);
+}
+
+/* Returns an item of an array, making a value for a packed number. */
+const JsonValue *json_array_item(const JsonValue *array, size_t index, JsonValue *scratch)
+{
+    if (!(array->flags & JSON_FLAG_PACKED_NUMBERS))
+        return array->value.array->items[index];
+    scratch->type = JSON_NUMBER;
+    scratch->flags = 0;
+    scratch->value.number = array->value.array->numbers[index];
+    return scratch;
+}
+
+/* Returns a short description of an error code. */
+const char *json_error_string(JsonErrorCode code)
+{
+    switch (code)
+    {
+    case JSON_ERROR_NONE:
+        return "no error";
+    case JSON_ERROR_UNEXPECTED_END:
+        return "unexpected end of input";
+    case JSON_ERROR_UNEXPECTED_CHAR:
+        return "unexpected character";
+    case JSON_ERROR_INVALID_NUMBER:
+        return "invalid number";
+    case JSON_ERROR_INVALID_STRING:
+        return "control character in string";
+    case JSON_ERROR_INVALID_ESCAPE:
+        return "invalid escape sequence";
+    case JSON_ERROR_INVALID_UTF8:
+        return "invalid UTF-8";
+    case JSON_ERROR_TOO_DEEP:
+        return "nesting too deep";
+    case JSON_ERROR_TRAILING_DATA:
+        return "trailing data after value";
+    }
+    return "unknown error";
+}
+
 /* Checks if a character is considered whitespace in JSON. */
 int json_is_whitespace(char c)
 {
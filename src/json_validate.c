@@ -0,0 +1,292 @@
+#include "json_validate.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include <string.h>
+
+/* Validator state: the input and the error being reported. */
+typedef struct
+{
+    const unsigned char *start; /**< First byte of the input. */
+    const unsigned char *end;   /**< One past the last byte of the input. */
+    JsonError *err;             /**< Where to report an error, or NULL. */
+} Validator;
+
+/**
+ * @brief Records an error at a position in the input.
+ *
+ * Line and column are only computed here, so valid input pays nothing for
+ * them.
+ *
+ * @return Always 0, for use in return statements.
+ */
+static int fail(const Validator *v, const unsigned char *at, JsonErrorCode code)
+{
+    if (!v->err)
+        return 0;
+
+    v->err->code = code;
+    v->err->offset = (size_t)(at - v->start);
+    v->err->line = 1;
+    v->err->column = 1;
+    for (const unsigned char *p = v->start; p < at; p++)
+    {
+        if (*p == '\n')
+        {
+            v->err->line++;
+            v->err->column = 1;
+        }
+        else
+        {
+            v->err->column++;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Records an error and returns NULL, for the scanning helpers.
+ */
+static const unsigned char *fail_at(const Validator *v, const unsigned char *at, JsonErrorCode code)
+{
+    fail(v, at, code);
+    return NULL;
+}
+
+/**
+ * @brief Skips JSON whitespace.
+ */
+static const unsigned char *skip_whitespace(const unsigned char *p, const unsigned char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        p++;
+    return p;
+}
+
+/**
+ * @brief Validates a string starting at its opening quote.
+ *
+ * @return Pointer past the closing quote, or NULL after reporting an error.
+ */
+static const unsigned char *validate_string(const Validator *v, const unsigned char *p)
+{
+    const unsigned char *end = v->end;
+    p++; /* Opening quote */
+
+    while (1)
+    {
+        p = (const unsigned char *)json_scan_string_run((const char *)p, (const char *)end);
+        if (p == end)
+            return fail_at(v, p, JSON_ERROR_UNEXPECTED_END);
+
+        unsigned char c = *p;
+        if (c == '"')
+            return p + 1;
+        if (c < 0x20)
+            return fail_at(v, p, JSON_ERROR_INVALID_STRING);
+        if (c >= 0x80)
+        {
+            size_t length = json_utf8_sequence_length(p, (size_t)(end - p));
+            if (!length)
+                return fail_at(v, p, JSON_ERROR_INVALID_UTF8);
+            p += length;
+            continue;
+        }
+
+        /* Backslash */
+        const unsigned char *escape = p;
+        if (end - p < 2)
+            return fail_at(v, end, JSON_ERROR_UNEXPECTED_END);
+        switch (p[1])
+        {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            p += 2;
+            break;
+        case 'u':
+        {
+            long unit = json_parse_hex4((const char *)p + 2, (size_t)(end - p - 2));
+            if (unit < 0)
+                return fail_at(v, escape, JSON_ERROR_INVALID_ESCAPE);
+            p += 6;
+            if (unit >= 0xDC00 && unit <= 0xDFFF)
+                return fail_at(v, escape, JSON_ERROR_INVALID_ESCAPE);
+            if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                /* A high surrogate must be followed by an escaped low surrogate */
+                long low = (end - p >= 6 && p[0] == '\\' && p[1] == 'u') ? json_parse_hex4((const char *)p + 2, 4) : -1;
+                if (low < 0xDC00 || low > 0xDFFF)
+                    return fail_at(v, escape, JSON_ERROR_INVALID_ESCAPE);
+                p += 6;
+            }
+            break;
+        }
+        default:
+            return fail_at(v, escape, JSON_ERROR_INVALID_ESCAPE);
+        }
+    }
+}
+
+/**
+ * @brief Validates an object member's key and the colon after it.
+ *
+ * @param[in] v Pointer to the Validator.
+ * @param[in] p Position of the key (whitespace already skipped).
+ * @return Pointer past the colon, or NULL after reporting an error.
+ */
+static const unsigned char *validate_key(const Validator *v, const unsigned char *p)
+{
+    if (p == v->end)
+        return fail_at(v, p, JSON_ERROR_UNEXPECTED_END);
+    if (*p != '"')
+        return fail_at(v, p, JSON_ERROR_UNEXPECTED_CHAR);
+    if (!(p = validate_string(v, p)))
+        return NULL;
+    p = skip_whitespace(p, v->end);
+    if (p == v->end)
+        return fail_at(v, p, JSON_ERROR_UNEXPECTED_END);
+    if (*p != ':')
+        return fail_at(v, p, JSON_ERROR_UNEXPECTED_CHAR);
+    return p + 1;
+}
+
+/**
+ * @brief Validates a number.
+ *
+ * @return Pointer past the number, or NULL after reporting an error.
+ */
+static const unsigned char *validate_number(const Validator *v, const unsigned char *p)
+{
+    const unsigned char *end = v->end;
+    size_t length = json_number_length((const char *)p, (size_t)(end - p));
+    if (length == 0)
+        return fail_at(v, p, JSON_ERROR_INVALID_NUMBER);
+    p += length;
+
+    /* "01" or "1x" must not be accepted as a number followed by more input */
+    if (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-'))
+        return fail_at(v, p, JSON_ERROR_INVALID_NUMBER);
+    return p;
+}
+
+/**
+ * @brief Validates one of the literals true, false and null.
+ *
+ * @return Pointer past the literal, or NULL after reporting an error.
+ */
+static const unsigned char *validate_literal(const Validator *v, const unsigned char *p, const char *literal)
+{
+    size_t length = strlen(literal);
+    if ((size_t)(v->end - p) < length || memcmp(p, literal, length) != 0)
+        return fail_at(v, p, (size_t)(v->end - p) < length ? JSON_ERROR_UNEXPECTED_END : JSON_ERROR_UNEXPECTED_CHAR);
+    return p + length;
+}
+
+int json_validate(const char *json, size_t length, JsonError *err)
+{
+    Validator v;
+    v.start = (const unsigned char *)json;
+    v.end = v.start + (json ? length : 0);
+    v.err = err;
+    if (err)
+        memset(err, 0, sizeof(*err));
+
+    /* One bit per open container: set for objects, clear for arrays */
+    unsigned char kinds[JSON_VALIDATE_MAX_DEPTH / 8];
+    size_t depth = 0;
+
+    const unsigned char *p = v.start;
+    const unsigned char *end = v.end;
+
+    while (1)
+    {
+        /* A value is expected */
+        p = skip_whitespace(p, end);
+        if (p == end)
+            return fail(&v, p, JSON_ERROR_UNEXPECTED_END);
+
+        switch (*p)
+        {
+        case '{':
+        case '[':
+        {
+            if (depth == JSON_VALIDATE_MAX_DEPTH)
+                return fail(&v, p, JSON_ERROR_TOO_DEEP);
+            int is_object = *p == '{';
+            if (is_object)
+                kinds[depth / 8] |= (unsigned char)(1u << (depth % 8));
+            else
+                kinds[depth / 8] &= (unsigned char)~(1u << (depth % 8));
+            depth++;
+
+            p = skip_whitespace(p + 1, end);
+            if (p < end && *p == (is_object ? '}' : ']'))
+            {
+                depth--;
+                p++;
+                break;
+            }
+            if (is_object && !(p = validate_key(&v, p)))
+                return 0;
+            continue;
+        }
+        case '"':
+            if (!(p = validate_string(&v, p)))
+                return 0;
+            break;
+        case 't':
+            if (!(p = validate_literal(&v, p, "true")))
+                return 0;
+            break;
+        case 'f':
+            if (!(p = validate_literal(&v, p, "false")))
+                return 0;
+            break;
+        case 'n':
+            if (!(p = validate_literal(&v, p, "null")))
+                return 0;
+            break;
+        default:
+            if (*p == '-' || (*p >= '0' && *p <= '9'))
+            {
+                if (!(p = validate_number(&v, p)))
+                    return 0;
+                break;
+            }
+            return fail(&v, p, JSON_ERROR_UNEXPECTED_CHAR);
+        }
+
+        /* A value is complete: close containers until one continues */
+        while (1)
+        {
+            p = skip_whitespace(p, end);
+            if (depth == 0)
+            {
+                if (p != end)
+                    return fail(&v, p, JSON_ERROR_TRAILING_DATA);
+                return 1;
+            }
+            if (p == end)
+                return fail(&v, p, JSON_ERROR_UNEXPECTED_END);
+
+            int in_object = (kinds[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            if (*p == (in_object ? '}' : ']'))
+            {
+                depth--;
+                p++;
+                continue;
+            }
+            if (*p != ',')
+                return fail(&v, p, JSON_ERROR_UNEXPECTED_CHAR);
+            p = skip_whitespace(p + 1, end);
+            if (in_object && !(p = validate_key(&v, p)))
+                return 0;
+            break;
+        }
+    }
+}
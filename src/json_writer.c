@@ -0,0 +1,263 @@
+#include "json_writer.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Capacity of a writer's first buffer. */
+#define WRITER_INITIAL_CAPACITY 256
+
+/**
+ * @brief Empties a writer without touching its options.
+ */
+static void writer_reset(JsonWriter *writer)
+{
+    writer->data = NULL;
+    writer->length = 0;
+    writer->capacity = 0;
+    writer->failed = 0;
+}
+
+void json_writer_init(JsonWriter *writer)
+{
+    writer_reset(writer);
+    writer->literal_slashes = 0;
+    writer->sink = NULL;
+    writer->sink_context = NULL;
+}
+
+void json_writer_init_sink(JsonWriter *writer, JsonWriterSink sink, void *context)
+{
+    json_writer_init(writer);
+    writer->sink = sink;
+    writer->sink_context = context;
+}
+
+/**
+ * @brief Sink writing to a stdio stream.
+ */
+static int file_sink(void *context, const char *data, size_t length)
+{
+    return fwrite(data, 1, length, (FILE *)context) == length;
+}
+
+void json_writer_init_file(JsonWriter *writer, FILE *file)
+{
+    json_writer_init_sink(writer, file_sink, file);
+}
+
+int json_writer_flush(JsonWriter *writer)
+{
+    if (writer->failed)
+        return 0;
+    if (writer->sink && writer->length > 0)
+    {
+        if (!writer->sink(writer->sink_context, writer->data, writer->length))
+        {
+            writer->failed = 1;
+            return 0;
+        }
+        writer->length = 0;
+    }
+    return 1;
+}
+
+void json_writer_free(JsonWriter *writer)
+{
+    json_free(writer->data);
+    writer_reset(writer);
+}
+
+int json_writer_reserve(JsonWriter *writer, size_t extra)
+{
+    if (writer->failed)
+        return 0;
+
+    /* One extra byte is always kept for the terminator added by json_writer_finish */
+    size_t needed = writer->length + extra + 1;
+    if (needed <= writer->capacity)
+        return 1;
+
+    /* A writer with a sink passes on what it holds rather than growing */
+    if (writer->sink && writer->length > 0)
+    {
+        if (!json_writer_flush(writer))
+            return 0;
+        needed = extra + 1;
+        if (needed <= writer->capacity)
+            return 1;
+    }
+
+    size_t capacity = writer->capacity ? writer->capacity
+                                       : (writer->sink ? JSON_STREAM_BUFFER_SIZE : WRITER_INITIAL_CAPACITY);
+    while (capacity < needed)
+        capacity *= 2;
+    char *data = json_realloc(writer->data, capacity);
+    if (!data)
+    {
+        writer->failed = 1;
+        return 0;
+    }
+    writer->data = data;
+    writer->capacity = capacity;
+    return 1;
+}
+
+void json_writer_write(JsonWriter *writer, const char *data, size_t length)
+{
+    if (!json_writer_reserve(writer, length))
+        return;
+    memcpy(writer->data + writer->length, data, length);
+    writer->length += length;
+}
+
+void json_writer_puts(JsonWriter *writer, const char *str)
+{
+    json_writer_write(writer, str, strlen(str));
+}
+
+void json_writer_putc(JsonWriter *writer, char c)
+{
+    if (!json_writer_reserve(writer, 1))
+        return;
+    writer->data[writer->length++] = c;
+}
+
+/*
+ * Escape letter for each byte: the character following the backslash, 'u'
+ * for bytes written as \u00XX, or 0 for bytes copied as-is.
+ */
+static const char escape_letter[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+    [0x5C] = '\\',
+};
+
+/**
+ * @brief Finds the first byte of a string that must be escaped.
+ *
+ * Examines 32 bytes at a time with AVX2, or 16 with SSE2, where the
+ * compiler provides them.
+ *
+ * @param[in] p       Where to start scanning.
+ * @param[in] end     One past the last byte of the string.
+ * @param[in] slashes Whether '/' must be escaped.
+ * @return The first byte to escape, or `end`.
+ */
+static const char *find_escape(const char *p, const char *end, int slashes)
+{
+#if defined(__AVX2__)
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i slash = _mm256_set1_epi8(slashes ? '/' : '"');
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        while (end - p >= 32)
+        {
+            __m256i chunk = _mm256_loadu_si256((const __m256i *)p);
+            /* Unsigned compare: a byte is below 0x20 when max(byte, 0x1F) == 0x1F */
+            __m256i special = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, slash),
+                                _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control)));
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+            if (mask)
+                return p + __builtin_ctz(mask);
+            p += 32;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i slash = _mm_set1_epi8(slashes ? '/' : '"');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        while (end - p >= 16)
+        {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(chunk, slash),
+                                                        _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)));
+            int mask = _mm_movemask_epi8(special);
+            if (mask)
+                return p + __builtin_ctz((unsigned int)mask);
+            p += 16;
+        }
+    }
+#endif
+    while (p < end)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (escape_letter[c] && (c != '/' || slashes))
+            return p;
+        p++;
+    }
+    return p;
+}
+
+void json_writer_write_escaped(JsonWriter *writer, const char *str, size_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *end = str + length;
+    int slashes = !writer->literal_slashes;
+
+    while (1)
+    {
+        /* Copy the clean run, leaving room for the escape that ends it */
+        const char *special = find_escape(str, end, slashes);
+        size_t run = (size_t)(special - str);
+        if (!json_writer_reserve(writer, run + 6))
+            return;
+        memcpy(writer->data + writer->length, str, run);
+        writer->length += run;
+        if (special == end)
+            return;
+
+        unsigned char c = (unsigned char)*special;
+        char *dst = writer->data + writer->length;
+        dst[0] = '\\';
+        dst[1] = escape_letter[c];
+        if (dst[1] == 'u')
+        {
+            dst[2] = '0';
+            dst[3] = '0';
+            dst[4] = hex[c >> 4];
+            dst[5] = hex[c & 0xF];
+            writer->length += 6;
+        }
+        else
+        {
+            writer->length += 2;
+        }
+        str = special + 1;
+    }
+}
+
+void json_writer_write_number(JsonWriter *writer, double number)
+{
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%g", number);
+    if (length > 0)
+        json_writer_write(writer, buffer, (size_t)length);
+}
+
+char *json_writer_finish(JsonWriter *writer)
+{
+    if (!json_writer_reserve(writer, 0))
+    {
+        json_writer_free(writer);
+        return NULL;
+    }
+    char *result = writer->data;
+    result[writer->length] = '\0';
+    writer_reset(writer);
+    return result;
+}
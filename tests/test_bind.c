@@ -0,0 +1,152 @@
+#include "json_bind.h"
+#include "json_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+    char *city;
+    int64_t zip;
+} Address;
+
+typedef struct
+{
+    int64_t id;
+    char *name;
+    double score;
+    bool active;
+    Address address;
+    char *note;
+} User;
+
+static const JsonFieldDesc address_fields[] = {
+    JSON_FIELD("city", JSON_FIELD_STRING, Address, city, NULL),
+    JSON_FIELD("zip", JSON_FIELD_INT, Address, zip, NULL),
+};
+static const JsonStructDesc address_desc = JSON_STRUCT_DESC(Address, address_fields);
+
+static const JsonFieldDesc user_fields[] = {
+    JSON_FIELD("id", JSON_FIELD_INT, User, id, NULL),
+    JSON_FIELD("name", JSON_FIELD_STRING, User, name, NULL),
+    JSON_FIELD("score", JSON_FIELD_DOUBLE, User, score, NULL),
+    JSON_FIELD("active", JSON_FIELD_BOOL, User, active, NULL),
+    JSON_FIELD("address", JSON_FIELD_OBJECT, User, address, &address_desc),
+    JSON_FIELD("note", JSON_FIELD_STRING, User, note, NULL),
+};
+static const JsonStructDesc user_desc = JSON_STRUCT_DESC(User, user_fields);
+
+/**
+ * @brief Tests binding known fields and skipping unknown ones.
+ */
+void test_bind_struct()
+{
+    const char *json = "{ \"id\": -9007199254740993, \"extra\": [1, {\"deep\": [[], {}]}, \"x\"], \"name\": \"ada\", "
+                       "\"score\": 45.25, \"active\": true, \"address\": { \"zip\": 10115, \"unused\": null, "
+                       "\"city\": \"Berlin\" }, \"note\": null, \"more\": {} }";
+    User user;
+    assert(json_bind(json, strlen(json), &user_desc, &user));
+    assert(user.id == -9007199254740993LL);
+    assert(strcmp(user.name, "ada") == 0);
+    assert(user.score == 45.25);
+    assert(user.active == true);
+    assert(strcmp(user.address.city, "Berlin") == 0);
+    assert(user.address.zip == 10115);
+    assert(user.note == NULL);
+    json_bind_free(&user_desc, &user);
+    assert(user.name == NULL && user.address.city == NULL);
+
+    /* Escaped keys and values are decoded */
+    const char *escaped = "{ \"n\\u0061me\": \"a\\tb\\u00e9\" }";
+    assert(json_bind(escaped, strlen(escaped), &user_desc, &user));
+    assert(strcmp(user.name, "a\tb\xc3\xa9") == 0);
+    json_bind_free(&user_desc, &user);
+
+    /* Absent members are zeroed */
+    assert(json_bind("{}", 2, &user_desc, &user));
+    assert(user.id == 0 && user.name == NULL && user.active == false);
+
+    /* A repeated key takes its last value whole, null included */
+    const char *repeated = "{ \"id\": 5, \"score\": 1.5, \"active\": true, \"name\": \"x\", "
+                           "\"address\": { \"city\": \"Oslo\", \"zip\": 150 }, \"id\": null, \"score\": null, "
+                           "\"active\": null, \"name\": null, \"address\": { \"zip\": 1 }, \"note\": \"y\", \"note\": null }";
+    assert(json_bind(repeated, strlen(repeated), &user_desc, &user));
+    assert(user.id == 0 && user.score == 0 && user.active == false && user.name == NULL && user.note == NULL);
+    assert(user.address.city == NULL && user.address.zip == 1);
+    json_bind_free(&user_desc, &user);
+    const char *cleared = "{ \"address\": { \"city\": \"Oslo\" }, \"address\": null }";
+    assert(json_bind(cleared, strlen(cleared), &user_desc, &user));
+    assert(user.address.city == NULL && user.address.zip == 0);
+
+    printf("test_bind_struct passed.\n");
+}
+
+/**
+ * @brief Tests that type mismatches and malformed input are rejected.
+ */
+void test_bind_errors()
+{
+    const char *cases[] = {
+        "{ \"id\": 1.5 }",
+        "{ \"id\": 99999999999999999999 }",
+        "{ \"name\": 3 }",
+        "{ \"active\": \"yes\" }",
+        "{ \"address\": [] }",
+        "{ \"name\": \"a\", \"unknown\": [1, 2 }",
+        "{ \"name\": \"a\" } extra",
+        "[1, 2]",
+        "{ \"name\": \"a\", }",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        User user;
+        assert(json_bind(cases[i], strlen(cases[i]), &user_desc, &user) == 0);
+        assert(user.name == NULL);
+    }
+    printf("test_bind_errors passed.\n");
+}
+
+/**
+ * @brief Tests writing structs back out as JSON.
+ */
+void test_emit_struct()
+{
+    User user = {-42, "a\"b", 2.5, true, {NULL, 10115}, NULL};
+    JsonWriter writer;
+    json_writer_init(&writer);
+    assert(json_emit_struct(&user_desc, &user, &writer));
+    char *json = json_writer_finish(&writer);
+    assert(json != NULL);
+    assert(strcmp(json, "{\"id\":-42,\"name\":\"a\\\"b\",\"score\":2.5,\"active\":true,"
+                        "\"address\":{\"city\":null,\"zip\":10115},\"note\":null}") == 0);
+
+    /* What is emitted binds back to the same values */
+    User copy;
+    assert(json_bind(json, strlen(json), &user_desc, &copy));
+    assert(copy.id == -42 && copy.score == 2.5 && copy.active && copy.address.zip == 10115);
+    json_bind_free(&user_desc, &copy);
+    json_free(json);
+
+    /* Entries without a prepared fragment escape their key while emitting */
+    static const JsonFieldDesc plain_fields[] = {
+        {"zip/code", JSON_FIELD_INT, offsetof(Address, zip), NULL, NULL, 0},
+        JSON_FIELD("city", JSON_FIELD_STRING, Address, city, NULL),
+    };
+    static const JsonStructDesc plain_desc = JSON_STRUCT_DESC(Address, plain_fields);
+    Address address = {"Oslo", 150};
+    assert(json_emit_struct(&plain_desc, &address, &writer));
+    json = json_writer_finish(&writer);
+    assert(strcmp(json, "{\"zip\\/code\":150,\"city\":\"Oslo\"}") == 0);
+    json_free(json);
+
+    printf("test_emit_struct passed.\n");
+}
+
+int main()
+{
+    test_bind_struct();
+    test_bind_errors();
+    test_emit_struct();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "json_builder.h"
+#include "json_parser.h"
+#include "json_accessor.h"
+#include "json_compare.h"
+#include "json_serializer.h"
+#include "json_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Serializes a value and compares it with the expected text.
+ */
+static int serializes_to(const JsonValue *value, const char *expected)
+{
+    char *out = json_serialize(value);
+    assert(out != NULL);
+    int same = strcmp(out, expected) == 0;
+    if (!same)
+        printf("got %s\n", out);
+    json_free(out);
+    return same;
+}
+
+/**
+ * @brief Tests building and editing a heap document.
+ */
+void test_build_document()
+{
+    JsonValue *root = json_new_object(NULL);
+    assert(root != NULL);
+    assert(json_object_set(NULL, root, "name", json_new_string(NULL, "c-json", 6), 0));
+    assert(json_object_set(NULL, root, "active", json_new_bool(NULL, 1), 0));
+
+    JsonValue *list = json_new_array(NULL);
+    assert(json_object_set(NULL, root, "list", list, 0));
+    for (int i = 0; i < 100; i++)
+        assert(json_array_push(NULL, list, json_new_number(NULL, i)));
+    assert(list->value.array->count == 100 && list->value.array->capacity >= 100);
+
+    /* Insert at the front, remove from the middle, take one out */
+    assert(json_array_insert(NULL, list, 0, json_new_null(NULL)));
+    JsonValue *extra = json_new_null(NULL);
+    assert(!json_array_insert(NULL, list, 102, extra));
+    assert(json_array_remove(NULL, list, 50, NULL));
+    JsonValue *taken = NULL;
+    assert(json_array_remove(NULL, list, 1, &taken));
+    assert(taken->type == JSON_NUMBER && taken->value.number == 0);
+    json_free_value(taken);
+    while (list->value.array->count > 3)
+        assert(json_array_remove(NULL, list, 3, NULL));
+    assert(!json_array_remove(NULL, list, 3, NULL));
+
+    /* Replacing keeps the member's position; moved keys and strings are adopted */
+    assert(json_object_set(NULL, root, "active", json_new_bool(NULL, 0), 0));
+    assert(json_object_set(NULL, root, json_strdup("note"), json_new_string_move(NULL, json_strdup("hi")),
+                           JSON_BUILD_MOVE_KEY));
+    assert(json_object_set(NULL, root, json_strdup("note"), json_new_string(NULL, "ho", 2), JSON_BUILD_MOVE_KEY));
+    assert(serializes_to(root, "{\"name\":\"c-json\",\"active\":false,\"list\":[null,1,2],\"note\":\"ho\"}"));
+
+    JsonValue *removed = NULL;
+    assert(json_object_remove(NULL, root, "name", &removed));
+    assert(strcmp(removed->value.string, "c-json") == 0);
+    json_free_value(removed);
+    assert(json_object_remove(NULL, root, "active", NULL));
+    assert(!json_object_remove(NULL, root, "active", NULL));
+    assert(json_get_value(root, "note") != NULL && json_get_value(root, "name") == NULL);
+    assert(serializes_to(root, "{\"list\":[null,1,2],\"note\":\"ho\"}"));
+
+    /* A failed call leaves the value with the caller */
+    assert(!json_array_push(NULL, root, extra));
+    json_free_value(extra);
+    json_free_value(root);
+    printf("test_build_document passed.\n");
+}
+
+/**
+ * @brief Tests editing parsed documents whose containers share one allocation.
+ */
+void test_edit_parsed()
+{
+    /* Heap document: small containers are inline and must be detached to grow */
+    JsonValue *root = json_parse("{\"a\":1,\"b\":[true],\"c\":{\"d\":2}}");
+    assert(root != NULL && (root->flags & JSON_FLAG_INLINE_CHILDREN));
+    assert(json_object_set(NULL, root, "e", json_new_number(NULL, 3), 0));
+    assert(!(root->flags & JSON_FLAG_INLINE_CHILDREN));
+    assert(json_array_insert(NULL, json_get_value(root, "b"), 0, json_new_null(NULL)));
+    assert(json_object_remove(NULL, json_get_value(root, "c"), "d", NULL));
+    assert(json_object_remove(NULL, root, "a", NULL));
+    assert(serializes_to(root, "{\"b\":[null,true],\"c\":{},\"e\":3}"));
+    json_free_value(root);
+
+    /* Arena document with packed arrays and shared keys */
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    assert(parser != NULL);
+    const char *json = "[{\"x\":1,\"y\":[1,2,3]},{\"x\":2,\"y\":[4]}]";
+    root = json_parser_parse(parser, json, strlen(json));
+    assert(root != NULL);
+    JsonArena *arena = json_parser_arena(parser);
+
+    JsonValue *first = root->value.array->items[0];
+    JsonValue *second = root->value.array->items[1];
+    assert(first->flags & JSON_FLAG_SHARED_KEYS);
+    assert(json_object_set(arena, first, "z", json_new_string(arena, "new", 3), 0));
+    assert(!(first->flags & JSON_FLAG_SHARED_KEYS) && first->value.object->shape == NULL);
+    assert(json_get_number(first, "x") == 1);
+
+    /* Removing from a packed array keeps it packed; growing unpacks it */
+    JsonValue *y = json_get_value(first, "y");
+    assert(y->flags & JSON_FLAG_PACKED_NUMBERS);
+    JsonValue *taken = NULL;
+    assert(json_array_remove(arena, y, 0, &taken) && taken->value.number == 1);
+    assert(y->flags & JSON_FLAG_PACKED_NUMBERS);
+    assert(json_array_push(arena, y, json_new_string(arena, "s", 1)));
+    assert(!(y->flags & JSON_FLAG_PACKED_NUMBERS));
+
+    /* The second object still uses the shared keys */
+    assert(json_object_remove(arena, second, "x", NULL));
+    assert(serializes_to(root, "[{\"x\":1,\"y\":[2,3,\"s\"],\"z\":\"new\"},{\"y\":[4]}]"));
+    json_parser_free(parser);
+    printf("test_edit_parsed passed.\n");
+}
+
+/**
+ * @brief Tests building a document in an arena.
+ */
+void test_build_arena()
+{
+    JsonArena arena;
+    json_arena_init(&arena, 0);
+
+    JsonValue *root = json_new_array(&arena);
+    assert(json_array_reserve(&arena, root, 1000));
+    assert(root->value.array->capacity == 1000);
+    JsonValue **items = root->value.array->items;
+    for (int i = 0; i < 1000; i++)
+    {
+        JsonValue *item = json_new_object(&arena);
+        assert(json_object_reserve(&arena, item, 2));
+        assert(json_object_set(&arena, item, "id", json_new_number(&arena, i), 0));
+        assert(json_object_set(&arena, item, "even", json_new_bool(&arena, i % 2 == 0), 0));
+        assert(item->value.object->capacity == 2);
+        assert(json_array_push(&arena, root, item));
+    }
+    assert(root->value.array->items == items);
+    assert(json_array_push(&arena, root, json_new_null(&arena)));
+    assert(root->value.array->capacity == 2000);
+    assert(json_get_number(root->value.array->items[999], "id") == 999);
+    assert(json_array_remove(&arena, root, 1000, NULL));
+    assert(root->value.array->count == 1000);
+
+    json_arena_destroy(&arena);
+    printf("test_build_arena passed.\n");
+}
+
+/**
+ * @brief Tests deep copies into the heap and into an arena.
+ */
+void test_clone()
+{
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    const char *json = "[{\"id\":1,\"v\":[1,2,3]},{\"id\":2,\"v\":[]},\"a string longer than inline\",null,true]";
+    JsonValue *original = json_parser_parse(parser, json, strlen(json));
+    assert(original != NULL);
+
+    /* The heap copy is independent of the parser that owns the original */
+    JsonValue *copy = json_clone(NULL, original);
+    assert(copy != NULL && json_equal(copy, original));
+    JsonValue *first = copy->value.array->items[0];
+    assert((first->flags & JSON_FLAG_INLINE_CHILDREN) && !(first->flags & JSON_FLAG_SHARED_KEYS));
+    assert(first->value.object->shape == NULL);
+    assert(json_get_value(first, "v")->flags & JSON_FLAG_PACKED_NUMBERS);
+    json_parser_free(parser);
+    assert(serializes_to(copy, "[{\"id\":1,\"v\":[1,2,3]},{\"id\":2,\"v\":[]},\"a string longer than inline\",null,true]"));
+
+    /* Copies can be edited like any other document */
+    assert(json_object_set(NULL, first, "extra", json_new_null(NULL), 0));
+    assert(json_array_push(NULL, json_get_value(first, "v"), json_new_number(NULL, 4)));
+
+    JsonArena arena;
+    json_arena_init(&arena, 0);
+    JsonValue *again = json_clone(&arena, copy);
+    assert(again != NULL && json_equal(again, copy) && json_hash(again) == json_hash(copy));
+    json_free_value(copy);
+    assert(serializes_to(again, "[{\"id\":1,\"v\":[1,2,3,4],\"extra\":null},{\"id\":2,\"v\":[]},"
+                                "\"a string longer than inline\",null,true]"));
+    assert(json_clone(&arena, NULL) == NULL);
+    json_arena_destroy(&arena);
+    printf("test_clone passed.\n");
+}
+
+int main()
+{
+    test_build_document();
+    test_edit_parsed();
+    test_build_arena();
+    test_clone();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "json_cache.h"
+#include "json_accessor.h"
+#include "json_compare.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Looks up text in a cache, returning the document.
+ */
+static JsonDocument *cached(JsonParseCache *cache, const char *json)
+{
+    return json_parse_cached(cache, json, strlen(json));
+}
+
+/**
+ * @brief Tests that repeated text shares one document and is counted as hits.
+ */
+void test_cache_hits()
+{
+    JsonParseCache *cache = json_parse_cache_new(NULL);
+    assert(cache != NULL);
+
+    const char *config = "{\"ttl\":30,\"hosts\":[\"a\",\"b\"]}";
+    JsonDocument *first = cached(cache, config);
+    assert(first != NULL);
+    char copy[64];
+    strcpy(copy, config);
+    JsonDocument *second = cached(cache, copy);
+    assert(second == first);
+    assert(json_get_number(json_document_root(second), "ttl") == 30);
+
+    /* Text differing in a single byte, or in length, is parsed on its own */
+    JsonDocument *other = cached(cache, "{\"ttl\":31,\"hosts\":[\"a\",\"b\"]}");
+    JsonDocument *prefix = json_parse_cached(cache, config, 9);
+    assert(other != NULL && other != first && prefix == NULL);
+    assert(cached(cache, "{\"ttl\":") == NULL);
+
+    JsonParseCacheStats stats;
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.hits == 1 && stats.misses == 4 && stats.entries == 2 && stats.evictions == 0);
+    assert(stats.bytes > 2 * strlen(config));
+
+    /* Documents handed out outlive clearing and freeing the cache */
+    json_parse_cache_clear(cache);
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.entries == 0 && stats.bytes == 0 && stats.hits == 1);
+    JsonDocument *third = cached(cache, config);
+    assert(third != first && json_equal(json_document_root(third), json_document_root(first)));
+    json_parse_cache_free(cache);
+    const JsonValue *hosts = json_get_value(json_document_root(first), "hosts");
+    assert(strcmp(hosts->value.array->items[1]->value.string, "b") == 0);
+
+    json_document_release(first);
+    json_document_release(second);
+    json_document_release(other);
+    json_document_release(third);
+    printf("test_cache_hits passed.\n");
+}
+
+/**
+ * @brief Tests that the least recently used documents are evicted first.
+ */
+void test_cache_eviction()
+{
+    const char *texts[] = {"[1,2,3]", "{\"a\":1}", "\"text\"", "[true,false]"};
+    JsonParseCache *probe = json_parse_cache_new(NULL);
+    JsonParseCacheStats stats;
+    size_t largest = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        size_t before;
+        json_parse_cache_stats(probe, &stats);
+        before = stats.bytes;
+        json_document_release(cached(probe, texts[i]));
+        json_parse_cache_stats(probe, &stats);
+        if (stats.bytes - before > largest)
+            largest = stats.bytes - before;
+    }
+    json_parse_cache_free(probe);
+
+    /* Room for three documents but not four */
+    JsonParseCacheOptions options = {0};
+    options.max_bytes = largest * 3;
+    JsonParseCache *cache = json_parse_cache_new(&options);
+    for (size_t i = 0; i < 3; i++)
+        json_document_release(cached(cache, texts[i]));
+    json_document_release(cached(cache, texts[0])); /* texts[1] is now the oldest */
+    json_document_release(cached(cache, texts[3]));
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.entries == 3 && stats.evictions == 1 && stats.bytes <= options.max_bytes);
+
+    json_document_release(cached(cache, texts[0]));
+    json_document_release(cached(cache, texts[2]));
+    json_document_release(cached(cache, texts[3]));
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.hits == 4 && stats.misses == 4);
+    json_document_release(cached(cache, texts[1]));
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.misses == 5 && stats.evictions == 2);
+    json_parse_cache_free(cache);
+
+    /* A document larger than the whole cache is returned but not kept */
+    options.max_bytes = 64;
+    cache = json_parse_cache_new(&options);
+    JsonDocument *document = cached(cache, texts[0]);
+    assert(document != NULL && json_document_root(document)->value.array->count == 3);
+    json_parse_cache_stats(cache, &stats);
+    assert(stats.entries == 0 && stats.bytes == 0);
+    json_document_release(document);
+    json_parse_cache_free(cache);
+    printf("test_cache_eviction passed.\n");
+}
+
+int main()
+{
+    test_cache_hits();
+    test_cache_eviction();
+    printf("All tests passed!\n");
+    return 0;
+}
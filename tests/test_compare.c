@@ -0,0 +1,120 @@
+#include "json_compare.h"
+#include "json_builder.h"
+#include "json_parser.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Tests deep equality, including member order and storage variants.
+ */
+void test_equal()
+{
+    JsonValue *a = json_parse("{\"id\":7,\"tags\":[\"x\",\"y\"],\"meta\":{\"on\":true,\"z\":null},\"n\":-0}");
+    JsonValue *same = json_parse("{\"id\":7.0,\"tags\":[\"x\",\"y\"],\"meta\":{\"on\":true,\"z\":null},\"n\":0}");
+    JsonValue *reordered = json_parse("{\"meta\":{\"z\":null,\"on\":true},\"n\":0,\"tags\":[\"x\",\"y\"],\"id\":7}");
+    JsonValue *other = json_parse("{\"id\":7,\"tags\":[\"y\",\"x\"],\"meta\":{\"on\":true,\"z\":null},\"n\":0}");
+    JsonValue *extra = json_parse("{\"id\":7,\"tags\":[\"x\",\"y\"],\"meta\":{\"on\":true,\"z\":false},\"n\":0}");
+    assert(a && same && reordered && other && extra);
+
+    assert(json_equal(a, a) && json_equal(NULL, NULL) && !json_equal(a, NULL));
+    assert(json_equal(a, same) && json_equal(a, reordered) && json_equal(reordered, a));
+    assert(!json_equal(a, other) && !json_equal(a, extra));
+
+    JsonValue *dup_a = json_parse("{\"k\":1,\"k\":1}");
+    JsonValue *dup_b = json_parse("{\"k\":1,\"j\":1}");
+    assert(!json_equal(dup_a, dup_b) && !json_equal(dup_b, dup_a));
+
+    /* Objects with repeated keys are equal as multisets of members, as they hash */
+    const char *repeated[][2] = {
+        {"{\"x\":1,\"y\":2,\"x\":1}", "{\"x\":1,\"y\":2,\"y\":2}"},
+        {"{\"x\":1,\"x\":2}", "{\"x\":2,\"x\":1}"},
+        {"{\"y\":0,\"x\":1,\"x\":2}", "{\"x\":2,\"y\":0,\"x\":1}"},
+        {"{\"x\":1,\"x\":1,\"y\":2}", "{\"x\":1,\"y\":2,\"y\":2}"},
+        {"{\"x\":1,\"x\":1}", "{\"x\":1,\"x\":2}"},
+    };
+    for (size_t i = 0; i < sizeof(repeated) / sizeof(repeated[0]); i++)
+    {
+        JsonValue *left = json_parse(repeated[i][0]);
+        JsonValue *right = json_parse(repeated[i][1]);
+        int equal = json_equal(left, right);
+        assert(equal == json_equal(right, left));
+        assert(equal == (json_hash(left) == json_hash(right)));
+        assert(equal == (i == 1 || i == 2));
+        json_free_value(left);
+        json_free_value(right);
+    }
+
+    /* Packed and unpacked arrays, and objects sharing a shape */
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    const char *json = "[{\"v\":[1,2,3]},{\"v\":[1,2,3]},{\"v\":[1,2,4]}]";
+    JsonValue *packed = json_parser_parse(parser, json, strlen(json));
+    JsonValue *plain = json_parse(json);
+    assert(packed->value.array->items[0]->value.object->shape != NULL);
+    assert(json_equal(packed->value.array->items[0], packed->value.array->items[1]));
+    assert(!json_equal(packed->value.array->items[0], packed->value.array->items[2]));
+    assert(json_equal(packed, plain) && json_equal(plain, packed));
+    assert(json_hash(packed) == json_hash(plain));
+    const char *shared = "[{\"x\":1,\"x\":2},{\"x\":2,\"x\":1}]";
+    JsonValue *swapped = json_parser_parse(parser, shared, strlen(shared));
+    assert(swapped->value.array->items[0]->value.object->shape == swapped->value.array->items[1]->value.object->shape);
+    assert(json_equal(swapped->value.array->items[0], swapped->value.array->items[1]));
+
+    json_parser_free(parser);
+    json_free_value(plain);
+    json_free_value(dup_a);
+    json_free_value(dup_b);
+    json_free_value(a);
+    json_free_value(same);
+    json_free_value(reordered);
+    json_free_value(other);
+    json_free_value(extra);
+    printf("test_equal passed.\n");
+}
+
+/**
+ * @brief Tests that equal values hash equally and different ones differ.
+ */
+void test_hash()
+{
+    const char *texts[] = {
+        "null", "true", "false", "0", "1", "\"\"", "\"a\"", "\"ab\"", "\"a longer string of text\"",
+        "[]", "{}", "[0]", "[null]", "[1,2]", "[2,1]", "[[1],2]", "[1,[2]]",
+        "{\"a\":1}", "{\"a\":2}", "{\"b\":1}", "{\"a\":1,\"b\":2}", "{\"a\":2,\"b\":1}", "{\"a\":{}}", "{\"a\":[]}",
+    };
+    size_t count = sizeof(texts) / sizeof(texts[0]);
+    JsonValue *values[sizeof(texts) / sizeof(texts[0])];
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = json_parse(texts[i]);
+        assert(values[i] != NULL);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = i + 1; j < count; j++)
+            assert(json_hash(values[i]) != json_hash(values[j]));
+    }
+
+    JsonValue *a = json_parse("{\"x\":[1,{\"y\":\"z\"}],\"w\":-0,\"v\":\"\\u00e9\"}");
+    JsonValue *b = json_parse("{\"v\":\"\xc3\xa9\",\"w\":0,\"x\":[1.0,{\"y\":\"z\"}]}");
+    assert(json_equal(a, b) && json_hash(a) == json_hash(b));
+    assert(json_hash_seeded(a, 1) == json_hash_seeded(b, 1));
+    assert(json_hash_seeded(a, 1) != json_hash(a));
+
+    json_free_value(a);
+    json_free_value(b);
+    for (size_t i = 0; i < count; i++)
+        json_free_value(values[i]);
+    printf("test_hash passed.\n");
+}
+
+int main()
+{
+    test_equal();
+    test_hash();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "json_document.h"
+#include "json_builder.h"
+#include "json_accessor.h"
+#include "json_serializer.h"
+#include "json_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Serializes a value and compares it with the expected text.
+ */
+static int serializes_to(const JsonValue *value, const char *expected)
+{
+    char *out = json_serialize(value);
+    assert(out != NULL);
+    int same = strcmp(out, expected) == 0;
+    if (!same)
+        printf("got %s\n", out);
+    json_free(out);
+    return same;
+}
+
+/**
+ * @brief Tests that subtrees outlive the document they were taken from.
+ */
+void test_document_subtree()
+{
+    const char *json = "{\"routes\":[{\"path\":\"/a\",\"to\":\"x\"},{\"path\":\"/b\",\"to\":\"y\"}],\"ttl\":30}";
+    JsonDocument *document = json_document_parse(json, strlen(json), NULL);
+    assert(document != NULL);
+    assert(json_document_parse("{", 1, NULL) == NULL);
+
+    const JsonValue *routes = json_get_value(json_document_root(document), "routes");
+    JsonDocument *second = json_document_subtree(document, routes->value.array->items[1]);
+    assert(second != NULL);
+    assert(json_document_retain(document) == document);
+    json_document_release(document);
+    json_document_release(document);
+
+    /* The root's last reference is gone; the subtree still holds its memory */
+    assert(strcmp(json_get_string(json_document_root(second), "to"), "y") == 0);
+    JsonDocument *path = json_document_subtree(second, json_get_value(json_document_root(second), "path"));
+    json_document_release(second);
+    assert(strcmp(json_document_root(path)->value.string, "/b") == 0);
+    json_document_release(path);
+    printf("test_document_subtree passed.\n");
+}
+
+/**
+ * @brief Tests copy-on-write editing of a document.
+ */
+void test_document_edit()
+{
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    const char *json = "{\"routes\":[{\"path\":\"a\",\"ports\":[80,443]},{\"path\":\"b\",\"ports\":[8080]}],"
+                       "\"limits\":{\"rps\":100}}";
+    JsonDocument *v1 = json_document_parse(json, strlen(json), &options);
+    assert(v1 != NULL);
+
+    JsonDocument *draft = json_document_edit(v1);
+    assert(draft != NULL);
+    assert(json_document_edit(draft) == NULL && json_document_subtree(draft, json_document_root(draft)) == NULL);
+    JsonArena *arena = json_document_arena(draft);
+
+    /* Change one route: the containers on its path are copied, the rest shared */
+    JsonValue *route = json_document_unshare(draft, "/routes/0");
+    assert(route != NULL && json_document_unshare(draft, "/routes/0") == route);
+    assert(json_object_set(arena, route, "path", json_new_string(arena, "z", 1), 0));
+    JsonValue *ports = json_document_unshare(draft, "/routes/0/ports");
+    assert(ports != NULL && (ports->flags & JSON_FLAG_PACKED_NUMBERS));
+    assert(json_array_push(arena, ports, json_new_number(arena, 8443)));
+    JsonValue *root = json_document_unshare(draft, "");
+    assert(json_object_remove(arena, root, "limits", NULL));
+
+    assert(json_document_unshare(draft, "/routes/2") == NULL);
+    assert(json_document_unshare(draft, "/routes/0/path") == NULL);
+    assert(json_document_unshare(draft, "routes") == NULL);
+    assert(json_document_unshare(draft, "/routes/01") == NULL);
+    assert(json_document_unshare(draft, "/routes/0/ports/0") == NULL);
+
+    JsonDocument *v2 = json_document_freeze(draft);
+    assert(json_document_unshare(v2, "") == NULL);
+
+    /* The old version is unchanged and the untouched route is shared */
+    const JsonValue *old_routes = json_get_value(json_document_root(v1), "routes");
+    const JsonValue *new_routes = json_get_value(json_document_root(v2), "routes");
+    assert(old_routes != new_routes);
+    assert(old_routes->value.array->items[1] == new_routes->value.array->items[1]);
+    assert(serializes_to(json_document_root(v1), json));
+    json_document_release(v1);
+    assert(serializes_to(json_document_root(v2), "{\"routes\":[{\"path\":\"z\",\"ports\":[80,443,8443]},"
+                                                 "{\"path\":\"b\",\"ports\":[8080]}]}"));
+
+    /* Keys needing escapes, and replacing the root */
+    json = "{\"a/b\":{\"c~d\":[]}}";
+    JsonDocument *v3 = json_document_parse(json, strlen(json), NULL);
+    draft = json_document_edit(v3);
+    JsonValue *inner = json_document_unshare(draft, "/a~1b/c~0d");
+    assert(inner != NULL && inner->type == JSON_ARRAY);
+    assert(json_document_unshare(draft, "/a~2b") == NULL);
+    assert(json_document_set_root(draft, inner));
+    assert(json_array_push(json_document_arena(draft), inner, json_new_null(json_document_arena(draft))));
+    json_document_freeze(draft);
+    assert(serializes_to(json_document_root(draft), "[null]"));
+    assert(serializes_to(json_document_root(v3), "{\"a\\/b\":{\"c~d\":[]}}"));
+    json_document_release(v3);
+    json_document_release(draft);
+    json_document_release(v2);
+    printf("test_document_edit passed.\n");
+}
+
+/**
+ * @brief Tests publishing versions through a slot.
+ */
+void test_document_slot()
+{
+    const char *json = "{\"version\":1}";
+    JsonDocument *v1 = json_document_parse(json, strlen(json), NULL);
+    JsonDocumentSlot slot;
+    json_document_slot_init(&slot, v1);
+    json_document_release(v1);
+
+    JsonDocument *reader = json_document_slot_acquire(&slot);
+    assert(reader == v1);
+
+    JsonDocument *draft = json_document_edit(reader);
+    JsonValue *root = json_document_unshare(draft, "");
+    assert(json_object_set(json_document_arena(draft), root, "version",
+                           json_new_number(json_document_arena(draft), 2), 0));
+    json_document_slot_publish(&slot, json_document_freeze(draft));
+    json_document_release(draft);
+
+    /* The reader keeps the version it acquired */
+    assert(json_get_number(json_document_root(reader), "version") == 1);
+    json_document_release(reader);
+    reader = json_document_slot_acquire(&slot);
+    assert(json_get_number(json_document_root(reader), "version") == 2);
+    json_document_release(reader);
+
+    json_document_slot_publish(&slot, NULL);
+    assert(json_document_slot_acquire(&slot) == NULL);
+    json_document_slot_clear(&slot);
+    printf("test_document_slot passed.\n");
+}
+
+/**
+ * @brief Replays a reader stalling in json_document_slot_acquire() across two publishes.
+ *
+ * The reader's side is stepped through by hand on the slot's counters, the
+ * way json_document_slot_acquire() runs when its thread is descheduled
+ * between reading the epoch and counting itself in.
+ */
+void test_document_slot_stalled_reader()
+{
+    const char *json[] = {"{\"version\":0}", "{\"version\":1}", "{\"version\":2}"};
+    JsonDocument *versions[3];
+    for (size_t i = 0; i < 3; i++)
+        versions[i] = json_document_parse(json[i], strlen(json[i]), NULL);
+    JsonDocumentSlot slot;
+    json_document_slot_init(&slot, versions[0]);
+    json_document_release(versions[0]);
+
+    /* The reader reads the epoch, then stalls */
+    size_t epoch = slot.epoch;
+
+    /* The first publish finds nobody counted in and frees version 0 */
+    json_document_slot_publish(&slot, versions[1]);
+    json_document_release(versions[1]);
+
+    /* The reader counts itself in under the epoch it read, which has ended */
+    slot.readers[epoch & 1]++;
+    assert(slot.epoch != epoch);
+    slot.readers[epoch & 1]--;
+
+    /* Counted in again under the current epoch, it holds off the next publish */
+    epoch = slot.epoch;
+    slot.readers[epoch & 1]++;
+    assert(slot.epoch == epoch);
+    JsonDocument *reader = json_document_retain(slot.current);
+    slot.readers[epoch & 1]--;
+
+    /* The second publish releases only the slot's reference to version 1 */
+    json_document_slot_publish(&slot, versions[2]);
+    json_document_release(versions[2]);
+    assert(json_get_number(json_document_root(reader), "version") == 1);
+    json_document_release(reader);
+
+    reader = json_document_slot_acquire(&slot);
+    assert(json_get_number(json_document_root(reader), "version") == 2);
+    json_document_release(reader);
+    json_document_slot_clear(&slot);
+    printf("test_document_slot_stalled_reader passed.\n");
+}
+
+int main()
+{
+    test_document_subtree();
+    test_document_edit();
+    test_document_slot();
+    test_document_slot_stalled_reader();
+    printf("All tests passed!\n");
+    return 0;
+}
@@ -1,5 +1,10 @@
 #include "json_parser.h"
 #include "json_accessor.h"
+#include "json_aggregate.h"
+#include "json_utils.h"
+#include "json_shape.h"
+#include "json_serializer.h"
+#include "json_printer.h"
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -154,6 +159,500 @@ void test_parse_nested()
     printf("test_parse_nested passed.\n");
 }
 
+/**
+ * @brief Tests freeing a tree nested far deeper than the call stack allows.
+ */
+void test_free_deep_nesting()
+{
+    const size_t depth = 1000000;
+    JsonValue *root = NULL;
+    for (size_t i = 0; i < depth; i++)
+    {
+        JsonValue *array = json_alloc(sizeof(JsonValue));
+        assert(array != NULL);
+        array->type = JSON_ARRAY;
+        array->flags = 0;
+        array->value.array = json_alloc(sizeof(JsonArray));
+        assert(array->value.array != NULL);
+        array->value.array->count = root ? 1 : 0;
+        array->value.array->items = NULL;
+        array->value.array->capacity = root ? 1 : 0;
+        if (root)
+        {
+            array->value.array->items = json_alloc(sizeof(JsonValue *));
+            assert(array->value.array->items != NULL);
+            array->value.array->items[0] = root;
+        }
+        root = array;
+    }
+    json_free_value(root);
+    printf("test_free_deep_nesting passed.\n");
+}
+
+/**
+ * @brief Tests that deferred frees are reclaimed incrementally and completely.
+ */
+void test_free_value_deferred()
+{
+    json_free_value_deferred(json_parse("{ \"a\": [1, 2, {\"b\": null}], \"c\": \"d\" }"));
+    json_free_value_deferred(json_parse("[true, false]"));
+    json_free_value_deferred(json_parse("42"));
+
+    /* 7 nodes in the first tree and 3 in the second; the scalar is freed at once */
+    size_t total = 0;
+    size_t freed;
+    while ((freed = json_reclaim_deferred(2)) > 0)
+    {
+        assert(freed <= 2);
+        total += freed;
+    }
+    assert(total == 10);
+    assert(json_reclaim_deferred(0) == 0);
+    printf("test_free_value_deferred passed.\n");
+}
+
+/**
+ * @brief Tests that malformed input is rejected without aborting.
+ */
+void test_parse_malformed()
+{
+    assert(json_parse("{ \"a\": 1, }") == NULL);
+    assert(json_parse("[1 2]") == NULL);
+    assert(json_parse("{ key: value }") == NULL);
+    assert(json_parse("[1, 2") == NULL);
+    assert(json_parse("{} []") == NULL);
+    printf("test_parse_malformed passed.\n");
+}
+
+/**
+ * @brief Tests parsing many documents with one reusable parser.
+ */
+void test_parser_reuse()
+{
+    JsonParser *parser = json_parser_new(NULL);
+    assert(parser != NULL);
+
+    /* Length-delimited input: the trailing garbage must not be read */
+    const char *buffer = "{ \"id\": 7, \"tags\": [\"a\", \"b\"] }garbage";
+    size_t length = strlen(buffer) - strlen("garbage");
+
+    for (int i = 0; i < 100; i++)
+    {
+        JsonValue *value = json_parser_parse(parser, buffer, length);
+        assert(value != NULL);
+        assert(json_get_number(value, "id") == 7);
+        JsonValue *tags = json_get_array(value, "tags");
+        assert(tags != NULL && tags->value.array->count == 2);
+        assert(strcmp(tags->value.array->items[1]->value.string, "b") == 0);
+    }
+
+    assert(json_parser_parse(parser, "[1,", 3) == NULL);
+    JsonValue *value = json_parser_parse(parser, "[true]", 6);
+    assert(value != NULL && value->value.array->items[0]->value.boolean == 1);
+
+    json_parser_free(parser);
+    printf("test_parser_reuse passed.\n");
+}
+
+/**
+ * @brief Tests that short strings and small containers are stored inline.
+ */
+void test_parse_inline_storage()
+{
+    const char *json = "{ \"status\": \"OK\", \"message\": \"this string is too long to inline\", "
+                       "\"small\": [1, 2], \"big\": [1, 2, 3, 4, 5, 6, 7, 8, 9] }";
+    JsonValue *value = json_parse(json);
+    assert(value != NULL);
+    assert(value->flags & JSON_FLAG_INLINE_CHILDREN);
+    assert((void *)value->value.object == (void *)(value + 1));
+    assert(strcmp(value->value.object->pairs[1].key, "message") == 0);
+
+    JsonValue *status = value->value.object->pairs[0].value;
+    assert(status->flags & JSON_FLAG_INLINE_STRING);
+    assert(strcmp(status->value.string, "OK") == 0);
+
+    JsonValue *message = value->value.object->pairs[1].value;
+    assert(!(message->flags & JSON_FLAG_INLINE_STRING));
+    assert(strcmp(json_get_string(value, "message"), "this string is too long to inline") == 0);
+
+    assert(json_get_array(value, "small")->flags & JSON_FLAG_INLINE_CHILDREN);
+    JsonValue *big = json_get_array(value, "big");
+    assert(!(big->flags & JSON_FLAG_INLINE_CHILDREN));
+    assert(big->value.array->count == 9 && big->value.array->items[8]->value.number == 9);
+
+    /* Objects too large to inline still own separate keys */
+    JsonValue *wide = json_parse("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"i\":9}");
+    assert(wide != NULL && !(wide->flags & JSON_FLAG_INLINE_CHILDREN));
+    assert(json_get_number(wide, "i") == 9);
+
+    json_free_value(wide);
+    json_free_value(value);
+    printf("test_parse_inline_storage passed.\n");
+}
+
+/**
+ * @brief Tests packing of all-number arrays into contiguous doubles.
+ */
+void test_parse_packed_numbers()
+{
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    JsonParser *parser = json_parser_new(&options);
+    assert(parser != NULL);
+
+    const char *json = "{ \"samples\": [1.5, -2, 3, 4, 5, 6, 7, 8, 9, 10], \"mixed\": [1, \"two\", 3], \"empty\": [] }";
+    JsonValue *value = json_parser_parse(parser, json, strlen(json));
+    assert(value != NULL);
+
+    size_t length = 0;
+    const double *samples = json_array_as_doubles(json_get_array(value, "samples"), &length);
+    assert(samples != NULL && length == 10);
+    assert(samples[0] == 1.5 && samples[1] == -2 && samples[9] == 10);
+
+    /* Mixed arrays fall back to the pointer layout */
+    JsonValue *mixed = json_get_array(value, "mixed");
+    assert(json_array_as_doubles(mixed, &length) == NULL && length == 0);
+    assert(mixed->value.array->count == 3);
+    assert(mixed->value.array->items[0]->value.number == 1);
+    assert(strcmp(mixed->value.array->items[1]->value.string, "two") == 0);
+    assert(json_array_as_doubles(json_get_array(value, "empty"), &length) == NULL);
+
+    /* Packed arrays serialize like their unpacked equivalent */
+    JsonValue *unpacked = json_parse(json);
+    char *a = json_serialize(value);
+    char *b = json_serialize(unpacked);
+    assert(a != NULL && b != NULL && strcmp(a, b) == 0);
+    json_free(a);
+    json_free(b);
+    json_free_value(unpacked);
+
+    json_parser_free(parser);
+    printf("test_parse_packed_numbers passed.\n");
+}
+
+/**
+ * @brief Tests aggregating packed and pointer arrays and fields of objects.
+ */
+void test_array_aggregate()
+{
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    JsonParser *parser = json_parser_new(&options);
+    assert(parser != NULL);
+
+    const char *json = "{ \"samples\": [4, -2, 7.5, 1, 0, 3, 9, -6, 2], "
+                       "\"orders\": [{\"amount\": 10, \"price\": {\"net\": 8}}, {\"amount\": \"n/a\"}, "
+                       "{\"amount\": 32.5, \"price\": {\"net\": 27}}, 5, {\"other\": 1}] }";
+    JsonValue *value = json_parser_parse(parser, json, strlen(json));
+    assert(value != NULL);
+
+    /* Packed arrays are reduced in place */
+    JsonAggregate agg;
+    assert(json_array_aggregate(json_get_array(value, "samples"), NULL, JSON_AGG_ALL, &agg));
+    assert(agg.count == 9 && agg.sum == 18.5);
+    assert(agg.min == -6 && agg.max == 9);
+
+    /* The same numbers through the pointer layout agree */
+    JsonValue *unpacked = json_parse(json);
+    JsonAggregate plain;
+    assert(json_array_aggregate(json_get_array(unpacked, "samples"), "", JSON_AGG_ALL, &plain));
+    assert(plain.count == agg.count && plain.sum == agg.sum && plain.min == agg.min && plain.max == agg.max);
+    json_free_value(unpacked);
+
+    /* Fields of objects, skipping items without a numeric value */
+    JsonValue *orders = json_get_array(value, "orders");
+    assert(json_array_aggregate(orders, "amount", JSON_AGG_SUM | JSON_AGG_MEAN, &agg));
+    assert(agg.count == 2 && agg.sum == 42.5 && agg.mean == 21.25);
+    assert(json_array_aggregate(orders, "price.net", JSON_AGG_MAX, &agg));
+    assert(agg.count == 2 && agg.max == 27);
+    assert(json_array_aggregate(orders, "missing", JSON_AGG_ALL, &agg));
+    assert(agg.count == 0 && agg.min == 0 && agg.mean == 0);
+
+    assert(json_array_aggregate(value, NULL, JSON_AGG_ALL, &agg) == 0);
+
+    json_parser_free(parser);
+    printf("test_array_aggregate passed.\n");
+}
+
+/**
+ * @brief Tests member lookup through precomputed key handles.
+ */
+void test_key_handles()
+{
+    const char *json = "{ \"user_id\": \"u-42\", \"score\": 17.5, \"admin\": true, \"tags\": [], "
+                       "\"meta\": {}, \"gone\": null, \"user\": 1, \"a\": 1, \"b\": 2, \"c\": 3 }";
+    JsonValue *value = json_parse(json);
+    assert(value != NULL);
+
+    JsonKey user_id = json_key("user_id");
+    JsonKey score = json_key("score");
+    assert(user_id.length == 7 && user_id.hash == json_hash_key("user_id", 7));
+    assert(strcmp(json_get_string_k(value, user_id), "u-42") == 0);
+    assert(json_get_number_k(value, score) == 17.5);
+    assert(json_get_bool_k(value, json_key("admin")));
+    assert(json_get_array_k(value, json_key("tags")) != NULL);
+    assert(json_get_object_k(value, json_key("meta")) != NULL);
+    assert(json_is_null_k(value, json_key("gone")));
+
+    /* A prefix of an existing key must not match */
+    assert(json_get_number_k(value, json_key("use")) == 0.0);
+    assert(json_get_string_k(value, score) == NULL);
+    json_free_value(value);
+
+    /* Hand-built pairs without a hash are compared in full */
+    JsonValue child = {JSON_NUMBER, 0, {.number = 3}};
+    JsonPair pair = {"k", &child, 0, 0};
+    JsonObject object = {&pair, 1, NULL, 0};
+    JsonValue built = {JSON_OBJECT, 0, {.object = &object}};
+    assert(json_get_number_k(&built, json_key("k")) == 3);
+
+    printf("test_key_handles passed.\n");
+}
+
+/**
+ * @brief Tests extracting several typed members in one pass.
+ */
+void test_get_many()
+{
+    const char *json = "{ \"id\": 7, \"name\": \"widget\", \"tags\": [\"a\"], \"price\": \"free\", "
+                       "\"id\": 8, \"stock\": null }";
+    JsonValue *value = json_parse(json);
+    assert(value != NULL);
+
+    JsonFieldSpec specs[] = {
+        {json_key("name"), JSON_TYPE_BIT(JSON_STRING)},
+        {json_key("id"), JSON_TYPE_BIT(JSON_NUMBER)},
+        {json_key("price"), JSON_TYPE_BIT(JSON_NUMBER)},
+        {json_key("missing"), 0},
+        {json_key("stock"), 0},
+        {json_key("tags"), JSON_TYPE_BIT(JSON_ARRAY) | JSON_TYPE_BIT(JSON_OBJECT)},
+    };
+    JsonValue *out[6];
+    assert(json_get_many(value, specs, 6, out) == 4);
+    assert(strcmp(out[0]->value.string, "widget") == 0);
+    assert(out[1]->value.number == 7);
+    assert(out[2] == NULL && out[3] == NULL);
+    assert(out[4] != NULL && out[4]->type == JSON_NULL);
+    assert(out[5] != NULL && out[5]->type == JSON_ARRAY);
+
+    assert(json_get_many(out[5], specs, 6, out) == 0 && out[0] == NULL);
+
+    json_free_value(value);
+    printf("test_get_many passed.\n");
+}
+
+/**
+ * @brief Tests that objects with the same key layout share one shape.
+ */
+void test_shape_cache()
+{
+    JsonParserOptions options = {0};
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    assert(parser != NULL);
+
+    const char *first = "{ \"ts\": 1, \"level\": \"info\", \"msg\": \"a\", \"host\": \"h1\", \"pid\": 10, "
+                        "\"tid\": 11, \"svc\": \"api\", \"region\": \"eu\", \"ok\": true, \"ts\": 99 }";
+    const char *second = "{ \"ts\": 2, \"level\": \"warn\", \"msg\": \"b\", \"host\": \"h2\", \"pid\": 20, "
+                         "\"tid\": 21, \"svc\": \"db\", \"region\": \"us\", \"ok\": false, \"ts\": 98 }";
+
+    JsonValue *value = json_parser_parse(parser, first, strlen(first));
+    assert(value != NULL && (value->flags & JSON_FLAG_SHARED_KEYS));
+    const JsonShape *shape = value->value.object->shape;
+    const char *level_key = value->value.object->pairs[1].key;
+    assert(shape != NULL && shape->count == 10);
+
+    /* The next record with the same layout reuses the key table */
+    value = json_parser_parse(parser, second, strlen(second));
+    assert(value != NULL && value->value.object->shape == shape);
+    assert(value->value.object->pairs[1].key == level_key);
+    assert(strcmp(json_get_string(value, "level"), "warn") == 0);
+    assert(json_get_number_k(value, json_key("pid")) == 20);
+    assert(json_get_bool(value, "ok") == false);
+    assert(json_get_number(value, "ts") == 2);
+    assert(json_get_string(value, "lvl") == NULL);
+
+    JsonFieldSpec specs[] = {{json_key("region"), JSON_TYPE_BIT(JSON_STRING)}, {json_key("tid"), 0}};
+    JsonValue *out[2];
+    assert(json_get_many(value, specs, 2, out) == 2);
+    assert(strcmp(out[0]->value.string, "us") == 0 && out[1]->value.number == 21);
+
+    /* A different key order is a different shape */
+    const char *reordered = "{ \"level\": \"info\", \"ts\": 3 }";
+    value = json_parser_parse(parser, reordered, strlen(reordered));
+    assert(value != NULL && value->value.object->shape != shape);
+    assert(json_get_number(value, "ts") == 3);
+
+    json_parser_free(parser);
+    printf("test_shape_cache passed.\n");
+}
+
+/**
+ * @brief Tests decoding of escapes and UTF-8 checks in strings and keys.
+ */
+void test_parse_escapes()
+{
+    const char *json = "{ \"q\\\"k\": \"a\\\\b\\/c\\n\", \"caf\\u00e9\": \"\\ud83d\\ude00 \xe2\x82\xac\", "
+                       "\"long\": \"tab\\there, plus enough text to be stored out of line \\u0041\" }";
+    JsonValue *value = json_parse(json);
+    assert(value != NULL);
+    assert(strcmp(json_get_string(value, "q\"k"), "a\\b/c\n") == 0);
+    assert(strcmp(json_get_string(value, "caf\xc3\xa9"), "\xf0\x9f\x98\x80 \xe2\x82\xac") == 0);
+    assert(strcmp(json_get_string(value, "long"), "tab\there, plus enough text to be stored out of line A") == 0);
+    assert(json_get_string_k(value, json_key("q\"k")) != NULL);
+
+    /* Decoded text is escaped again on output */
+    char *out = json_serialize(value);
+    assert(strstr(out, "\"q\\\"k\":\"a\\\\b\\/c\\n\"") != NULL);
+    json_free(out);
+    json_free_value(value);
+
+    /* Escaped keys of nested objects and shaped objects are kept apart */
+    JsonParserOptions options = {0};
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    const char *nested = "{ \"\\u0061\": { \"\\u0062\": 1, \"c\": { \"\\u0064\": 2 } }, \"\\u0065\": 3 }";
+    for (int pass = 0; pass < 2; pass++)
+    {
+        value = json_parser_parse(parser, nested, strlen(nested));
+        assert(value != NULL);
+        JsonValue *a = json_get_object(value, "a");
+        assert(json_get_number(a, "b") == 1);
+        assert(json_get_number(json_get_object(a, "c"), "d") == 2);
+        assert(json_get_number_k(value, json_key("e")) == 3);
+    }
+    json_parser_free(parser);
+
+    const char *bad[] = {
+        "\"\\x\"",
+        "\"\\u12\"",
+        "\"\\ud83d\"",
+        "\"\\ude00\\ud83d\"",
+        "{ \"\\q\": 1 }",
+        "\"\xc3\x28\"",
+        "\"\xed\xa0\x80\"",
+        "[\"0123456789abcdef\xff\"]",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        assert(json_parse(bad[i]) == NULL);
+    }
+    printf("test_parse_escapes passed.\n");
+}
+
+/**
+ * @brief Tests string escaping on output, including long clean runs.
+ */
+void test_serialize_escapes()
+{
+    /* Specials at every offset within and across 16- and 32-byte blocks */
+    char text[200];
+    char expected[1200];
+    size_t n = 0;
+    strcpy(expected, "\"");
+    n = 1;
+    for (size_t i = 0; i < sizeof(text) - 1; i++)
+    {
+        static const char specials[] = "\"\\/\n\t\x01\x1f";
+        char c = (i % 11 == 0) ? specials[(i / 11) % 7] : (char)('a' + i % 26);
+        text[i] = c;
+        switch (c)
+        {
+        case '"':
+            n += (size_t)sprintf(expected + n, "\\\"");
+            break;
+        case '\\':
+            n += (size_t)sprintf(expected + n, "\\\\");
+            break;
+        case '/':
+            n += (size_t)sprintf(expected + n, "\\/");
+            break;
+        case '\n':
+            n += (size_t)sprintf(expected + n, "\\n");
+            break;
+        case '\t':
+            n += (size_t)sprintf(expected + n, "\\t");
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                n += (size_t)sprintf(expected + n, "\\u%04x", (unsigned char)c);
+            else
+                expected[n++] = c;
+        }
+    }
+    text[sizeof(text) - 1] = '\0';
+    strcpy(expected + n, "\"");
+
+    JsonValue value = {JSON_STRING, 0, {.string = text}};
+    char *out = json_serialize(&value);
+    assert(out != NULL && strcmp(out, expected) == 0);
+    json_free(out);
+
+    /* Non-ASCII bytes pass through untouched */
+    value.value.string = "caf\xc3\xa9 0123456789abcdef0123456789abcdef \xe2\x82\xac";
+    out = json_serialize(&value);
+    assert(strcmp(out, "\"caf\xc3\xa9 0123456789abcdef0123456789abcdef \xe2\x82\xac\"") == 0);
+    json_free(out);
+
+    /* Slashes can be left unescaped */
+    JsonValue *doc = json_parse("{\"url\": \"https://example.com/a/b\", \"n\": [1, \"x/y\"]}");
+    assert(doc != NULL);
+    out = json_serialize(doc);
+    assert(strcmp(out, "{\"url\":\"https:\\/\\/example.com\\/a\\/b\",\"n\":[1,\"x\\/y\"]}") == 0);
+    json_free(out);
+    JsonSerializeOptions options = {0};
+    options.literal_slashes = 1;
+    out = json_serialize_with(doc, &options);
+    assert(strcmp(out, "{\"url\":\"https://example.com/a/b\",\"n\":[1,\"x/y\"]}") == 0);
+    json_free(out);
+    json_free_value(doc);
+
+    printf("test_serialize_escapes passed.\n");
+}
+
+/**
+ * @brief Tests pretty-printed layout with different indent options.
+ */
+void test_print_layout()
+{
+    JsonValue *value = json_parse("{\"a\": [1, {\"b\": \"x\\\"y\"}, []], \"c\": {}, \"d\": null}");
+    assert(value != NULL);
+
+    char *out = json_print_string(value, NULL);
+    assert(out != NULL);
+    assert(strcmp(out, "{\n"
+                       "  \"a\": [\n"
+                       "    1,\n"
+                       "    {\n"
+                       "      \"b\": \"x\\\"y\"\n"
+                       "    },\n"
+                       "    []\n"
+                       "  ],\n"
+                       "  \"c\": {},\n"
+                       "  \"d\": null\n"
+                       "}\n") == 0);
+    json_free(out);
+
+    JsonPrintOptions options = {0};
+    options.indent_width = 1;
+    options.indent_style = JSON_INDENT_TABS;
+    options.base_indent = 1;
+    out = json_print_string(json_get_array(value, "a"), &options);
+    assert(strcmp(out, "\t[\n\t\t1,\n\t\t{\n\t\t\t\"b\": \"x\\\"y\"\n\t\t},\n\t\t[]\n\t]\n") == 0);
+    json_free(out);
+
+    /* Indentation deeper than the precomputed run is written in chunks */
+    options.indent_style = JSON_INDENT_SPACES;
+    options.indent_width = 100;
+    options.base_indent = 0;
+    out = json_print_string(value, &options);
+    assert(strncmp(out, "{\n", 2) == 0 && strspn(out + 2, " ") == 100 && out[102] == '"');
+    json_free(out);
+
+    json_free_value(value);
+    printf("test_print_layout passed.\n");
+}
+
 int main()
 {
     test_parse_empty_object();
@@ -162,6 +661,19 @@ int main()
     test_parse_simple_object();
     test_parse_array();
     test_parse_nested();
+    test_free_deep_nesting();
+    test_free_value_deferred();
+    test_parse_malformed();
+    test_parser_reuse();
+    test_parse_inline_storage();
+    test_parse_packed_numbers();
+    test_array_aggregate();
+    test_key_handles();
+    test_get_many();
+    test_shape_cache();
+    test_parse_escapes();
+    test_serialize_escapes();
+    test_print_layout();
     printf("All tests passed!\n");
     return 0;
 }
@@ -0,0 +1,211 @@
+#include "json_patch.h"
+#include "json_compare.h"
+#include "json_parser.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Parses a value and compares it with another.
+ */
+static int equals_json(const JsonValue *value, const char *json)
+{
+    JsonValue *expected = json_parse(json);
+    assert(expected != NULL);
+    int same = json_equal(value, expected);
+    json_free_value(expected);
+    return same;
+}
+
+/**
+ * @brief Applies a patch to a heap document, returning whether it succeeded.
+ */
+static int patch_heap(JsonValue **document, const char *patch_json, JsonPatchError *err)
+{
+    JsonValue *patch = json_parse(patch_json);
+    assert(patch != NULL);
+    int ok = json_patch_apply(NULL, document, patch, err);
+    json_free_value(patch);
+    return ok;
+}
+
+/**
+ * @brief Tests the operations of RFC 6902, and that failed patches change nothing.
+ */
+void test_patch_apply()
+{
+    const char *original = "{\"baz\":\"qux\",\"foo\":\"bar\",\"list\":[1,2,3],\"a~b\":{\"c/d\":[{\"n\":1}]}}";
+    JsonValue *document = json_parse(original);
+    JsonPatchError err;
+    assert(patch_heap(&document,
+                      "[{\"op\":\"add\",\"path\":\"/list/1\",\"value\":9},"
+                      "{\"op\":\"add\",\"path\":\"/list/-\",\"value\":{\"x\":[true]}},"
+                      "{\"op\":\"replace\",\"path\":\"/baz\",\"value\":\"boo\"},"
+                      "{\"op\":\"remove\",\"path\":\"/foo\"},"
+                      "{\"op\":\"add\",\"path\":\"/hello\",\"value\":[\"world\"]},"
+                      "{\"op\":\"move\",\"from\":\"/a~0b/c~1d/0\",\"path\":\"/moved\"},"
+                      "{\"op\":\"copy\",\"from\":\"/list/4/x\",\"path\":\"/copied\"},"
+                      "{\"op\":\"test\",\"path\":\"/moved\",\"value\":{\"n\":1.0}},"
+                      "{\"op\":\"add\",\"path\":\"/baz\",\"value\":null}]",
+                      &err));
+    assert(err.code == JSON_PATCH_ERROR_NONE);
+    assert(equals_json(document, "{\"baz\":null,\"list\":[1,9,2,3,{\"x\":[true]}],\"a~b\":{\"c/d\":[]},"
+                                 "\"hello\":[\"world\"],\"moved\":{\"n\":1},\"copied\":[true]}"));
+
+    /* Each failure leaves the document exactly as it was */
+    const char *before = "{\"baz\":null,\"list\":[1,9,2,3,{\"x\":[true]}],\"a~b\":{\"c/d\":[]},"
+                         "\"hello\":[\"world\"],\"moved\":{\"n\":1},\"copied\":[true]}";
+    const struct
+    {
+        const char *patch;
+        JsonPatchErrorCode code;
+        size_t operation;
+    } failures[] = {
+        {"[{\"op\":\"remove\",\"path\":\"/list/0\"},{\"op\":\"test\",\"path\":\"/list/0\",\"value\":1}]",
+         JSON_PATCH_ERROR_TEST_FAILED, 1},
+        {"[{\"op\":\"add\",\"path\":\"/new\",\"value\":1},{\"op\":\"remove\",\"path\":\"/missing\"}]",
+         JSON_PATCH_ERROR_NOT_FOUND, 1},
+        {"[{\"op\":\"move\",\"from\":\"/hello\",\"path\":\"/list/0\"},{\"op\":\"move\",\"from\":\"/list\",\"path\":\"/list/1\"}]",
+         JSON_PATCH_ERROR_INVALID, 1},
+        {"[{\"op\":\"remove\",\"path\":\"/moved\"},{\"op\":\"replace\",\"path\":\"\",\"value\":[]},"
+         "{\"op\":\"add\",\"path\":\"/list/7\",\"value\":0}]",
+         JSON_PATCH_ERROR_NOT_FOUND, 2},
+        {"[{\"op\":\"copy\",\"from\":\"/list\",\"path\":\"/list/-\"},{\"op\":\"add\",\"path\":\"/list/01\",\"value\":0}]",
+         JSON_PATCH_ERROR_NOT_FOUND, 1},
+        {"[{\"op\":\"add\",\"path\":\"list\",\"value\":0}]", JSON_PATCH_ERROR_INVALID, 0},
+        {"[{\"op\":\"jump\",\"path\":\"/list\"}]", JSON_PATCH_ERROR_INVALID, 0},
+        {"[{\"op\":\"add\",\"path\":\"/a~2b\",\"value\":0}]", JSON_PATCH_ERROR_INVALID, 0},
+        {"{\"op\":\"remove\",\"path\":\"/list\"}", JSON_PATCH_ERROR_INVALID, 0},
+    };
+    for (size_t i = 0; i < sizeof(failures) / sizeof(failures[0]); i++)
+    {
+        assert(!patch_heap(&document, failures[i].patch, &err));
+        assert(err.code == failures[i].code && err.operation == failures[i].operation);
+        assert(equals_json(document, before));
+    }
+
+    /* Replacing the root */
+    assert(patch_heap(&document, "[{\"op\":\"replace\",\"path\":\"\",\"value\":[1]},{\"op\":\"add\",\"path\":\"/0\",\"value\":0}]", NULL));
+    assert(equals_json(document, "[0,1]"));
+    json_free_value(document);
+
+    /* A parsed document in an arena, with inline, packed and shaped containers */
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    const char *json = "[{\"id\":1,\"ports\":[80,443]},{\"id\":2,\"ports\":[8080]}]";
+    JsonValue *root = json_parser_parse(parser, json, strlen(json));
+    JsonValue *patch = json_parse("[{\"op\":\"add\",\"path\":\"/0/ports/1\",\"value\":8443},"
+                                  "{\"op\":\"replace\",\"path\":\"/1/ports/0\",\"value\":\"any\"},"
+                                  "{\"op\":\"move\",\"from\":\"/0/id\",\"path\":\"/1/old\"},"
+                                  "{\"op\":\"test\",\"path\":\"/0/ports/2\",\"value\":443}]");
+    assert(json_patch_apply(json_parser_arena(parser), &root, patch, NULL));
+    assert(equals_json(root, "[{\"ports\":[80,8443,443]},{\"id\":2,\"ports\":[\"any\"],\"old\":1}]"));
+    json_free_value(patch);
+
+    patch = json_parse("[{\"op\":\"remove\",\"path\":\"/1/id\"},{\"op\":\"test\",\"path\":\"/1/id\",\"value\":2}]");
+    assert(!json_patch_apply(json_parser_arena(parser), &root, patch, &err));
+    assert(err.code == JSON_PATCH_ERROR_NOT_FOUND);
+    assert(equals_json(root, "[{\"ports\":[80,8443,443]},{\"id\":2,\"ports\":[\"any\"],\"old\":1}]"));
+    json_free_value(patch);
+    json_parser_free(parser);
+    printf("test_patch_apply passed.\n");
+}
+
+/**
+ * @brief Tests the examples of RFC 7386.
+ */
+void test_merge_patch()
+{
+    const char *cases[][3] = {
+        {"{\"a\":\"b\"}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"},
+        {"{\"a\":\"b\"}", "{\"b\":\"c\"}", "{\"a\":\"b\",\"b\":\"c\"}"},
+        {"{\"a\":\"b\"}", "{\"a\":null}", "{}"},
+        {"{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}", "{\"b\":\"c\"}"},
+        {"{\"a\":[\"b\"]}", "{\"a\":\"c\"}", "{\"a\":\"c\"}"},
+        {"{\"a\":\"c\"}", "{\"a\":[\"b\"]}", "{\"a\":[\"b\"]}"},
+        {"{\"a\":{\"b\":\"c\"}}", "{\"a\":{\"b\":\"d\",\"c\":null}}", "{\"a\":{\"b\":\"d\"}}"},
+        {"{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}", "{\"a\":[1]}"},
+        {"[\"a\",\"b\"]", "[\"c\",\"d\"]", "[\"c\",\"d\"]"},
+        {"{\"a\":\"b\"}", "[\"c\"]", "[\"c\"]"},
+        {"{\"a\":\"foo\"}", "null", "null"},
+        {"{\"a\":\"foo\"}", "\"bar\"", "\"bar\""},
+        {"{\"e\":null}", "{\"a\":1}", "{\"e\":null,\"a\":1}"},
+        {"[1,2]", "{\"a\":\"b\",\"c\":null}", "{\"a\":\"b\"}"},
+        {"{}", "{\"a\":{\"bb\":{\"ccc\":null}}}", "{\"a\":{\"bb\":{}}}"},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonValue *document = json_parse(cases[i][0]);
+        JsonValue *patch = json_parse(cases[i][1]);
+        assert(json_merge_patch(NULL, &document, patch));
+        assert(equals_json(document, cases[i][2]));
+        json_free_value(document);
+        json_free_value(patch);
+    }
+    printf("test_merge_patch passed.\n");
+}
+
+/**
+ * @brief Tests that diffs are small and turn one value into the other.
+ */
+void test_diff()
+{
+    const struct
+    {
+        const char *from;
+        const char *to;
+        size_t operations;
+    } cases[] = {
+        {"{\"a\":1,\"b\":[1,2,3]}", "{\"a\":1,\"b\":[1,2,3]}", 0},
+        {"{\"a\":1,\"b\":{\"c\":[1,2,3],\"d\":true}}", "{\"a\":1,\"b\":{\"c\":[1,2,5],\"d\":true}}", 1},
+        {"[1,2,3,4,5,6]", "[1,2,3,9,4,5,6]", 1},
+        {"[1,2,3,4,5,6]", "[1,2,5,6]", 2},
+        {"{\"keep\":1,\"drop\":2}", "{\"keep\":1,\"new~/\":3}", 2},
+        {"{\"a\":[{\"id\":1},{\"id\":2}]}", "{\"a\":[{\"id\":1,\"x\":true},{\"id\":2}]}", 1},
+        {"{\"a\":1}", "[1]", 1},
+        {"[]", "[[],{},null]", 3},
+        {"\"x\"", "\"x\"", 0},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonValue *from = json_parse(cases[i].from);
+        JsonValue *to = json_parse(cases[i].to);
+        JsonValue *patch = json_diff(NULL, from, to);
+        assert(patch != NULL && patch->type == JSON_ARRAY);
+        assert(patch->value.array->count == cases[i].operations);
+        assert(json_patch_apply(NULL, &from, patch, NULL));
+        assert(json_equal(from, to));
+        json_free_value(patch);
+        json_free_value(from);
+        json_free_value(to);
+    }
+
+    /* Packed arrays, and a patch built in an arena */
+    JsonParserOptions options = {0};
+    options.pack_numeric_arrays = 1;
+    JsonParser *parser = json_parser_new(&options);
+    const char *json = "{\"v\":[1,2,3,4],\"w\":[5]}";
+    JsonValue *from = json_parser_parse(parser, json, strlen(json));
+    JsonValue *to = json_parse("{\"v\":[1,3,4],\"w\":[5,6]}");
+    JsonArena arena;
+    json_arena_init(&arena, 0);
+    JsonValue *patch = json_diff(&arena, from, to);
+    assert(patch->value.array->count == 2);
+    assert(json_patch_apply(json_parser_arena(parser), &from, patch, NULL));
+    assert(json_equal(from, to));
+    json_arena_destroy(&arena);
+    json_free_value(to);
+    json_parser_free(parser);
+    printf("test_diff passed.\n");
+}
+
+int main()
+{
+    test_patch_apply();
+    test_merge_patch();
+    test_diff();
+    printf("All tests passed!\n");
+    return 0;
+}
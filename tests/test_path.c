@@ -0,0 +1,354 @@
+#include "json_path.h"
+#include "json_parser.h"
+#include "json_serializer.h"
+#include "json_stream.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Input handed out a few bytes at a time, so tokens straddle reads. */
+typedef struct
+{
+    const char *text;
+    size_t length;
+    size_t position;
+    size_t chunk;
+} ChunkSource;
+
+static size_t chunk_read(void *context, char *buffer, size_t size)
+{
+    ChunkSource *source = context;
+    size_t n = source->length - source->position;
+    if (n > source->chunk)
+        n = source->chunk;
+    if (n > size)
+        n = size;
+    memcpy(buffer, source->text + source->position, n);
+    source->position += n;
+    return n;
+}
+
+/* Matches joined with '|', and an optional limit on how many to take. */
+typedef struct
+{
+    char text[512];
+    size_t length;
+    size_t count;
+    size_t limit;
+} Matches;
+
+static int collect(void *context, const char *json, size_t length)
+{
+    Matches *matches = context;
+    if (matches->count++)
+        matches->text[matches->length++] = '|';
+    assert(matches->length + length < sizeof(matches->text));
+    memcpy(matches->text + matches->length, json, length);
+    matches->length += length;
+    matches->text[matches->length] = '\0';
+    return !matches->limit || matches->count < matches->limit;
+}
+
+/**
+ * @brief Streams a document in chunks of 1 to 5 bytes and checks the matches.
+ */
+static void check_stream(const char *expression, const char *json, const char *expected)
+{
+    JsonPath *path = json_path_compile(expression, NULL);
+    assert(path);
+    for (size_t chunk = 1; chunk <= 5; chunk++)
+    {
+        ChunkSource source = {json, strlen(json), 0, chunk};
+        JsonReader reader = {chunk_read, &source};
+        Matches matches;
+        memset(&matches, 0, sizeof(matches));
+        assert(json_path_stream(path, &reader, collect, &matches) == 1);
+        assert(strcmp(matches.text, expected) == 0);
+    }
+    json_path_free(path);
+}
+
+/**
+ * @brief Tests streaming evaluation of child, index and wildcard steps.
+ */
+void test_path_stream()
+{
+    const char *json = "{\"items\": [{\"sku\": \"a1\", \"qty\": 2, \"tags\": [\"x\", \"y\"]},"
+                       " {\"qty\": 1}, {\"sku\": \"b\\\"2\", \"extra\": {\"sku\": \"no\"}}],"
+                       " \"meta\": {\"items\": [{\"sku\": \"deep\"}]}, \"n\": -1.5e2}";
+    check_stream("$.items[*].sku", json, "\"a1\"|\"b\\\"2\"");
+    check_stream("$['items'][0]", json, "{\"sku\":\"a1\",\"qty\":2,\"tags\":[\"x\",\"y\"]}");
+    check_stream("$.items[0].tags[1]", json, "\"y\"");
+    check_stream("$.items[2].*", json, "\"b\\\"2\"|{\"sku\":\"no\"}");
+    check_stream("$.n", json, "-1.5e2");
+    check_stream("$.missing", json, "");
+    check_stream("$", " [ 1 , { } ] ", "[1,{}]");
+    check_stream("$[*]", "[[], {}, [[1]]]", "[]|{}|[[1]]");
+
+    /* Escaped keys are matched decoded; quoted names may contain dots */
+    check_stream("$[\"a.b\"]", "{\"a.b\": 1, \"a\": {\"b\": 2}}", "1");
+    check_stream("$.key", "{\"k\\u0065y\": true}", "true");
+
+    printf("test_path_stream passed.\n");
+}
+
+/**
+ * @brief Tests recursive descent, where matches can nest.
+ */
+void test_path_stream_descendants()
+{
+    const char *json = "{\"sku\": 1, \"items\": [{\"sku\": 2}, {\"sub\": {\"sku\": {\"sku\": 3}}}]}";
+    /* Nested matches are delivered first, as they complete */
+    check_stream("$..sku", json, "1|2|3|{\"sku\":3}");
+    check_stream("$.items..sku", json, "2|3|{\"sku\":3}");
+    check_stream("$..[1]", "[0, [1, 2], [3]]", "2|[1,2]");
+    check_stream("$..*", "{\"a\": [1]}", "1|[1]");
+
+    printf("test_path_stream_descendants passed.\n");
+}
+
+/**
+ * @brief Tests syntax errors, malformed documents and stopping early.
+ */
+void test_path_stream_errors()
+{
+    struct
+    {
+        const char *expression;
+        JsonErrorCode code;
+        size_t offset;
+    } cases[] = {
+        {"", JSON_ERROR_UNEXPECTED_END, 0},
+        {"a.b", JSON_ERROR_UNEXPECTED_CHAR, 0},
+        {"$.", JSON_ERROR_UNEXPECTED_END, 2},
+        {"$x", JSON_ERROR_UNEXPECTED_CHAR, 1},
+        {"$[", JSON_ERROR_UNEXPECTED_END, 2},
+        {"$[1", JSON_ERROR_UNEXPECTED_END, 3},
+        {"$['a'", JSON_ERROR_UNEXPECTED_END, 5},
+        {"$['a", JSON_ERROR_UNEXPECTED_END, 4},
+        {"$[-1]", JSON_ERROR_UNEXPECTED_CHAR, 2},
+        {"$[99999999999999999999999]", JSON_ERROR_INVALID_NUMBER, 21},
+        {"$.a]", JSON_ERROR_UNEXPECTED_CHAR, 3},
+        {"$.a b", JSON_ERROR_UNEXPECTED_CHAR, 3},
+        {"$.a-b", JSON_ERROR_UNEXPECTED_CHAR, 3},
+        {"$..", JSON_ERROR_UNEXPECTED_END, 3},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonError err;
+        assert(json_path_compile(cases[i].expression, &err) == NULL);
+        assert(err.code == cases[i].code);
+        assert(err.offset == cases[i].offset);
+    }
+
+    char expression[2 * JSON_PATH_MAX_STEPS + 4] = "$";
+    for (size_t i = 0; i < JSON_PATH_MAX_STEPS; i++)
+        strcat(expression, ".a");
+    JsonPath *path = json_path_compile(expression, NULL);
+    assert(path);
+    json_path_free(path);
+    strcat(expression, ".a");
+    JsonError err;
+    assert(json_path_compile(expression, &err) == NULL && err.code == JSON_ERROR_TOO_DEEP);
+
+    /* Malformed documents fail, including inside skipped subtrees and matches */
+    path = json_path_compile("$.a", NULL);
+    assert(path);
+    const char *bad[] = {
+        "",
+        "{\"a\": }",
+        "{\"b\": [1, 2}",
+        "{\"a\": 1,}",
+        "[1] 2",
+        "{\"a\": 1",
+        "{\"a\": 01}",
+        "{\"a\": -}",
+        "{\"a\": 1.}",
+        "{\"a\": [2, 1e]}",
+        "{\"a\": \"x\ty\"}",
+        "{\"a\": {\"k\\q\": 1}}",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        JsonMemorySource source;
+        JsonReader reader;
+        json_reader_init_memory(&reader, &source, bad[i], strlen(bad[i]));
+        Matches matches;
+        memset(&matches, 0, sizeof(matches));
+        assert(json_path_stream(path, &reader, collect, &matches) == 0);
+    }
+    json_path_free(path);
+
+    /* The callback can stop the evaluation before the rest is read */
+    path = json_path_compile("$[*]", NULL);
+    assert(path);
+    const char *json = "[1, {\"x\": [2]}, 3, oops";
+    JsonMemorySource source;
+    JsonReader reader;
+    json_reader_init_memory(&reader, &source, json, strlen(json));
+    Matches matches;
+    memset(&matches, 0, sizeof(matches));
+    matches.limit = 2;
+    assert(json_path_stream(path, &reader, collect, &matches) == 1);
+    assert(strcmp(matches.text, "1|{\"x\":[2]}") == 0);
+    json_path_free(path);
+
+    printf("test_path_stream_errors passed.\n");
+}
+
+static int collect_value(void *context, const JsonValue *value)
+{
+    char *json = json_serialize(value);
+    assert(json);
+    int more = collect(context, json, strlen(json));
+    json_free(json);
+    return more;
+}
+
+/**
+ * @brief Evaluates a path over a parsed document and checks the matches.
+ */
+static void check_eval(const char *expression, const JsonValue *root, const char *expected)
+{
+    JsonPath *path = json_path_compile(expression, NULL);
+    assert(path);
+    Matches matches;
+    memset(&matches, 0, sizeof(matches));
+    size_t count = json_path_eval(path, root, collect_value, &matches);
+    assert(count == matches.count);
+    assert(strcmp(matches.text, expected) == 0);
+    assert(json_path_eval(path, root, NULL, NULL) == count);
+    json_path_free(path);
+}
+
+/**
+ * @brief Tests evaluation over a parsed document, including packed arrays
+ *        and shaped objects.
+ */
+void test_path_eval()
+{
+    JsonValue *root = json_parse("{\"items\": [{\"sku\": \"a\", \"qty\": 2}, {\"qty\": 1}, {\"sku\": \"b\"}],"
+                                 " \"sub\": {\"sku\": \"c\"}, \"nums\": [1, 2.5, 3]}");
+    assert(root);
+    check_eval("$.items[*].sku", root, "\"a\"|\"b\"");
+    check_eval("$..sku", root, "\"a\"|\"b\"|\"c\"");
+    check_eval("$.items[1]", root, "{\"qty\":1}");
+    check_eval("$.nums[1]", root, "2.5");
+    check_eval("$.items[7]", root, "");
+    check_eval("$", root, "{\"items\":[{\"sku\":\"a\",\"qty\":2},{\"qty\":1},{\"sku\":\"b\"}],"
+                          "\"sub\":{\"sku\":\"c\"},\"nums\":[1,2.5,3]}");
+    json_free_value(root);
+
+    const char *json = "[{\"id\": 1, \"v\": [1, 2, 3]}, {\"id\": 2, \"v\": [4, 5]}, {\"id\": 3, \"v\": []}]";
+    JsonParserOptions options;
+    memset(&options, 0, sizeof(options));
+    options.pack_numeric_arrays = 1;
+    options.cache_shapes = 1;
+    JsonParser *parser = json_parser_new(&options);
+    assert(parser);
+    root = json_parser_parse(parser, json, strlen(json));
+    assert(root);
+    check_eval("$[*].v[1]", root, "2|5");
+    check_eval("$..[?(@ > 2)]", root, "3|4|5|3");
+    check_eval("$[?(@.v[0] == 4)].id", root, "2");
+    check_eval("$[*].id", root, "1|2|3");
+    json_parser_free(parser);
+
+    printf("test_path_eval passed.\n");
+}
+
+/**
+ * @brief Tests filter expressions.
+ */
+void test_path_filters()
+{
+    JsonValue *root = json_parse(
+        "{\"min\": 3, \"events\": ["
+        "{\"id\": 1, \"level\": 5, \"src\": \"db\", \"tags\": {\"hot\": true}},"
+        "{\"id\": 2, \"level\": 2, \"src\": \"db\"},"
+        "{\"id\": 3, \"level\": 4, \"src\": \"web\", \"user\": null},"
+        "{\"id\": 4, \"level\": 9, \"src\": \"db\", \"note\": \"it's\"},"
+        "{\"id\": 5, \"src\": \"db\"}]}");
+    assert(root);
+    check_eval("$.events[?(@.level > 3 && @.src == \"db\")].id", root, "1|4");
+    check_eval("$.events[?@.level > 3 && @.src == 'db'].id", root, "1|4");
+    check_eval("$.events[?(@.level >= $.min)].id", root, "1|3|4");
+    check_eval("$.events[?(@.level < 3 || @.src != 'db')].id", root, "2|3");
+    check_eval("$.events[?(!(@.level <= 4))].id", root, "1|4|5");
+    check_eval("$.events[?(@.user)].id", root, "3");
+    check_eval("$.events[?(!@.level)].id", root, "5");
+    check_eval("$.events[?(@.user == null)].id", root, "3");
+    check_eval("$.events[?(@['tags'].hot == true)].id", root, "1");
+    check_eval("$.events[?(@.note == 'it\\'s')].id", root, "4");
+    check_eval("$.events[?(@.src > 'dz')].id", root, "3");
+    check_eval("$.events[?(@.level == 5e0 || @.level == -1.5)].id", root, "1");
+    check_eval("$.events[?(@.missing == @.other)].id", root, "1|2|3|4|5");
+    check_eval("$.events[?(@.level > 'a')].id", root, "");
+    check_eval("$..[?(@.hot)]", root, "{\"hot\":true}");
+
+    /* Stopping early still counts the match that stopped it */
+    JsonPath *path = json_path_compile("$.events[?(@.src == 'db')].id", NULL);
+    assert(path);
+    Matches matches;
+    memset(&matches, 0, sizeof(matches));
+    matches.limit = 2;
+    assert(json_path_eval(path, root, collect_value, &matches) == 2);
+    assert(strcmp(matches.text, "1|2") == 0);
+
+    /* Filters need the whole value under test, so they cannot be streamed */
+    JsonMemorySource source;
+    JsonReader reader;
+    json_reader_init_memory(&reader, &source, "[1]", 3);
+    assert(json_path_stream(path, &reader, collect, &matches) == 0);
+    json_path_free(path);
+    json_free_value(root);
+
+    /* Syntax errors in filters */
+    struct
+    {
+        const char *expression;
+        JsonErrorCode code;
+        size_t offset;
+    } cases[] = {
+        {"$[?(@.a > 1]", JSON_ERROR_UNEXPECTED_CHAR, 11},
+        {"$[?@.a = 1]", JSON_ERROR_UNEXPECTED_CHAR, 7},
+        {"$[?@.a > ]", JSON_ERROR_UNEXPECTED_CHAR, 9},
+        {"$[?@.a > 1.]", JSON_ERROR_INVALID_NUMBER, 9},
+        {"$[?@. > 1]", JSON_ERROR_UNEXPECTED_CHAR, 5},
+        {"$[?@.a > 'x]", JSON_ERROR_UNEXPECTED_END, 12},
+        {"$[?@.a && ]", JSON_ERROR_UNEXPECTED_CHAR, 10},
+        {"$[?", JSON_ERROR_UNEXPECTED_END, 3},
+        {"$[?false]", JSON_ERROR_UNEXPECTED_CHAR, 8},
+        {"$[?null]", JSON_ERROR_UNEXPECTED_CHAR, 7},
+        {"$[?!true]", JSON_ERROR_UNEXPECTED_CHAR, 8},
+        {"$[?(1) || @.a]", JSON_ERROR_UNEXPECTED_CHAR, 5},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonError err;
+        assert(json_path_compile(cases[i].expression, &err) == NULL);
+        assert(err.code == cases[i].code);
+        assert(err.offset == cases[i].offset);
+    }
+
+    char deep[JSON_PATH_MAX_STACK + 8] = "$[?";
+    memset(deep + 3, '!', JSON_PATH_MAX_STACK + 1);
+    strcpy(deep + 4 + JSON_PATH_MAX_STACK, "@]");
+    JsonError err;
+    assert(json_path_compile(deep, &err) == NULL && err.code == JSON_ERROR_TOO_DEEP);
+
+    printf("test_path_filters passed.\n");
+}
+
+int main()
+{
+    test_path_stream();
+    test_path_stream_descendants();
+    test_path_stream_errors();
+    test_path_eval();
+    test_path_filters();
+    printf("All tests passed!\n");
+    return 0;
+}
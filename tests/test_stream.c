@@ -0,0 +1,411 @@
+#include "json_reformat.h"
+#include "json_filter.h"
+#include "json_stream.h"
+#include "json_writer.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Input handed out a few bytes at a time, so tokens straddle reads. */
+typedef struct
+{
+    const char *text;
+    size_t length;
+    size_t position;
+    size_t chunk;
+} ChunkSource;
+
+static size_t chunk_read(void *context, char *buffer, size_t size)
+{
+    ChunkSource *source = context;
+    size_t n = source->length - source->position;
+    if (n > source->chunk)
+        n = source->chunk;
+    if (n > size)
+        n = size;
+    memcpy(buffer, source->text + source->position, n);
+    source->position += n;
+    return n;
+}
+
+/* Collects sink output into a fixed buffer. */
+typedef struct
+{
+    char data[256];
+    size_t length;
+    size_t calls;
+} MemorySink;
+
+static int memory_sink(void *context, const char *data, size_t length)
+{
+    MemorySink *sink = context;
+    assert(sink->length + length < sizeof(sink->data));
+    memcpy(sink->data + sink->length, data, length);
+    sink->length += length;
+    sink->data[sink->length] = '\0';
+    sink->calls++;
+    return 1;
+}
+
+/**
+ * @brief Reformats a text read in chunks of every size from 1 to 7 bytes.
+ *
+ * @return The output, identical for every chunk size, or NULL on failure.
+ */
+static char *reformat(const char *json, JsonFormatMode mode)
+{
+    JsonFormatOptions options;
+    memset(&options, 0, sizeof(options));
+    options.mode = mode;
+
+    char *first = NULL;
+    for (size_t chunk = 1; chunk <= 7; chunk++)
+    {
+        ChunkSource source = {json, strlen(json), 0, chunk};
+        JsonReader reader = {chunk_read, &source};
+        JsonWriter writer;
+        json_writer_init(&writer);
+        if (!json_reformat(&reader, &writer, &options))
+        {
+            json_writer_free(&writer);
+            assert(!first);
+            return NULL;
+        }
+        char *output = json_writer_finish(&writer);
+        assert(output);
+        if (!first)
+        {
+            first = output;
+            continue;
+        }
+        assert(strcmp(first, output) == 0);
+        json_free(output);
+    }
+    return first;
+}
+
+static void check(const char *json, JsonFormatMode mode, const char *expected)
+{
+    char *output = reformat(json, mode);
+    assert(output);
+    assert(strcmp(output, expected) == 0);
+    json_free(output);
+}
+
+/**
+ * @brief Tests minified and pretty-printed output.
+ */
+void test_reformat_layout()
+{
+    const char *json = " { \"a\" : [ 1 , 2.50 , -3E+2 , true ] ,\n\t\"b\" : { } , \"c\" : [ ] ,"
+                       " \"d\" : { \"e\" : null , \"f\" : \"x\\/y\" } } ";
+    check(json, JSON_FORMAT_MINIFY,
+          "{\"a\":[1,2.50,-3E+2,true],\"b\":{},\"c\":[],\"d\":{\"e\":null,\"f\":\"x\\/y\"}}");
+    check(json, JSON_FORMAT_PRETTY,
+          "{\n"
+          "  \"a\": [\n"
+          "    1,\n"
+          "    2.50,\n"
+          "    -3E+2,\n"
+          "    true\n"
+          "  ],\n"
+          "  \"b\": {},\n"
+          "  \"c\": [],\n"
+          "  \"d\": {\n"
+          "    \"e\": null,\n"
+          "    \"f\": \"x\\/y\"\n"
+          "  }\n"
+          "}\n");
+    check(" \"scalar\" ", JSON_FORMAT_PRETTY, "\"scalar\"\n");
+    check("[[[]]]", JSON_FORMAT_MINIFY, "[[[]]]");
+
+    /* Pretty output follows the layout options */
+    JsonFormatOptions options;
+    memset(&options, 0, sizeof(options));
+    options.mode = JSON_FORMAT_PRETTY;
+    options.layout.indent_style = JSON_INDENT_TABS;
+    options.layout.indent_width = 1;
+    ChunkSource source = {"[1,{\"k\":false}]", 15, 0, 64};
+    JsonReader reader = {chunk_read, &source};
+    JsonWriter writer;
+    json_writer_init(&writer);
+    assert(json_reformat(&reader, &writer, &options));
+    char *output = json_writer_finish(&writer);
+    assert(strcmp(output, "[\n\t1,\n\t{\n\t\t\"k\": false\n\t}\n]\n") == 0);
+    json_free(output);
+
+    printf("test_reformat_layout passed.\n");
+}
+
+/**
+ * @brief Tests canonical output of strings and numbers.
+ */
+void test_reformat_canonical()
+{
+    check("{\"k\\u0065y\": \"\\u00e9\\/\\t\\ud83d\\ude00\", \"b\": [-0, 10, 1.50, 1e+07, -2.5E-03, 0.1, 0e5, -0.0]}",
+          JSON_FORMAT_CANONICAL,
+          "{\"key\":\"\xc3\xa9/\\t\xf0\x9f\x98\x80\",\"b\":[0,10,1.5,1e7,-0.0025,0.1,0,0]}");
+    check("[1e400, 123456789012345678901234567890, 0.30000000000000004]", JSON_FORMAT_CANONICAL,
+          "[1e400,123456789012345678901234567890,0.30000000000000004]");
+    check("\"\\u0001\\\"\"", JSON_FORMAT_CANONICAL, "\"\\u0001\\\"\"");
+
+    printf("test_reformat_canonical passed.\n");
+}
+
+/**
+ * @brief Tests that malformed input is rejected in every mode.
+ */
+void test_reformat_rejects()
+{
+    const char *cases[] = {
+        "",
+        "[1, 2",
+        "[1, 2,]",
+        "{\"a\" 1}",
+        "{\"a\": 1,}",
+        "{1: 2}",
+        "[1}",
+        "tru",
+        "\"\\x\"",
+        "\"\\ud83d\"",
+        "\"unterminated",
+        "{} {}",
+        "[-]",
+        "[01]",
+        "[1.]",
+        "[1e]",
+        "[1e+]",
+        "-0.",
+        "[\"a\tb\"]",
+        "{\"k\n\": 1}",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        assert(reformat(cases[i], JSON_FORMAT_MINIFY) == NULL);
+        assert(reformat(cases[i], JSON_FORMAT_PRETTY) == NULL);
+        assert(reformat(cases[i], JSON_FORMAT_CANONICAL) == NULL);
+    }
+
+    /* Nesting at the limit is accepted, one deeper is not */
+    static char deep[2 * JSON_STREAM_MAX_DEPTH + 3];
+    memset(deep, '[', JSON_STREAM_MAX_DEPTH);
+    memset(deep + JSON_STREAM_MAX_DEPTH, ']', JSON_STREAM_MAX_DEPTH);
+    char *output = reformat(deep, JSON_FORMAT_MINIFY);
+    assert(output && strcmp(output, deep) == 0);
+    json_free(output);
+    memset(deep, '[', JSON_STREAM_MAX_DEPTH + 1);
+    memset(deep + JSON_STREAM_MAX_DEPTH + 1, ']', JSON_STREAM_MAX_DEPTH + 1);
+    assert(reformat(deep, JSON_FORMAT_MINIFY) == NULL);
+
+    printf("test_reformat_rejects passed.\n");
+}
+
+/**
+ * @brief Tests the token stream and sink-backed writers directly.
+ */
+void test_stream_tokens()
+{
+    /* A string longer than the stream's first buffer is read whole */
+    size_t big = JSON_STREAM_BUFFER_SIZE + 100;
+    char *json = json_alloc(big + 8);
+    assert(json);
+    json[0] = '[';
+    json[1] = '"';
+    memset(json + 2, 'x', big);
+    strcpy(json + 2 + big, "\", 1]");
+
+    ChunkSource source = {json, strlen(json), 0, 4096};
+    JsonReader reader = {chunk_read, &source};
+    JsonStream stream;
+    json_stream_init(&stream, &reader);
+    const char *text;
+    size_t length;
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_LEFT_BRACKET);
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_STRING);
+    assert(length == big && text[0] == 'x' && text[big - 1] == 'x');
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_COMMA);
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_NUMBER);
+    assert(length == 1 && text[0] == '1');
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_RIGHT_BRACKET);
+    assert(json_stream_next(&stream, &text, &length) == TOKEN_EOF);
+    assert(json_stream_offset(&stream) == strlen(json));
+    json_stream_free(&stream);
+    json_free(json);
+
+    /* Output reaches the sink once the reformatter flushes */
+    MemorySink sink;
+    memset(&sink, 0, sizeof(sink));
+    JsonWriter writer;
+    json_writer_init_sink(&writer, memory_sink, &sink);
+    ChunkSource small = {"[ true , false ]", 16, 0, 3};
+    JsonReader small_reader = {chunk_read, &small};
+    assert(json_reformat(&small_reader, &writer, NULL));
+    assert(strcmp(sink.data, "[true,false]") == 0);
+    assert(sink.calls == 1 && writer.length == 0);
+    json_writer_free(&writer);
+
+    printf("test_stream_tokens passed.\n");
+}
+
+/**
+ * @brief Applies a filter to a text read in chunks of 1 to 7 bytes.
+ *
+ * @return The output, identical for every chunk size, or NULL on failure.
+ */
+static char *filter(const JsonFilter *compiled, const char *json)
+{
+    char *first = NULL;
+    for (size_t chunk = 1; chunk <= 7; chunk++)
+    {
+        ChunkSource source = {json, strlen(json), 0, chunk};
+        JsonReader reader = {chunk_read, &source};
+        JsonWriter writer;
+        json_writer_init(&writer);
+        if (!json_filter_apply(compiled, &reader, &writer))
+        {
+            json_writer_free(&writer);
+            assert(!first);
+            return NULL;
+        }
+        char *output = json_writer_finish(&writer);
+        assert(output);
+        if (!first)
+        {
+            first = output;
+            continue;
+        }
+        assert(strcmp(first, output) == 0);
+        json_free(output);
+    }
+    return first;
+}
+
+static void check_filter(const JsonFilterRule *rules, size_t count, const char *json, const char *expected)
+{
+    JsonFilter *compiled = json_filter_compile(rules, count);
+    assert(compiled);
+    char *output = filter(compiled, json);
+    assert(output);
+    assert(strcmp(output, expected) == 0);
+    json_free(output);
+    json_filter_free(compiled);
+}
+
+/**
+ * @brief Tests excluding and redacting members.
+ */
+void test_filter_exclude_redact()
+{
+    const char *json = "{\"user\": {\"name\": \"ann\", \"password\": \"s3cret\", \"keys\": [{\"token\": {\"v\": \"]}\\\"\"}}]},"
+                       " \"debug\": {\"trace\": [1, [2, \"}\"]], \"x\": {}}, \"n\": 1.5e3}";
+    JsonFilterRule rules[] = {
+        {"debug", JSON_FILTER_EXCLUDE, NULL},
+        {"user.password", JSON_FILTER_REDACT, NULL},
+        {"*.keys.token", JSON_FILTER_REDACT, "null"},
+    };
+    check_filter(rules, 3, json,
+                 "{\"user\":{\"name\":\"ann\",\"password\":\"[REDACTED]\",\"keys\":[{\"token\":null}]},\"n\":1.5e3}");
+
+    /* Excluding the first member leaves no stray comma; escaped keys are decoded before matching */
+    JsonFilterRule first[] = {{"a", JSON_FILTER_EXCLUDE, NULL}, {"pw", JSON_FILTER_REDACT, NULL}};
+    check_filter(first, 2, "{\"a\": [1], \"b\": 2, \"p\\u0077\": 3}", "{\"b\":2,\"p\\u0077\":\"[REDACTED]\"}");
+
+    /* With no rules the input is only minified; scalar roots are kept */
+    check_filter(NULL, 0, " [ 1 , { \"a\" : \"\\n\" } , true, false, null ] ", "[1,{\"a\":\"\\n\"},true,false,null]");
+    check_filter(rules, 3, " 42 ", "42");
+
+    printf("test_filter_exclude_redact passed.\n");
+}
+
+/**
+ * @brief Tests projecting documents onto included paths.
+ */
+void test_filter_include()
+{
+    const char *json = "{\"id\": 7, \"user\": {\"name\": \"ann\", \"age\": 30, \"auth\": {\"token\": \"t\", \"kind\": 1}},"
+                       " \"items\": [{\"sku\": \"a\", \"qty\": 1}, {\"qty\": 2}, 3], \"meta\": {\"v\": 1}}";
+    JsonFilterRule rules[] = {
+        {"id", JSON_FILTER_INCLUDE, NULL},
+        {"user.auth", JSON_FILTER_INCLUDE, NULL},
+        {"user.auth.token", JSON_FILTER_REDACT, NULL},
+        {"items.sku", JSON_FILTER_INCLUDE, NULL},
+        {"meta.v.deeper", JSON_FILTER_INCLUDE, NULL},
+    };
+    check_filter(rules, 5, json,
+                 "{\"id\":7,\"user\":{\"auth\":{\"token\":\"[REDACTED]\",\"kind\":1}},"
+                 "\"items\":[{\"sku\":\"a\"},{}],\"meta\":{}}");
+
+    /* Exclusion wins over inclusion */
+    JsonFilterRule conflict[] = {{"a", JSON_FILTER_INCLUDE, NULL}, {"a.b", JSON_FILTER_EXCLUDE, NULL}};
+    check_filter(conflict, 2, "{\"a\": {\"b\": 1, \"c\": 2}, \"d\": 3}", "{\"a\":{\"c\":2}}");
+
+    printf("test_filter_include passed.\n");
+}
+
+/**
+ * @brief Tests rejected rules and malformed input.
+ */
+void test_filter_rejects()
+{
+    JsonFilterRule empty = {"", JSON_FILTER_EXCLUDE, NULL};
+    assert(json_filter_compile(&empty, 1) == NULL);
+    JsonFilterRule bad = {"a", JSON_FILTER_REDACT, "{oops"};
+    assert(json_filter_compile(&bad, 1) == NULL);
+    JsonFilterRule many[JSON_FILTER_MAX_RULES + 1];
+    for (size_t i = 0; i <= JSON_FILTER_MAX_RULES; i++)
+        many[i] = empty;
+    assert(json_filter_compile(many, JSON_FILTER_MAX_RULES + 1) == NULL);
+
+    JsonFilterRule rules[] = {{"a", JSON_FILTER_EXCLUDE, NULL}, {"b", JSON_FILTER_REDACT, NULL}};
+    JsonFilter *compiled = json_filter_compile(rules, 2);
+    assert(compiled);
+    const char *cases[] = {
+        "",
+        "{\"a\": [1, 2",
+        "{\"b\": {\"x\": \"}",
+        "{\"c\" 1}",
+        "[1,]",
+        "{} {}",
+        "{\"c\": tru}",
+        "{\"c\": 01}",
+        "{\"c\": -}",
+        "{\"c\": 1.}",
+        "[1e]",
+        "{\"c\": \"x\ty\"}",
+        "{\"c\\q\": 1}",
+        "[\"\\u12\"]",
+        "{\"a\":01,\"b\":-,\"c\":\"x\ty\",\"d\":1.}",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        assert(filter(compiled, cases[i]) == NULL);
+
+    /* In-memory input through a memory reader */
+    JsonMemorySource source;
+    JsonReader reader;
+    const char *json = "{\"a\": 1, \"b\": [2], \"c\": 3}";
+    json_reader_init_memory(&reader, &source, json, strlen(json));
+    JsonWriter writer;
+    json_writer_init(&writer);
+    assert(json_filter_apply(compiled, &reader, &writer));
+    char *output = json_writer_finish(&writer);
+    assert(strcmp(output, "{\"b\":\"[REDACTED]\",\"c\":3}") == 0);
+    json_free(output);
+    json_filter_free(compiled);
+
+    printf("test_filter_rejects passed.\n");
+}
+
+int main()
+{
+    test_reformat_layout();
+    test_reformat_canonical();
+    test_reformat_rejects();
+    test_stream_tokens();
+    test_filter_exclude_redact();
+    test_filter_include();
+    test_filter_rejects();
+    printf("All tests passed!\n");
+    return 0;
+}
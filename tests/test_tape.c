@@ -0,0 +1,109 @@
+#include "json_tape.h"
+#include "json_parser.h"
+#include "json_serializer.h"
+#include "json_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Tests node layout and navigation on a small document.
+ */
+void test_tape_navigation()
+{
+    const char *json = "{ \"id\": 7, \"name\": \"tape\", \"ok\": true, \"list\": [1, [2, 3], {\"x\": null}], \"end\": 9 }";
+    JsonTape *tape = json_tape_parse(json, strlen(json));
+    assert(tape != NULL);
+    assert(sizeof(JsonTapeNode) == 16);
+
+    assert(json_tape_type(tape, 0) == JSON_OBJECT);
+    assert(json_tape_count(tape, 0) == 5);
+    assert(json_tape_end(tape, 0) == tape->count);
+    assert(json_tape_end(tape, tape->count) == JSON_TAPE_NONE);
+    assert(json_tape_end(tape, JSON_TAPE_NONE) == JSON_TAPE_NONE);
+
+    assert(json_tape_get_number(tape, 0, "id") == 7);
+    assert(strcmp(json_tape_get_string(tape, 0, "name"), "tape") == 0);
+    assert(json_tape_get_bool(tape, 0, "ok") == true);
+    assert(json_tape_get_number(tape, 0, "end") == 9);
+    assert(json_tape_find(tape, 0, "missing") == JSON_TAPE_NONE);
+
+    size_t list = json_tape_find(tape, 0, "list");
+    assert(json_tape_type(tape, list) == JSON_ARRAY);
+    assert(json_tape_count(tape, list) == 3);
+    assert(json_tape_number(tape, json_tape_at(tape, list, 0)) == 1);
+    size_t inner = json_tape_at(tape, list, 1);
+    assert(json_tape_count(tape, inner) == 2);
+    assert(json_tape_number(tape, json_tape_at(tape, inner, 1)) == 3);
+    size_t object = json_tape_at(tape, list, 2);
+    assert(json_tape_type(tape, json_tape_find(tape, object, "x")) == JSON_NULL);
+    assert(json_tape_at(tape, list, 3) == JSON_TAPE_NONE);
+
+    /* Sibling iteration visits each item exactly once */
+    size_t items = 0;
+    for (size_t i = list + 1; i < json_tape_end(tape, list); i = json_tape_end(tape, i))
+        items++;
+    assert(items == 3);
+
+    json_tape_free(tape);
+    printf("test_tape_navigation passed.\n");
+}
+
+/**
+ * @brief Tests that tape serialization matches the JsonValue serializer.
+ */
+void test_tape_serialize()
+{
+    const char *json = "{\"a\": [1, 2.5, \"s/t\"], \"b\": {}, \"c\": [], \"d\": {\"e\": [false, null]}}";
+    JsonTape *tape = json_tape_parse(json, strlen(json));
+    JsonValue *value = json_parse(json);
+    assert(tape != NULL && value != NULL);
+
+    char *from_tape = json_tape_serialize(tape, 0);
+    char *from_tree = json_serialize(value);
+    assert(from_tape != NULL && from_tree != NULL);
+    assert(strcmp(from_tape, from_tree) == 0);
+
+    char *sub = json_tape_serialize(tape, json_tape_find(tape, 0, "d"));
+    assert(strcmp(sub, "{\"e\":[false,null]}") == 0);
+
+    json_free(sub);
+    json_free(from_tape);
+    json_free(from_tree);
+    json_free_value(value);
+    json_tape_free(tape);
+    printf("test_tape_serialize passed.\n");
+}
+
+/**
+ * @brief Tests that malformed documents are rejected.
+ */
+void test_tape_malformed()
+{
+    const char *bad[] = {"", "[1,]", "{\"a\" 1}", "[1 2]", "{\"a\":1,}", "[1,:", "{} {}", "[", "{\"a\":}", "[}"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        assert(json_tape_parse(bad[i], strlen(bad[i])) == NULL);
+    }
+
+    /* Escapes are decoded into the string arena; bad ones are rejected */
+    const char *escaped = "{\"k\\u0065y\": \"\\\"q\\\"\"}";
+    JsonTape *tape = json_tape_parse(escaped, strlen(escaped));
+    assert(tape != NULL && strcmp(json_tape_get_string(tape, 0, "key"), "\"q\"") == 0);
+    json_tape_free(tape);
+    assert(json_tape_parse("[\"\\u00\"]", 8) == NULL);
+
+    tape = json_tape_parse("42", 2);
+    assert(tape != NULL && tape->count == 1 && json_tape_number(tape, 0) == 42);
+    json_tape_free(tape);
+    printf("test_tape_malformed passed.\n");
+}
+
+int main()
+{
+    test_tape_navigation();
+    test_tape_serialize();
+    test_tape_malformed();
+    printf("All tests passed!\n");
+    return 0;
+}
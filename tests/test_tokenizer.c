@@ -1,6 +1,7 @@
 #include "json_tokenizer.h"
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 // Utility function to print tokens for debugging
 void print_token(const JsonToken *token)
@@ -92,6 +93,47 @@ void test_whitespace_handling()
     test_tokenizer_single("  {  \"key\"  :  \"value\"  }  ");
 }
 
+// Test batch tokenization onto a reusable token tape
+void test_token_tape()
+{
+    const char *json = "{ \"key\": [1.5, -2, \"a\\\"b\", true, false, null] }";
+    static const JsonTokenType expected[] = {
+        TOKEN_LEFT_BRACE, TOKEN_STRING, TOKEN_COLON, TOKEN_LEFT_BRACKET,
+        TOKEN_NUMBER, TOKEN_COMMA, TOKEN_NUMBER, TOKEN_COMMA, TOKEN_STRING,
+        TOKEN_COMMA, TOKEN_TRUE, TOKEN_COMMA, TOKEN_FALSE, TOKEN_COMMA,
+        TOKEN_NULL, TOKEN_RIGHT_BRACKET, TOKEN_RIGHT_BRACE, TOKEN_EOF};
+    size_t count = sizeof(expected) / sizeof(expected[0]);
+
+    printf("\nTesting token tape: %s\n", json);
+
+    JsonTokenTape tape;
+    json_token_tape_init(&tape);
+
+    /* Tokenize twice to exercise reuse of the tape's storage */
+    for (int pass = 0; pass < 2; pass++)
+    {
+        assert(json_tokenize_all(json, strlen(json), &tape) == 1);
+        assert(tape.count == count);
+        for (size_t i = 0; i < count; i++)
+        {
+            assert(tape.tokens[i].type == (uint32_t)expected[i]);
+        }
+    }
+    assert(strncmp(json + tape.tokens[1].offset, "key", tape.tokens[1].length) == 0);
+    assert(tape.tokens[4].length == 3 && strncmp(json + tape.tokens[4].offset, "1.5", 3) == 0);
+    assert(tape.tokens[8].length == 4);
+
+    /* The length bounds the input, and lexical errors end the tape */
+    assert(json_tokenize_all("[1, 2]", 4, &tape) == 1);
+    assert(tape.count == 4 && tape.tokens[3].type == TOKEN_EOF);
+    assert(json_tokenize_all("[tru]", 5, &tape) == 0);
+    assert(tape.tokens[tape.count - 1].type == TOKEN_ERROR);
+    assert(tape.tokens[tape.count - 1].offset == 1);
+
+    json_token_tape_free(&tape);
+    printf("Token tape test passed\n");
+}
+
 int main()
 {
     // Test cases
@@ -107,6 +149,7 @@ int main()
     test_large_number();
     test_negative_number();
     test_whitespace_handling();
+    test_token_tape();
 
     printf("\nAll tests completed.\n");
 
@@ -0,0 +1,116 @@
+#include "json_validate.h"
+#include "json_utils.h"
+#include "json_config.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Tests that well-formed documents are accepted.
+ */
+void test_validate_accepts()
+{
+    const char *cases[] = {
+        "{}",
+        " [ ] ",
+        "0",
+        "-0.5e-10",
+        "1E+2",
+        "\"\"",
+        "true",
+        "null",
+        "{\"a\": [1, 2.5, -3e4, true, false, null, {\"b\": {}}], \"c\": \"d\"}",
+        "\"esc \\\" \\\\ \\/ \\b \\f \\n \\r \\t \\u00e9 \\ud83d\\ude00\"",
+        "\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\"",
+        "\"a long string that crosses several sixteen byte blocks before ending\"",
+        "\t\r\n[\n1\n]\n",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonError err;
+        assert(json_validate(cases[i], strlen(cases[i]), &err) == 1);
+        assert(err.code == JSON_ERROR_NONE);
+    }
+
+    /* Nesting at the limit is accepted, one deeper is not */
+    static char deep[2 * JSON_VALIDATE_MAX_DEPTH + 3];
+    memset(deep, '[', JSON_VALIDATE_MAX_DEPTH);
+    memset(deep + JSON_VALIDATE_MAX_DEPTH, ']', JSON_VALIDATE_MAX_DEPTH);
+    assert(json_validate(deep, 2 * JSON_VALIDATE_MAX_DEPTH, NULL) == 1);
+    memset(deep, '[', JSON_VALIDATE_MAX_DEPTH + 1);
+    memset(deep + JSON_VALIDATE_MAX_DEPTH + 1, ']', JSON_VALIDATE_MAX_DEPTH + 1);
+    JsonError err;
+    assert(json_validate(deep, 2 * JSON_VALIDATE_MAX_DEPTH + 2, &err) == 0);
+    assert(err.code == JSON_ERROR_TOO_DEEP && err.offset == JSON_VALIDATE_MAX_DEPTH);
+
+    printf("test_validate_accepts passed.\n");
+}
+
+/**
+ * @brief Tests that malformed documents are rejected with the right reason.
+ */
+void test_validate_rejects()
+{
+    struct
+    {
+        const char *json;
+        JsonErrorCode code;
+        size_t offset;
+    } cases[] = {
+        {"", JSON_ERROR_UNEXPECTED_END, 0},
+        {"[1, 2", JSON_ERROR_UNEXPECTED_END, 5},
+        {"[1, 2,]", JSON_ERROR_UNEXPECTED_CHAR, 6},
+        {"{\"a\" 1}", JSON_ERROR_UNEXPECTED_CHAR, 5},
+        {"{\"a\": 1,}", JSON_ERROR_UNEXPECTED_CHAR, 8},
+        {"{1: 2}", JSON_ERROR_UNEXPECTED_CHAR, 1},
+        {"[1}", JSON_ERROR_UNEXPECTED_CHAR, 2},
+        {"01", JSON_ERROR_INVALID_NUMBER, 1},
+        {"-", JSON_ERROR_INVALID_NUMBER, 0},
+        {"1.", JSON_ERROR_INVALID_NUMBER, 0},
+        {"1e", JSON_ERROR_INVALID_NUMBER, 0},
+        {"+1", JSON_ERROR_UNEXPECTED_CHAR, 0},
+        {".5", JSON_ERROR_UNEXPECTED_CHAR, 0},
+        {"tru", JSON_ERROR_UNEXPECTED_END, 0},
+        {"nul1", JSON_ERROR_UNEXPECTED_CHAR, 0},
+        {"\"tab\there\"", JSON_ERROR_INVALID_STRING, 4},
+        {"\"\\x\"", JSON_ERROR_INVALID_ESCAPE, 1},
+        {"\"\\u12g4\"", JSON_ERROR_INVALID_ESCAPE, 1},
+        {"\"\\ud83d alone\"", JSON_ERROR_INVALID_ESCAPE, 1},
+        {"\"\\ude00\"", JSON_ERROR_INVALID_ESCAPE, 1},
+        {"\"\xc3\"", JSON_ERROR_INVALID_UTF8, 1},
+        {"\"\xc0\xaf\"", JSON_ERROR_INVALID_UTF8, 1},
+        {"\"\xed\xa0\x80\"", JSON_ERROR_INVALID_UTF8, 1},
+        {"\"\xf4\x90\x80\x80\"", JSON_ERROR_INVALID_UTF8, 1},
+        {"\"0123456789abcdef\xff\"", JSON_ERROR_INVALID_UTF8, 17},
+        {"\"unterminated", JSON_ERROR_UNEXPECTED_END, 13},
+        {"{} {}", JSON_ERROR_TRAILING_DATA, 3},
+        {"\xef\xbb\xbf{}", JSON_ERROR_UNEXPECTED_CHAR, 0},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonError err;
+        assert(json_validate(cases[i].json, strlen(cases[i].json), &err) == 0);
+        assert(err.code == cases[i].code);
+        assert(err.offset == cases[i].offset);
+    }
+
+    /* Lines and columns are 1-based */
+    const char *multiline = "{\n  \"a\": 1,\n  \"b\": ?\n}";
+    JsonError err;
+    assert(json_validate(multiline, strlen(multiline), &err) == 0);
+    assert(err.line == 3 && err.column == 8);
+    assert(strcmp(json_error_string(err.code), "unexpected character") == 0);
+
+    /* Length-delimited input is not read past its end */
+    assert(json_validate("[1]]", 3, NULL) == 1);
+
+    printf("test_validate_rejects passed.\n");
+}
+
+int main()
+{
+    test_validate_accepts();
+    test_validate_rejects();
+    printf("All tests passed!\n");
+    return 0;
+}
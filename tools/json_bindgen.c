@@ -0,0 +1,359 @@
+/**
+ * @file json_bindgen.c
+ * @brief Generates json_bind() descriptors from a sample JSON document.
+ *
+ * Usage: json_bindgen <StructName> <sample.json> <output.h>
+ *
+ * Writes a header declaring one C struct per object in the sample (nested
+ * objects become nested structs named `<Parent>_<key>`), together with the
+ * JsonFieldDesc tables and JsonStructDesc definitions binding them. Numbers
+ * that are integers in the sample become `int64_t`, other numbers `double`.
+ * Arrays, nulls and empty objects cannot be inferred and are listed as
+ * comments instead. Keys that are C keywords get a trailing `_`, and keys
+ * that would make the same member name are numbered (`a_b`, `a_b_2`).
+ */
+
+#include "json_parser.h"
+#include "json_utils.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Longest struct or member name generated. */
+#define BINDGEN_NAME_MAX 256
+
+/* C99 keywords, and names the generated header's includes define as macros. */
+static const char *const reserved_names[] = {
+    "auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum",
+    "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return",
+    "short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void",
+    "volatile", "while", "_Bool", "_Complex", "_Imaginary", "bool", "true", "false", "NULL", "offsetof",
+};
+
+/**
+ * @brief Turns a JSON key into a C identifier.
+ *
+ * Characters that cannot appear in identifiers become `_`, and reserved
+ * names get a trailing `_`.
+ */
+static void make_identifier(const char *key, char *out, size_t size)
+{
+    size_t n = 0;
+    if (!isalpha((unsigned char)key[0]) && key[0] != '_')
+        out[n++] = '_';
+    for (const char *p = key; *p && n + 2 < size; p++)
+        out[n++] = isalnum((unsigned char)*p) ? *p : '_';
+    out[n] = '\0';
+
+    for (size_t i = 0; i < sizeof(reserved_names) / sizeof(reserved_names[0]); i++)
+    {
+        if (strcmp(out, reserved_names[i]) == 0)
+        {
+            out[n++] = '_';
+            out[n] = '\0';
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Picks a distinct member name for every key of an object.
+ *
+ * Keys that map to the same identifier (`a-b` and `a_b`, or a key repeated
+ * in the sample) are told apart by a numeric suffix: `a_b`, `a_b_2`, ...
+ */
+static void make_member_names(const JsonObject *members, char (*fields)[BINDGEN_NAME_MAX])
+{
+    for (size_t i = 0; i < members->count; i++)
+    {
+        /* Leaves room for the suffix */
+        char base[BINDGEN_NAME_MAX - 24];
+        make_identifier(members->pairs[i].key, base, sizeof(base));
+        strcpy(fields[i], base);
+        for (size_t suffix = 2, j = 0; j < i; j++)
+        {
+            if (strcmp(fields[i], fields[j]) == 0)
+            {
+                snprintf(fields[i], BINDGEN_NAME_MAX, "%s_%zu", base, suffix++);
+                j = (size_t)-1; /* Check the new name against every earlier one */
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes a key inside a C comment, so that it cannot end the comment.
+ */
+static void write_comment_key(FILE *out, const char *key)
+{
+    fputc('"', out);
+    for (const char *p = key; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c < 0x20 || c >= 0x7F)
+            fprintf(out, "\\%03o", c);
+        else if (c == '/' && p > key && p[-1] == '*')
+            fputs("\\/", out);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+/**
+ * @brief Returns whether a key needs escaping inside a JSON string.
+ */
+static int needs_json_escape(const char *key)
+{
+    for (const char *p = key; *p; p++)
+    {
+        if (*p == '"' || *p == '\\' || (unsigned char)*p < 0x20)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes a decoded key as a C string literal.
+ */
+static void write_c_string(FILE *out, const char *key)
+{
+    fputc('"', out);
+    for (const char *p = key; *p; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20 || c >= 0x7F)
+            fprintf(out, "\\%03o", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+/**
+ * @brief Returns whether a sample value can be bound to a struct member.
+ */
+static int is_bindable(const JsonValue *value)
+{
+    switch (value->type)
+    {
+    case JSON_BOOL:
+    case JSON_NUMBER:
+    case JSON_STRING:
+        return 1;
+    case JSON_OBJECT:
+        for (size_t i = 0; i < value->value.object->count; i++)
+        {
+            if (is_bindable(value->value.object->pairs[i].value))
+                return 1;
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Returns whether a sample number should be bound as an integer.
+ */
+static int is_integer(double number)
+{
+    return number == floor(number) && fabs(number) < 9007199254740992.0;
+}
+
+/**
+ * @brief Emits the struct, field table and descriptor for an object,
+ *        after those of its nested objects.
+ *
+ * @return 1 on success, 0 if allocation fails.
+ */
+static int emit_struct(FILE *out, const JsonValue *object, const char *name)
+{
+    const JsonObject *members = object->value.object;
+    char (*fields)[BINDGEN_NAME_MAX] = json_alloc(sizeof(*fields) * (members->count ? members->count : 1));
+    if (!fields)
+        return 0;
+    make_member_names(members, fields);
+
+    for (size_t i = 0; i < members->count; i++)
+    {
+        const JsonValue *value = members->pairs[i].value;
+        if (value->type == JSON_OBJECT && is_bindable(value))
+        {
+            char nested[BINDGEN_NAME_MAX * 2];
+            snprintf(nested, sizeof(nested), "%s_%s", name, fields[i]);
+            if (!emit_struct(out, value, nested))
+            {
+                json_free(fields);
+                return 0;
+            }
+        }
+    }
+
+    fprintf(out, "typedef struct\n{\n");
+    for (size_t i = 0; i < members->count; i++)
+    {
+        const char *key = members->pairs[i].key;
+        const JsonValue *value = members->pairs[i].value;
+        const char *field = fields[i];
+
+        if (!is_bindable(value))
+        {
+            fprintf(out, "    /* ");
+            write_comment_key(out, key);
+            fprintf(out, ": not bound */\n");
+            continue;
+        }
+        switch (value->type)
+        {
+        case JSON_BOOL:
+            fprintf(out, "    bool %s;\n", field);
+            break;
+        case JSON_NUMBER:
+            fprintf(out, "    %s %s;\n", is_integer(value->value.number) ? "int64_t" : "double", field);
+            break;
+        case JSON_STRING:
+            fprintf(out, "    char *%s;\n", field);
+            break;
+        default:
+            fprintf(out, "    %s_%s %s;\n", name, field, field);
+            break;
+        }
+    }
+    fprintf(out, "} %s;\n\n", name);
+
+    fprintf(out, "static const JsonFieldDesc %s_fields[] = {\n", name);
+    for (size_t i = 0; i < members->count; i++)
+    {
+        const char *key = members->pairs[i].key;
+        const JsonValue *value = members->pairs[i].value;
+        const char *field = fields[i];
+
+        if (!is_bindable(value))
+            continue;
+
+        const char *type;
+        char nested[BINDGEN_NAME_MAX * 3] = "NULL";
+        switch (value->type)
+        {
+        case JSON_BOOL:
+            type = "JSON_FIELD_BOOL";
+            break;
+        case JSON_NUMBER:
+            type = is_integer(value->value.number) ? "JSON_FIELD_INT" : "JSON_FIELD_DOUBLE";
+            break;
+        case JSON_STRING:
+            type = "JSON_FIELD_STRING";
+            break;
+        default:
+            type = "JSON_FIELD_OBJECT";
+            snprintf(nested, sizeof(nested), "&%s_%s_desc", name, field);
+            break;
+        }
+
+        /* JSON_FIELD() pastes the key into its fragment, which only works unescaped */
+        if (needs_json_escape(key))
+        {
+            fprintf(out, "    {");
+            write_c_string(out, key);
+            fprintf(out, ", %s, offsetof(%s, %s), %s, NULL, 0},\n", type, name, field, nested);
+        }
+        else
+        {
+            fprintf(out, "    JSON_FIELD(");
+            write_c_string(out, key);
+            fprintf(out, ", %s, %s, %s, %s),\n", type, name, field, nested);
+        }
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "static const JsonStructDesc %s_desc = JSON_STRUCT_DESC(%s, %s_fields);\n\n", name, name, name);
+    json_free(fields);
+    return 1;
+}
+
+/**
+ * @brief Reads a whole file into a null-terminated buffer.
+ */
+static char *read_file(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *data = json_alloc(capacity);
+    while (data)
+    {
+        length += fread(data + length, 1, capacity - length - 1, file);
+        if (length < capacity - 1)
+            break;
+        capacity *= 2;
+        char *grown = json_realloc(data, capacity);
+        if (!grown)
+            json_free(data);
+        data = grown;
+    }
+    fclose(file);
+    if (data)
+        data[length] = '\0';
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "Usage: %s <StructName> <sample.json> <output.h>\n", argv[0]);
+        return 1;
+    }
+
+    char *text = read_file(argv[2]);
+    if (!text)
+    {
+        fprintf(stderr, "json_bindgen: cannot read %s\n", argv[2]);
+        return 1;
+    }
+    JsonValue *sample = json_parse(text);
+    json_free(text);
+    if (!sample || sample->type != JSON_OBJECT || !is_bindable(sample))
+    {
+        fprintf(stderr, "json_bindgen: %s is not an object with bindable members\n", argv[2]);
+        json_free_value(sample);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[3], "w");
+    if (!out)
+    {
+        fprintf(stderr, "json_bindgen: cannot write %s\n", argv[3]);
+        json_free_value(sample);
+        return 1;
+    }
+
+    char name[BINDGEN_NAME_MAX];
+    char guard[BINDGEN_NAME_MAX];
+    make_identifier(argv[1], name, sizeof(name));
+    for (size_t i = 0; i <= strlen(name); i++)
+        guard[i] = (char)toupper((unsigned char)name[i]);
+
+    fprintf(out, "/* Generated by json_bindgen from ");
+    write_comment_key(out, argv[2]);
+    fprintf(out, ". */\n\n");
+    fprintf(out, "#ifndef %s_BINDING_H\n#define %s_BINDING_H\n\n", guard, guard);
+    fprintf(out, "#include \"json_bind.h\"\n#include <stdbool.h>\n#include <stddef.h>\n#include <stdint.h>\n\n");
+    int ok = emit_struct(out, sample, name);
+    fprintf(out, "#endif // %s_BINDING_H\n", guard);
+
+    fclose(out);
+    json_free_value(sample);
+    if (!ok)
+    {
+        fprintf(stderr, "json_bindgen: out of memory\n");
+        return 1;
+    }
+    return 0;
+}